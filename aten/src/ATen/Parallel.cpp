@@ -0,0 +1,165 @@
+#include <ATen/Parallel.h>
+#include <ATen/detail/WorkStealingPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace at {
+
+namespace {
+
+// Chunks handed out per participating thread by the native backend. Splitting
+// the range more finely than one chunk per thread lets idle threads steal the
+// tail of an imbalanced loop.
+constexpr int64_t CHUNKS_PER_THREAD = 4;
+
+int default_parallel_backend() {
+  const char* env_p = std::getenv("ATEN_PARALLEL_BACKEND");
+  if (env_p && std::strcmp(env_p, "native") == 0) {
+    return static_cast<int>(ParallelBackend::Native);
+  }
+  return static_cast<int>(ParallelBackend::OpenMP);
+}
+
+std::atomic<int>& parallel_backend() {
+  static std::atomic<int> backend(default_parallel_backend());
+  return backend;
+}
+
+int64_t native_num_threads() {
+  int num_threads = get_num_threads();
+  if (num_threads <= 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  return std::max(num_threads, 1);
+}
+
+// The pool is shared by every thread that calls into ATen, so concurrent
+// inter-op threads queue onto the same workers instead of each spawning
+// their own team. It is rebuilt if at::set_num_threads changes the size;
+// callers still holding the previous pool keep it alive until they finish.
+std::shared_ptr<detail::WorkStealingPool> get_pool(int64_t num_threads) {
+  static std::mutex mutex;
+  static std::shared_ptr<detail::WorkStealingPool> pool;
+  std::lock_guard<std::mutex> guard(mutex);
+  size_t num_workers = static_cast<size_t>(num_threads - 1);
+  if (!pool || pool->num_workers() != num_workers) {
+    pool = std::make_shared<detail::WorkStealingPool>(num_workers);
+  }
+  return pool;
+}
+
+struct ParallelForJob {
+  void (*fn)(void*, int64_t, int64_t);
+  void* ctx;
+  int64_t remaining;
+  std::exception_ptr eptr;
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+void run_chunk(void* job_, int64_t begin, int64_t end) {
+  auto job = static_cast<ParallelForJob*>(job_);
+  std::exception_ptr eptr;
+  try {
+    job->fn(job->ctx, begin, end);
+  } catch (...) {
+    eptr = std::current_exception();
+  }
+  // The job lives on the submitting thread's stack; it may be destroyed as
+  // soon as remaining reaches zero, so the update and the notification both
+  // happen under the job's mutex.
+  std::lock_guard<std::mutex> guard(job->mutex);
+  if (eptr && !job->eptr) {
+    job->eptr = eptr;
+  }
+  if (--job->remaining == 0) {
+    job->cv.notify_all();
+  }
+}
+
+} // namespace
+
+void set_parallel_backend(ParallelBackend backend) {
+  parallel_backend().store(static_cast<int>(backend));
+}
+
+ParallelBackend get_parallel_backend() {
+  return static_cast<ParallelBackend>(parallel_backend().load());
+}
+
+bool in_parallel_region() {
+#ifdef _OPENMP
+  if (omp_in_parallel()) {
+    return true;
+  }
+#endif
+  return detail::in_pool_task();
+}
+
+namespace internal {
+
+void native_parallel_for(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    void (*fn)(void*, int64_t, int64_t),
+    void* ctx) {
+  const int64_t range = end - begin;
+  if (range <= 0) {
+    return;
+  }
+  const int64_t num_threads = native_num_threads();
+  if (range < grain_size || num_threads == 1 || in_parallel_region()) {
+    fn(ctx, begin, end);
+    return;
+  }
+
+  const int64_t num_chunks = std::min(
+      num_threads * CHUNKS_PER_THREAD, divup(range, std::max<int64_t>(grain_size, 1)));
+  if (num_chunks == 1) {
+    fn(ctx, begin, end);
+    return;
+  }
+  const int64_t chunk_size = divup(range, num_chunks);
+
+  auto pool = get_pool(num_threads);
+  ParallelForJob job;
+  job.fn = fn;
+  job.ctx = ctx;
+  job.remaining = divup(range, chunk_size);
+  for (int64_t i = begin + chunk_size; i < end; i += chunk_size) {
+    pool->submit({run_chunk, &job, i, std::min(end, i + chunk_size)});
+  }
+
+  // The calling thread takes the first chunk and then helps drain the pool
+  // until every chunk of this job has been processed.
+  detail::WorkStealingPool::run_task(
+      {run_chunk, &job, begin, std::min(end, begin + chunk_size)});
+  while (true) {
+    {
+      std::lock_guard<std::mutex> guard(job.mutex);
+      if (job.remaining == 0) {
+        break;
+      }
+    }
+    if (!pool->run_pending_task()) {
+      std::unique_lock<std::mutex> lock(job.mutex);
+      job.cv.wait(lock, [&job] { return job.remaining == 0; });
+      break;
+    }
+  }
+  if (job.eptr) {
+    std::rethrow_exception(job.eptr);
+  }
+}
+
+} // namespace internal
+} // namespace at
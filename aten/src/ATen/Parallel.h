@@ -1,5 +1,6 @@
 #pragma once
 #include <ATen/ATen.h>
+#include <ATen/SmallVector.h>
 #include <cstddef>
 
 #ifdef _OPENMP
@@ -20,12 +21,63 @@ inline int64_t divup(int64_t x, int64_t y) {
   return (x + y - 1) / y;
 }
 
+// Intra-op parallelism backend used by parallel_for and parallel_reduce.
+//
+// OpenMP forks an OpenMP team per call and splits the range into one equal
+// chunk per thread. Native schedules the range as several chunks per thread
+// on a process-wide work-stealing pool (see detail/WorkStealingPool.h), so
+// that many inter-op threads calling into ATen share one set of workers
+// instead of oversubscribing the machine. The default is OpenMP; it can be
+// changed with set_parallel_backend or by setting the environment variable
+// ATEN_PARALLEL_BACKEND=native.
+enum class ParallelBackend { OpenMP, Native };
+
+AT_API void set_parallel_backend(ParallelBackend backend);
+AT_API ParallelBackend get_parallel_backend();
+
+// Returns true if the calling thread is already executing inside a
+// parallel_for, in which case nested parallel loops run serially.
+AT_API bool in_parallel_region();
+
+namespace internal {
+AT_API void native_parallel_for(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    void (*fn)(void*, int64_t, int64_t),
+    void* ctx);
+
+// Pairwise reduction of data[0 ... n-1] in place; returns the result.
+// Compared to a left fold this keeps the rounding error of floating point
+// sums at O(log n) in the number of partial results.
+template <class scalar_t, class SF>
+inline scalar_t tree_reduce(scalar_t* data, int64_t n, const SF& sf) {
+  for (int64_t stride = 1; stride < n; stride *= 2) {
+    for (int64_t i = 0; i + stride < n; i += 2 * stride) {
+      data[i] = sf(data[i], data[i + stride]);
+    }
+  }
+  return data[0];
+}
+} // namespace internal
+
 template <class F>
 inline void parallel_for(
     const int64_t begin,
     const int64_t end,
     const int64_t grain_size,
     const F& f) {
+  if (get_parallel_backend() == ParallelBackend::Native) {
+    internal::native_parallel_for(
+        begin,
+        end,
+        grain_size,
+        [](void* ctx, int64_t begin_, int64_t end_) {
+          (*static_cast<const F*>(ctx))(begin_, end_);
+        },
+        const_cast<void*>(static_cast<const void*>(&f)));
+    return;
+  }
 #ifdef _OPENMP
 #pragma omp parallel if ((end - begin) >= grain_size)
   {
@@ -41,6 +93,20 @@ inline void parallel_for(
 #endif
 }
 
+// parallel_for as a function object, for kernels that are templated on their
+// parallel loop so that they can be shared with Caffe2 (e.g. UniqueKernel in
+// ATen/core/Unique.h).
+struct ParallelFor {
+  template <class F>
+  void operator()(
+      const int64_t begin,
+      const int64_t end,
+      const int64_t grain_size,
+      const F& f) const {
+    parallel_for(begin, end, grain_size, f);
+  }
+};
+
 template <class scalar_t, class F, class SF>
 inline scalar_t parallel_reduce(
     const int64_t begin,
@@ -49,19 +115,21 @@ inline scalar_t parallel_reduce(
     const scalar_t ident,
     const F f,
     const SF sf) {
-  if (get_num_threads() == 1) {
+  const int64_t num_results = divup((end - begin), grain_size);
+  if (get_num_threads() == 1 || num_results <= 1 || in_parallel_region()) {
     return f(begin, end, ident);
   } else {
-    const int64_t num_results = divup((end - begin), grain_size);
-    std::vector<scalar_t> results(num_results);
+    // Partial results are always split at multiples of grain_size, so the
+    // result does not depend on the number of threads or on the backend.
+    SmallVector<scalar_t, 64> results(num_results, ident);
     scalar_t* results_data = results.data();
-#pragma omp parallel for if ((end - begin) >= grain_size)
-    for (int64_t id = 0; id < num_results; id++) {
-      int64_t i = begin + id * grain_size;
-      results_data[id] = f(i, i + std::min(end - i, grain_size), ident);
-    }
-    return std::accumulate(
-        results_data, results_data + results.size(), ident, sf);
+    parallel_for(0, num_results, 1, [&](int64_t id_begin, int64_t id_end) {
+      for (int64_t id = id_begin; id < id_end; id++) {
+        int64_t i = begin + id * grain_size;
+        results_data[id] = f(i, i + std::min(end - i, grain_size), ident);
+      }
+    });
+    return internal::tree_reduce(results_data, num_results, sf);
   }
 }
 
@@ -0,0 +1,330 @@
+#include <ATen/core/CPUCachingAllocator.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#if defined(__ANDROID__)
+#include <malloc.h>
+#endif
+
+namespace at {
+
+namespace {
+
+// Every block starts with a header recording its size class. The header
+// takes a full alignment unit so that the pointer handed out stays aligned.
+struct BlockHeader {
+  size_t size_class;
+  size_t nbytes;
+};
+constexpr size_t kHeaderSize = CPUCachingAllocator::kAlignment;
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "BlockHeader too large");
+
+constexpr size_t kUncached = static_cast<size_t>(-1);
+
+// Size classes cover (2^k, 2^(k+1)] in four equal steps, for k from
+// kMinLog (2^kMinLog < kMinCachedSize) up to the class that ends at
+// kMaxCachedSize.
+constexpr size_t kMinLog = 11;
+constexpr size_t kMaxLog = 30;
+constexpr size_t kStepsPerLog = 4;
+constexpr size_t kNumClasses = (kMaxLog - kMinLog + 1) * kStepsPerLog;
+
+// Free blocks a thread keeps per size class before handing them to the
+// global pool.
+constexpr size_t kThreadCacheBlocks = 4;
+
+size_t floorLog2(size_t n) {
+  size_t k = 0;
+  while (n >>= 1) {
+    k++;
+  }
+  return k;
+}
+
+// Requires kMinCachedSize <= nbytes <= kMaxCachedSize.
+size_t sizeClass(size_t nbytes) {
+  size_t k = floorLog2(nbytes - 1);
+  size_t base = size_t(1) << k;
+  size_t step = base / kStepsPerLog;
+  size_t j = (nbytes - base + step - 1) / step;
+  return (k - kMinLog) * kStepsPerLog + (j - 1);
+}
+
+size_t classBytes(size_t size_class) {
+  size_t base = size_t(1) << (size_class / kStepsPerLog + kMinLog);
+  return base + (size_class % kStepsPerLog + 1) * (base / kStepsPerLog);
+}
+
+BlockHeader* header(void* ptr) {
+  return reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - kHeaderSize);
+}
+
+void* systemAlloc(size_t nbytes) {
+  void* base = nullptr;
+#if defined(__ANDROID__)
+  base = memalign(CPUCachingAllocator::kAlignment, nbytes + kHeaderSize);
+#elif defined(_MSC_VER)
+  base = _aligned_malloc(nbytes + kHeaderSize, CPUCachingAllocator::kAlignment);
+#else
+  if (posix_memalign(&base, CPUCachingAllocator::kAlignment, nbytes + kHeaderSize) != 0) {
+    base = nullptr;
+  }
+#endif
+  return base ? static_cast<char*>(base) + kHeaderSize : nullptr;
+}
+
+void systemFree(void* ptr) {
+  void* base = header(ptr);
+#ifdef _MSC_VER
+  _aligned_free(base);
+#else
+  ::free(base);
+#endif
+}
+
+struct ThreadCache {
+  // Only contended by emptyCache(), which may drain other threads' caches.
+  std::mutex mutex;
+  std::vector<void*> blocks[kNumClasses];
+};
+
+// The cache of the current thread. tls_cache_destroyed is set once the owner
+// below has run its destructor, after which frees on this thread (e.g. from
+// other thread_local destructors) go straight to the global pool.
+thread_local ThreadCache* tls_cache = nullptr;
+thread_local bool tls_cache_destroyed = false;
+
+} // namespace
+
+struct CPUCachingAllocator::Impl {
+  std::atomic<size_t> max_cached_bytes{kDefaultMaxCachedBytes};
+
+  std::atomic<size_t> allocated_bytes{0};
+  std::atomic<size_t> peak_allocated_bytes{0};
+  std::atomic<size_t> cached_bytes{0};
+  std::atomic<uint64_t> num_allocations{0};
+  std::atomic<uint64_t> num_cache_hits{0};
+
+  // Guards global_blocks and thread_caches.
+  std::mutex mutex;
+  std::vector<void*> global_blocks[kNumClasses];
+  std::vector<ThreadCache*> thread_caches;
+
+  // Retires the thread's cache when the thread exits.
+  struct ThreadCacheOwner {
+    Impl* impl = nullptr;
+    ThreadCache* cache = nullptr;
+    ~ThreadCacheOwner() {
+      tls_cache = nullptr;
+      tls_cache_destroyed = true;
+      if (cache) {
+        impl->retire(cache);
+      }
+    }
+  };
+
+  ThreadCache* threadCache();
+  void retire(ThreadCache* cache);
+
+  void recordAllocated(size_t nbytes) {
+    size_t now = allocated_bytes.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+    size_t peak = peak_allocated_bytes.load(std::memory_order_relaxed);
+    while (now > peak &&
+           !peak_allocated_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Accounts for nbytes more cached memory, unless that would exceed the cap.
+  bool reserveCached(size_t nbytes) {
+    size_t prev = cached_bytes.fetch_add(nbytes, std::memory_order_relaxed);
+    if (prev + nbytes > max_cached_bytes.load(std::memory_order_relaxed)) {
+      cached_bytes.fetch_sub(nbytes, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  void releaseBlocks(std::vector<void*>& blocks, size_t size_class) {
+    if (blocks.empty()) {
+      return;
+    }
+    cached_bytes.fetch_sub(blocks.size() * classBytes(size_class), std::memory_order_relaxed);
+    for (void* ptr : blocks) {
+      systemFree(ptr);
+    }
+    blocks.clear();
+  }
+
+  void* takeCached(size_t size_class) {
+    if (ThreadCache* cache = threadCache()) {
+      std::lock_guard<std::mutex> guard(cache->mutex);
+      auto& blocks = cache->blocks[size_class];
+      if (!blocks.empty()) {
+        void* ptr = blocks.back();
+        blocks.pop_back();
+        return ptr;
+      }
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    auto& blocks = global_blocks[size_class];
+    if (!blocks.empty()) {
+      void* ptr = blocks.back();
+      blocks.pop_back();
+      return ptr;
+    }
+    return nullptr;
+  }
+
+  void putCached(void* ptr, size_t size_class) {
+    if (ThreadCache* cache = threadCache()) {
+      std::lock_guard<std::mutex> guard(cache->mutex);
+      auto& blocks = cache->blocks[size_class];
+      if (blocks.size() < kThreadCacheBlocks) {
+        blocks.push_back(ptr);
+        return;
+      }
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    global_blocks[size_class].push_back(ptr);
+  }
+};
+
+ThreadCache* CPUCachingAllocator::Impl::threadCache() {
+  if (tls_cache || tls_cache_destroyed) {
+    return tls_cache;
+  }
+  static thread_local ThreadCacheOwner owner;
+  owner.impl = this;
+  owner.cache = new ThreadCache();
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    thread_caches.push_back(owner.cache);
+  }
+  tls_cache = owner.cache;
+  return tls_cache;
+}
+
+// Moves the blocks of an exiting thread to the global pool.
+void CPUCachingAllocator::Impl::retire(ThreadCache* cache) {
+  std::lock_guard<std::mutex> guard(mutex);
+  for (size_t i = 0; i < thread_caches.size(); i++) {
+    if (thread_caches[i] == cache) {
+      thread_caches.erase(thread_caches.begin() + i);
+      break;
+    }
+  }
+  for (size_t c = 0; c < kNumClasses; c++) {
+    auto& blocks = cache->blocks[c];
+    global_blocks[c].insert(global_blocks[c].end(), blocks.begin(), blocks.end());
+  }
+  delete cache;
+}
+
+constexpr size_t CPUCachingAllocator::kAlignment;
+constexpr size_t CPUCachingAllocator::kMinCachedSize;
+constexpr size_t CPUCachingAllocator::kMaxCachedSize;
+constexpr size_t CPUCachingAllocator::kDefaultMaxCachedBytes;
+
+CPUCachingAllocator::CPUCachingAllocator() : impl_(new Impl()) {}
+
+CPUCachingAllocator& CPUCachingAllocator::get() {
+  // Intentionally leaked: blocks may be freed by static destructors that run
+  // after this would have been destroyed.
+  static CPUCachingAllocator* allocator = new CPUCachingAllocator();
+  return *allocator;
+}
+
+void* CPUCachingAllocator::allocate(size_t nbytes, bool* from_cache) {
+  impl_->num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (from_cache) {
+    *from_cache = false;
+  }
+
+  size_t size_class = kUncached;
+  size_t block_bytes = nbytes;
+  if (nbytes >= kMinCachedSize && nbytes <= kMaxCachedSize) {
+    size_class = sizeClass(nbytes);
+    block_bytes = classBytes(size_class);
+    if (void* ptr = impl_->takeCached(size_class)) {
+      impl_->cached_bytes.fetch_sub(block_bytes, std::memory_order_relaxed);
+      impl_->num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+      impl_->recordAllocated(block_bytes);
+      if (from_cache) {
+        *from_cache = true;
+      }
+      return ptr;
+    }
+  }
+
+  void* ptr = systemAlloc(block_bytes);
+  if (!ptr) {
+    // Memory pressure: give back everything we hold and try once more.
+    emptyCache();
+    ptr = systemAlloc(block_bytes);
+    if (!ptr) {
+      return nullptr;
+    }
+  }
+  BlockHeader* h = header(ptr);
+  h->size_class = size_class;
+  h->nbytes = block_bytes;
+  impl_->recordAllocated(block_bytes);
+  return ptr;
+}
+
+void CPUCachingAllocator::free(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  Impl* impl = get().impl_;
+  BlockHeader* h = header(ptr);
+  impl->allocated_bytes.fetch_sub(h->nbytes, std::memory_order_relaxed);
+  if (h->size_class == kUncached || !impl->reserveCached(h->nbytes)) {
+    systemFree(ptr);
+    return;
+  }
+  impl->putCached(ptr, h->size_class);
+}
+
+void CPUCachingAllocator::emptyCache() {
+  std::lock_guard<std::mutex> guard(impl_->mutex);
+  for (ThreadCache* cache : impl_->thread_caches) {
+    std::lock_guard<std::mutex> cache_guard(cache->mutex);
+    for (size_t c = 0; c < kNumClasses; c++) {
+      impl_->releaseBlocks(cache->blocks[c], c);
+    }
+  }
+  for (size_t c = 0; c < kNumClasses; c++) {
+    impl_->releaseBlocks(impl_->global_blocks[c], c);
+  }
+}
+
+void CPUCachingAllocator::setMaxCachedBytes(size_t bytes) {
+  impl_->max_cached_bytes.store(bytes);
+  if (impl_->cached_bytes.load() > bytes) {
+    emptyCache();
+  }
+}
+
+size_t CPUCachingAllocator::maxCachedBytes() const {
+  return impl_->max_cached_bytes.load();
+}
+
+CPUCachingAllocator::Stats CPUCachingAllocator::stats() const {
+  Stats stats;
+  stats.allocated_bytes = impl_->allocated_bytes.load();
+  stats.peak_allocated_bytes = impl_->peak_allocated_bytes.load();
+  stats.cached_bytes = impl_->cached_bytes.load();
+  stats.num_allocations = impl_->num_allocations.load();
+  stats.num_cache_hits = impl_->num_cache_hits.load();
+  return stats;
+}
+
+void CPUCachingAllocator::resetPeakStats() {
+  impl_->peak_allocated_bytes.store(impl_->allocated_bytes.load());
+}
+
+} // namespace at
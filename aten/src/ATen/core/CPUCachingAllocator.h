@@ -0,0 +1,80 @@
+#pragma once
+
+#include <ATen/core/ATenCoreTest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace at {
+
+// Caching allocator for CPU memory, shared by ATen and Caffe2.
+//
+// Tensors that are freed and reallocated every iteration (activations,
+// gradients, operator scratch space) otherwise cost a malloc/free pair each
+// time, and for large blocks glibc hands them back to the kernel, so every
+// reuse pays again for page faults and (in Caffe2) for NUMA page moves.
+//
+// Requests are rounded up to a size class (four classes per power of two)
+// and freed blocks are kept on per-class free lists:
+//
+//  - Every thread has a small cache of its own, so the common
+//    allocate-free-allocate pattern of one thread never takes a shared lock.
+//  - Blocks that do not fit in the thread's cache go to a global pool, where
+//    other threads can pick them up. A thread's cache is flushed to the
+//    global pool when the thread exits.
+//  - The total number of cached bytes is capped (setMaxCachedBytes); blocks
+//    that would exceed the cap are returned to the system immediately.
+//  - If the system allocation fails, every cache is released and the
+//    allocation is retried once before giving up.
+//
+// Blocks smaller than kMinCachedSize or larger than kMaxCachedSize bypass the
+// caches. All blocks are aligned to kAlignment bytes. Blocks are freed with
+// CPUCachingAllocator::free, which may be called from any thread.
+class AT_CORE_API CPUCachingAllocator {
+ public:
+  static constexpr size_t kAlignment = 64;
+  static constexpr size_t kMinCachedSize = 4096;
+  static constexpr size_t kMaxCachedSize = size_t(1) << 31;
+  static constexpr size_t kDefaultMaxCachedBytes = size_t(1) << 30;
+
+  struct Stats {
+    // Bytes handed out and not yet freed, rounded up to their size class.
+    size_t allocated_bytes;
+    // High-water mark of allocated_bytes.
+    size_t peak_allocated_bytes;
+    // Bytes held in free lists, ready to be reused.
+    size_t cached_bytes;
+    // Number of allocate() calls, and how many were served from a cache.
+    uint64_t num_allocations;
+    uint64_t num_cache_hits;
+  };
+
+  static CPUCachingAllocator& get();
+
+  // Returns a block of at least nbytes bytes, or nullptr if the system is out
+  // of memory even after releasing the caches. If from_cache is non-null, it
+  // is set to whether the block was reused rather than freshly allocated.
+  void* allocate(size_t nbytes, bool* from_cache = nullptr);
+
+  // Deleter matching allocate(); accepts nullptr.
+  static void free(void* ptr);
+
+  // Returns every cached block to the system.
+  void emptyCache();
+
+  void setMaxCachedBytes(size_t bytes);
+  size_t maxCachedBytes() const;
+
+  Stats stats() const;
+  void resetPeakStats();
+
+ private:
+  CPUCachingAllocator();
+  CPUCachingAllocator(const CPUCachingAllocator&) = delete;
+  CPUCachingAllocator& operator=(const CPUCachingAllocator&) = delete;
+
+  struct Impl;
+  Impl* impl_;
+};
+
+} // namespace at
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace at {
+
+// Maps a value to an unsigned integer whose order is the order of the values,
+// so that sorting, selection and hashing kernels only deal with integers
+// (and radix sort applies to every type).
+//
+// For floating point types NaNs are canonicalized to a single positive NaN,
+// which orders above +inf (as in TH, where NaN compares greater than
+// everything else), and -0 is mapped to +0 so that the two zeros compare
+// equal. Two values have the same key iff they compare equal, or are both NaN.
+template <typename T>
+struct OrderedKey;
+
+template <>
+struct OrderedKey<uint8_t> {
+  using type = uint8_t;
+  static type get(uint8_t x) {
+    return x;
+  }
+};
+
+template <>
+struct OrderedKey<int8_t> {
+  using type = uint8_t;
+  static type get(int8_t x) {
+    return static_cast<uint8_t>(x) ^ 0x80u;
+  }
+};
+
+template <>
+struct OrderedKey<int16_t> {
+  using type = uint16_t;
+  static type get(int16_t x) {
+    return static_cast<uint16_t>(x) ^ 0x8000u;
+  }
+};
+
+template <>
+struct OrderedKey<int32_t> {
+  using type = uint32_t;
+  static type get(int32_t x) {
+    return static_cast<uint32_t>(x) ^ 0x80000000u;
+  }
+};
+
+template <>
+struct OrderedKey<int64_t> {
+  using type = uint64_t;
+  static type get(int64_t x) {
+    return static_cast<uint64_t>(x) ^ (uint64_t(1) << 63);
+  }
+};
+
+// IEEE floats order like sign-magnitude integers: flip all bits of negative
+// numbers and only the sign bit of positive ones.
+template <>
+struct OrderedKey<float> {
+  using type = uint32_t;
+  static type get(float x) {
+    uint32_t bits = 0;
+    if (std::isnan(x)) {
+      bits = 0x7fc00000u;
+    } else if (x != 0) {
+      std::memcpy(&bits, &x, sizeof(bits));
+    }
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+  }
+};
+
+template <>
+struct OrderedKey<double> {
+  using type = uint64_t;
+  static type get(double x) {
+    uint64_t bits = 0;
+    if (std::isnan(x)) {
+      bits = 0x7ff8000000000000ull;
+    } else if (x != 0) {
+      std::memcpy(&bits, &x, sizeof(bits));
+    }
+    const uint64_t sign = uint64_t(1) << 63;
+    return (bits & sign) ? ~bits : (bits | sign);
+  }
+};
+
+} // namespace at
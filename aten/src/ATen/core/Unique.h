@@ -0,0 +1,367 @@
+#pragma once
+
+#include <ATen/core/OrderedKey.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace at {
+
+// Runs f(i, i + 1) for every i in [begin, end), on the OpenMP threads if there
+// are more than grain_size iterations. This is the default ParallelFor of
+// UniqueKernel for callers without an intra-op thread pool of their own (such
+// as Caffe2 operators); ATen passes at::parallel_for instead.
+struct OpenMPParallelFor {
+  template <typename F>
+  void operator()(int64_t begin, int64_t end, int64_t grain_size, const F& f)
+      const {
+#ifdef _OPENMP
+    if (end - begin > grain_size && !omp_in_parallel()) {
+#pragma omp parallel for schedule(dynamic)
+      for (int64_t i = begin; i < end; i++) {
+        f(i, i + 1);
+      }
+      return;
+    }
+#endif
+    f(begin, end);
+  }
+};
+
+// Parallel unique for a flat array of values, shared by ATen's unique and
+// Caffe2's Unique operator.
+//
+// The input is split into fixed-size chunks, and every value is assigned to a
+// partition; the chunks are scattered into per-partition buckets in parallel,
+// and each partition is then deduplicated independently with an
+// open-addressing hash table. Partitions are chosen by hash, or, if the
+// output is to be sorted, by range with splitters taken from a sample of the
+// input, so that sorting each partition's unique values sorts the whole
+// output. The tables are kept to compute inverse indices afterwards.
+//
+// Chunking does not depend on the number of threads, so the output is
+// deterministic: without sorting, unique values come out partition by
+// partition in the order of their first occurrence.
+//
+// Values are compared by OrderedKey, so all NaNs are one value.
+//
+// Usage: construct, allocate size() outputs, then call unique() and,
+// optionally, inverse(). ParallelFor is called as
+// parallel_for(begin, end, grain_size, f) and must run f(b, e) on subranges
+// covering [begin, end), like at::parallel_for.
+template <typename T, typename ParallelFor = OpenMPParallelFor>
+class UniqueKernel {
+ public:
+  UniqueKernel(
+      const T* data,
+      int64_t n,
+      bool sorted,
+      const ParallelFor& parallel_for = ParallelFor())
+      : data_(data), n_(n), sorted_(sorted), parallel_for_(parallel_for) {
+    num_chunks_ = std::min<int64_t>(
+        kMaxChunks, std::max<int64_t>(1, n_ / kChunkSize));
+    num_partitions_ = 1;
+    log_partitions_ = 0;
+    while (num_partitions_ < num_chunks_) {
+      num_partitions_ *= 2;
+      log_partitions_++;
+    }
+    partitions_.resize(num_partitions_);
+    if (num_partitions_ > 1) {
+      if (sorted_) {
+        chooseSplitters();
+      }
+      scatter();
+    }
+    parallel_for_(0, num_partitions_, 1, [this](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        buildPartition(p);
+      }
+    });
+    offsets_.resize(num_partitions_ + 1);
+    offsets_[0] = 0;
+    for (int64_t p = 0; p < num_partitions_; p++) {
+      offsets_[p + 1] = offsets_[p] + partitions_[p].values.size();
+    }
+    // The buckets are not needed to look up inverse indices.
+    std::vector<T>().swap(buckets_);
+  }
+
+  // Number of unique values.
+  int64_t size() const {
+    return offsets_.back();
+  }
+
+  // Writes the size() unique values to `output` and, unless it is null, the
+  // number of occurrences of each to `counts`.
+  void unique(T* output, int64_t* counts) const {
+    parallel_for_(0, num_partitions_, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        const Partition& partition = partitions_[p];
+        std::copy(
+            partition.values.begin(),
+            partition.values.end(),
+            output + offsets_[p]);
+        if (counts) {
+          std::copy(
+              partition.counts.begin(),
+              partition.counts.end(),
+              counts + offsets_[p]);
+        }
+      }
+    });
+  }
+
+  // Writes, for each of the n input values, its position in the output of
+  // unique().
+  template <typename index_t>
+  void inverse(index_t* output) const {
+    parallel_for_(0, num_chunks_, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        const int64_t chunk_end = chunkEnd(c);
+        for (int64_t i = chunkBegin(c); i < chunk_end; i++) {
+          const Key key = OrderedKey<T>::get(data_[i]);
+          const int64_t p = partitionOf(key);
+          output[i] =
+              static_cast<index_t>(offsets_[p] + partitions_[p].find(key));
+        }
+      }
+    });
+  }
+
+ private:
+  using Key = typename OrderedKey<T>::type;
+
+  // Inputs are split into chunks of this many values (but at most kMaxChunks
+  // of them), and into a power of two number of partitions no smaller than the
+  // number of chunks. Inputs of a single chunk are deduplicated serially.
+  static constexpr int64_t kChunkSize = 1 << 16;
+  static constexpr int64_t kMaxChunks = 256;
+  // Sampled values per partition when choosing splitters.
+  static constexpr int64_t kSamplesPerPartition = 32;
+
+  struct Partition {
+    // Open-addressing hash table from key to position in `values`; -1 marks
+    // an empty slot. The capacity is a power of two, at most half full.
+    std::vector<Key> keys;
+    std::vector<int64_t> slots;
+    // The partition's unique values and their number of occurrences.
+    std::vector<T> values;
+    std::vector<int64_t> counts;
+    // The partition's range in buckets_.
+    int64_t bucket_begin = 0;
+    int64_t bucket_end = 0;
+
+    // Position of `key`, which must be in the table.
+    int64_t find(Key key) const {
+      const size_t mask = slots.size() - 1;
+      size_t s = hash(key) & mask;
+      while (slots[s] < 0 || keys[s] != key) {
+        s = (s + 1) & mask;
+      }
+      return slots[s];
+    }
+  };
+
+  // Finalizer of MurmurHash3; the top bits pick the partition and the
+  // bottom bits the slot.
+  static uint64_t hash(Key key) {
+    uint64_t h = key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  int64_t chunkBegin(int64_t c) const {
+    return n_ * c / num_chunks_;
+  }
+
+  int64_t chunkEnd(int64_t c) const {
+    return n_ * (c + 1) / num_chunks_;
+  }
+
+  int64_t partitionOf(Key key) const {
+    if (num_partitions_ == 1) {
+      return 0;
+    }
+    if (sorted_) {
+      // Branch-free binary search for the number of splitters <= key; there
+      // are num_partitions_ - 1 of them.
+      int64_t p = 0;
+      for (int64_t step = num_partitions_ / 2; step > 0; step /= 2) {
+        p += splitters_[p + step - 1] <= key ? step : 0;
+      }
+      return p;
+    }
+    return hash(key) >> (64 - log_partitions_);
+  }
+
+  // Range partitioning for sorted output: partition p holds the keys in
+  // [splitters_[p - 1], splitters_[p]). Equal keys always share a partition,
+  // and the sample keeps partitions balanced for skewed inputs.
+  void chooseSplitters() {
+    const int64_t num_samples = num_partitions_ * kSamplesPerPartition;
+    std::vector<Key> sample(num_samples);
+    for (int64_t i = 0; i < num_samples; i++) {
+      sample[i] = OrderedKey<T>::get(data_[n_ * i / num_samples]);
+    }
+    std::sort(sample.begin(), sample.end());
+    splitters_.resize(num_partitions_ - 1);
+    for (int64_t p = 0; p < num_partitions_ - 1; p++) {
+      splitters_[p] = sample[(p + 1) * kSamplesPerPartition];
+    }
+  }
+
+  // Copies the input into buckets_, grouped by partition and in input order
+  // within each partition.
+  void scatter() {
+    // counts[c * P + p] is the number of values of chunk c in partition p,
+    // and then the position in buckets_ where chunk c writes them.
+    std::vector<int64_t> counts(num_chunks_ * num_partitions_, 0);
+    parallel_for_(0, num_chunks_, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* chunk_counts = &counts[c * num_partitions_];
+        const int64_t chunk_end = chunkEnd(c);
+        for (int64_t i = chunkBegin(c); i < chunk_end; i++) {
+          chunk_counts[partitionOf(OrderedKey<T>::get(data_[i]))]++;
+        }
+      }
+    });
+    int64_t offset = 0;
+    for (int64_t p = 0; p < num_partitions_; p++) {
+      partitions_[p].bucket_begin = offset;
+      for (int64_t c = 0; c < num_chunks_; c++) {
+        const int64_t count = counts[c * num_partitions_ + p];
+        counts[c * num_partitions_ + p] = offset;
+        offset += count;
+      }
+      partitions_[p].bucket_end = offset;
+    }
+    buckets_.resize(n_);
+    parallel_for_(0, num_chunks_, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* positions = &counts[c * num_partitions_];
+        const int64_t chunk_end = chunkEnd(c);
+        for (int64_t i = chunkBegin(c); i < chunk_end; i++) {
+          const int64_t p = partitionOf(OrderedKey<T>::get(data_[i]));
+          buckets_[positions[p]++] = data_[i];
+        }
+      }
+    });
+  }
+
+  void buildPartition(int64_t p) {
+    Partition& partition = partitions_[p];
+    const T* begin = data_;
+    const T* end = data_ + n_;
+    if (num_partitions_ > 1) {
+      begin = buckets_.data() + partition.bucket_begin;
+      end = buckets_.data() + partition.bucket_end;
+    }
+    size_t capacity = 16;
+    partition.keys.assign(capacity, 0);
+    partition.slots.assign(capacity, -1);
+    for (const T* it = begin; it != end; ++it) {
+      const Key key = OrderedKey<T>::get(*it);
+      size_t mask = capacity - 1;
+      size_t s = hash(key) & mask;
+      while (partition.slots[s] >= 0 && partition.keys[s] != key) {
+        s = (s + 1) & mask;
+      }
+      if (partition.slots[s] >= 0) {
+        partition.counts[partition.slots[s]]++;
+        continue;
+      }
+      partition.keys[s] = key;
+      partition.slots[s] = partition.values.size();
+      partition.values.push_back(*it);
+      partition.counts.push_back(1);
+      if (partition.values.size() * 2 > capacity) {
+        capacity *= 2;
+        rehash(&partition, capacity);
+      }
+    }
+    if (sorted_) {
+      sortPartition(&partition);
+    }
+  }
+
+  static void rehash(Partition* partition, size_t capacity) {
+    std::vector<Key> keys(capacity, 0);
+    std::vector<int64_t> slots(capacity, -1);
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < partition->slots.size(); i++) {
+      if (partition->slots[i] < 0) {
+        continue;
+      }
+      size_t s = hash(partition->keys[i]) & mask;
+      while (slots[s] >= 0) {
+        s = (s + 1) & mask;
+      }
+      keys[s] = partition->keys[i];
+      slots[s] = partition->slots[i];
+    }
+    partition->keys.swap(keys);
+    partition->slots.swap(slots);
+  }
+
+  // Sorts the partition's unique values and renumbers the hash table.
+  static void sortPartition(Partition* partition) {
+    const int64_t size = partition->values.size();
+    std::vector<Key> keys(size);
+    for (int64_t i = 0; i < size; i++) {
+      keys[i] = OrderedKey<T>::get(partition->values[i]);
+    }
+    std::vector<int64_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&keys](int64_t a, int64_t b) {
+      return keys[a] < keys[b];
+    });
+    std::vector<int64_t> rank(size);
+    std::vector<T> values(size);
+    std::vector<int64_t> counts(size);
+    for (int64_t i = 0; i < size; i++) {
+      rank[order[i]] = i;
+      values[i] = partition->values[order[i]];
+      counts[i] = partition->counts[order[i]];
+    }
+    for (auto& slot : partition->slots) {
+      if (slot >= 0) {
+        slot = rank[slot];
+      }
+    }
+    partition->values.swap(values);
+    partition->counts.swap(counts);
+  }
+
+  const T* data_;
+  int64_t n_;
+  bool sorted_;
+  ParallelFor parallel_for_;
+  int64_t num_chunks_;
+  int64_t num_partitions_;
+  int log_partitions_;
+  std::vector<Key> splitters_;
+  std::vector<T> buckets_;
+  std::vector<Partition> partitions_;
+  // offsets_[p] is the position of partition p's values in the output.
+  std::vector<int64_t> offsets_;
+};
+
+template <typename T, typename ParallelFor>
+constexpr int64_t UniqueKernel<T, ParallelFor>::kChunkSize;
+template <typename T, typename ParallelFor>
+constexpr int64_t UniqueKernel<T, ParallelFor>::kMaxChunks;
+template <typename T, typename ParallelFor>
+constexpr int64_t UniqueKernel<T, ParallelFor>::kSamplesPerPartition;
+
+} // namespace at
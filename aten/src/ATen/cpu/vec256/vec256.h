@@ -5,6 +5,8 @@
 #include "vec256_base.h"
 #include "vec256_float.h"
 #include "vec256_double.h"
+#include "vec256_float_avx512.h"
+#include "vec256_double_avx512.h"
 #include "vec256_int.h"
 
 #include <algorithm>
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec256_base.h"
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+// 512-bit specialization of Vec256<double>, used by the kernels in native/cpu
+// when they are compiled for CPUCapability::AVX512. Under that capability
+// Vec256<T> should be read as "the widest native vector for T": kernels may
+// only rely on Vec::size and the operations below, not on a 32-byte width.
+
+namespace at {
+namespace vec256 {
+namespace {
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+
+template <> class Vec256<double> {
+private:
+  __m512d values;
+  static inline __mmask8 mask_for(int64_t count) {
+    return static_cast<__mmask8>((1 << count) - 1);
+  }
+public:
+  static constexpr int size = 8;
+  Vec256() {}
+  Vec256(__m512d v) : values(v) {}
+  Vec256(double val) {
+    values = _mm512_set1_pd(val);
+  }
+  operator __m512d() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec256<double> blend(Vec256<double> a, Vec256<double> b) {
+    return _mm512_mask_blend_pd(static_cast<__mmask8>(mask), a.values, b.values);
+  }
+  static Vec256<double> set(Vec256<double> a, Vec256<double> b, int64_t count = size) {
+    if (count >= size) {
+      return b;
+    }
+    return _mm512_mask_blend_pd(mask_for(count), a.values, b.values);
+  }
+  static Vec256<double> loadu(const void* ptr, int64_t count = size) {
+    if (count == size)
+      return _mm512_loadu_pd(reinterpret_cast<const double*>(ptr));
+    return _mm512_maskz_loadu_pd(mask_for(count), ptr);
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      _mm512_storeu_pd(reinterpret_cast<double*>(ptr), values);
+    } else {
+      _mm512_mask_storeu_pd(ptr, mask_for(count), values);
+    }
+  }
+  const double& operator[](int idx) const  = delete;
+  double& operator[](int idx) = delete;
+  Vec256<double> map(double (*f)(double)) const {
+    __at_align32__ double tmp[8];
+    store(tmp);
+    for (int64_t i = 0; i < 8; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec256<double> abs() const {
+    auto mask = _mm512_set1_epi64(0x7fffffffffffffffLL);
+    return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(values), mask));
+  }
+  Vec256<double> acos() const {
+    return Vec256<double>(Sleef_acosd8_u10(values));
+  }
+  Vec256<double> asin() const {
+    return Vec256<double>(Sleef_asind8_u10(values));
+  }
+  Vec256<double> atan() const {
+    return Vec256<double>(Sleef_atand8_u10(values));
+  }
+  Vec256<double> erf() const {
+    return Vec256<double>(Sleef_erfd8_u10(values));
+  }
+  Vec256<double> erfc() const {
+    return Vec256<double>(Sleef_erfcd8_u15(values));
+  }
+  Vec256<double> exp() const {
+    return Vec256<double>(Sleef_expd8_u10(values));
+  }
+  Vec256<double> expm1() const {
+    return Vec256<double>(Sleef_expm1d8_u10(values));
+  }
+  Vec256<double> log() const {
+    return Vec256<double>(Sleef_logd8_u10(values));
+  }
+  Vec256<double> log2() const {
+    return Vec256<double>(Sleef_log2d8_u10(values));
+  }
+  Vec256<double> log10() const {
+    return Vec256<double>(Sleef_log10d8_u10(values));
+  }
+  Vec256<double> log1p() const {
+    return Vec256<double>(Sleef_log1pd8_u10(values));
+  }
+  Vec256<double> sin() const {
+    return map(std::sin);
+  }
+  Vec256<double> sinh() const {
+    return map(std::sinh);
+  }
+  Vec256<double> cos() const {
+    return map(std::cos);
+  }
+  Vec256<double> cosh() const {
+    return map(std::cosh);
+  }
+  Vec256<double> ceil() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<double> floor() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<double> neg() const {
+    auto mask = _mm512_set1_epi64(static_cast<int64_t>(0x8000000000000000ULL));
+    return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(values), mask));
+  }
+  Vec256<double> round() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Vec256<double> tan() const {
+    return map(std::tan);
+  }
+  Vec256<double> tanh() const {
+    return Vec256<double>(Sleef_tanhd8_u10(values));
+  }
+  Vec256<double> trunc() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+  }
+  Vec256<double> sqrt() const {
+    return _mm512_sqrt_pd(values);
+  }
+  Vec256<double> reciprocal() const {
+    return _mm512_div_pd(_mm512_set1_pd(1), values);
+  }
+  Vec256<double> rsqrt() const {
+    return _mm512_div_pd(_mm512_set1_pd(1), _mm512_sqrt_pd(values));
+  }
+};
+
+template <>
+Vec256<double> inline operator+(const Vec256<double>& a, const Vec256<double>& b) {
+  return _mm512_add_pd(a, b);
+}
+
+template <>
+Vec256<double> inline operator-(const Vec256<double>& a, const Vec256<double>& b) {
+  return _mm512_sub_pd(a, b);
+}
+
+template <>
+Vec256<double> inline operator*(const Vec256<double>& a, const Vec256<double>& b) {
+  return _mm512_mul_pd(a, b);
+}
+
+template <>
+Vec256<double> inline operator/(const Vec256<double>& a, const Vec256<double>& b) {
+  return _mm512_div_pd(a, b);
+}
+
+template <>
+Vec256<double> inline max(const Vec256<double>& a, const Vec256<double>& b) {
+  return _mm512_max_pd(a, b);
+}
+
+template <>
+Vec256<double> fmadd(const Vec256<double>& a, const Vec256<double>& b, const Vec256<double>& c) {
+  return _mm512_fmadd_pd(a, b, c);
+}
+
+#endif
+
+}}}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec256_base.h"
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+// 512-bit specialization of Vec256<float>, used by the kernels in native/cpu
+// when they are compiled for CPUCapability::AVX512. Under that capability
+// Vec256<T> should be read as "the widest native vector for T": kernels may
+// only rely on Vec::size and the operations below, not on a 32-byte width.
+
+namespace at {
+namespace vec256 {
+namespace {
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+
+template <> class Vec256<float> {
+private:
+  __m512 values;
+  static inline __mmask16 mask_for(int64_t count) {
+    return static_cast<__mmask16>((1 << count) - 1);
+  }
+public:
+  static constexpr int64_t size = 16;
+  Vec256() {}
+  Vec256(__m512 v) : values(v) {}
+  Vec256(float val) {
+    values = _mm512_set1_ps(val);
+  }
+  operator __m512() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec256<float> blend(Vec256<float> a, Vec256<float> b) {
+    return _mm512_mask_blend_ps(static_cast<__mmask16>(mask), a.values, b.values);
+  }
+  static Vec256<float> set(Vec256<float> a, Vec256<float> b, int64_t count = size) {
+    if (count >= size) {
+      return b;
+    }
+    return _mm512_mask_blend_ps(mask_for(count), a.values, b.values);
+  }
+  static Vec256<float> loadu(const void* ptr, int64_t count = size) {
+    if (count == size)
+      return _mm512_loadu_ps(reinterpret_cast<const float*>(ptr));
+    return _mm512_maskz_loadu_ps(mask_for(count), ptr);
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      _mm512_storeu_ps(reinterpret_cast<float*>(ptr), values);
+    } else {
+      _mm512_mask_storeu_ps(ptr, mask_for(count), values);
+    }
+  }
+  const float& operator[](int idx) const  = delete;
+  float& operator[](int idx) = delete;
+  Vec256<float> map(float (*f)(float)) const {
+    __at_align32__ float tmp[16];
+    store(tmp);
+    for (int64_t i = 0; i < 16; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec256<float> abs() const {
+    auto mask = _mm512_set1_epi32(0x7fffffff);
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(values), mask));
+  }
+  Vec256<float> acos() const {
+    return Vec256<float>(Sleef_acosf16_u10(values));
+  }
+  Vec256<float> asin() const {
+    return Vec256<float>(Sleef_asinf16_u10(values));
+  }
+  Vec256<float> atan() const {
+    return Vec256<float>(Sleef_atanf16_u10(values));
+  }
+  Vec256<float> erf() const {
+    return Vec256<float>(Sleef_erff16_u10(values));
+  }
+  Vec256<float> erfc() const {
+    return Vec256<float>(Sleef_erfcf16_u15(values));
+  }
+  Vec256<float> exp() const {
+    return Vec256<float>(Sleef_expf16_u10(values));
+  }
+  Vec256<float> expm1() const {
+    return Vec256<float>(Sleef_expm1f16_u10(values));
+  }
+  Vec256<float> log() const {
+    return Vec256<float>(Sleef_logf16_u10(values));
+  }
+  Vec256<float> log2() const {
+    return Vec256<float>(Sleef_log2f16_u10(values));
+  }
+  Vec256<float> log10() const {
+    return Vec256<float>(Sleef_log10f16_u10(values));
+  }
+  Vec256<float> log1p() const {
+    return Vec256<float>(Sleef_log1pf16_u10(values));
+  }
+  Vec256<float> sin() const {
+    return map(std::sin);
+  }
+  Vec256<float> sinh() const {
+    return map(std::sinh);
+  }
+  Vec256<float> cos() const {
+    return map(std::cos);
+  }
+  Vec256<float> cosh() const {
+    return map(std::cosh);
+  }
+  Vec256<float> ceil() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<float> floor() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<float> neg() const {
+    auto mask = _mm512_set1_epi32(static_cast<int>(0x80000000));
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(values), mask));
+  }
+  Vec256<float> round() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Vec256<float> tan() const {
+    return map(std::tan);
+  }
+  Vec256<float> tanh() const {
+    return Vec256<float>(Sleef_tanhf16_u10(values));
+  }
+  Vec256<float> trunc() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+  }
+  Vec256<float> sqrt() const {
+    return _mm512_sqrt_ps(values);
+  }
+  Vec256<float> reciprocal() const {
+    return _mm512_div_ps(_mm512_set1_ps(1), values);
+  }
+  Vec256<float> rsqrt() const {
+    return _mm512_div_ps(_mm512_set1_ps(1), _mm512_sqrt_ps(values));
+  }
+};
+
+template <>
+Vec256<float> inline operator+(const Vec256<float>& a, const Vec256<float>& b) {
+  return _mm512_add_ps(a, b);
+}
+
+template <>
+Vec256<float> inline operator-(const Vec256<float>& a, const Vec256<float>& b) {
+  return _mm512_sub_ps(a, b);
+}
+
+template <>
+Vec256<float> inline operator*(const Vec256<float>& a, const Vec256<float>& b) {
+  return _mm512_mul_ps(a, b);
+}
+
+template <>
+Vec256<float> inline operator/(const Vec256<float>& a, const Vec256<float>& b) {
+  return _mm512_div_ps(a, b);
+}
+
+template <>
+Vec256<float> inline max(const Vec256<float>& a, const Vec256<float>& b) {
+  return _mm512_max_ps(a, b);
+}
+
+template <>
+Vec256<float> fmadd(const Vec256<float>& a, const Vec256<float>& b, const Vec256<float>& c) {
+  return _mm512_fmadd_ps(a, b, c);
+}
+
+#endif
+
+}}}
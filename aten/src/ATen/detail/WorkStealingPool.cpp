@@ -0,0 +1,119 @@
+#include <ATen/detail/WorkStealingPool.h>
+
+namespace at { namespace detail {
+
+namespace {
+thread_local bool in_task_ = false;
+} // namespace
+
+bool in_pool_task() {
+  return in_task_;
+}
+
+WorkStealingPool::WorkStealingPool(size_t num_workers) {
+  queues_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    queues_.emplace_back(new WorkerQueue());
+  }
+  threads_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    threads_.emplace_back([this, i] { worker_loop(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> guard(sleep_mutex_);
+    stop_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::submit(PoolTask task) {
+  if (queues_.empty()) {
+    run_task(task);
+    return;
+  }
+  size_t id = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  {
+    std::lock_guard<std::mutex> guard(queues_[id]->mutex);
+    queues_[id]->tasks.push_back(task);
+  }
+  pending_.fetch_add(1);
+  // Taking the sleep mutex orders the increment above against a worker
+  // that is about to park, so the notification cannot be lost.
+  { std::lock_guard<std::mutex> guard(sleep_mutex_); }
+  sleep_cv_.notify_one();
+}
+
+bool WorkStealingPool::run_pending_task() {
+  PoolTask task;
+  if (queues_.empty() || !steal(queues_.size(), task)) {
+    return false;
+  }
+  run_task(task);
+  return true;
+}
+
+void WorkStealingPool::run_task(const PoolTask& task) {
+  bool was_in_task = in_task_;
+  in_task_ = true;
+  task.fn(task.ctx, task.begin, task.end);
+  in_task_ = was_in_task;
+}
+
+bool WorkStealingPool::pop_local(size_t id, PoolTask& task) {
+  auto& queue = *queues_[id];
+  std::lock_guard<std::mutex> guard(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.back();
+  queue.tasks.pop_back();
+  pending_.fetch_sub(1);
+  return true;
+}
+
+// Steal the oldest task from some other deque. Victims are visited starting
+// right after the thief so that concurrent thieves spread out.
+bool WorkStealingPool::steal(size_t thief, PoolTask& task) {
+  const size_t n = queues_.size();
+  for (size_t k = 1; k <= n; ++k) {
+    size_t victim = (thief + k) % n;
+    if (victim == thief) {
+      continue;
+    }
+    auto& queue = *queues_[victim];
+    std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || queue.tasks.empty()) {
+      continue;
+    }
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    pending_.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::worker_loop(size_t id) {
+  while (true) {
+    PoolTask task;
+    if (pop_local(id, task) || steal(id, task)) {
+      run_task(task);
+      continue;
+    }
+    // A try_lock in steal() can miss a task that is still pending; only
+    // park once no task is left anywhere.
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleep_cv_.wait(lock, [this] { return stop_ || pending_.load() > 0; });
+    if (stop_ && pending_.load() <= 0) {
+      return;
+    }
+  }
+}
+
+}} // namespace at::detail
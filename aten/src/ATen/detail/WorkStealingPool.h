@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ATen/ATenGeneral.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace at { namespace detail {
+
+// A unit of work for the WorkStealingPool: a half-open index range
+// [begin, end) together with the type-erased function that processes it.
+// Tasks are plain structs (no std::function) so that pushing and stealing
+// them never allocates.
+struct PoolTask {
+  void (*fn)(void* ctx, int64_t begin, int64_t end);
+  void* ctx;
+  int64_t begin;
+  int64_t end;
+};
+
+// Fixed-size pool of worker threads, each owning a deque of PoolTasks.
+// A worker pops from the back of its own deque and, when that is empty,
+// steals from the front of the other workers' deques. Threads that are
+// not part of the pool (e.g. the thread calling at::parallel_for) submit
+// tasks round-robin across the deques and may help execute pending tasks
+// with run_pending_task() while they wait for their own work to finish.
+//
+// Any thread executing a task (worker or helper) reports in_pool_task(),
+// which at::parallel_for uses to run nested parallel loops inline.
+class AT_API WorkStealingPool {
+ public:
+  explicit WorkStealingPool(size_t num_workers);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  size_t num_workers() const {
+    return queues_.size();
+  }
+
+  // Enqueue a task. Never blocks on task execution.
+  void submit(PoolTask task);
+
+  // Run at most one pending task on the calling thread, stealing it from
+  // any worker's deque. Returns false if no task was available.
+  bool run_pending_task();
+
+  // Run a task on the calling thread, marking it as inside a pool task.
+  static void run_task(const PoolTask& task);
+
+ private:
+  struct alignas(64) WorkerQueue {
+    std::mutex mutex;
+    std::deque<PoolTask> tasks;
+  };
+
+  void worker_loop(size_t id);
+  bool pop_local(size_t id, PoolTask& task);
+  bool steal(size_t thief, PoolTask& task);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  // Number of tasks sitting in any deque; workers park when it drops to 0.
+  std::atomic<int64_t> pending_{0};
+  std::atomic<size_t> next_queue_{0};
+  std::atomic<bool> stop_{false};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+};
+
+// True while the calling thread is executing a PoolTask.
+AT_API bool in_pool_task();
+
+}} // namespace at::detail
@@ -1,19 +1,15 @@
 #include "ATen/ATen.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/core/Unique.h"
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
 
-#include "TH/THBlasUtils.h"
-
+#include <algorithm>
+#include <cmath>
 #include <cstring>
-#include <iostream>
-#include <memory>
-#include <sstream>
 #include <vector>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 namespace {
   const int MODE_SUM = 0;
   const int MODE_MEAN = 1;
@@ -23,6 +19,9 @@ namespace {
 namespace at {
 namespace native {
 
+DEFINE_DISPATCH(embedding_bag_sum_stub);
+DEFINE_DISPATCH(embedding_bag_max_stub);
+
 static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
                             Tensor &offset2bag) {
   offset2bag.index_add_(
@@ -31,31 +30,6 @@ static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
   offset2bag = offset2bag.cumsum(0);     // offset2bag = [0 0 1 1 2]
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-static void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output) {
-  auto add_indices_data = add_indices.data<int64_t>();
-  auto select_indices_data = select_indices.data<int64_t>();
-  auto src_data = src.data<T>();
-  auto output_data = output.data<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
-  }
-}
-
 static void make_bag_size(const Tensor &offsets, const Tensor &indices,
                           const int64_t mode, Tensor &bag_size) {
   if (mode == MODE_MEAN || mode == MODE_MAX) {
@@ -69,26 +43,6 @@ static void make_bag_size(const Tensor &offsets, const Tensor &indices,
   }
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = indices.size(0);
-      output /= bag_size_;
-    } else {
-      // Avoid dividing by 0 for empty bags.
-      // Instead we want empty bags to return all 0s
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size))
-                           .toType(output.type())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -108,45 +62,45 @@ static Tensor apply_bag_size_backward(const Tensor &offsets,
 }
 
 
-template <typename scalar_t>
-std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
-  const Tensor& weight, const Tensor &indices, const Tensor& offset2bag, const Tensor& output, const Tensor& bag_size, const Tensor& offsets) {
-
-    auto max_indices = at::zeros({offsets.size(0), weight.size(1)}, indices.type());
-
-    int64_t numel = indices.numel();
-    int64_t dims = weight.size(1);
-    auto indices_data = indices.data<int64_t>();
-    auto offset2bag_data = offset2bag.data<int64_t>();
-
-    auto max_indices_data = max_indices.data<int64_t>();
-    auto max_indices_stride = max_indices.stride(0);
-
-    auto weight_data = weight.data<scalar_t>();
-    auto output_data = output.data<scalar_t>();
-    auto weight_stride0 = weight.stride(0);
-    auto weight_stride1 = weight.stride(1);
-    auto output_stride = output.stride(0);
-
-    for (int i = 0; i < numel; i++) {
-      auto bag = offset2bag_data[i];
-      auto word_idx = indices_data[i];
-
-
-      for (int dim = 0; dim < dims; dim++) {
-        auto& current_item = output_data[output_stride * bag + dim];
-        auto weight_item = weight_data[weight_stride0 * word_idx + dim * weight_stride1];
-
-        bool is_first_for_bag = (i == 0) || offset2bag_data[i - 1] != bag;
-
-        if (is_first_for_bag || weight_item > current_item) {
-          current_item = weight_item;
-          max_indices_data[max_indices_stride * bag + dim] = word_idx;
-        }
-      }
-    }
+// The CPU kernels index rows without bounds checks, so indices and offsets
+// are validated here, before any work is handed to the thread pool.
+static void check_embedding_bag_indices(const Tensor &indices,
+                                        const Tensor &offsets,
+                                        int64_t num_weights) {
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
+  int64_t numel = indices.numel();
+  for (int64_t i = 0; i < numel; i++) {
+    AT_CHECK(indices_data[i] >= 0 && indices_data[i] < num_weights,
+             "embedding_bag: index ", indices_data[i],
+             " is out of range for a weight with ", num_weights, " rows");
+  }
+  for (int64_t b = 0; b < offsets.numel(); b++) {
+    AT_CHECK(offsets_data[b] >= 0 && offsets_data[b] <= numel &&
+             (b == 0 || offsets_data[b] >= offsets_data[b - 1]),
+             "embedding_bag: offsets must be non-decreasing and within "
+             "[0, ", numel, "]");
+  }
+}
 
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
+// Returns per_sample_weights converted to the accumulation type of the
+// kernels (Double for Double weights, Float otherwise), or an undefined
+// tensor if there are none.
+static Tensor check_per_sample_weights(const Tensor &per_sample_weights,
+                                       const Tensor &indices,
+                                       const Tensor &weight, int64_t mode) {
+  if (!per_sample_weights.defined()) {
+    return per_sample_weights;
+  }
+  AT_CHECK(mode == MODE_SUM,
+           "embedding_bag: per_sample_weights is only supported for mode='sum'");
+  AT_CHECK(per_sample_weights.dim() == 1 &&
+           per_sample_weights.numel() == indices.numel(),
+           "embedding_bag: expected per_sample_weights to be a 1D tensor with ",
+           indices.numel(), " elements, but got ", per_sample_weights.sizes());
+  auto acc_type = weight.type().scalarType() == kDouble ? kDouble : kFloat;
+  return per_sample_weights.toType(
+      per_sample_weights.type().toScalarType(acc_type)).contiguous();
 }
 
 // embedding_bag wrapper to enforce contiguity in tensors other than `weight`.
@@ -155,9 +109,11 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
 std::tuple<Tensor, Tensor, Tensor, Tensor>
 embedding_bag(const Tensor &weight, const Tensor &indices,
               const Tensor &offsets, const bool scale_grad_by_freq,
-              const int64_t mode, bool sparse) {
+              const int64_t mode, bool sparse,
+              const Tensor &per_sample_weights) {
   return at::_embedding_bag(weight, indices.contiguous(), offsets.contiguous(),
-                            scale_grad_by_freq, mode, sparse);
+                            scale_grad_by_freq, mode, sparse,
+                            per_sample_weights);
   };
 
 // Assumes all input tensors except for `weight` are contiguous.
@@ -165,13 +121,20 @@ embedding_bag(const Tensor &weight, const Tensor &indices,
 std::tuple<Tensor, Tensor, Tensor, Tensor>
 _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
                   const Tensor &offsets, const bool scale_grad_by_freq,
-                  const int64_t mode, bool sparse) {
+                  const int64_t mode, bool sparse,
+                  const Tensor &per_sample_weights) {
   auto indices_arg = TensorArg(indices, "indices", 1);
   checkScalarType("embedding_bag", indices_arg, kLong);
   auto offsets_arg = TensorArg(offsets, "offsets", 1);
-  checkScalarType("embedding_bag", indices_arg, kLong);
+  checkScalarType("embedding_bag", offsets_arg, kLong);
   auto weight_arg = TensorArg(weight, "weight", 1);
-  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble});
+  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble, kHalf});
+  checkDim("embedding_bag", weight_arg, 2);
+  AT_CHECK(!sparse || weight.type().scalarType() != kHalf,
+           "embedding_bag: sparse gradients are not supported for Half weights on CPU");
+  check_embedding_bag_indices(indices, offsets, weight.size(0));
+  auto sample_weights =
+      check_per_sample_weights(per_sample_weights, indices, weight, mode);
 
   auto bag_size = at::zeros(offsets.sizes(), indices.type());
   make_bag_size(offsets, indices, mode, bag_size);
@@ -187,22 +150,19 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
 
   offset2bag.resize_({indices.sizes()[0]});
 
-  auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
+  // The kernels read rows of `weight` as contiguous vectors.
+  auto weight_rows = weight.stride(1) == 1 ? weight : weight.contiguous();
+  auto output = at::empty({offsets.size(0), weight.size(1)}, weight.options());
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    if (weight.type().scalarType() == kFloat) {
-      index_select_add<float>(indices, offset2bag, weight, output);
-    } else if (weight.type().scalarType() == kDouble) {
-      index_select_add<double>(indices, offset2bag, weight, output);
-    }
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
+    embedding_bag_sum_stub(kCPU, output, Tensor(), weight_rows, indices,
+                           offsets, sample_weights, mode == MODE_MEAN);
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
   } else { // MODE_MAX
-    return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      weight.type(), "embedding_bag_cpu_max", [&]() {
-        return embedding_bag_cpu_max<scalar_t>(weight, indices, offset2bag, output, bag_size, offsets);
-      }
-    );
+    auto max_indices = at::empty({offsets.size(0), weight.size(1)}, indices.options());
+    embedding_bag_max_stub(kCPU, output, max_indices, weight_rows, indices,
+                           offsets);
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
   }
 }
 
@@ -215,7 +175,8 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
                               const Tensor &max_indices_,
                               int64_t num_weights,
                               bool scale_grad_by_freq, int64_t mode,
-                              bool sparse) {
+                              bool sparse,
+                              const Tensor &per_sample_weights) {
   auto indices_arg = TensorArg(indices, "indices", 1);
   checkScalarType("embedding_bag", indices_arg, kLong);
   checkContiguous("embedding_bag", indices_arg);
@@ -229,100 +190,132 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
   if (sparse) {
     return at::_embedding_bag_sparse_backward(
         grad, indices, offsets, offset2bag, bag_size_, num_weights,
-        scale_grad_by_freq, mode);
+        scale_grad_by_freq, mode, per_sample_weights);
   } else {
     return at::_embedding_bag_dense_backward(
         grad, indices, offsets, offset2bag, bag_size_, max_indices_, num_weights,
-        scale_grad_by_freq, mode);
+        scale_grad_by_freq, mode, per_sample_weights);
   }
 }
 
+// Accumulates the gradient of the sum and mean modes without sorting
+// indices: the positions of each distinct index are grouped with the
+// parallel hash-partitioned UniqueKernel and a counting pass, the bags and
+// scales of the positions are looked up in parallel over the rows, and then
+// every row of grad_weight that receives gradient is reduced by a single
+// thread with the forward kernel, reading rows of grad through offset2bag.
+template <typename scalar_t>
+static void embedding_bag_backward_sum_cpu(Tensor &grad_weight,
+                                           const Tensor &grad,
+                                           const Tensor &indices,
+                                           const Tensor &offsets,
+                                           const Tensor &offset2bag,
+                                           bool scale_grad_by_freq,
+                                           int64_t mode,
+                                           const Tensor &per_sample_weights) {
+  int64_t numel = indices.numel();
+  if (numel == 0) {
+    return;
+  }
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
+  auto offset2bag_data = offset2bag.data<int64_t>();
+  int64_t num_bags = offsets.numel();
+
+  UniqueKernel<int64_t, ParallelFor> unique(indices_data, numel, false);
+  int64_t num_rows = unique.size();
+  auto rows = at::empty({num_rows}, indices.options());
+  std::vector<int64_t> counts(num_rows);
+  unique.unique(rows.data<int64_t>(), counts.data());
+  std::vector<int64_t> inverse(numel);
+  unique.inverse(inverse.data());
+
+  // Positions [row_offsets[r], row_offsets[r + 1]) belong to rows[r].
+  auto row_offsets = at::empty({num_rows}, indices.options());
+  auto row_offsets_data = row_offsets.data<int64_t>();
+  int64_t offset = 0;
+  for (int64_t r = 0; r < num_rows; r++) {
+    row_offsets_data[r] = offset;
+    offset += counts[r];
+  }
+
+  // The positions of rows[r] list the indices that refer to it, in order.
+  std::vector<int64_t> next(row_offsets_data, row_offsets_data + num_rows);
+  auto sources = at::empty({numel}, indices.options());
+  auto sources_data = sources.data<int64_t>();
+  for (int64_t i = 0; i < numel; i++) {
+    sources_data[next[inverse[i]]++] = i;
+  }
+
+  // Every row replaces its indices with the bags they belong to, and
+  // computes the scales of their gradients.
+  auto scales = at::empty({numel}, grad.options());
+  auto scales_data = scales.data<scalar_t>();
+  const scalar_t* sample_weights_data = per_sample_weights.defined()
+      ? per_sample_weights.data<scalar_t>()
+      : nullptr;
+  const int64_t row_cost = std::max<int64_t>(1, numel / num_rows);
+  parallel_for(0, num_rows, std::max<int64_t>(1, internal::GRAIN_SIZE / row_cost),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      for (int64_t position = row_offsets_data[r]; position < next[r]; position++) {
+        int64_t i = sources_data[position];
+        int64_t bag = offset2bag_data[i];
+        scalar_t scale = sample_weights_data ? sample_weights_data[i] : 1;
+        if (scale_grad_by_freq) {
+          scale /= counts[r];
+        }
+        if (mode == MODE_MEAN) {
+          int64_t bag_end = bag + 1 < num_bags ? offsets_data[bag + 1] : numel;
+          scale /= bag_end - offsets_data[bag];
+        }
+        sources_data[position] = bag;
+        scales_data[position] = scale;
+      }
+    }
+  });
+
+  embedding_bag_sum_stub(kCPU, grad_weight, rows, grad, sources, row_offsets,
+                         scales, false);
+}
+
 Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indices_,
                                   const Tensor &offsets_,
                                   const Tensor &offset2bag__,
                                   const Tensor &bag_size_,
                                   const Tensor& max_indices_, int64_t num_weights,
-                                  bool scale_grad_by_freq, int64_t mode) {
+                                  bool scale_grad_by_freq, int64_t mode,
+                                  const Tensor &per_sample_weights) {
   // indices_, offsets_ and offset2bag__ are assumed having correct dtypes and
   // contiguous here due to the checks in _embedding_bag_backward above.
   // Also see NOTE [ embedding_bag Native Functions ] in native_functions.yaml
   // for more details.
 
+  if (grad_.type().scalarType() == kHalf) {
+    // There is no Half arithmetic on CPU; accumulate in float like the forward
+    return _embedding_bag_dense_backward_cpu(
+        grad_.toType(kFloat), indices_, offsets_, offset2bag__, bag_size_,
+        max_indices_, num_weights, scale_grad_by_freq, mode,
+        per_sample_weights).toType(kHalf);
+  }
+
   auto grad = grad_.contiguous();
   auto grad_arg = TensorArg(grad, "grad_", 1);
   checkScalarTypes("embedding_bag", grad_arg, {kFloat, kDouble});
 
-  Tensor &offset2bag_ = const_cast<Tensor &>(offset2bag__);
-
-  auto ind_sort_ = indices_.sort();
-  auto indices = std::get<0>(ind_sort_);
-  auto ind_sort = std::get<1>(ind_sort_);
-  auto offset2bag = offset2bag_.index_select(0, ind_sort);
-
-  auto indices_data = indices.data<int64_t>();
-  auto offsets_data = offsets_.data<int64_t>();
-  auto offset2bag_data = offset2bag.data<int64_t>();
-  int64_t numel = indices.numel();
-
-  std::vector<int64_t> counts(num_weights);
-  for (int i = 0; i < numel; i++) {
-    counts[indices_data[i]] = 0;
-  }
-  for (int i = 0; i < numel; i++) {
-    counts[indices_data[i]]++;
-  }
-
   auto index_grad_weight =
       at::zeros({num_weights, grad.size(1)}, grad.type()).contiguous();
 
-  std::vector<int64_t> counts_uniq;
-  counts_uniq.reserve(num_weights);
-  int64_t o = 0;
-  for (int64_t i = 0; i < numel; i += counts[indices_data[i]]) {
-    counts_uniq.push_back(counts[indices_data[i]]);
-    if (o > 0) {
-      counts_uniq[o] += counts_uniq[o - 1];
-    }
-    o++;
-  }
-
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    #pragma omp parallel for if (numel > 1000)
-      for (int64_t i = 0; i < (int64_t)counts_uniq.size(); i++) {
-        int64_t start = i == 0 ? 0 : counts_uniq[i - 1];
-        int64_t index = indices_data[start];
-        for (int64_t j = start; j < counts_uniq[i]; j++) {
-          int64_t source = offset2bag_data[j];
-          double scale = 1.0;
-          if (scale_grad_by_freq) {
-            scale /= counts[indices_data[i]];
-          }
-          if (mode == 1) { // MODE_MEAN
-            if (offsets_.size(0) == 1) {
-              auto bag_size = indices.size(0);
-              scale /= bag_size;
-            } else {
-              if (source == offsets_.size(0) - 1) {
-                scale /= indices.size(0) - offsets_data[offsets_.size(0) - 1];
-              } else {
-                scale /= offsets_data[source + 1] - offsets_data[source];
-              }
-            }
-          }
-          int64_t ddim = grad.size(1);
-          if (grad.type().scalarType() == kFloat) {
-            auto igwd = index_grad_weight.data<float>();
-            auto gd = grad.data<float>();
-            THBlas_axpy<float>(ddim, (float)scale, gd + ddim * source, 1,
-                        igwd + ddim * index, 1);
-          } else if (grad.type().scalarType() == kDouble) {
-            auto igwd = index_grad_weight.data<double>();
-            auto gd = grad.data<double>();
-            THBlas_axpy<double>(ddim, (double)scale, gd + ddim * source, 1,
-                         igwd + ddim * index, 1);
-          }
-        }
-      }
+    Tensor sample_weights;
+    if (per_sample_weights.defined()) {
+      sample_weights = per_sample_weights.toType(grad.type()).contiguous();
+    }
+    AT_DISPATCH_FLOATING_TYPES(grad.type(), "embedding_bag_backward", [&] {
+      embedding_bag_backward_sum_cpu<scalar_t>(
+          index_grad_weight, grad, indices_, offsets_, offset2bag__,
+          scale_grad_by_freq, mode, sample_weights);
+    });
   } else if (mode == MODE_MAX) {
     auto nonempty_max_indices = max_indices_.index_select(0, bag_size_.nonzero().view(-1));
     auto nonempty_grad = grad_.index_select(0, bag_size_.nonzero().view(-1));
@@ -339,7 +332,7 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
 Tensor _embedding_bag_sparse_backward(
     const Tensor &grad_, const Tensor &indices, const Tensor &offsets,
     const Tensor &offset2bag, const Tensor &bag_size_, int64_t num_weights,
-    bool scale_grad_by_freq, int64_t mode) {
+    bool scale_grad_by_freq, int64_t mode, const Tensor &per_sample_weights) {
   // indices, offsets and offset2bag are assumed having correct dtypes and
   // contiguous here due to the checks in _embedding_bag_backward above.
   // Also see NOTE [ embedding_bag Native Functions ] in native_functions.yaml
@@ -349,8 +342,92 @@ Tensor _embedding_bag_sparse_backward(
   Tensor index_grad = grad_.index_select(0, offset2bag);
   index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
                                        offset2bag, bag_size_);
+  if (per_sample_weights.defined()) {
+    index_grad.mul_(per_sample_weights.toType(index_grad.type()).unsqueeze(1));
+  }
   return native::embedding_backward(index_grad, indices, num_weights, -1,
                                     scale_grad_by_freq, true);
 }
+
+Tensor _embedding_bag_per_sample_weights_backward(
+    const Tensor &grad, const Tensor &weight, const Tensor &indices,
+    const Tensor &offset2bag, int64_t mode) {
+  AT_CHECK(mode == MODE_SUM,
+           "embedding_bag: per_sample_weights is only supported for mode='sum'");
+  if (!grad.is_cuda() && weight.type().scalarType() == kHalf) {
+    return native::_embedding_bag_per_sample_weights_backward(
+        grad.toType(kFloat), weight.toType(kFloat), indices, offset2bag, mode);
+  }
+  return (grad.index_select(0, offset2bag) * weight.index_select(0, indices))
+      .sum(1);
+}
+
+// Embedding bags over a table in the fused 8-bit rowwise format of Caffe2's
+// Fused8BitRowwiseQuantized operators, as produced by
+// _fused_8bit_rowwise_quantize. The result is Float.
+Tensor _embedding_bag_byte_rowwise(const Tensor &weight, const Tensor &indices_,
+                                   const Tensor &offsets_, int64_t mode,
+                                   const Tensor &per_sample_weights) {
+  auto weight_arg = TensorArg(weight, "weight", 1);
+  checkScalarType("embedding_bag_byte_rowwise", weight_arg, kByte);
+  checkDim("embedding_bag_byte_rowwise", weight_arg, 2);
+  AT_CHECK(weight.size(1) > static_cast<int64_t>(2 * sizeof(float)),
+           "embedding_bag_byte_rowwise: expected rows of at least ",
+           2 * sizeof(float) + 1, " bytes, but got ", weight.size(1));
+  AT_CHECK(mode == MODE_SUM || mode == MODE_MEAN,
+           "embedding_bag_byte_rowwise: only mode='sum' and mode='mean' are "
+           "supported");
+  auto indices = indices_.contiguous();
+  auto offsets = offsets_.contiguous();
+  auto indices_arg = TensorArg(indices, "indices", 2);
+  checkScalarType("embedding_bag_byte_rowwise", indices_arg, kLong);
+  auto offsets_arg = TensorArg(offsets, "offsets", 3);
+  checkScalarType("embedding_bag_byte_rowwise", offsets_arg, kLong);
+  check_embedding_bag_indices(indices, offsets, weight.size(0));
+  auto sample_weights =
+      check_per_sample_weights(per_sample_weights, indices, weight, mode);
+
+  auto weight_rows = weight.stride(1) == 1 ? weight : weight.contiguous();
+  auto output = at::empty(
+      {offsets.size(0), weight.size(1) - static_cast<int64_t>(2 * sizeof(float))},
+      weight.type().toScalarType(kFloat));
+  embedding_bag_sum_stub(kCPU, output, Tensor(), weight_rows, indices, offsets,
+                         sample_weights, mode == MODE_MEAN);
+  return output;
+}
+
+// Quantizes each row of a 2D Float tensor to uint8 with its own scale and
+// bias, stored as two floats after the row (the layout of Caffe2's
+// FloatToFused8BitRowwiseQuantized).
+Tensor _fused_8bit_rowwise_quantize(const Tensor &self) {
+  auto self_arg = TensorArg(self, "self", 1);
+  checkScalarType("fused_8bit_rowwise_quantize", self_arg, kFloat);
+  checkDim("fused_8bit_rowwise_quantize", self_arg, 2);
+  auto input = self.contiguous();
+  int64_t rows = input.size(0);
+  int64_t cols = input.size(1);
+  int64_t output_cols = cols + 2 * sizeof(float);
+  auto output = at::empty({rows, output_cols}, self.type().toScalarType(kByte));
+  auto input_data = input.data<float>();
+  auto output_data = output.data<uint8_t>();
+  constexpr float kEpsilon = 1e-8f;
+  parallel_for(0, rows, std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, cols)),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const float* input_row = input_data + r * cols;
+      uint8_t* output_row = output_data + r * output_cols;
+      float minimum = cols > 0 ? *std::min_element(input_row, input_row + cols) : 0;
+      float maximum = cols > 0 ? *std::max_element(input_row, input_row + cols) : 0;
+      float range = maximum - minimum;
+      float scale_bias[2] = {range / 255.0f, minimum};
+      float inverse_scale = 255.0f / (range + kEpsilon);
+      for (int64_t c = 0; c < cols; c++) {
+        output_row[c] = std::lrintf((input_row[c] - minimum) * inverse_scale);
+      }
+      std::memcpy(output_row + cols, scale_bias, sizeof(scale_bias));
+    }
+  });
+  return output;
+}
 }
 } // namespace at::native
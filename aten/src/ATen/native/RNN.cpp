@@ -0,0 +1,607 @@
+#include "ATen/ATen.h"
+#include "ATen/Error.h"
+#include "ATen/MatrixRef.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/cpu/RNNKernel.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+// Note [CPU fused RNN]
+// ~~~~~~~~~~~~~~~~~~~~
+// _cpu_rnn is the CPU counterpart of _cudnn_rnn: it runs all layers and
+// directions of an RNN, LSTM or GRU over a whole (possibly packed) sequence
+// in a single op, and _cpu_rnn_backward is its dedicated backward. The
+// arguments, the weight layout and the mode codes are those of _cudnn_rnn,
+// minus dropout, which callers that need it still implement with the
+// per-step autograd code.
+//
+// The input is processed time-major, with the rows of step t being
+// [offsets[t], offsets[t] + batch_sizes[t]); for packed sequences this is
+// just the packed data. For every (layer, direction) cell:
+//
+//   - The input projection of all steps, input @ w_ih^T + b_ih (+ b_hh for
+//     LSTM and plain RNNs), is a single GEMM into the gates buffer.
+//   - Every step adds h @ w_hh^T to its rows of the gates with one more GEMM
+//     (for GRU into a separate buffer, since the hidden projection of n is
+//     scaled by r) and then calls a vectorized pointwise kernel (see
+//     cpu/RNNKernel.h) that computes the activations and the new state in
+//     one pass.
+//
+// Step t only updates the first batch_sizes[t] rows of the running hidden
+// and cell states, which start as hx and cx and end up being hy and cy, so
+// sequences that ended early keep their last state. Nothing is allocated
+// per step: all buffers are views into a single workspace, which doubles as
+// the reserve that backward reads the activations from.
+//
+// Parallelism: the directions of a bidirectional layer are independent and
+// run in parallel. Unidirectional stacks instead run as a wavefront: the
+// sequence is cut into chunks of steps and chunk c of layer l only needs
+// chunk c of layer l - 1 and chunk c - 1 of layer l, so all cells on a
+// diagonal l + c run in parallel, each projecting only its own chunk.
+//
+// Backward walks the steps in the opposite order with the same kernels and
+// per-step GEMMs, storing the gradients of the gates of all steps. The
+// weight and input gradients are then again one GEMM each per cell.
+// With train=false the forward pass keeps no activations, and backward
+// first recomputes them. _cpu_rnn_backward is not differentiable: for double
+// backward, the Python RNN modules recompute the forward pass with the
+// per-step autograd code (see CpuRNNFunction in torch/nn/_functions/rnn.py).
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(lstm_forward_stub);
+DEFINE_DISPATCH(gru_forward_stub);
+DEFINE_DISPATCH(rnn_forward_stub);
+DEFINE_DISPATCH(lstm_backward_stub);
+DEFINE_DISPATCH(gru_backward_stub);
+DEFINE_DISPATCH(rnn_backward_stub);
+
+namespace {
+
+// The mode codes of _cudnn_rnn
+enum RNNMode : int64_t { RNN_RELU = 0, RNN_TANH = 1, LSTM = 2, GRU = 3 };
+
+// Number of chunks per layer a wavefront cuts the sequence into
+constexpr int64_t kWavefrontChunksPerLayer = 4;
+// Rows of the chunks projected at once when no reserve is kept
+constexpr int64_t kInferenceChunkRows = 1024;
+
+int64_t num_gates(int64_t mode) {
+  switch (mode) {
+    case RNN_RELU:
+    case RNN_TANH:
+      return 1;
+    case LSTM:
+      return 4;
+    case GRU:
+      return 3;
+    default:
+      AT_ERROR("_cpu_rnn: unknown mode ", mode);
+  }
+}
+
+struct RNNParams {
+  int64_t mode;
+  int64_t hidden_size;
+  int64_t num_layers;
+  int64_t num_directions;
+  int64_t input_size;
+  int64_t mini_batch;
+  int64_t seq_length;
+  bool train;
+  bool has_biases;
+  // Per step
+  std::vector<int64_t> batch_sizes;
+  // Per step and one past the last step
+  std::vector<int64_t> offsets;
+  // First step of every chunk and one past the last step
+  std::vector<int64_t> chunks;
+
+  RNNParams(
+      const Tensor& input,
+      int64_t mode,
+      int64_t hidden_size,
+      int64_t num_layers,
+      bool bidirectional,
+      bool train,
+      int64_t weight_stride0,
+      IntList batch_sizes_)
+      : mode(mode),
+        hidden_size(hidden_size),
+        num_layers(num_layers),
+        num_directions(bidirectional ? 2 : 1),
+        train(train),
+        has_biases(weight_stride0 == 4) {
+    AT_CHECK(
+        weight_stride0 == 2 || weight_stride0 == 4,
+        "_cpu_rnn: expected 2 or 4 weights per layer, got ", weight_stride0);
+    AT_CHECK(
+        hidden_size > 0 && num_layers > 0,
+        "_cpu_rnn: expected a positive hidden_size and num_layers");
+    num_gates(mode);
+    if (batch_sizes_.size() != 0) {
+      AT_CHECK(
+          input.dim() == 2,
+          "_cpu_rnn: expected packed input to be 2-d, got ", input.dim(), "-d");
+      batch_sizes = batch_sizes_.vec();
+      input_size = input.size(1);
+      mini_batch = batch_sizes[0];
+    } else {
+      AT_CHECK(
+          input.dim() == 3,
+          "_cpu_rnn: expected input to be 3-d, got ", input.dim(), "-d");
+      batch_sizes.assign(input.size(0), input.size(1));
+      input_size = input.size(2);
+      mini_batch = input.size(1);
+    }
+    seq_length = batch_sizes.size();
+    offsets.push_back(0);
+    for (int64_t t = 0; t < seq_length; t++) {
+      AT_CHECK(
+          batch_sizes[t] > 0 && batch_sizes[t] <= mini_batch &&
+              (t == 0 || batch_sizes[t] <= batch_sizes[t - 1]),
+          "_cpu_rnn: batch_sizes must be positive and non-increasing");
+      offsets.push_back(offsets.back() + batch_sizes[t]);
+    }
+    AT_CHECK(
+        seq_length > 0 && offsets.back() * input_size == input.numel(),
+        "_cpu_rnn: input of size ", input.sizes(),
+        " does not match batch_sizes");
+
+    int64_t chunk_steps = seq_length;
+    if (wavefront()) {
+      chunk_steps = divup(
+          seq_length,
+          std::min(seq_length, kWavefrontChunksPerLayer * num_layers));
+    }
+    if (!train) {
+      chunk_steps = std::min(
+          chunk_steps, std::max<int64_t>(1, kInferenceChunkRows / mini_batch));
+    }
+    for (int64_t t = 0; t < seq_length; t += chunk_steps) {
+      chunks.push_back(t);
+    }
+    chunks.push_back(seq_length);
+  }
+
+  int64_t rows() const {
+    return offsets.back();
+  }
+  int64_t gate_size() const {
+    return num_gates(mode) * hidden_size;
+  }
+  int64_t output_size() const {
+    return num_directions * hidden_size;
+  }
+  int64_t num_cells() const {
+    return num_layers * num_directions;
+  }
+  int64_t num_chunks() const {
+    return chunks.size() - 1;
+  }
+  int64_t chunk_rows(int64_t chunk) const {
+    return offsets[chunks[chunk + 1]] - offsets[chunks[chunk]];
+  }
+  // Whether layers run as a wavefront; the directions of a bidirectional
+  // layer need the whole output of the layer below and run in parallel
+  // instead.
+  bool wavefront() const {
+    return num_directions == 1 && num_layers > 1 && get_num_threads() > 1;
+  }
+};
+
+// The buffers of all cells (indexed by layer * num_directions + direction)
+// and the outputs of all layers but the last, as views into a single
+// workspace. When training, the workspace is the reserve and holds the
+// activations of all steps; otherwise the gates buffers only hold one chunk
+// and the GRU hidden projections only one step.
+struct RNNWorkspace {
+  Tensor buffer;
+  std::vector<Tensor> gates;
+  std::vector<Tensor> hgates;
+  std::vector<Tensor> cells;
+  std::vector<Tensor> outputs;
+
+  RNNWorkspace(const RNNParams& p, const Tensor& like, Tensor reserve = Tensor()) {
+    int64_t gates_rows = p.rows();
+    if (!p.train) {
+      gates_rows = 0;
+      for (int64_t chunk = 0; chunk < p.num_chunks(); chunk++) {
+        gates_rows = std::max(gates_rows, p.chunk_rows(chunk));
+      }
+    }
+    std::vector<std::tuple<std::vector<Tensor>*, int64_t, int64_t>> views;
+    for (int64_t cell = 0; cell < p.num_cells(); cell++) {
+      views.emplace_back(&gates, gates_rows, p.gate_size());
+      if (p.mode == GRU) {
+        views.emplace_back(
+            &hgates, p.train ? p.rows() : p.mini_batch, p.gate_size());
+      }
+      if (p.mode == LSTM && p.train) {
+        views.emplace_back(&cells, p.rows(), p.hidden_size);
+      }
+    }
+    for (int64_t layer = 0; layer < p.num_layers - 1; layer++) {
+      views.emplace_back(&outputs, p.rows(), p.output_size());
+    }
+
+    int64_t size = 0;
+    for (const auto& view : views) {
+      size += std::get<1>(view) * std::get<2>(view);
+    }
+    if (reserve.defined()) {
+      AT_CHECK(
+          reserve.numel() == size,
+          "_cpu_rnn_backward: expected a reserve of ", size,
+          " elements, got ", reserve.numel());
+      buffer = reserve;
+    } else {
+      buffer = like.type().tensor({size});
+    }
+    int64_t offset = 0;
+    for (const auto& view : views) {
+      const int64_t rows = std::get<1>(view);
+      const int64_t cols = std::get<2>(view);
+      std::get<0>(view)->push_back(
+          buffer.narrow(0, offset, rows * cols).view({rows, cols}));
+      offset += rows * cols;
+    }
+  }
+};
+
+void check_arguments(
+    const RNNParams& p,
+    const MatrixRef<Tensor>& weights,
+    const Tensor& hx,
+    const Tensor& cx) {
+  AT_CHECK(
+      static_cast<int64_t>(weights.size(0)) == p.num_cells(),
+      "_cpu_rnn: expected ", p.num_cells() * weights.size(1),
+      " weights, got ", weights.size(0) * weights.size(1));
+  for (int64_t cell = 0; cell < p.num_cells(); cell++) {
+    const int64_t layer_input_size =
+        cell < p.num_directions ? p.input_size : p.output_size();
+    auto w = weights[cell];
+    AT_CHECK(
+        w[0].sizes().equals({p.gate_size(), layer_input_size}) &&
+            w[1].sizes().equals({p.gate_size(), p.hidden_size}),
+        "_cpu_rnn: weights of cell ", cell, " have the wrong size");
+    if (p.has_biases) {
+      AT_CHECK(
+          w[2].sizes().equals({p.gate_size()}) &&
+              w[3].sizes().equals({p.gate_size()}),
+          "_cpu_rnn: biases of cell ", cell, " have the wrong size");
+    }
+  }
+  std::vector<int64_t> hidden_size = {
+      p.num_cells(), p.mini_batch, p.hidden_size};
+  AT_CHECK(
+      hx.sizes().equals(hidden_size),
+      "_cpu_rnn: expected hidden size ", IntList(hidden_size),
+      ", got ", hx.sizes());
+  if (p.mode == LSTM) {
+    AT_CHECK(
+        cx.defined() && cx.sizes().equals(hidden_size),
+        "_cpu_rnn: expected cell size ", IntList(hidden_size));
+  } else {
+    AT_CHECK(!cx.defined(), "_cpu_rnn: illegal defined cx for non-LSTM RNN");
+  }
+}
+
+// The time-major input as a [rows, input_size] matrix
+Tensor input_rows(const Tensor& input, const RNNParams& p, bool batch_first, bool is_input_packed) {
+  auto x = input;
+  if (batch_first && !is_input_packed) {
+    x = x.transpose(0, 1);
+  }
+  return x.contiguous().view({p.rows(), x.size(-1)});
+}
+
+// Undoes input_rows for a result of the shape of the input
+Tensor unflatten_rows(const Tensor& rows, const RNNParams& p, bool batch_first, bool is_input_packed) {
+  if (is_input_packed) {
+    return rows;
+  }
+  auto result = rows.view({p.seq_length, p.mini_batch, rows.size(1)});
+  if (batch_first) {
+    result.transpose_(0, 1);
+  }
+  return result;
+}
+
+// Returns, for every step of a direction, the state it started from, row
+// aligned with states, the states computed by the steps. Sequences start
+// from initial: for the forward direction all of them at step 0, for the
+// reverse direction those that are longer than t + 1 at step t.
+Tensor previous_states(const Tensor& states, const Tensor& initial, const RNNParams& p, bool reverse) {
+  auto result = states.type().tensor({p.rows(), states.size(1)});
+  for (int64_t t = 0; t < p.seq_length; t++) {
+    const int64_t batch = p.batch_sizes[t];
+    auto step = result.narrow(0, p.offsets[t], batch);
+    int64_t carried = 0;
+    if (!reverse && t > 0) {
+      carried = batch;
+      step.copy_(states.narrow(0, p.offsets[t - 1], batch));
+    } else if (reverse && t + 1 < p.seq_length) {
+      carried = p.batch_sizes[t + 1];
+      step.narrow(0, 0, carried)
+          .copy_(states.narrow(0, p.offsets[t + 1], carried));
+    }
+    if (carried < batch) {
+      step.narrow(0, carried, batch - carried)
+          .copy_(initial.narrow(0, carried, batch - carried));
+    }
+  }
+  return result;
+}
+
+} // anonymous namespace
+
+std::tuple<Tensor, Tensor, Tensor, Tensor> _cpu_rnn(
+    const Tensor& input,
+    TensorList weight, int64_t weight_stride0,
+    const Tensor& hx, const Tensor& cx,
+    int64_t mode, int64_t hidden_size,
+    int64_t num_layers, bool batch_first,
+    bool train, bool bidirectional, IntList batch_sizes) {
+  const bool is_input_packed = batch_sizes.size() != 0;
+  RNNParams p(
+      input, mode, hidden_size, num_layers, bidirectional, train,
+      weight_stride0, batch_sizes);
+  MatrixRef<Tensor> weights{weight, static_cast<size_t>(weight_stride0)};
+  check_arguments(p, weights, hx, cx);
+
+  const int64_t H = p.hidden_size;
+  RNNWorkspace ws(p, input);
+  auto output = input.type().tensor({p.rows(), p.output_size()});
+  std::vector<Tensor> layer_inputs = {input_rows(input, p, batch_first, is_input_packed)};
+  std::vector<Tensor> layer_outputs = ws.outputs;
+  layer_inputs.insert(layer_inputs.end(), ws.outputs.begin(), ws.outputs.end());
+  layer_outputs.push_back(output);
+
+  // hy and cy are the running states; see Note [CPU fused RNN]
+  auto hy = hx.clone();
+  auto cy = cx.defined() ? cx.clone() : hx.type().tensor();
+  std::vector<Tensor> ih_weights, hh_weights, ih_biases, hh_biases;
+  for (int64_t cell = 0; cell < p.num_cells(); cell++) {
+    auto w = weights[cell];
+    ih_weights.push_back(w[0].t());
+    hh_weights.push_back(w[1].t());
+    if (p.has_biases) {
+      ih_biases.push_back(p.mode == GRU ? w[2] : w[2] + w[3]);
+      hh_biases.push_back(w[3]);
+    }
+  }
+
+  auto run_chunk = [&](int64_t layer, int64_t direction, int64_t chunk) {
+    const int64_t cell = layer * p.num_directions + direction;
+    const int64_t first = p.chunks[chunk];
+    const int64_t last = p.chunks[chunk + 1];
+    const int64_t chunk_offset = p.offsets[first];
+    const int64_t chunk_rows = p.chunk_rows(chunk);
+    const int64_t gates_offset = p.train ? chunk_offset : 0;
+
+    auto x = layer_inputs[layer].narrow(0, chunk_offset, chunk_rows);
+    auto gates = ws.gates[cell].narrow(0, gates_offset, chunk_rows);
+    if (p.has_biases) {
+      at::addmm_out(gates, ih_biases[cell], x, ih_weights[cell]);
+    } else {
+      at::mm_out(gates, x, ih_weights[cell]);
+    }
+    auto output_cols = layer_outputs[layer].narrow(1, direction * H, H);
+    auto hidden = hy[cell];
+
+    for (int64_t i = first; i < last; i++) {
+      const int64_t t = direction == 1 ? first + last - 1 - i : i;
+      const int64_t batch = p.batch_sizes[t];
+      auto step_gates = gates.narrow(0, p.offsets[t] - chunk_offset, batch);
+      auto step_hx = hidden.narrow(0, 0, batch);
+      auto step_output = output_cols.narrow(0, p.offsets[t], batch);
+      if (p.mode == GRU) {
+        auto step_hgates =
+            ws.hgates[cell].narrow(0, p.train ? p.offsets[t] : 0, batch);
+        if (p.has_biases) {
+          at::addmm_out(step_hgates, hh_biases[cell], step_hx, hh_weights[cell]);
+        } else {
+          at::mm_out(step_hgates, step_hx, hh_weights[cell]);
+        }
+        gru_forward_stub(kCPU, step_gates, step_hgates, step_hx, step_output);
+      } else if (p.mode == LSTM) {
+        step_gates.addmm_(step_hx, hh_weights[cell]);
+        auto step_cx = cy[cell].narrow(0, 0, batch);
+        auto step_cells = p.train
+            ? ws.cells[cell].narrow(0, p.offsets[t], batch)
+            : Tensor();
+        lstm_forward_stub(
+            kCPU, step_gates, step_hx, step_cx, step_output, step_cells);
+      } else {
+        step_gates.addmm_(step_hx, hh_weights[cell]);
+        rnn_forward_stub(kCPU, step_gates, step_hx, step_output, p.mode);
+      }
+    }
+  };
+
+  if (p.wavefront()) {
+    const int64_t num_chunks = p.num_chunks();
+    for (int64_t diagonal = 0; diagonal < p.num_layers + num_chunks - 1; diagonal++) {
+      const int64_t first_layer = std::max<int64_t>(0, diagonal - num_chunks + 1);
+      const int64_t last_layer = std::min(p.num_layers - 1, diagonal);
+      parallel_for(first_layer, last_layer + 1, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t layer = begin; layer < end; layer++) {
+          run_chunk(layer, 0, diagonal - layer);
+        }
+      });
+    }
+  } else {
+    for (int64_t layer = 0; layer < p.num_layers; layer++) {
+      parallel_for(0, p.num_directions, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t direction = begin; direction < end; direction++) {
+          for (int64_t i = 0; i < p.num_chunks(); i++) {
+            run_chunk(layer, direction, direction == 1 ? p.num_chunks() - 1 - i : i);
+          }
+        }
+      });
+    }
+  }
+
+  auto reserve = p.train ? ws.buffer : input.type().tensor();
+  return std::make_tuple(
+      unflatten_rows(output, p, batch_first, is_input_packed), hy, cy, reserve);
+}
+
+std::tuple<Tensor, Tensor, Tensor, std::vector<Tensor>> _cpu_rnn_backward(
+    const Tensor& input, TensorList weight, int64_t weight_stride0,
+    const Tensor& hx, const Tensor& cx,
+    const Tensor& output, const Tensor& grad_output_r,
+    const Tensor& grad_hy_r, const Tensor& grad_cy_r,
+    int64_t mode, int64_t hidden_size,
+    int64_t num_layers, bool batch_first,
+    bool train, bool bidirectional, IntList batch_sizes,
+    const Tensor& reserve, std::array<bool, 4> output_mask) {
+  if (!train) {
+    // The forward pass did not keep the activations of the steps, e.g.
+    // because it was recorded in a trace without grad that is now run with
+    // grad. Recompute them.
+    auto recomputed = native::_cpu_rnn(
+        input, weight, weight_stride0, hx, cx, mode, hidden_size, num_layers,
+        batch_first, /*train=*/true, bidirectional, batch_sizes);
+    return native::_cpu_rnn_backward(
+        input, weight, weight_stride0, hx, cx, std::get<0>(recomputed),
+        grad_output_r, grad_hy_r, grad_cy_r, mode, hidden_size, num_layers,
+        batch_first, /*train=*/true, bidirectional, batch_sizes,
+        std::get<3>(recomputed), output_mask);
+  }
+  const bool is_input_packed = batch_sizes.size() != 0;
+  RNNParams p(
+      input, mode, hidden_size, num_layers, bidirectional, train,
+      weight_stride0, batch_sizes);
+  MatrixRef<Tensor> weights{weight, static_cast<size_t>(weight_stride0)};
+  check_arguments(p, weights, hx, cx);
+
+  const int64_t H = p.hidden_size;
+  RNNWorkspace ws(p, input, reserve);
+  auto x = input_rows(input, p, batch_first, is_input_packed);
+  auto output_rows = input_rows(output, p, batch_first, is_input_packed);
+  std::vector<Tensor> layer_inputs = {x};
+  std::vector<Tensor> layer_outputs = ws.outputs;
+  layer_inputs.insert(layer_inputs.end(), ws.outputs.begin(), ws.outputs.end());
+  layer_outputs.push_back(output_rows);
+
+  auto grad_output = grad_output_r.defined()
+      ? input_rows(grad_output_r, p, batch_first, is_input_packed)
+      : output_rows.type().zeros_like(output_rows);
+  auto grad_hx = grad_hy_r.defined() ? grad_hy_r.clone() : hx.type().zeros_like(hx);
+  Tensor grad_cx;
+  if (cx.defined()) {
+    grad_cx = grad_cy_r.defined() ? grad_cy_r.clone() : cx.type().zeros_like(cx);
+  }
+
+  std::vector<Tensor> grad_weights(weight.size());
+  std::vector<Tensor> grad_gates(p.num_cells());
+  std::vector<Tensor> grad_hgates(p.num_cells());
+  Tensor grad_layer_output = grad_output;
+  Tensor grad_input;
+
+  auto backward_cell = [&](int64_t layer, int64_t direction) {
+    const int64_t cell = layer * p.num_directions + direction;
+    const bool reverse = direction == 1;
+    auto w = weights[cell];
+    auto states = layer_outputs[layer].narrow(1, direction * H, H);
+    auto grad_states = grad_layer_output.narrow(1, direction * H, H);
+    auto dgates = input.type().tensor({p.rows(), p.gate_size()});
+    Tensor dhgates;
+    if (p.mode == GRU) {
+      dhgates = input.type().tensor({p.rows(), p.gate_size()});
+    }
+    Tensor prev_states;
+    if (p.mode == GRU || output_mask[3]) {
+      prev_states = previous_states(states, hx[cell], p, reverse);
+    }
+    Tensor prev_cells;
+    if (p.mode == LSTM) {
+      prev_cells = previous_states(ws.cells[cell], cx[cell], p, reverse);
+    }
+    auto dh = grad_hx[cell];
+    auto dc = p.mode == LSTM ? grad_cx[cell] : Tensor();
+
+    for (int64_t i = 0; i < p.seq_length; i++) {
+      const int64_t t = reverse ? i : p.seq_length - 1 - i;
+      const int64_t offset = p.offsets[t];
+      const int64_t batch = p.batch_sizes[t];
+      auto step_dgates = dgates.narrow(0, offset, batch);
+      auto step_gates = ws.gates[cell].narrow(0, offset, batch);
+      auto step_grad_output = grad_states.narrow(0, offset, batch);
+      auto step_dh = dh.narrow(0, 0, batch);
+      if (p.mode == GRU) {
+        auto step_dhgates = dhgates.narrow(0, offset, batch);
+        gru_backward_stub(
+            kCPU, step_dgates, step_dhgates, step_gates,
+            ws.hgates[cell].narrow(0, offset, batch),
+            prev_states.narrow(0, offset, batch), step_grad_output, step_dh);
+        step_dh.addmm_(step_dhgates, w[1]);
+      } else {
+        if (p.mode == LSTM) {
+          auto step_dc = dc.narrow(0, 0, batch);
+          lstm_backward_stub(
+              kCPU, step_dgates, step_gates,
+              ws.cells[cell].narrow(0, offset, batch),
+              prev_cells.narrow(0, offset, batch), step_grad_output, step_dh,
+              step_dc);
+        } else {
+          rnn_backward_stub(
+              kCPU, step_dgates, step_gates, step_grad_output, step_dh, p.mode);
+        }
+        at::mm_out(step_dh, step_dgates, w[1]);
+      }
+    }
+
+    if (output_mask[3]) {
+      const auto& dhidden = p.mode == GRU ? dhgates : dgates;
+      auto dw = grad_weights.begin() + cell * weight_stride0;
+      dw[0] = dgates.t().mm(layer_inputs[layer]);
+      dw[1] = dhidden.t().mm(prev_states);
+      if (p.has_biases) {
+        dw[2] = dgates.sum(0);
+        dw[3] = dhidden.sum(0);
+      }
+    }
+    grad_gates[cell] = dgates;
+  };
+
+  for (int64_t layer = p.num_layers - 1; layer >= 0; layer--) {
+    parallel_for(0, p.num_directions, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t direction = begin; direction < end; direction++) {
+        backward_cell(layer, direction);
+      }
+    });
+    if (layer == 0 && !output_mask[0]) {
+      break;
+    }
+    // The gradient of the layer's input is the sum over both directions
+    Tensor grad_layer_input;
+    for (int64_t direction = 0; direction < p.num_directions; direction++) {
+      const int64_t cell = layer * p.num_directions + direction;
+      if (direction == 0) {
+        grad_layer_input = grad_gates[cell].mm(weights[cell][0]);
+      } else {
+        grad_layer_input.addmm_(grad_gates[cell], weights[cell][0]);
+      }
+      grad_gates[cell].reset();
+    }
+    grad_layer_output = grad_layer_input;
+  }
+  if (output_mask[0]) {
+    grad_input = unflatten_rows(grad_layer_output, p, batch_first, is_input_packed);
+  }
+
+  return std::tuple<Tensor, Tensor, Tensor, std::vector<Tensor>>{
+      grad_input,
+      output_mask[1] ? grad_hx : Tensor(),
+      output_mask[2] ? grad_cx : Tensor(),
+      grad_weights};
+}
+
+}} // namespace at::native
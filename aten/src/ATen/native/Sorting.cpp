@@ -0,0 +1,298 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Error.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/WrapDimUtils.h"
+#include "ATen/core/OrderedKey.h"
+#include "ReduceOpsUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// CPU sort, topk and kthvalue.
+//
+// All three work on independent slices along `dim`, which are distributed
+// over threads with parallel_for. Each slice is copied into a contiguous
+// per-thread buffer of (key, position) entries, where the key is an unsigned
+// integer that orders like the value (see OrderedKey), so the kernels never
+// touch strided memory and only compare integers. Full sorts of long slices
+// use an LSD radix sort on the keys; topk and kthvalue select with
+// nth_element/partial_sort and only sort what they return.
+
+namespace at { namespace native {
+
+namespace {
+
+// Slices shorter than this are sorted with std::sort, longer ones with
+// radix_sort.
+constexpr int64_t kRadixSortMinSize = 256;
+
+template <typename key_t>
+struct SortEntry {
+  key_t key;
+  int64_t index;
+};
+
+// Ties are broken by position, which makes every kernel deterministic and
+// the comparison sorts agree with the (stable) radix sort.
+template <typename entry_t>
+inline bool entry_less(const entry_t& a, const entry_t& b) {
+  return a.key < b.key || (a.key == b.key && a.index < b.index);
+}
+
+// Stable LSD radix sort of entries by key, one byte per pass. Passes on which
+// all keys have the same digit are skipped, which is common for small
+// integers and for floats of similar magnitude. `tmp` must hold n entries.
+template <typename key_t>
+void radix_sort(SortEntry<key_t>* data, SortEntry<key_t>* tmp, int64_t n) {
+  constexpr int kPasses = sizeof(key_t);
+  int64_t counts[kPasses][256];
+  std::memset(counts, 0, sizeof(counts));
+  for (int64_t i = 0; i < n; i++) {
+    const key_t key = data[i].key;
+    for (int p = 0; p < kPasses; p++) {
+      counts[p][(key >> (8 * p)) & 0xff]++;
+    }
+  }
+  SortEntry<key_t>* src = data;
+  SortEntry<key_t>* dst = tmp;
+  for (int p = 0; p < kPasses; p++) {
+    int64_t* count = counts[p];
+    if (count[(src[0].key >> (8 * p)) & 0xff] == n) {
+      continue;
+    }
+    int64_t offset = 0;
+    for (int b = 0; b < 256; b++) {
+      const int64_t c = count[b];
+      count[b] = offset;
+      offset += c;
+    }
+    for (int64_t i = 0; i < n; i++) {
+      dst[count[(src[i].key >> (8 * p)) & 0xff]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+  if (src != data) {
+    std::copy(src, src + n, data);
+  }
+}
+
+template <typename entry_t>
+void sort_entries(entry_t* entries, entry_t* tmp, int64_t n) {
+  if (n < kRadixSortMinSize) {
+    std::sort(entries, entries + n, entry_less<entry_t>);
+  } else {
+    radix_sort(entries, tmp, n);
+  }
+}
+
+// The selection kernels below rearrange the n entries of a slice so that
+// its first values.size(dim) entries are the result.
+
+struct SortSelect {
+  template <typename entry_t>
+  void operator()(entry_t* entries, entry_t* tmp, int64_t n) const {
+    sort_entries(entries, tmp, n);
+  }
+};
+
+struct TopKSelect {
+  int64_t k;
+  bool sorted;
+
+  template <typename entry_t>
+  void operator()(entry_t* entries, entry_t* tmp, int64_t n) const {
+    if (k == 0 || (k == n && !sorted)) {
+      return;
+    }
+    if (sorted && k * 4 >= n) {
+      // Most of the slice is returned; selecting first does not pay off.
+      sort_entries(entries, tmp, n);
+    } else if (sorted && k <= 32) {
+      // Heap selection, O(n log k).
+      std::partial_sort(entries, entries + k, entries + n, entry_less<entry_t>);
+    } else {
+      // Introselect, then sort only the selected entries.
+      std::nth_element(
+          entries, entries + k - 1, entries + n, entry_less<entry_t>);
+      if (sorted) {
+        sort_entries(entries, tmp, k);
+      }
+    }
+  }
+};
+
+struct KthValueSelect {
+  int64_t k;
+
+  template <typename entry_t>
+  void operator()(entry_t* entries, entry_t* /*tmp*/, int64_t n) const {
+    std::nth_element(
+        entries, entries + k - 1, entries + n, entry_less<entry_t>);
+    entries[0] = entries[k - 1];
+  }
+};
+
+// Offset of the first element of slice number `slice` along `dim`, where
+// slices are numbered in row-major order of the remaining dimensions.
+int64_t slice_offset(int64_t slice, const Tensor& t, int64_t dim) {
+  int64_t offset = 0;
+  for (int64_t d = t.dim() - 1; d >= 0; d--) {
+    if (d == dim) {
+      continue;
+    }
+    offset += (slice % t.size(d)) * t.stride(d);
+    slice /= t.size(d);
+  }
+  return offset;
+}
+
+// Runs `select` on every slice of `self` along `dim` and writes the first
+// values.size(dim) entries of each slice to `values` and `indices`, which must
+// have the shape of `self` except in `dim`. If `descending` is set, keys are
+// inverted so that the selection kernels see the largest values first.
+template <typename scalar_t, typename Select>
+void select_slices(
+    const Tensor& self,
+    Tensor& values,
+    Tensor& indices,
+    int64_t dim,
+    bool descending,
+    const Select& select) {
+  using key_t = typename OrderedKey<scalar_t>::type;
+  using entry_t = SortEntry<key_t>;
+  const int64_t n = self.size(dim);
+  const int64_t out_n = values.size(dim);
+  const int64_t num_slices = self.numel() / n;
+  const scalar_t* self_data = self.data<scalar_t>();
+  scalar_t* values_data = values.data<scalar_t>();
+  int64_t* indices_data = indices.data<int64_t>();
+  const int64_t self_stride = self.stride(dim);
+  const int64_t values_stride = values.stride(dim);
+  const int64_t indices_stride = indices.stride(dim);
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / n);
+  parallel_for(0, num_slices, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> slice_values(n);
+    std::vector<entry_t> entries(n);
+    std::vector<entry_t> tmp(n);
+    for (int64_t slice = begin; slice < end; slice++) {
+      const scalar_t* src = self_data + slice_offset(slice, self, dim);
+      for (int64_t i = 0; i < n; i++) {
+        const scalar_t value = src[i * self_stride];
+        const key_t key = OrderedKey<scalar_t>::get(value);
+        slice_values[i] = value;
+        entries[i].key = descending ? static_cast<key_t>(~key) : key;
+        entries[i].index = i;
+      }
+      select(entries.data(), tmp.data(), n);
+      scalar_t* values_out = values_data + slice_offset(slice, values, dim);
+      int64_t* indices_out = indices_data + slice_offset(slice, indices, dim);
+      for (int64_t j = 0; j < out_n; j++) {
+        const int64_t index = entries[j].index;
+        values_out[j * values_stride] = slice_values[index];
+        indices_out[j * indices_stride] = index;
+      }
+    }
+  });
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor> sort(const Tensor& self, int64_t dim, bool descending) {
+  Tensor values = self.type().tensor();
+  Tensor indices = self.type().toScalarType(kLong).tensor();
+  return at::native::sort_out(values, indices, self, dim, descending);
+}
+
+std::tuple<Tensor &,Tensor &> sort_out(Tensor& values, Tensor& indices,
+                                       const Tensor& self, int64_t dim, bool descending) {
+  if (self.type().backend() != Backend::CPU) {
+    return at::_th_sort_out(values, indices, self, dim, descending);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+  values.resize_(self.sizes());
+  indices.resize_(self.sizes());
+  if (self.dim() == 0) {
+    values.copy_(self);
+    indices.fill_(0);
+  } else if (self.numel() > 0) {
+    AT_DISPATCH_ALL_TYPES(self.type(), "sort", [&] {
+      select_slices<scalar_t>(self, values, indices, dim, descending, SortSelect());
+    });
+  }
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> topk(const Tensor& self, int64_t k, int64_t dim, bool largest, bool sorted) {
+  Tensor values = self.type().tensor();
+  Tensor indices = self.type().toScalarType(kLong).tensor();
+  return at::native::topk_out(values, indices, self, k, dim, largest, sorted);
+}
+
+std::tuple<Tensor &,Tensor &> topk_out(Tensor& values, Tensor& indices,
+                                       const Tensor& self, int64_t k, int64_t dim, bool largest, bool sorted) {
+  if (self.type().backend() != Backend::CPU) {
+    return at::_th_topk_out(values, indices, self, k, dim, largest, sorted);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+  const int64_t slice_size = self.dim() == 0 ? 1 : self.size(dim);
+  AT_CHECK(k >= 0 && k <= slice_size, "k not in range for dimension");
+  if (self.dim() == 0) {
+    if (k == 1) {
+      values.resize_({}).copy_(self);
+      indices.resize_({}).fill_(0);
+    } else {
+      values.resize_({0});
+      indices.resize_({0});
+    }
+    return std::forward_as_tuple(values, indices);
+  }
+  auto sizes = self.sizes().vec();
+  sizes[dim] = k;
+  values.resize_(sizes);
+  indices.resize_(sizes);
+  if (values.numel() > 0) {
+    AT_DISPATCH_ALL_TYPES(self.type(), "topk", [&] {
+      select_slices<scalar_t>(self, values, indices, dim, largest, TopKSelect{k, sorted});
+    });
+  }
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> kthvalue(const Tensor& self, int64_t k, int64_t dim, bool keepdim) {
+  Tensor values = self.type().tensor();
+  Tensor indices = self.type().toScalarType(kLong).tensor();
+  return at::native::kthvalue_out(values, indices, self, k, dim, keepdim);
+}
+
+std::tuple<Tensor &,Tensor &> kthvalue_out(Tensor& values, Tensor& indices,
+                                           const Tensor& self, int64_t k, int64_t dim, bool keepdim) {
+  AT_CHECK(self.type().backend() == Backend::CPU || self.type().backend() == Backend::CUDA,
+           "kthvalue only supports CPU AND CUDA backend, got: ", at::toString(self.type().backend()));
+  dim = maybe_wrap_dim(dim, self.dim());
+  if (_dimreduce_return_trivial_no_ident(values, self, dim, keepdim, "kthvalue")) {
+    AT_ASSERT(values.dim() == 0);
+    indices.resize_({}).fill_(0);
+    return std::forward_as_tuple(values, indices);
+  }
+  if (self.type().backend() != Backend::CPU) {
+    return at::_th_kthvalue_out(values, indices, self, k, dim, keepdim);
+  }
+  AT_CHECK(k >= 1 && k <= self.size(dim), "selected index out of range");
+  auto sizes = self.sizes().vec();
+  sizes[dim] = 1;
+  values.resize_(sizes);
+  indices.resize_(sizes);
+  AT_DISPATCH_ALL_TYPES(self.type(), "kthvalue", [&] {
+    select_slices<scalar_t>(self, values, indices, dim, false, KthValueSelect{k});
+  });
+  if (!keepdim) {
+    values.squeeze_(dim);
+    indices.squeeze_(dim);
+  }
+  return std::forward_as_tuple(values, indices);
+}
+
+}} // namespace at::native
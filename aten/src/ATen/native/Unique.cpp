@@ -2,11 +2,11 @@
 
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/core/Unique.h"
 
-#include <set>
 #include <tuple>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace at {
 namespace native{
@@ -14,45 +14,46 @@ namespace native{
 namespace {
 
 template <typename scalar_t>
-std::tuple<Tensor, Tensor> _unique_cpu_template(
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu_template(
     const Tensor& self,
     const bool sorted,
-    const bool return_inverse) {
+    const bool return_inverse,
+    const bool return_counts) {
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data<scalar_t>();
-  std::unordered_set<scalar_t> set(input_data, input_data + input.numel());
-  Tensor output = at::empty({static_cast<int64_t>(set.size())}, input.type());
-  scalar_t* output_data = output.data<scalar_t>();
-
-  if (sorted) {
-    std::vector<scalar_t> vec(set.begin(), set.end());
-    std::sort(vec.begin(), vec.end());
-    std::copy(vec.begin(), vec.end(), output_data);
-  } else {
-    std::copy(set.begin(), set.end(), output_data);
+  UniqueKernel<scalar_t, ParallelFor> kernel(
+      input_data, input.numel(), sorted);
+
+  Tensor output = at::empty({kernel.size()}, input.type());
+  Tensor counts = at::empty({0}, self.type().toScalarType(kLong));
+  if (return_counts) {
+    counts.resize_({kernel.size()});
   }
+  kernel.unique(
+      output.data<scalar_t>(),
+      return_counts ? counts.data<int64_t>() : nullptr);
 
   Tensor inverse_indices = at::empty({0}, self.type().toScalarType(kLong));
   if (return_inverse) {
     inverse_indices.resize_(input.sizes());
-    int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
-    std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int i = 0; i < output.numel(); ++i) {
-      inverse_map[output_data[i]] = i;
-    }
-    for (int i = 0; i < input.numel(); ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
-    }
+    kernel.inverse(inverse_indices.data<int64_t>());
   }
-  return std::make_tuple(output, inverse_indices);
+  return std::make_tuple(output, inverse_indices, counts);
 }
 } // namespace
 
 std::tuple<Tensor, Tensor>
 _unique_cpu(const Tensor& self, const bool sorted, const bool return_inverse) {
+  Tensor output, inverse_indices, counts;
+  std::tie(output, inverse_indices, counts) =
+      _unique2_cpu(self, sorted, return_inverse, false);
+  return std::make_tuple(output, inverse_indices);
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cpu(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
   return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
-    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse);
+    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse, return_counts);
   });
 }
 
@@ -0,0 +1,341 @@
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// Embedding lookup kernels, modeled on the generated EmbeddingLookup kernels
+// in caffe2/perfkernels. Bags are distributed over threads; each bag is
+// accumulated in a single pass over its indices, and the row needed
+// kPrefetchDistance lookups ahead is prefetched, since for large tables the
+// kernel is bound by the latency of the random row accesses.
+//
+// A row reader provides, for one weight format:
+//   acc_t    - accumulation type
+//   out_t    - output type
+//   dim      - number of columns
+//   prefetch(index)          - prefetch the row `index`
+//   accumulate(acc, index, w) - acc[0, dim) += w * row `index`
+
+namespace at { namespace native {
+namespace {
+
+constexpr int64_t kPrefetchDistance = 16;
+constexpr int64_t kCacheLineSize = 64;
+
+inline void prefetch_bytes(const void* ptr, int64_t size) {
+#if defined(__GNUC__)
+  const char* p = static_cast<const char*>(ptr);
+  for (int64_t offset = 0; offset < size; offset += kCacheLineSize) {
+    __builtin_prefetch(p + offset, 0, 3);
+  }
+#endif
+}
+
+// Loads Vec256<float>::size values of the row at src converted to float.
+template <typename T>
+inline vec256::Vec256<float> load_as_float(const T* src) {
+  using Vec = vec256::Vec256<float>;
+  __at_align32__ float values[Vec::size];
+  for (int64_t i = 0; i < Vec::size; i++) {
+    values[i] = static_cast<float>(src[i]);
+  }
+  return Vec::loadu(values);
+}
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+template <>
+inline vec256::Vec256<float> load_as_float<Half>(const Half* src) {
+  return _mm512_cvtph_ps(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+}
+
+template <>
+inline vec256::Vec256<float> load_as_float<uint8_t>(const uint8_t* src) {
+  return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src))));
+}
+#elif defined(__AVX2__) && !defined(_MSC_VER)
+#if defined(__F16C__)
+template <>
+inline vec256::Vec256<float> load_as_float<Half>(const Half* src) {
+  return _mm256_cvtph_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+}
+#endif
+
+template <>
+inline vec256::Vec256<float> load_as_float<uint8_t>(const uint8_t* src) {
+  return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src))));
+}
+#endif
+
+template <typename scalar_t>
+struct DenseRows {
+  using acc_t = scalar_t;
+  using out_t = scalar_t;
+
+  const scalar_t* data;
+  int64_t stride;
+  int64_t dim;
+
+  explicit DenseRows(const Tensor& weight)
+      : data(weight.data<scalar_t>()),
+        stride(weight.stride(0)),
+        dim(weight.size(1)) {}
+
+  void prefetch(int64_t index) const {
+    prefetch_bytes(data + index * stride, dim * sizeof(scalar_t));
+  }
+
+  void accumulate(acc_t* acc, int64_t index, acc_t w) const {
+    using Vec = vec256::Vec256<scalar_t>;
+    const scalar_t* row = data + index * stride;
+    const Vec vec_w(w);
+    int64_t d = 0;
+    for (; d + Vec::size <= dim; d += Vec::size) {
+      vec256::fmadd(vec_w, Vec::loadu(row + d), Vec::loadu(acc + d))
+          .store(acc + d);
+    }
+    for (; d < dim; d++) {
+      acc[d] += w * row[d];
+    }
+  }
+};
+
+// Half rows are accumulated in float.
+template <>
+struct DenseRows<Half> {
+  using acc_t = float;
+  using out_t = Half;
+
+  const Half* data;
+  int64_t stride;
+  int64_t dim;
+
+  explicit DenseRows(const Tensor& weight)
+      : data(weight.data<Half>()),
+        stride(weight.stride(0)),
+        dim(weight.size(1)) {}
+
+  void prefetch(int64_t index) const {
+    prefetch_bytes(data + index * stride, dim * sizeof(Half));
+  }
+
+  void accumulate(float* acc, int64_t index, float w) const {
+    using Vec = vec256::Vec256<float>;
+    const Half* row = data + index * stride;
+    const Vec vec_w(w);
+    int64_t d = 0;
+    for (; d + Vec::size <= dim; d += Vec::size) {
+      vec256::fmadd(vec_w, load_as_float(row + d), Vec::loadu(acc + d))
+          .store(acc + d);
+    }
+    for (; d < dim; d++) {
+      acc[d] += w * static_cast<float>(row[d]);
+    }
+  }
+};
+
+// Rows in the fused 8-bit rowwise format of caffe2's
+// Fused8BitRowwiseQuantized operators: `dim` uint8 values followed by a float
+// scale and a float bias, so that value = scale * q + bias.
+struct Fused8BitRows {
+  using acc_t = float;
+  using out_t = float;
+
+  const uint8_t* data;
+  int64_t stride;
+  int64_t dim;
+
+  explicit Fused8BitRows(const Tensor& weight)
+      : data(weight.data<uint8_t>()),
+        stride(weight.stride(0)),
+        dim(weight.size(1) - 2 * sizeof(float)) {}
+
+  void prefetch(int64_t index) const {
+    prefetch_bytes(data + index * stride, dim + 2 * sizeof(float));
+  }
+
+  void accumulate(float* acc, int64_t index, float w) const {
+    const uint8_t* row = data + index * stride;
+    float scale_bias[2];
+    std::memcpy(scale_bias, row + dim, sizeof(scale_bias));
+    const float scale = w * scale_bias[0];
+    const float bias = w * scale_bias[1];
+    using Vec = vec256::Vec256<float>;
+    const Vec vec_scale(scale);
+    const Vec vec_bias(bias);
+    int64_t d = 0;
+    for (; d + Vec::size <= dim; d += Vec::size) {
+      vec256::fmadd(
+          vec_scale, load_as_float(row + d), Vec::loadu(acc + d) + vec_bias)
+          .store(acc + d);
+    }
+    for (; d < dim; d++) {
+      acc[d] += scale * row[d] + bias;
+    }
+  }
+};
+
+template <typename Rows>
+void embedding_bag_sum_impl(
+    Tensor& output,
+    const Tensor& output_rows,
+    const Rows& rows,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    bool mean) {
+  using acc_t = typename Rows::acc_t;
+  using out_t = typename Rows::out_t;
+  constexpr bool kAccumulateInOutput = std::is_same<acc_t, out_t>::value;
+
+  const int64_t* indices_data = indices.data<int64_t>();
+  const int64_t* offsets_data = offsets.data<int64_t>();
+  const int64_t* output_rows_data =
+      output_rows.defined() ? output_rows.data<int64_t>() : nullptr;
+  const acc_t* weights_data = per_sample_weights.defined()
+      ? per_sample_weights.data<acc_t>()
+      : nullptr;
+  out_t* output_data = output.data<out_t>();
+  const int64_t output_stride = output.stride(0);
+  const int64_t numel = indices.numel();
+  const int64_t num_bags = offsets.numel();
+  const int64_t dim = rows.dim;
+
+  const int64_t bag_cost =
+      std::max<int64_t>(1, dim * (numel / std::max<int64_t>(1, num_bags)));
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / bag_cost);
+  parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> buffer(kAccumulateInOutput ? 0 : dim);
+    for (int64_t bag = begin; bag < end; bag++) {
+      const int64_t start = offsets_data[bag];
+      const int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : numel;
+      const int64_t row = output_rows_data ? output_rows_data[bag] : bag;
+      out_t* out = output_data + row * output_stride;
+      acc_t* acc = kAccumulateInOutput ? reinterpret_cast<acc_t*>(out)
+                                       : buffer.data();
+      std::fill(acc, acc + dim, acc_t(0));
+      for (int64_t i = start; i < stop; i++) {
+        if (i + kPrefetchDistance < numel) {
+          rows.prefetch(indices_data[i + kPrefetchDistance]);
+        }
+        rows.accumulate(
+            acc, indices_data[i], weights_data ? weights_data[i] : acc_t(1));
+      }
+      if (mean && stop > start) {
+        const acc_t scale = acc_t(1) / (stop - start);
+        for (int64_t d = 0; d < dim; d++) {
+          acc[d] *= scale;
+        }
+      }
+      if (!kAccumulateInOutput) {
+        for (int64_t d = 0; d < dim; d++) {
+          out[d] = static_cast<out_t>(acc[d]);
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+void embedding_bag_max_impl(
+    Tensor& output,
+    Tensor& max_indices,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets) {
+  const DenseRows<scalar_t> rows(weight);
+  const int64_t* indices_data = indices.data<int64_t>();
+  const int64_t* offsets_data = offsets.data<int64_t>();
+  scalar_t* output_data = output.data<scalar_t>();
+  int64_t* max_indices_data = max_indices.data<int64_t>();
+  const int64_t output_stride = output.stride(0);
+  const int64_t max_indices_stride = max_indices.stride(0);
+  const int64_t numel = indices.numel();
+  const int64_t num_bags = offsets.numel();
+  const int64_t dim = rows.dim;
+
+  const int64_t bag_cost =
+      std::max<int64_t>(1, dim * (numel / std::max<int64_t>(1, num_bags)));
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / bag_cost);
+  parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      const int64_t start = offsets_data[bag];
+      const int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : numel;
+      scalar_t* out = output_data + bag * output_stride;
+      int64_t* out_indices = max_indices_data + bag * max_indices_stride;
+      if (start >= stop) {
+        std::fill(out, out + dim, scalar_t(0));
+        std::fill(out_indices, out_indices + dim, int64_t(0));
+        continue;
+      }
+      const int64_t first = indices_data[start];
+      std::copy(rows.data + first * rows.stride,
+                rows.data + first * rows.stride + dim, out);
+      std::fill(out_indices, out_indices + dim, first);
+      for (int64_t i = start + 1; i < stop; i++) {
+        if (i + kPrefetchDistance < numel) {
+          rows.prefetch(indices_data[i + kPrefetchDistance]);
+        }
+        const int64_t index = indices_data[i];
+        const scalar_t* row = rows.data + index * rows.stride;
+        for (int64_t d = 0; d < dim; d++) {
+          if (row[d] > out[d]) {
+            out[d] = row[d];
+            out_indices[d] = index;
+          }
+        }
+      }
+    }
+  });
+}
+
+static void embedding_bag_sum_kernel_impl(
+    Tensor& output,
+    const Tensor& output_rows,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    bool mean) {
+  if (weight.type().scalarType() == kByte) {
+    embedding_bag_sum_impl(
+        output, output_rows, Fused8BitRows(weight), indices, offsets,
+        per_sample_weights, mean);
+    return;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(weight.type(), "embedding_bag_sum", [&] {
+    embedding_bag_sum_impl(
+        output, output_rows, DenseRows<scalar_t>(weight), indices, offsets,
+        per_sample_weights, mean);
+  });
+}
+
+static void embedding_bag_max_kernel_impl(
+    Tensor& output,
+    Tensor& max_indices,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(weight.type(), "embedding_bag_max", [&] {
+    embedding_bag_max_impl<scalar_t>(
+        output, max_indices, weight, indices, offsets);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(embedding_bag_sum_stub, &embedding_bag_sum_kernel_impl);
+REGISTER_DISPATCH(embedding_bag_max_stub, &embedding_bag_max_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Bag b reduces the rows weight[indices[i]] for i in
+// [offsets[b], offsets[b + 1]) (the last bag ends at indices.numel()).
+// indices and offsets are contiguous int64 tensors and every index has been
+// checked to be a valid row.
+//
+// embedding_bag_sum writes the (optionally per_sample_weights-weighted) sum
+// of bag b, or its mean if `mean` is set, to output[b], or to
+// output[output_rows[b]] if output_rows is defined. Empty bags produce zeros.
+// weight is Float, Double or Half, or Byte holding rows in the fused 8-bit
+// rowwise format (see _fused_8bit_rowwise_quantize), in which case output is
+// Float. per_sample_weights, if defined, is contiguous and has the
+// accumulation type: Double for Double weights and Float otherwise.
+using embedding_bag_sum_fn = void(*)(
+    Tensor& output,
+    const Tensor& output_rows,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    bool mean);
+
+// embedding_bag_max writes the elementwise maximum of bag b to output[b] and
+// the index of the row it was taken from to max_indices[b].
+using embedding_bag_max_fn = void(*)(
+    Tensor& output,
+    Tensor& max_indices,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets);
+
+DECLARE_DISPATCH(embedding_bag_sum_fn, embedding_bag_sum_stub);
+DECLARE_DISPATCH(embedding_bag_max_fn, embedding_bag_max_stub);
+
+}} // namespace at::native
@@ -0,0 +1,249 @@
+#include "ATen/native/cpu/RNNKernel.h"
+
+#include <algorithm>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// Pointwise kernels of the fused CPU RNN. Every kernel makes a single pass
+// over the columns of a row, reading the gates of one hidden unit from the
+// gate blocks at offsets 0, H, 2H (and 3H) and keeping all intermediate
+// values in registers. Rows are distributed over threads; see
+// [Note AVX-SSE transitions] in SoftMaxKernel.cpp for why the scalar tails
+// go through Vec256 as well.
+
+namespace at { namespace native {
+namespace {
+
+template <typename scalar_t>
+inline vec256::Vec256<scalar_t> sigmoid(vec256::Vec256<scalar_t> x) {
+  using Vec = vec256::Vec256<scalar_t>;
+  const Vec one(1);
+  return one / (one + x.neg().exp());
+}
+
+// Calls f(b, j, n) for all rows b of the batch and all column blocks
+// [j, j + n) of a row of size hidden_size. cost is a rough number of
+// operations per column, used to size the chunk of rows per thread.
+template <typename scalar_t, typename F>
+inline void for_each_block(
+    int64_t batch,
+    int64_t hidden_size,
+    int64_t cost,
+    const F& f) {
+  constexpr int64_t vec_size = vec256::Vec256<scalar_t>::size;
+  int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / (cost * hidden_size));
+  parallel_for(0, batch, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      for (int64_t j = 0; j < hidden_size; j += vec_size) {
+        f(b, j, std::min(vec_size, hidden_size - j));
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+inline scalar_t* row(Tensor& t, int64_t b) {
+  return t.data<scalar_t>() + b * t.stride(0);
+}
+
+template <typename scalar_t>
+inline const scalar_t* row(const Tensor& t, int64_t b) {
+  return t.data<scalar_t>() + b * t.stride(0);
+}
+
+void lstm_forward_kernel_impl(
+    Tensor& gates,
+    Tensor& hx,
+    Tensor& cx,
+    Tensor& output,
+    Tensor& cells) {
+  AT_DISPATCH_FLOATING_TYPES(gates.type(), "lstm_forward", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    const int64_t H = hx.size(1);
+    const bool store_cells = cells.defined();
+    for_each_block<scalar_t>(hx.size(0), H, 48, [&](int64_t b, int64_t j, int64_t n) {
+      scalar_t* g = row<scalar_t>(gates, b) + j;
+      scalar_t* c = row<scalar_t>(cx, b) + j;
+      auto in_gate = sigmoid(Vec::loadu(g, n));
+      auto forget_gate = sigmoid(Vec::loadu(g + H, n));
+      auto cell_gate = Vec::loadu(g + 2 * H, n).tanh();
+      auto out_gate = sigmoid(Vec::loadu(g + 3 * H, n));
+      auto cy = forget_gate * Vec::loadu(c, n) + in_gate * cell_gate;
+      auto hy = out_gate * cy.tanh();
+      in_gate.store(g, n);
+      forget_gate.store(g + H, n);
+      cell_gate.store(g + 2 * H, n);
+      out_gate.store(g + 3 * H, n);
+      cy.store(c, n);
+      if (store_cells) {
+        cy.store(row<scalar_t>(cells, b) + j, n);
+      }
+      hy.store(row<scalar_t>(hx, b) + j, n);
+      hy.store(row<scalar_t>(output, b) + j, n);
+    });
+  });
+}
+
+void gru_forward_kernel_impl(
+    Tensor& gates,
+    const Tensor& hgates,
+    Tensor& hx,
+    Tensor& output) {
+  AT_DISPATCH_FLOATING_TYPES(gates.type(), "gru_forward", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    const int64_t H = hx.size(1);
+    for_each_block<scalar_t>(hx.size(0), H, 40, [&](int64_t b, int64_t j, int64_t n) {
+      scalar_t* g = row<scalar_t>(gates, b) + j;
+      const scalar_t* hg = row<scalar_t>(hgates, b) + j;
+      scalar_t* h = row<scalar_t>(hx, b) + j;
+      auto reset_gate = sigmoid(Vec::loadu(g, n) + Vec::loadu(hg, n));
+      auto input_gate = sigmoid(Vec::loadu(g + H, n) + Vec::loadu(hg + H, n));
+      auto new_gate = (Vec::loadu(g + 2 * H, n) +
+                       reset_gate * Vec::loadu(hg + 2 * H, n)).tanh();
+      auto hy = new_gate + input_gate * (Vec::loadu(h, n) - new_gate);
+      reset_gate.store(g, n);
+      input_gate.store(g + H, n);
+      new_gate.store(g + 2 * H, n);
+      hy.store(h, n);
+      hy.store(row<scalar_t>(output, b) + j, n);
+    });
+  });
+}
+
+void rnn_forward_kernel_impl(
+    Tensor& gates,
+    Tensor& hx,
+    Tensor& output,
+    int64_t mode) {
+  AT_DISPATCH_FLOATING_TYPES(gates.type(), "rnn_forward", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    const bool relu = mode == 0;
+    const Vec zero(0);
+    for_each_block<scalar_t>(hx.size(0), hx.size(1), 16, [&](int64_t b, int64_t j, int64_t n) {
+      scalar_t* g = row<scalar_t>(gates, b) + j;
+      auto pre = Vec::loadu(g, n);
+      auto hy = relu ? vec256::max(pre, zero) : pre.tanh();
+      hy.store(g, n);
+      hy.store(row<scalar_t>(hx, b) + j, n);
+      hy.store(row<scalar_t>(output, b) + j, n);
+    });
+  });
+}
+
+void lstm_backward_kernel_impl(
+    Tensor& grad_gates,
+    const Tensor& gates,
+    const Tensor& cells,
+    const Tensor& prev_cells,
+    const Tensor& grad_output,
+    const Tensor& grad_hx,
+    Tensor& grad_cx) {
+  AT_DISPATCH_FLOATING_TYPES(gates.type(), "lstm_backward", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    const int64_t H = cells.size(1);
+    const Vec one(1);
+    for_each_block<scalar_t>(cells.size(0), H, 48, [&](int64_t b, int64_t j, int64_t n) {
+      const scalar_t* g = row<scalar_t>(gates, b) + j;
+      scalar_t* dg = row<scalar_t>(grad_gates, b) + j;
+      scalar_t* dc = row<scalar_t>(grad_cx, b) + j;
+      auto in_gate = Vec::loadu(g, n);
+      auto forget_gate = Vec::loadu(g + H, n);
+      auto cell_gate = Vec::loadu(g + 2 * H, n);
+      auto out_gate = Vec::loadu(g + 3 * H, n);
+      auto tanh_cy = Vec::loadu(row<scalar_t>(cells, b) + j, n).tanh();
+      auto dhy = Vec::loadu(row<scalar_t>(grad_output, b) + j, n) +
+          Vec::loadu(row<scalar_t>(grad_hx, b) + j, n);
+      auto dcy = Vec::loadu(dc, n) +
+          dhy * out_gate * (one - tanh_cy * tanh_cy);
+      auto cx = Vec::loadu(row<scalar_t>(prev_cells, b) + j, n);
+      (dcy * cell_gate * in_gate * (one - in_gate)).store(dg, n);
+      (dcy * cx * forget_gate * (one - forget_gate)).store(dg + H, n);
+      (dcy * in_gate * (one - cell_gate * cell_gate)).store(dg + 2 * H, n);
+      (dhy * tanh_cy * out_gate * (one - out_gate)).store(dg + 3 * H, n);
+      (dcy * forget_gate).store(dc, n);
+    });
+  });
+}
+
+void gru_backward_kernel_impl(
+    Tensor& grad_gates,
+    Tensor& grad_hgates,
+    const Tensor& gates,
+    const Tensor& hgates,
+    const Tensor& prev_hx,
+    const Tensor& grad_output,
+    Tensor& grad_hx) {
+  AT_DISPATCH_FLOATING_TYPES(gates.type(), "gru_backward", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    const int64_t H = prev_hx.size(1);
+    const Vec one(1);
+    for_each_block<scalar_t>(prev_hx.size(0), H, 40, [&](int64_t b, int64_t j, int64_t n) {
+      const scalar_t* g = row<scalar_t>(gates, b) + j;
+      scalar_t* dg = row<scalar_t>(grad_gates, b) + j;
+      scalar_t* dhg = row<scalar_t>(grad_hgates, b) + j;
+      scalar_t* dh = row<scalar_t>(grad_hx, b) + j;
+      auto reset_gate = Vec::loadu(g, n);
+      auto input_gate = Vec::loadu(g + H, n);
+      auto new_gate = Vec::loadu(g + 2 * H, n);
+      auto hn = Vec::loadu(row<scalar_t>(hgates, b) + j + 2 * H, n);
+      auto hx = Vec::loadu(row<scalar_t>(prev_hx, b) + j, n);
+      auto dhy = Vec::loadu(row<scalar_t>(grad_output, b) + j, n) +
+          Vec::loadu(dh, n);
+      auto dnew = dhy * (one - input_gate) * (one - new_gate * new_gate);
+      auto dinput = dhy * (hx - new_gate) * input_gate * (one - input_gate);
+      auto dreset = dnew * hn * reset_gate * (one - reset_gate);
+      dreset.store(dg, n);
+      dinput.store(dg + H, n);
+      dnew.store(dg + 2 * H, n);
+      dreset.store(dhg, n);
+      dinput.store(dhg + H, n);
+      (dnew * reset_gate).store(dhg + 2 * H, n);
+      (dhy * input_gate).store(dh, n);
+    });
+  });
+}
+
+void rnn_backward_kernel_impl(
+    Tensor& grad_gates,
+    const Tensor& gates,
+    const Tensor& grad_output,
+    const Tensor& grad_hx,
+    int64_t mode) {
+  AT_DISPATCH_FLOATING_TYPES(gates.type(), "rnn_backward", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    const bool relu = mode == 0;
+    const Vec one(1);
+    for_each_block<scalar_t>(gates.size(0), gates.size(1), 16, [&](int64_t b, int64_t j, int64_t n) {
+      auto hy = Vec::loadu(row<scalar_t>(gates, b) + j, n);
+      auto dhy = Vec::loadu(row<scalar_t>(grad_output, b) + j, n) +
+          Vec::loadu(row<scalar_t>(grad_hx, b) + j, n);
+      scalar_t* dg = row<scalar_t>(grad_gates, b) + j;
+      if (relu) {
+        // Vec256 has no comparisons, so the ReLU mask is applied per element
+        dhy.store(dg, n);
+        const scalar_t* h = row<scalar_t>(gates, b) + j;
+        for (int64_t k = 0; k < n; k++) {
+          if (!(h[k] > 0)) {
+            dg[k] = 0;
+          }
+        }
+      } else {
+        (dhy * (one - hy * hy)).store(dg, n);
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lstm_forward_stub, &lstm_forward_kernel_impl);
+REGISTER_DISPATCH(gru_forward_stub, &gru_forward_kernel_impl);
+REGISTER_DISPATCH(rnn_forward_stub, &rnn_forward_kernel_impl);
+REGISTER_DISPATCH(lstm_backward_stub, &lstm_backward_kernel_impl);
+REGISTER_DISPATCH(gru_backward_stub, &gru_backward_kernel_impl);
+REGISTER_DISPATCH(rnn_backward_stub, &rnn_backward_kernel_impl);
+
+}} // namespace at::native
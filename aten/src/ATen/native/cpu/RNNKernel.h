@@ -0,0 +1,88 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Pointwise parts of one time step of the fused CPU RNN (see RNN.cpp). Every
+// tensor is a 2-d [batch, columns] view whose rows may be strided but whose
+// columns are contiguous; H is the hidden size. The kernels see the batch of
+// the step only, i.e. hx and cx are the first batch rows of the running state.
+//
+// Gate order is the one of the weights: i, f, g, o for LSTM and r, z, n for
+// GRU. On entry gates holds the preactivations of the step, with the hidden
+// projection already added for LSTM and plain RNNs; the kernels replace them
+// with the activations, which is what backward reads.
+//
+// lstm_forward: gates is [B, 4H]. Updates cx and hx to the new cell and
+// hidden state, writes the hidden state to output and, if defined, the cell
+// state to cells.
+using lstm_forward_fn = void(*)(
+    Tensor& gates,
+    Tensor& hx,
+    Tensor& cx,
+    Tensor& output,
+    Tensor& cells);
+
+// gru_forward: gates is the input projection and hgates the hidden projection
+// (both [B, 3H], with biases). hgates is left as is, since backward needs
+// its n part.
+using gru_forward_fn = void(*)(
+    Tensor& gates,
+    const Tensor& hgates,
+    Tensor& hx,
+    Tensor& output);
+
+// rnn_forward: gates is [B, H]; mode is 0 for ReLU and 1 for tanh.
+using rnn_forward_fn = void(*)(
+    Tensor& gates,
+    Tensor& hx,
+    Tensor& output,
+    int64_t mode);
+
+// The backward kernels take the activations saved by the forward kernels and
+// the gradient of the step's output and compute the gradient of the gates'
+// preactivations. grad_hx holds the gradient of the step's hidden state
+// coming from the following step; it is added to grad_output.
+//
+// lstm_backward: cells and prev_cells are the cell state after and before
+// the step. Replaces grad_cx by the gradient of prev_cells. The caller still
+// has to compute the gradient of the previous hidden state from grad_gates.
+using lstm_backward_fn = void(*)(
+    Tensor& grad_gates,
+    const Tensor& gates,
+    const Tensor& cells,
+    const Tensor& prev_cells,
+    const Tensor& grad_output,
+    const Tensor& grad_hx,
+    Tensor& grad_cx);
+
+// gru_backward: grad_gates and grad_hgates are the gradients of the input
+// and hidden projections. Replaces grad_hx by the part of the gradient of
+// prev_hx that does not flow through the hidden projection.
+using gru_backward_fn = void(*)(
+    Tensor& grad_gates,
+    Tensor& grad_hgates,
+    const Tensor& gates,
+    const Tensor& hgates,
+    const Tensor& prev_hx,
+    const Tensor& grad_output,
+    Tensor& grad_hx);
+
+// rnn_backward: gates holds the hidden state computed by the step.
+using rnn_backward_fn = void(*)(
+    Tensor& grad_gates,
+    const Tensor& gates,
+    const Tensor& grad_output,
+    const Tensor& grad_hx,
+    int64_t mode);
+
+DECLARE_DISPATCH(lstm_forward_fn, lstm_forward_stub);
+DECLARE_DISPATCH(gru_forward_fn, gru_forward_stub);
+DECLARE_DISPATCH(rnn_forward_fn, rnn_forward_stub);
+DECLARE_DISPATCH(lstm_backward_fn, lstm_backward_stub);
+DECLARE_DISPATCH(gru_backward_fn, gru_backward_stub);
+DECLARE_DISPATCH(rnn_backward_fn, rnn_backward_stub);
+
+}} // namespace at::native
@@ -157,15 +157,18 @@ struct Reduction {
   // Reduce down a column of WIDTH elements (128 bytes) with the given number
   // of rows. Stores the results in out[0 ... WIDTH-1].
   static void reduce128(const scalar_t* data, scalar_t* out, int64_t rows, int64_t stride) {
-    Vec acc[4] = {ident, ident, ident, ident};  // 128 bytes (two cache lines)
+    // 128 bytes (two cache lines): four 256-bit or two 512-bit vectors
+    static constexpr int NUM_ACC = WIDTH / Vec::size;
+    Vec acc[NUM_ACC];
+    std::fill(acc, acc + NUM_ACC, Vec(ident));
     static_assert(sizeof(acc) == 128, "accumulator should be 128 bytes");
     for (int64_t row = 0; row != rows; row++) {
-      for (int j = 0; j != 4; j++) {
+      for (int j = 0; j != NUM_ACC; j++) {
         auto val = Vec::loadu(&data[row * stride + j * Vec::size]);
         acc[j] = Reduce()(acc[j], val);
       }
     }
-    for (int j = 0; j != 4; j++) {
+    for (int j = 0; j != NUM_ACC; j++) {
       acc[j].store(&out[j * Vec::size]);
     }
   }
@@ -5,7 +5,7 @@
 #include "ATen/cpu/vml.h"
 #include "ATen/CPUApplyUtils.h"
 #include "ATen/native/DispatchStub.h"
-#ifdef __AVX2__
+#if defined(__AVX2__) && !defined(__AVX512F__)
 #include "ATen/native/cpu/avx_mathfun.h"
 #endif
 
@@ -29,7 +29,7 @@ int64_t _sigmoid(float* x, float* y, int64_t size) {
     Vec ret2 = Vec::loadu(y + i + Vec::size);
     ret = ret.neg();
     ret2 = ret2.neg();
-#if defined(__AVX2__) && !defined(_MSC_VER)
+#if defined(__AVX2__) && !defined(__AVX512F__) && !defined(_MSC_VER)
     ret = exp256_ps(ret);
     ret2 = exp256_ps(ret2);
 #else
@@ -86,5 +86,21 @@ _unique_cuda(const Tensor& self, const bool sorted, const bool return_inverse) {
 #endif
 }
 
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cuda(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
+  Tensor output, inverse_indices;
+  std::tie(output, inverse_indices) =
+      _unique_cuda(self, sorted, return_inverse || return_counts);
+  Tensor counts = at::empty({0}, self.type().toScalarType(kLong));
+  if (return_counts) {
+    counts.resize_({output.numel()}).zero_();
+    counts.index_add_(0, inverse_indices.view(-1), at::ones_like(inverse_indices.view(-1)));
+  }
+  if (!return_inverse) {
+    inverse_indices = at::empty({0}, self.type().toScalarType(kLong));
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
+
 }  // namespace native
 }  // namespace at
@@ -3,10 +3,14 @@
 
 #include "ATen/ATen.h"
 #include "ATen/DLConvertor.h"
+#include "ATen/Parallel.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string.h>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 #include "test_seed.h"
 
 using namespace at;
@@ -26,3 +30,49 @@ TEST_CASE( "parallel", "[cpu]" ) {
   as[2] = 0;
   REQUIRE(a.sum(0).equal(as));
 }
+
+TEST_CASE( "parallel native backend", "[cpu]" ) {
+
+  manual_seed(123, at::Backend::CPU);
+  int prev_num_threads = get_num_threads();
+  ParallelBackend prev_backend = get_parallel_backend();
+  set_num_threads(4);
+  set_parallel_backend(ParallelBackend::Native);
+
+  // every index is visited exactly once, including from nested loops
+  std::vector<int> visited(100003, 0);
+  parallel_for(0, visited.size(), 7, [&](int64_t begin, int64_t end) {
+    parallel_for(begin, end, 1, [&](int64_t begin_, int64_t end_) {
+      for (int64_t i = begin_; i < end_; i++) {
+        visited[i]++;
+      }
+    });
+  });
+  REQUIRE(std::all_of(visited.begin(), visited.end(), [](int v) { return v == 1; }));
+
+  double sum = parallel_reduce(0, 1000000, 1000, 0.0,
+      [](int64_t begin, int64_t end, double init) {
+        for (int64_t i = begin; i < end; i++) {
+          init += i;
+        }
+        return init;
+      },
+      std::plus<double>());
+  REQUIRE(sum == 499999500000.0);
+
+  REQUIRE_THROWS(parallel_for(0, 1000, 1, [](int64_t begin, int64_t end) {
+    if (begin == 0) {
+      throw std::runtime_error("error in chunk");
+    }
+  }));
+
+  Tensor a = rand({1000, 1000});
+  set_parallel_backend(ParallelBackend::OpenMP);
+  Tensor expected = a.sum(1);
+  set_parallel_backend(ParallelBackend::Native);
+  REQUIRE(a.sum(1).equal(expected));
+  REQUIRE((a + a).equal(a * 2));
+
+  set_parallel_backend(prev_backend);
+  set_num_threads(prev_num_threads);
+}
@@ -1,5 +1,10 @@
 #include "THAllocator.h"
 
+#include <ATen/core/CPUCachingAllocator.h>
+
+#include <cstdlib>
+#include <cstring>
+
 /* stuff for mapped files */
 #ifdef _WIN32
 #include <windows.h>
@@ -29,9 +34,38 @@ struct THDefaultAllocator final : public at::Allocator {
   }
 };
 
+// Keeps freed blocks for reuse instead of returning them to the system, see
+// ATen/core/CPUCachingAllocator.h. Selected with ATEN_CPU_CACHING_ALLOCATOR=1;
+// the choice is made once, so that every block is freed by the allocator that
+// allocated it.
+struct THCachingAllocator final : public at::Allocator {
+  at::DataPtr allocate(size_t size) const override {
+    if (size == 0) {
+      return {nullptr, nullptr, &at::CPUCachingAllocator::free, at::kCPU};
+    }
+    auto* ptr = at::CPUCachingAllocator::get().allocate(size);
+    if (!ptr) {
+      THError("$ Torch: not enough memory: you tried to allocate %dGB. Buy new RAM!", size/1073741824);
+    }
+    return {ptr, ptr, &at::CPUCachingAllocator::free, at::kCPU};
+  }
+  at::DeleterFnPtr raw_deleter() const override {
+    return &at::CPUCachingAllocator::free;
+  }
+};
+
+static bool th_use_caching_allocator() {
+  const char* env_p = std::getenv("ATEN_CPU_CACHING_ALLOCATOR");
+  return env_p && std::strcmp(env_p, "1") == 0;
+}
+
 static THDefaultAllocator th_default_allocator;
+static THCachingAllocator th_caching_allocator;
 at::Allocator* getTHDefaultAllocator() {
-  return &th_default_allocator;
+  static at::Allocator* allocator = th_use_caching_allocator()
+      ? static_cast<at::Allocator*>(&th_caching_allocator)
+      : static_cast<at::Allocator*>(&th_default_allocator);
+  return allocator;
 }
 
 #if defined(_WIN32) || defined(HAVE_MMAP)
@@ -0,0 +1,79 @@
+"""Measures backward() time of a wide, multi-tower graph for different numbers
+of autograd CPU worker threads (TORCH_AUTOGRAD_CPU_THREADS).
+
+The worker count is fixed when the autograd engine starts, so every
+configuration runs in its own subprocess.
+
+Usage:
+    python benchmarks/autograd/branched_backward.py --threads 1 2 4 8
+"""
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+
+def run_child(args):
+    import torch
+
+    torch.manual_seed(0)
+    towers = [[torch.randn(args.width, args.width, requires_grad=True)
+               for _ in range(args.depth)]
+              for _ in range(args.towers)]
+    x = torch.randn(args.batch, args.width)
+
+    def step():
+        outputs = []
+        for tower in towers:
+            h = x
+            for w in tower:
+                h = torch.tanh(h.mm(w))
+            outputs.append(h.sum())
+        torch.stack(outputs).sum().backward()
+
+    for _ in range(args.warmup):
+        step()
+    start = time.time()
+    for _ in range(args.iters):
+        step()
+    elapsed = (time.time() - start) / args.iters
+    print('{:.3f}'.format(elapsed * 1000))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--threads', type=int, nargs='+', default=[1, 2, 4])
+    parser.add_argument('--towers', type=int, default=16)
+    parser.add_argument('--depth', type=int, default=4)
+    parser.add_argument('--width', type=int, default=256)
+    parser.add_argument('--batch', type=int, default=64)
+    parser.add_argument('--iters', type=int, default=20)
+    parser.add_argument('--warmup', type=int, default=5)
+    parser.add_argument('--child', action='store_true', help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.child:
+        run_child(args)
+        return
+
+    child_args = sys.argv[1:]
+    baseline = None
+    print('towers={} depth={} width={} batch={}'.format(
+        args.towers, args.depth, args.width, args.batch))
+    for threads in args.threads:
+        env = dict(os.environ)
+        env['TORCH_AUTOGRAD_CPU_THREADS'] = str(threads)
+        # Keep intra-op parallelism out of the picture so that the speedup
+        # comes from evaluating independent branches concurrently.
+        env.setdefault('OMP_NUM_THREADS', '1')
+        out = subprocess.check_output(
+            [sys.executable, __file__, '--child'] + child_args, env=env)
+        ms = float(out.decode().strip().splitlines()[-1])
+        baseline = baseline or ms
+        print('autograd CPU threads: {:2d}  {:8.3f} ms/iter  speedup {:.2f}x'.format(
+            threads, ms, baseline / ms))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,67 @@
+"""Measures autograd engine overhead: backward() through a graph of many tiny
+ops, where the cost of scheduling each Function dominates the math.
+
+The graph interleaves a long chain with short side branches, so the ready
+queue sees both back-to-back single tasks and a few concurrently ready ones.
+
+Usage:
+    python benchmarks/autograd/tiny_ops_backward.py --ops 10000
+"""
+import argparse
+import time
+
+import torch
+
+
+def build_loss(x, num_ops, branch_every):
+    h = x
+    side = []
+    for i in range(num_ops):
+        if i % 2 == 0:
+            h = h * 1.0001
+        else:
+            h = h + 0.5
+        if branch_every and i % branch_every == 0:
+            side.append(h.sin())
+    if side:
+        h = h + torch.stack(side).sum()
+    return h.sum()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--ops', type=int, default=10000)
+    parser.add_argument('--size', type=int, default=1,
+                        help='number of elements in each tensor')
+    parser.add_argument('--branch-every', type=int, default=100,
+                        help='add a side branch every N ops (0 disables)')
+    parser.add_argument('--iters', type=int, default=20)
+    parser.add_argument('--warmup', type=int, default=3)
+    args = parser.parse_args()
+
+    torch.set_num_threads(1)
+    x = torch.randn(args.size, requires_grad=True)
+
+    forward = 0.0
+    backward = 0.0
+    for i in range(args.warmup + args.iters):
+        start = time.time()
+        loss = build_loss(x, args.ops, args.branch_every)
+        mid = time.time()
+        loss.backward()
+        end = time.time()
+        if i >= args.warmup:
+            forward += mid - start
+            backward += end - mid
+
+    num_branches = -(-args.ops // args.branch_every) if args.branch_every else 0
+    num_nodes = args.ops + num_branches
+    backward_ms = backward / args.iters * 1000
+    print('ops={} size={} branch_every={}'.format(args.ops, args.size, args.branch_every))
+    print('forward:  {:8.3f} ms/iter'.format(forward / args.iters * 1000))
+    print('backward: {:8.3f} ms/iter  ({:.2f} us/node)'.format(
+        backward_ms, backward_ms * 1000 / num_nodes))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,94 @@
+"""Measures the time of an allreduce of a single float tensor over a Gloo
+process group on CPU with every Compression mode, next to the number of
+bytes every process sends and the error of the result.
+
+Bytes on the wire are computed from the algorithms: every mode runs a
+ring allreduce that sends 2 * (size - 1) chunks of 1 / size of the tensor
+per process, which INT8 and TOPK encode.
+
+Usage:
+    python benchmarks/distributed/compressed_allreduce.py --world-size 4 --numel 4194304
+"""
+import argparse
+import math
+import multiprocessing
+import tempfile
+import time
+
+import torch
+from torch.distributed import c10d
+
+
+def bytes_on_wire(args, compression):
+    n = args.world_size
+    if compression == 'NONE':
+        return 2.0 * (n - 1) / n * args.numel * 4
+    if compression == 'FP16':
+        return 2.0 * (n - 1) / n * args.numel * 2
+    chunk = (args.numel + n - 1) // n
+    if compression == 'INT8':
+        # A float scale for every 256 elements
+        return 2 * (n - 1) * ((chunk + 255) // 256 * 4 + chunk)
+    k = max(1, int(math.ceil(chunk * args.topk_ratio)))
+    return 2 * (n - 1) * k * 8
+
+
+def run(rank, args, path, results):
+    torch.set_num_threads(1)
+    store = c10d.FileStore(path)
+    opts = c10d.ProcessGroupGloo.Options()
+    opts.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+    pg = c10d.ProcessGroupGloo(store, rank, args.world_size, opts)
+
+    torch.manual_seed(rank)
+    input = torch.randn(args.numel)
+    exact = input.clone()
+    pg.allreduce(exact).wait()
+
+    for compression in ['NONE', 'FP16', 'INT8', 'TOPK']:
+        opts = c10d.AllreduceOptions()
+        opts.compression = getattr(c10d.Compression, compression)
+        opts.topkRatio = args.topk_ratio
+        opts.residual = torch.zeros(args.numel)
+
+        elapsed = 0.0
+        for i in range(args.warmup + args.iters):
+            tensor = input.clone()
+            opts.residual.zero_()
+            pg.barrier().wait()
+            start = time.time()
+            pg.allreduce([tensor], opts).wait()
+            if i >= args.warmup:
+                elapsed += time.time() - start
+        if rank == 0:
+            error = (tensor - exact).norm() / exact.norm()
+            results.put((compression, bytes_on_wire(args, compression),
+                         elapsed / args.iters, error.item()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--world-size', type=int, default=2)
+    parser.add_argument('--numel', type=int, default=1 << 22,
+                        help='elements of the tensor to allreduce')
+    parser.add_argument('--topk-ratio', type=float, default=0.01)
+    parser.add_argument('--iters', type=int, default=20)
+    parser.add_argument('--warmup', type=int, default=3)
+    args = parser.parse_args()
+
+    with tempfile.NamedTemporaryFile() as f:
+        results = multiprocessing.Queue()
+        processes = [multiprocessing.Process(target=run, args=(rank, args, f.name, results))
+                     for rank in range(args.world_size)]
+        for p in processes:
+            p.start()
+        for _ in range(4):
+            compression, sent, seconds, error = results.get()
+            print('{:>5}: {:10.3f} MB sent per process, {:8.3f} ms, relative error {:.2e}'.format(
+                compression, sent / 1e6, seconds * 1000, error))
+        for p in processes:
+            p.join()
+
+
+if __name__ == '__main__':
+    main()
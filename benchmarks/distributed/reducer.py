@@ -0,0 +1,102 @@
+"""Measures the time per training iteration of a model with many small
+parameters on CPU, averaging gradients over a Gloo process group either
+with one allreduce per parameter after backward() or with c10d.Reducer,
+which buckets the gradients and overlaps the allreduces with backward().
+
+Every process runs the same model on its own random batch; rank 0 prints
+the mean time per iteration of both modes.
+
+Usage:
+    python benchmarks/distributed/reducer.py --world-size 4 --layers 32
+"""
+import argparse
+import multiprocessing
+import tempfile
+import time
+
+import torch
+import torch.nn as nn
+from torch.distributed import c10d
+
+
+def create_model(args):
+    layers = []
+    for _ in range(args.layers):
+        layers += [nn.Linear(args.hidden, args.hidden), nn.ReLU()]
+    return nn.Sequential(*layers)
+
+
+def per_parameter_step(model, pg, input):
+    model(input).sum().backward()
+    work = [pg.allreduce(p.grad) for p in model.parameters()]
+    for w, p in zip(work, model.parameters()):
+        w.wait()
+        p.grad /= pg.size()
+
+
+def reducer_step(model, pg, input):
+    model(input).sum().backward()
+
+
+def run(rank, args, path, results):
+    torch.set_num_threads(1)
+    store = c10d.FileStore(path)
+    opts = c10d.ProcessGroupGloo.Options()
+    opts.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+    opts.threads = args.threads
+    pg = c10d.ProcessGroupGloo(store, rank, args.world_size, opts)
+
+    torch.manual_seed(rank)
+    input = torch.randn(args.batch_size, args.hidden)
+    for mode, step in [('per-parameter', per_parameter_step), ('reducer', reducer_step)]:
+        model = create_model(args)
+        reducer = None
+        if mode == 'reducer':
+            reducer = c10d.Reducer(list(model.parameters()), pg,
+                                   int(args.bucket_mb * 1024 * 1024))
+
+        elapsed = 0.0
+        for i in range(args.warmup + args.iters):
+            model.zero_grad()
+            pg.barrier().wait()
+            start = time.time()
+            step(model, pg, input)
+            if i >= args.warmup:
+                elapsed += time.time() - start
+        if rank == 0:
+            buckets = len(reducer.get_bucket_indices()) if reducer else len(list(model.parameters()))
+            results.put((mode, buckets, elapsed / args.iters))
+        del reducer
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--world-size', type=int, default=2)
+    parser.add_argument('--layers', type=int, default=32)
+    parser.add_argument('--hidden', type=int, default=64,
+                        help='features of every linear layer')
+    parser.add_argument('--batch-size', type=int, default=32)
+    parser.add_argument('--bucket-mb', type=float, default=1.0,
+                        help='bucket size cap of the reducer in MB')
+    parser.add_argument('--threads', type=int, default=2,
+                        help='worker threads of the process group')
+    parser.add_argument('--iters', type=int, default=50)
+    parser.add_argument('--warmup', type=int, default=5)
+    args = parser.parse_args()
+
+    with tempfile.NamedTemporaryFile() as f:
+        results = multiprocessing.Queue()
+        processes = [multiprocessing.Process(target=run, args=(rank, args, f.name, results))
+                     for rank in range(args.world_size)]
+        for p in processes:
+            p.start()
+        for _ in range(2):
+            mode, collectives, seconds = results.get()
+            print('{:>14}: {:4d} allreduces per iteration, {:8.3f} ms per iteration'.format(
+                mode, collectives, seconds * 1000))
+        for p in processes:
+            p.join()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,87 @@
+"""Measures per-op dispatch latency of the JIT interpreter, comparing register
+dispatch (the default) with the stack-based loop.
+
+Graphs are compiled with optimize=False so that every op is executed by the
+interpreter itself rather than being fused away. Tensors have a single
+element, so the time is dominated by dispatch rather than by the kernels.
+
+Usage:
+    python benchmarks/jit/interpreter_dispatch.py --ops 200 --trips 1000
+"""
+import argparse
+import time
+
+import torch
+
+
+def straight_line_source(num_ops):
+    lines = ['def straight(x):']
+    for i in range(num_ops):
+        lines.append('    x = x + 1' if i % 2 == 0 else '    x = x * 2')
+    lines.append('    return x')
+    return '\n'.join(lines) + '\n'
+
+
+LOOP_SOURCE = '''
+def loop(a, n):
+    b = a
+    while n > 0:
+        a, b = b, a + b
+        n -= 1
+    return a
+'''
+
+
+def bench(fn, args, iters, warmup):
+    for _ in range(warmup):
+        fn(*args)
+    start = time.time()
+    for _ in range(iters):
+        fn(*args)
+    return (time.time() - start) / iters
+
+
+def run_both(fn, args, iters, warmup):
+    results = {}
+    old = torch._C._jit_get_register_dispatch()
+    try:
+        for register_dispatch in (False, True):
+            torch._C._jit_set_register_dispatch(register_dispatch)
+            results[register_dispatch] = bench(fn, args, iters, warmup)
+    finally:
+        torch._C._jit_set_register_dispatch(old)
+    return results[False], results[True]
+
+
+def report(name, stack, register, ops):
+    print('{:<12} stack: {:7.3f} us/op  register: {:7.3f} us/op  speedup: {:.2f}x'.format(
+        name, stack * 1e6 / ops, register * 1e6 / ops, stack / register))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--ops', type=int, default=200,
+                        help='number of ops in the straight-line graph')
+    parser.add_argument('--trips', type=int, default=1000,
+                        help='number of iterations of the loop graph')
+    parser.add_argument('--iters', type=int, default=200)
+    parser.add_argument('--warmup', type=int, default=20)
+    args = parser.parse_args()
+
+    torch.set_num_threads(1)
+    x = torch.ones(1)
+
+    cu = torch.jit.CompilationUnit(straight_line_source(args.ops), optimize=False)
+    stack, register = run_both(cu.straight, (x,), args.iters, args.warmup)
+    report('straight', stack, register, args.ops)
+
+    cu = torch.jit.CompilationUnit(LOOP_SOURCE, optimize=False)
+    n = torch.tensor([args.trips])
+    # each trip runs the add, the decrement, the comparison and the loop's
+    # own assignment and branch
+    stack, register = run_both(cu.loop, (x, n), max(args.iters // 10, 1), args.warmup)
+    report('loop', stack, register, args.trips * 5)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the OpenMP and native work-stealing intra-op backends of
+// at::parallel_for / at::parallel_reduce on reductions and binary ops.
+// The first argument of every benchmark selects the backend (0 = OpenMP,
+// 1 = native); use --benchmark_filter to restrict the set of kernels.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+
+#include <thread>
+#include <vector>
+
+static at::ParallelBackend backend_arg(benchmark::State& state) {
+  return state.range(0) ? at::ParallelBackend::Native
+                        : at::ParallelBackend::OpenMP;
+}
+
+static void BM_SumAll(benchmark::State& state) {
+  at::set_parallel_backend(backend_arg(state));
+  auto a = at::rand({state.range(1)}, at::CPU(at::kFloat));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(a.sum());
+  }
+  state.SetBytesProcessed(state.iterations() * a.numel() * sizeof(float));
+}
+BENCHMARK(BM_SumAll)
+    ->ArgPair(0, 1 << 16)->ArgPair(1, 1 << 16)
+    ->ArgPair(0, 1 << 24)->ArgPair(1, 1 << 24);
+
+static void BM_SumDim(benchmark::State& state) {
+  at::set_parallel_backend(backend_arg(state));
+  auto a = at::rand({state.range(1), 1024}, at::CPU(at::kFloat));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(a.sum(state.range(2)));
+  }
+  state.SetBytesProcessed(state.iterations() * a.numel() * sizeof(float));
+}
+BENCHMARK(BM_SumDim)
+    ->Args({0, 64, 0})->Args({1, 64, 0})
+    ->Args({0, 64, 1})->Args({1, 64, 1})
+    ->Args({0, 4096, 0})->Args({1, 4096, 0})
+    ->Args({0, 4096, 1})->Args({1, 4096, 1});
+
+static void BM_Add(benchmark::State& state) {
+  at::set_parallel_backend(backend_arg(state));
+  auto a = at::rand({state.range(1)}, at::CPU(at::kFloat));
+  auto b = at::rand({state.range(1)}, at::CPU(at::kFloat));
+  auto out = at::empty({state.range(1)}, at::CPU(at::kFloat));
+  while (state.KeepRunning()) {
+    at::add_out(out, a, b);
+  }
+  state.SetBytesProcessed(state.iterations() * 3 * a.numel() * sizeof(float));
+}
+BENCHMARK(BM_Add)
+    ->ArgPair(0, 1 << 16)->ArgPair(1, 1 << 16)
+    ->ArgPair(0, 1 << 24)->ArgPair(1, 1 << 24);
+
+static void BM_Mul(benchmark::State& state) {
+  at::set_parallel_backend(backend_arg(state));
+  auto a = at::rand({state.range(1)}, at::CPU(at::kFloat));
+  auto b = at::rand({state.range(1)}, at::CPU(at::kFloat));
+  auto out = at::empty({state.range(1)}, at::CPU(at::kFloat));
+  while (state.KeepRunning()) {
+    at::mul_out(out, a, b);
+  }
+  state.SetBytesProcessed(state.iterations() * 3 * a.numel() * sizeof(float));
+}
+BENCHMARK(BM_Mul)
+    ->ArgPair(0, 1 << 16)->ArgPair(1, 1 << 16)
+    ->ArgPair(0, 1 << 24)->ArgPair(1, 1 << 24);
+
+// Several inter-op threads issuing ATen ops concurrently; this is where
+// per-call OpenMP teams oversubscribe the machine.
+static void BM_ConcurrentCallers(benchmark::State& state) {
+  at::set_parallel_backend(backend_arg(state));
+  const int64_t num_callers = state.range(1);
+  std::vector<at::Tensor> inputs;
+  for (int64_t i = 0; i < num_callers; i++) {
+    inputs.push_back(at::rand({1 << 20}, at::CPU(at::kFloat)));
+  }
+  while (state.KeepRunning()) {
+    std::vector<std::thread> callers;
+    for (int64_t i = 0; i < num_callers; i++) {
+      callers.emplace_back([&inputs, i] {
+        for (int r = 0; r < 16; r++) {
+          benchmark::DoNotOptimize((inputs[i] * inputs[i]).sum());
+        }
+      });
+    }
+    for (auto& caller : callers) {
+      caller.join();
+    }
+  }
+}
+BENCHMARK(BM_ConcurrentCallers)
+    ->ArgPair(0, 4)->ArgPair(1, 4)
+    ->ArgPair(0, 16)->ArgPair(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
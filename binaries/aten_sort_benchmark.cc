@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmarks the CPU sort, topk and kthvalue kernels on a rows x cols tensor.
+// The arguments of every benchmark are {rows, cols, dim, dtype}, where dtype
+// is 0 for float, 1 for double, 2 for int and 3 for long. Sorting along
+// dim 0 exercises the strided path.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+
+static at::Tensor make_input(benchmark::State& state) {
+  static const at::ScalarType kTypes[] = {
+      at::kFloat, at::kDouble, at::kInt, at::kLong};
+  auto input = at::rand({state.range(0), state.range(1)}, at::CPU(at::kFloat));
+  // Integer inputs get a value range wide enough to need every radix pass.
+  return (input * (1 << 30)).toType(at::CPU(kTypes[state.range(3)]));
+}
+
+static void SortArgs(benchmark::internal::Benchmark* b) {
+  for (int dtype = 0; dtype < 4; dtype++) {
+    b->Args({1, 1 << 20, 1, dtype});
+    b->Args({1024, 1024, 1, dtype});
+    b->Args({1024, 1024, 0, dtype});
+    b->Args({1 << 16, 16, 1, dtype});
+  }
+}
+
+static void BM_Sort(benchmark::State& state) {
+  auto input = make_input(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(input.sort(state.range(2)));
+  }
+  state.SetItemsProcessed(state.iterations() * input.numel());
+}
+BENCHMARK(BM_Sort)->Apply(SortArgs);
+
+static void BM_SortDescending(benchmark::State& state) {
+  auto input = make_input(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(input.sort(state.range(2), true));
+  }
+  state.SetItemsProcessed(state.iterations() * input.numel());
+}
+BENCHMARK(BM_SortDescending)->Apply(SortArgs);
+
+static void BM_TopK(benchmark::State& state) {
+  auto input = make_input(state);
+  const int64_t dim = state.range(2);
+  const int64_t k = std::min<int64_t>(input.size(dim), state.range(4));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(input.topk(k, dim));
+  }
+  state.SetItemsProcessed(state.iterations() * input.numel());
+}
+BENCHMARK(BM_TopK)
+    ->Args({1, 1 << 20, 1, 0, 10})
+    ->Args({1, 1 << 20, 1, 0, 1000})
+    ->Args({1, 1 << 20, 1, 0, 1 << 19})
+    ->Args({1024, 1024, 1, 0, 10})
+    ->Args({1024, 1024, 0, 0, 10})
+    ->Args({1024, 1024, 1, 0, 256})
+    ->Args({1024, 1024, 1, 3, 10});
+
+static void BM_KthValue(benchmark::State& state) {
+  auto input = make_input(state);
+  const int64_t dim = state.range(2);
+  const int64_t k = input.size(dim) / 2 + 1;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(input.kthvalue(k, dim));
+  }
+  state.SetItemsProcessed(state.iterations() * input.numel());
+}
+BENCHMARK(BM_KthValue)->Apply(SortArgs);
+
+BENCHMARK_MAIN();
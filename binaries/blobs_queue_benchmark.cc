@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the throughput of a BlobsQueue under contention: producer threads
+// write small tensors into the queue while consumer threads read them, one
+// record or --read_batch records at a time. Prints the records per second and
+// the queue's stats, e.g.
+//
+//   blobs_queue_benchmark --producers=32 --consumers=4 --read_batch=16
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/init.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/queue/blobs_queue.h"
+
+CAFFE2_DEFINE_int(producers, 32, "Number of threads writing to the queue.");
+CAFFE2_DEFINE_int(consumers, 4, "Number of threads reading from the queue.");
+CAFFE2_DEFINE_int(capacity, 64, "Capacity of the queue.");
+CAFFE2_DEFINE_int(num_blobs, 2, "Number of blobs in a record.");
+CAFFE2_DEFINE_int(blob_size, 16, "Number of floats in every blob.");
+CAFFE2_DEFINE_int64(records, 1000000, "Total number of records to write.");
+CAFFE2_DEFINE_int(read_batch, 1, "Maximum number of records per read.");
+
+namespace caffe2 {
+
+namespace {
+
+void produce(BlobsQueue* queue, int64_t records) {
+  std::vector<Blob> blobs(FLAGS_num_blobs);
+  std::vector<Blob*> inputs;
+  for (auto& blob : blobs) {
+    inputs.push_back(&blob);
+  }
+  for (int64_t i = 0; i < records; ++i) {
+    // The queue swaps the blobs' contents with those of its own blobs, so
+    // they need to be filled again.
+    for (auto& blob : blobs) {
+      auto* tensor = blob.GetMutableTensor(CPU);
+      tensor->Resize(FLAGS_blob_size);
+      tensor->mutable_data<float>()[0] = i;
+    }
+    CAFFE_ENFORCE(queue->blockingWrite(inputs));
+  }
+}
+
+int64_t consume(BlobsQueue* queue) {
+  std::vector<Blob> blobs(FLAGS_read_batch * FLAGS_num_blobs);
+  std::vector<std::vector<Blob*>> records(FLAGS_read_batch);
+  for (int r = 0; r < FLAGS_read_batch; ++r) {
+    for (int b = 0; b < FLAGS_num_blobs; ++b) {
+      records[r].push_back(&blobs[r * FLAGS_num_blobs + b]);
+    }
+  }
+  int64_t consumed = 0;
+  while (true) {
+    const size_t read = FLAGS_read_batch > 1
+        ? queue->blockingReadMany(records)
+        : queue->blockingRead(records[0]);
+    if (read == 0) {
+      return consumed;
+    }
+    consumed += read;
+  }
+}
+
+void run() {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(
+      &ws, "queue", FLAGS_capacity, FLAGS_num_blobs, true);
+
+  Timer timer;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < FLAGS_producers; ++p) {
+    const int64_t records = FLAGS_records / FLAGS_producers +
+        (p < FLAGS_records % FLAGS_producers ? 1 : 0);
+    producers.emplace_back(produce, queue.get(), records);
+  }
+  std::vector<int64_t> consumed(FLAGS_consumers);
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < FLAGS_consumers; ++c) {
+    consumers.emplace_back([&, c] { consumed[c] = consume(queue.get()); });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  queue->close();
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+  const double seconds = timer.Seconds();
+
+  int64_t total = 0;
+  for (auto records : consumed) {
+    total += records;
+  }
+  CAFFE_ENFORCE_EQ(total, FLAGS_records);
+  printf(
+      "%d producers, %d consumers, read batch %d: %.3f s, %.0f records/s\n",
+      FLAGS_producers,
+      FLAGS_consumers,
+      FLAGS_read_batch,
+      seconds,
+      total / seconds);
+  for (const auto& stat : StatRegistry::get().publish()) {
+    printf("  %s: %lld\n", stat.key.c_str(), (long long)stat.value);
+  }
+}
+
+} // namespace
+
+} // namespace caffe2
+
+int main(int argc, char** argv) {
+  caffe2::GlobalInit(&argc, &argv);
+  caffe2::run();
+  return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how fast float tensors are saved to and loaded from a db with the
+// Save and Load operators, and the peak resident memory of the process. The
+// serialization flags apply, e.g.
+//
+//   checkpoint_benchmark --db=/tmp/ckpt --num_blobs=4 --blob_size=50000000
+//   checkpoint_benchmark --db=/tmp/ckpt --caffe2_serialize_using_raw_bytes
+//   checkpoint_benchmark --db=/tmp/ckpt --mode=load --load_in_place
+
+#include <sys/resource.h>
+#include <cstdio>
+
+#include "caffe2/core/init.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/utils/proto_utils.h"
+
+CAFFE2_DEFINE_string(db, "", "The db to save to and load from.");
+CAFFE2_DEFINE_string(db_type, "minidb", "The type of the db.");
+CAFFE2_DEFINE_string(mode, "both", "What to measure: save, load or both.");
+CAFFE2_DEFINE_int(num_blobs, 4, "Number of tensors.");
+CAFFE2_DEFINE_int64(blob_size, 10000000, "Number of floats per tensor.");
+CAFFE2_DEFINE_bool(
+    load_in_place,
+    false,
+    "Load into tensors allocated before running Load.");
+
+namespace caffe2 {
+
+namespace {
+
+std::vector<string> blobNames() {
+  std::vector<string> names;
+  for (int i = 0; i < FLAGS_num_blobs; ++i) {
+    names.push_back(MakeString("blob_", i));
+  }
+  return names;
+}
+
+void allocateBlobs(Workspace* ws, bool fill) {
+  for (const auto& name : blobNames()) {
+    auto* tensor = ws->CreateBlob(name)->GetMutableTensor(CPU);
+    tensor->Resize(FLAGS_blob_size);
+    float* data = tensor->mutable_data<float>();
+    if (fill) {
+      for (TIndex i = 0; i < tensor->size(); ++i) {
+        data[i] = static_cast<float>(i % 1000) / 1000;
+      }
+    }
+  }
+}
+
+double runOnce(const OperatorDef& def, Workspace* ws) {
+  auto op = CreateOperator(def, ws);
+  Timer timer;
+  CAFFE_ENFORCE(op->Run());
+  return timer.Seconds();
+}
+
+long peakRSSMegabytes() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024;
+}
+
+void report(const char* what, double seconds) {
+  const double megabytes =
+      static_cast<double>(FLAGS_num_blobs) * FLAGS_blob_size * sizeof(float) /
+      (1 << 20);
+  printf("%s: %.3f s, %.1f MB/s, peak RSS %ld MB\n",
+         what,
+         seconds,
+         megabytes / seconds,
+         peakRSSMegabytes());
+}
+
+void run() {
+  CAFFE_ENFORCE(!FLAGS_db.empty(), "--db is required");
+  const std::vector<Argument> db_args{
+      MakeArgument<string>("db", FLAGS_db),
+      MakeArgument<string>("db_type", FLAGS_db_type),
+      MakeArgument<int>("absolute_path", 1)};
+  if (FLAGS_mode == "save" || FLAGS_mode == "both") {
+    Workspace ws;
+    allocateBlobs(&ws, true);
+    report("save", runOnce(CreateOperatorDef(
+        "Save", "", blobNames(), {}, db_args), &ws));
+  }
+  if (FLAGS_mode == "load" || FLAGS_mode == "both") {
+    Workspace ws;
+    if (FLAGS_load_in_place) {
+      allocateBlobs(&ws, false);
+    }
+    auto args = db_args;
+    args.push_back(MakeArgument<int>("load_in_place", FLAGS_load_in_place));
+    report("load", runOnce(CreateOperatorDef(
+        "Load", "", {}, blobNames(), args), &ws));
+  }
+}
+
+} // namespace
+
+} // namespace caffe2
+
+int main(int argc, char** argv) {
+  caffe2::GlobalInit(&argc, &argv);
+  caffe2::run();
+  return 0;
+}
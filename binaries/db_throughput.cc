@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <thread>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "caffe2/core/init.h"
 #include "caffe2/core/timer.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/parallel_db_reader.h"
 
 CAFFE2_DEFINE_string(input_db, "", "The input db.");
 CAFFE2_DEFINE_string(input_db_type, "", "The input db type.");
@@ -30,10 +32,25 @@ CAFFE2_DEFINE_int(repeat, 10, "The number to repeat the throughput test.");
 CAFFE2_DEFINE_bool(use_reader, false, "If true, use the reader interface.");
 CAFFE2_DEFINE_int(num_read_threads, 1,
                    "The number of concurrent reading threads.");
+CAFFE2_DEFINE_bool(use_value_view, false,
+                   "If true, read values through Cursor::valueView(), "
+                   "without copying them.");
+CAFFE2_DEFINE_bool(use_parallel_reader, false,
+                   "If true, use a ParallelDBReader with 1, 2, 4, ... up to "
+                   "--num_db_readers cursors.");
+CAFFE2_DEFINE_int(num_db_readers, 8,
+                  "The maximum number of cursors of the parallel reader.");
+CAFFE2_DEFINE_int(readahead, 64,
+                  "The number of records every cursor of the parallel "
+                  "reader keeps ready.");
+CAFFE2_DEFINE_bool(key_range_sharding, false,
+                   "If true, the parallel reader's cursors read key ranges "
+                   "instead of strided records.");
 
 using caffe2::db::Cursor;
 using caffe2::db::DB;
 using caffe2::db::DBReader;
+using caffe2::db::ParallelDBReader;
 using caffe2::string;
 
 void TestThroughputWithDB() {
@@ -44,7 +61,12 @@ void TestThroughputWithDB() {
     caffe2::Timer timer;
     for (int i = 0; i < caffe2::FLAGS_report_interval; ++i) {
       string key = cursor->key();
-      string value = cursor->value();
+      if (caffe2::FLAGS_use_value_view) {
+        auto value = cursor->valueView();
+        CAFFE_ENFORCE(value.data != nullptr);
+      } else {
+        string value = cursor->value();
+      }
       //VLOG(1) << "Key " << key;
       cursor->Next();
       if (!cursor->Valid()) {
@@ -87,9 +109,54 @@ void TestThroughputWithReader() {
   }
 }
 
+void TestThroughputWithParallelReaderWorker(
+    ParallelDBReader* reader, int64_t items) {
+  string key, value;
+  for (int64_t i = 0; i < items; ++i) {
+    reader->Read(&key, &value);
+  }
+}
+
+// Reports the aggregate throughput of --num_read_threads threads reading
+// from a ParallelDBReader, for an increasing number of cursors.
+void TestThroughputWithParallelReader() {
+  const int64_t items_per_thread =
+      static_cast<int64_t>(caffe2::FLAGS_repeat) *
+      caffe2::FLAGS_report_interval;
+  for (int num_readers = 1;; num_readers *= 2) {
+    num_readers = std::min(num_readers, caffe2::FLAGS_num_db_readers);
+    ParallelDBReader reader(
+        caffe2::FLAGS_input_db_type,
+        caffe2::FLAGS_input_db,
+        num_readers,
+        caffe2::FLAGS_readahead,
+        caffe2::FLAGS_key_range_sharding ? ParallelDBReader::KEY_RANGE
+                                         : ParallelDBReader::STRIDE);
+    caffe2::Timer timer;
+    std::vector<std::thread> reading_threads;
+    for (int i = 0; i < caffe2::FLAGS_num_read_threads; ++i) {
+      reading_threads.emplace_back(
+          TestThroughputWithParallelReaderWorker, &reader, items_per_thread);
+    }
+    for (auto& thread : reading_threads) {
+      thread.join();
+    }
+    double elapsed_seconds = timer.Seconds();
+    printf("%2d readers, took %4.5f seconds, throughput %f items/sec.\n",
+           num_readers, elapsed_seconds,
+           items_per_thread * caffe2::FLAGS_num_read_threads /
+               elapsed_seconds);
+    if (num_readers == caffe2::FLAGS_num_db_readers) {
+      break;
+    }
+  }
+}
+
 int main(int argc, char** argv) {
   caffe2::GlobalInit(&argc, &argv);
-  if (caffe2::FLAGS_use_reader) {
+  if (caffe2::FLAGS_use_parallel_reader) {
+    TestThroughputWithParallelReader();
+  } else if (caffe2::FLAGS_use_reader) {
     TestThroughputWithReader();
   } else {
     TestThroughputWithDB();
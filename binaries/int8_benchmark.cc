@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares a float FC or NHWC Conv layer with its Int8 version, produced by
+// opt::RewriteForInt8 from the ranges of one float run, and reports the time
+// per iteration of both nets (the Int8 one including the quantization of its
+// input and the dequantization of its output) and the error of the Int8
+// output. The rewrite marks the weights as static, so the Int8 layer packs
+// them once, during the warm-up iterations.
+//
+//   int8_benchmark --op=FC --batch_size=64 --input_channels=1024
+//   int8_benchmark --op=Conv --input_channels=64 --output_channels=64
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "caffe2/core/init.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/int8_rewrite.h"
+#include "caffe2/utils/proto_utils.h"
+
+CAFFE2_DEFINE_string(op, "FC", "The layer to benchmark: FC or Conv.");
+CAFFE2_DEFINE_int(batch_size, 16, "Batch size.");
+CAFFE2_DEFINE_int(input_channels, 256, "Input features or channels.");
+CAFFE2_DEFINE_int(output_channels, 256, "Output features or channels.");
+CAFFE2_DEFINE_int(image_size, 28, "Height and width of the Conv input.");
+CAFFE2_DEFINE_int(kernel, 3, "Conv kernel size.");
+CAFFE2_DEFINE_int(warmup, 5, "Warm-up iterations.");
+CAFFE2_DEFINE_int(iter, 50, "Timed iterations.");
+
+namespace caffe2 {
+
+namespace {
+
+void fillRandom(
+    const std::string& name,
+    const std::vector<TIndex>& dims,
+    float min,
+    float max,
+    Workspace* ws) {
+  auto* tensor = ws->CreateBlob(name)->GetMutableTensor(CPU);
+  tensor->Resize(dims);
+  std::mt19937 gen(name.size());
+  std::uniform_real_distribution<float> dist(min, max);
+  float* data = tensor->mutable_data<float>();
+  for (TIndex i = 0; i < tensor->size(); ++i) {
+    data[i] = dist(gen);
+  }
+}
+
+NetDef buildNet(Workspace* ws) {
+  NetDef net;
+  net.set_name("layer");
+  net.add_external_input("X");
+  net.add_external_input("W");
+  net.add_external_input("b");
+  net.add_external_output("Y");
+  const int C = FLAGS_input_channels;
+  const int M = FLAGS_output_channels;
+  if (FLAGS_op == "FC") {
+    fillRandom("X", {FLAGS_batch_size, C}, 0, 1, ws);
+    fillRandom("W", {M, C}, -0.1, 0.1, ws);
+    *net.add_op() = CreateOperatorDef("FC", "", {"X", "W", "b"}, {"Y"});
+  } else if (FLAGS_op == "Conv") {
+    const int size = FLAGS_image_size;
+    fillRandom("X", {FLAGS_batch_size, size, size, C}, 0, 1, ws);
+    fillRandom("W", {M, FLAGS_kernel, FLAGS_kernel, C}, -0.1, 0.1, ws);
+    *net.add_op() = CreateOperatorDef(
+        "Conv",
+        "",
+        {"X", "W", "b"},
+        {"Y"},
+        {MakeArgument<int>("kernel", FLAGS_kernel),
+         MakeArgument<int>("pad", FLAGS_kernel / 2),
+         MakeArgument<string>("order", "NHWC")});
+  } else {
+    LOG(FATAL) << "Unknown --op " << FLAGS_op;
+  }
+  fillRandom("b", {M}, -0.1, 0.1, ws);
+  return net;
+}
+
+int8::QuantizationParams rangeParams(const TensorCPU& tensor) {
+  const float* data = tensor.data<float>();
+  const auto minmax = std::minmax_element(data, data + tensor.size());
+  return int8::ChooseQuantizationParams(*minmax.first, *minmax.second);
+}
+
+double secondsPerIteration(const NetDef& net_def, Workspace* ws) {
+  NetBase* net = ws->CreateNet(net_def, true);
+  CAFFE_ENFORCE(net);
+  for (int i = 0; i < FLAGS_warmup; ++i) {
+    CAFFE_ENFORCE(net->Run());
+  }
+  Timer timer;
+  for (int i = 0; i < FLAGS_iter; ++i) {
+    CAFFE_ENFORCE(net->Run());
+  }
+  return timer.Seconds() / FLAGS_iter;
+}
+
+void run() {
+  Workspace ws;
+  const NetDef net = buildNet(&ws);
+  CAFFE_ENFORCE(ws.RunNetOnce(net));
+  TensorCPU expected(ws.GetBlob("Y")->Get<TensorCPU>(), CPU);
+
+  std::unordered_map<std::string, int8::QuantizationParams> params;
+  params["X"] = rangeParams(ws.GetBlob("X")->Get<TensorCPU>());
+  params["Y"] = rangeParams(expected);
+  NetDef int8_net = opt::RewriteForInt8(net, params, &ws);
+  int8_net.set_name("int8_layer");
+
+  const double float_seconds = secondsPerIteration(net, &ws);
+  const double int8_seconds = secondsPerIteration(int8_net, &ws);
+
+  const auto& Y = ws.GetBlob("Y")->Get<TensorCPU>();
+  CAFFE_ENFORCE_EQ(Y.dims(), expected.dims());
+  double max_error = 0, sum_error = 0;
+  for (TIndex i = 0; i < Y.size(); ++i) {
+    const double error =
+        std::abs(Y.data<float>()[i] - expected.data<float>()[i]);
+    max_error = std::max(max_error, error);
+    sum_error += error;
+  }
+  printf("%s: float %.3f ms, int8 %.3f ms (%.2fx)\n",
+         FLAGS_op.c_str(),
+         float_seconds * 1e3,
+         int8_seconds * 1e3,
+         float_seconds / int8_seconds);
+  printf("int8 error: max %g, mean %g, output quantization step %g\n",
+         max_error,
+         sum_error / Y.size(),
+         params["Y"].scale);
+}
+
+} // namespace
+
+} // namespace caffe2
+
+int main(int argc, char** argv) {
+  caffe2::GlobalInit(&argc, &argv);
+  caffe2::run();
+  return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs predictor replicas on every NUMA node of the machine and reports the
+// aggregate throughput.
+//
+// With --pin (the default) each node gets its own copy of the parameters
+// (predictor_utils::createNUMAParameterShards), replica threads are bound to
+// their node and the predict net is pinned to it, so that all of a replica's
+// memory traffic stays on its socket. With --nopin the same number of
+// replicas share one copy of the parameters and run unbound, which is the
+// baseline for cross-socket traffic.
+//
+// Without --init_net/--predict_net a stack of FC layers is used as the model.
+//
+//   numa_predictor_benchmark --caffe2_cpu_numa_enabled --replicas_per_node=8
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/init.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/numa.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/predictor/predictor.h"
+#include "caffe2/predictor/predictor_utils.h"
+#include "caffe2/utils/proto_utils.h"
+#include "caffe2/utils/string_utils.h"
+
+CAFFE2_DEFINE_string(init_net, "", "The given path to the init protobuffer.");
+CAFFE2_DEFINE_string(
+    predict_net,
+    "",
+    "The given path to the predict protobuffer.");
+CAFFE2_DEFINE_string(
+    input_dims,
+    "",
+    "Comma separated dims of the first external input of the predict net. "
+    "Defaults to batch_size x hidden for the built-in model.");
+CAFFE2_DEFINE_int(batch_size, 16, "Batch size of the built-in model.");
+CAFFE2_DEFINE_int(hidden, 1024, "Width of the built-in model's FC layers.");
+CAFFE2_DEFINE_int(layers, 8, "Number of FC layers in the built-in model.");
+CAFFE2_DEFINE_int(replicas_per_node, 4, "Predictor replicas per NUMA node.");
+CAFFE2_DEFINE_int(warmup, 10, "Warm-up iterations per replica.");
+CAFFE2_DEFINE_int(iter, 200, "Timed iterations per replica.");
+CAFFE2_DEFINE_bool(
+    pin,
+    true,
+    "Pin replicas, their nets and a copy of the parameters to each node.");
+
+namespace caffe2 {
+
+namespace {
+
+void buildFCModel(NetDef* init_net, NetDef* predict_net) {
+  init_net->set_name("fc_init");
+  predict_net->set_name("fc_predict");
+  predict_net->add_external_input("data");
+  std::string input = "data";
+  for (int i = 0; i < FLAGS_layers; ++i) {
+    const std::string w = "fc" + caffe2::to_string(i) + "_w";
+    const std::string b = "fc" + caffe2::to_string(i) + "_b";
+    const std::string out = "fc" + caffe2::to_string(i);
+    *init_net->add_op() = CreateOperatorDef(
+        "XavierFill",
+        "",
+        std::vector<string>{},
+        std::vector<string>{w},
+        std::vector<Argument>{MakeArgument<std::vector<int>>(
+            "shape", {FLAGS_hidden, FLAGS_hidden})});
+    *init_net->add_op() = CreateOperatorDef(
+        "ConstantFill",
+        "",
+        std::vector<string>{},
+        std::vector<string>{b},
+        std::vector<Argument>{
+            MakeArgument<std::vector<int>>("shape", {FLAGS_hidden}),
+            MakeArgument<float>("value", 0.1f)});
+    predict_net->add_external_input(w);
+    predict_net->add_external_input(b);
+    *predict_net->add_op() = CreateOperatorDef(
+        "FC",
+        "",
+        std::vector<string>{input, w, b},
+        std::vector<string>{out});
+    *predict_net->add_op() = CreateOperatorDef(
+        "Relu", "", std::vector<string>{out}, std::vector<string>{out});
+    input = out;
+  }
+  predict_net->add_external_output(input);
+}
+
+std::vector<TIndex> inputDims() {
+  std::vector<TIndex> dims;
+  if (FLAGS_input_dims.empty()) {
+    dims = {FLAGS_batch_size, FLAGS_hidden};
+  } else {
+    for (const auto& dim : split(',', FLAGS_input_dims)) {
+      dims.push_back(std::stoll(dim));
+    }
+  }
+  return dims;
+}
+
+void run() {
+  NetDef init_net, predict_net;
+  if (FLAGS_init_net.empty() != FLAGS_predict_net.empty()) {
+    LOG(FATAL) << "Specify both --init_net and --predict_net, or neither.";
+  }
+  if (FLAGS_init_net.empty()) {
+    buildFCModel(&init_net, &predict_net);
+  } else {
+    CAFFE_ENFORCE(ReadProtoFromFile(FLAGS_init_net, &init_net));
+    CAFFE_ENFORCE(ReadProtoFromFile(FLAGS_predict_net, &predict_net));
+  }
+  if (!predict_net.has_type()) {
+    predict_net.set_type("async_scheduling");
+  }
+
+  int num_nodes = IsNUMAEnabled() ? GetNumNUMANodes() : 1;
+  if (num_nodes < 1) {
+    num_nodes = 1;
+  }
+  if (FLAGS_pin && !IsNUMAEnabled()) {
+    LOG(WARNING) << "NUMA is not enabled (--caffe2_cpu_numa_enabled), "
+                 << "replicas will not be pinned";
+  }
+  const bool pin = FLAGS_pin && IsNUMAEnabled();
+  const int num_replicas = num_nodes * FLAGS_replicas_per_node;
+
+  std::vector<std::unique_ptr<Workspace>> shards;
+  if (pin) {
+    shards = predictor_utils::createNUMAParameterShards(init_net, num_nodes);
+  } else {
+    shards.emplace_back(caffe2::make_unique<Workspace>());
+    CAFFE_ENFORCE(shards.back()->RunNetOnce(init_net));
+  }
+
+  const auto dims = inputDims();
+  std::atomic<int> ready{0};
+  std::atomic<bool> start{false};
+  std::vector<double> seconds(num_replicas);
+  std::vector<std::thread> threads;
+  for (int replica = 0; replica < num_replicas; ++replica) {
+    threads.emplace_back([&, replica]() {
+      const int node = replica % num_nodes;
+      NetDef net(predict_net);
+      net.set_name(predict_net.name() + "_" + caffe2::to_string(replica));
+      if (pin) {
+        NUMABind(node);
+        predictor_utils::setNUMANode(&net, node);
+      }
+      Workspace* parent = pin ? shards[node].get() : shards[0].get();
+      Predictor predictor(init_net, net, parent, false);
+
+      TensorCPU input(dims, CPU);
+      float* data = input.mutable_data<float>();
+      for (TIndex i = 0; i < input.size(); ++i) {
+        data[i] = static_cast<float>(i % 7) * 0.1f;
+      }
+      Predictor::TensorVector inputs{&input};
+      Predictor::TensorVector outputs;
+      for (int i = 0; i < FLAGS_warmup; ++i) {
+        CAFFE_ENFORCE(predictor.run(inputs, &outputs));
+      }
+
+      ready++;
+      while (!start) {
+        std::this_thread::yield();
+      }
+      Timer timer;
+      for (int i = 0; i < FLAGS_iter; ++i) {
+        CAFFE_ENFORCE(predictor.run(inputs, &outputs));
+      }
+      seconds[replica] = timer.Seconds();
+    });
+  }
+  while (ready < num_replicas) {
+    std::this_thread::yield();
+  }
+  start = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  double total_qps = 0;
+  for (int node = 0; node < num_nodes; ++node) {
+    double node_qps = 0;
+    for (int replica = node; replica < num_replicas; replica += num_nodes) {
+      node_qps += FLAGS_iter / seconds[replica];
+    }
+    printf(
+        "NUMA node %d: %d replicas, %.1f runs/sec\n",
+        node,
+        FLAGS_replicas_per_node,
+        node_qps);
+    total_qps += node_qps;
+  }
+  printf(
+      "%s: %d replicas on %d nodes, %.1f runs/sec total\n",
+      pin ? "pinned" : "unpinned",
+      num_replicas,
+      num_nodes,
+      total_qps);
+}
+
+} // namespace
+
+} // namespace caffe2
+
+int main(int argc, char** argv) {
+  caffe2::GlobalInit(&argc, &argv);
+  caffe2::run();
+  return 0;
+}
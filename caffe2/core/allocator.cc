@@ -1,4 +1,5 @@
 #include "caffe2/core/context.h"
+#include "caffe2/core/init.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/core/typeid.h"
@@ -13,6 +14,17 @@ CAFFE2_DEFINE_bool(
     true,
     "If set, do memory zerofilling when allocating on CPU");
 
+CAFFE2_DEFINE_bool(
+    caffe2_cpu_caching_allocator,
+    false,
+    "If set, use a caching allocator that reuses freed CPU memory blocks");
+
+CAFFE2_DEFINE_int64(
+    caffe2_cpu_caching_allocator_max_cached_bytes,
+    static_cast<int64_t>(at::CPUCachingAllocator::kDefaultMaxCachedBytes),
+    "Maximum number of bytes the CPU caching allocator keeps in its free "
+    "lists; blocks freed beyond that are returned to the system");
+
 namespace caffe2 {
 
 void NoDelete(void*) {}
@@ -26,14 +38,41 @@ void SetCPUAllocator(CPUAllocator* alloc) {
   g_cpu_allocator.reset(alloc);
 }
 
+bool Caffe2SetCPUCachingAllocator(int*, char***) {
+  if (!FLAGS_caffe2_cpu_caching_allocator) {
+    return true;
+  }
+  CAFFE_ENFORCE_GE(FLAGS_caffe2_cpu_caching_allocator_max_cached_bytes, 0);
+  at::CPUCachingAllocator::get().setMaxCachedBytes(
+      static_cast<size_t>(FLAGS_caffe2_cpu_caching_allocator_max_cached_bytes));
+  VLOG(1) << "Using the CPU caching allocator, caching up to "
+          << FLAGS_caffe2_cpu_caching_allocator_max_cached_bytes << " bytes";
+  SetCPUAllocator(new CachingCPUAllocator());
+  return true;
+}
+REGISTER_CAFFE2_INIT_FUNCTION(
+    Caffe2SetCPUCachingAllocator,
+    &Caffe2SetCPUCachingAllocator,
+    "Use the CPU caching allocator.");
+
 MemoryAllocationReporter CPUStaticContext::reporter_;
 
+// With the caching allocator, memory freed by Caffe2 is not necessarily
+// returned to the system; report how much of it is being held.
+std::string MemoryAllocationReporter::CachedBytesSuffix() {
+  if (!FLAGS_caffe2_cpu_caching_allocator) {
+    return "";
+  }
+  auto stats = at::CPUCachingAllocator::get().stats();
+  return ", cached " + caffe2::to_string(stats.cached_bytes) + " bytes";
+}
+
 void MemoryAllocationReporter::New(void* ptr, size_t nbytes) {
   std::lock_guard<std::mutex> guard(mutex_);
   size_table_[ptr] = nbytes;
   allocated_ += nbytes;
   LOG(INFO) << "Caffe2 alloc " << nbytes << " bytes, total alloc " << allocated_
-            << " bytes.";
+            << " bytes" << CachedBytesSuffix() << ".";
 }
 
 void MemoryAllocationReporter::Delete(void* ptr) {
@@ -42,7 +81,7 @@ void MemoryAllocationReporter::Delete(void* ptr) {
   CHECK(it != size_table_.end());
   allocated_ -= it->second;
   LOG(INFO) << "Caffe2 deleted " << it->second << " bytes, total alloc "
-            << allocated_ << " bytes.";
+            << allocated_ << " bytes" << CachedBytesSuffix() << ".";
   size_table_.erase(it);
 }
 
@@ -6,8 +6,12 @@
 #include "caffe2/core/logging.h"
 #include "caffe2/core/numa.h"
 
+#include "ATen/core/CPUCachingAllocator.h"
+
 CAFFE2_DECLARE_bool(caffe2_report_cpu_memory_usage);
 CAFFE2_DECLARE_bool(caffe2_cpu_allocator_do_zero_fill);
+CAFFE2_DECLARE_bool(caffe2_cpu_caching_allocator);
+CAFFE2_DECLARE_int64(caffe2_cpu_caching_allocator_max_cached_bytes);
 
 namespace caffe2 {
 
@@ -36,6 +40,8 @@ class MemoryAllocationReporter {
   void Delete(void* ptr);
 
  private:
+  static std::string CachedBytesSuffix();
+
   std::mutex mutex_;
   std::unordered_map<void*, size_t> size_table_;
   size_t allocated_;
@@ -54,8 +60,8 @@ struct DefaultCPUAllocator final : CPUAllocator {
     CAFFE_ENFORCE_EQ(posix_memalign(&data, gCaffe2Alignment, nbytes), 0);
 #endif
     CAFFE_ENFORCE(data);
-    // move data to a thread's NUMA node
-    NUMAMove(data, nbytes, GetCurrentNUMANode());
+    // move data to the NUMA node requested by the thread
+    NUMAMove(data, nbytes, GetAllocationNUMANode());
     if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
       memset(data, 0, nbytes);
     }
@@ -77,6 +83,36 @@ struct DefaultCPUAllocator final : CPUAllocator {
   }
 };
 
+// An allocator that keeps freed blocks in size-class free lists and hands
+// them out again instead of going back to the system, see
+// ATen/core/CPUCachingAllocator.h. Only fresh blocks are moved to the
+// requested NUMA node; reused blocks keep their placement. Enabled with
+// --caffe2_cpu_caching_allocator.
+struct CachingCPUAllocator final : CPUAllocator {
+  CachingCPUAllocator() {}
+  ~CachingCPUAllocator() override {}
+  std::pair<void*, MemoryDeleter> New(size_t nbytes) override {
+    bool from_cache = false;
+    void* data = at::CPUCachingAllocator::get().allocate(nbytes, &from_cache);
+    CAFFE_ENFORCE(data, "Failed to allocate ", nbytes, " bytes on CPU");
+    if (!from_cache) {
+      NUMAMove(data, nbytes, GetAllocationNUMANode());
+    }
+    if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+      memset(data, 0, nbytes);
+    }
+    return {data, Delete};
+  }
+
+  static void Delete(void* data) {
+    at::CPUCachingAllocator::free(data);
+  }
+
+  MemoryDeleter GetDeleter() override {
+    return Delete;
+  }
+};
+
 // Get the CPU Alloctor.
 CPUAllocator* GetCPUAllocator();
 // Sets the CPU allocator to the given allocator: the caller gives away the
@@ -0,0 +1,139 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/allocator.h"
+
+namespace caffe2 {
+
+using at::CPUCachingAllocator;
+
+TEST(CPUCachingAllocatorTest, Alignment) {
+  auto& allocator = CPUCachingAllocator::get();
+  for (size_t nbytes : {0, 1, 100, 4096, 5000, 1 << 20}) {
+    void* data = allocator.allocate(nbytes);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(
+        reinterpret_cast<size_t>(data) % CPUCachingAllocator::kAlignment, 0);
+    CPUCachingAllocator::free(data);
+  }
+}
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlocks) {
+  auto& allocator = CPUCachingAllocator::get();
+  allocator.emptyCache();
+  bool from_cache = true;
+  void* data = allocator.allocate(100000, &from_cache);
+  EXPECT_FALSE(from_cache);
+  CPUCachingAllocator::free(data);
+  EXPECT_GE(allocator.stats().cached_bytes, 100000);
+
+  // A slightly different size in the same size class reuses the block.
+  void* again = allocator.allocate(99000, &from_cache);
+  EXPECT_TRUE(from_cache);
+  EXPECT_EQ(again, data);
+  CPUCachingAllocator::free(again);
+
+  // Small blocks are never cached.
+  void* small = allocator.allocate(16, &from_cache);
+  EXPECT_FALSE(from_cache);
+  CPUCachingAllocator::free(small);
+  small = allocator.allocate(16, &from_cache);
+  EXPECT_FALSE(from_cache);
+  CPUCachingAllocator::free(small);
+
+  allocator.emptyCache();
+  EXPECT_EQ(allocator.stats().cached_bytes, 0);
+}
+
+TEST(CPUCachingAllocatorTest, RespectsMaxCachedBytes) {
+  auto& allocator = CPUCachingAllocator::get();
+  allocator.emptyCache();
+  size_t old_max = allocator.maxCachedBytes();
+  allocator.setMaxCachedBytes(1 << 20);
+
+  std::vector<void*> blocks;
+  for (int i = 0; i < 8; ++i) {
+    blocks.push_back(allocator.allocate(256 * 1024));
+  }
+  for (void* data : blocks) {
+    CPUCachingAllocator::free(data);
+  }
+  EXPECT_LE(allocator.stats().cached_bytes, 1 << 20);
+  EXPECT_GT(allocator.stats().cached_bytes, 0);
+
+  allocator.setMaxCachedBytes(0);
+  EXPECT_EQ(allocator.stats().cached_bytes, 0);
+  allocator.setMaxCachedBytes(old_max);
+}
+
+TEST(CPUCachingAllocatorTest, Stats) {
+  auto& allocator = CPUCachingAllocator::get();
+  allocator.emptyCache();
+  auto before = allocator.stats();
+  allocator.resetPeakStats();
+  void* a = allocator.allocate(1 << 16);
+  void* b = allocator.allocate(1 << 16);
+  auto during = allocator.stats();
+  EXPECT_EQ(during.allocated_bytes, before.allocated_bytes + (2 << 16));
+  EXPECT_EQ(during.peak_allocated_bytes, during.allocated_bytes);
+  CPUCachingAllocator::free(a);
+  CPUCachingAllocator::free(b);
+  void* c = allocator.allocate(1 << 16);
+  CPUCachingAllocator::free(c);
+  auto after = allocator.stats();
+  EXPECT_EQ(after.allocated_bytes, before.allocated_bytes);
+  EXPECT_EQ(after.peak_allocated_bytes, during.peak_allocated_bytes);
+  EXPECT_EQ(after.num_allocations, before.num_allocations + 3);
+  EXPECT_EQ(after.num_cache_hits, before.num_cache_hits + 1);
+  allocator.emptyCache();
+}
+
+TEST(CPUCachingAllocatorTest, CrossThreadFree) {
+  auto& allocator = CPUCachingAllocator::get();
+  allocator.emptyCache();
+  std::vector<void*> blocks(16);
+  std::thread producer([&]() {
+    for (auto& data : blocks) {
+      data = CPUCachingAllocator::get().allocate(1 << 15);
+    }
+  });
+  producer.join();
+  std::thread consumer([&]() {
+    for (void* data : blocks) {
+      CPUCachingAllocator::free(data);
+    }
+  });
+  // The consumer's cache is flushed to the global pool when it exits, so the
+  // blocks can be picked up by this thread.
+  consumer.join();
+  bool from_cache = false;
+  void* data = allocator.allocate(1 << 15, &from_cache);
+  EXPECT_TRUE(from_cache);
+  CPUCachingAllocator::free(data);
+  allocator.emptyCache();
+}
+
+TEST(CachingCPUAllocatorTest, NewAndDelete) {
+  CachingCPUAllocator allocator;
+  for (size_t nbytes : {1, 64, 10000, 100000}) {
+    auto data = allocator.New(nbytes);
+    ASSERT_NE(data.first, nullptr);
+    EXPECT_EQ((reinterpret_cast<size_t>(data.first) % gCaffe2Alignment), 0);
+    if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+      for (size_t i = 0; i < nbytes; ++i) {
+        ASSERT_EQ(static_cast<char*>(data.first)[i], 0);
+      }
+    }
+    memset(data.first, 1, nbytes);
+    data.second(data.first);
+  }
+  // Reused blocks are zero filled as well.
+  auto data = allocator.New(100000);
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    EXPECT_EQ(static_cast<char*>(data.first)[0], 0);
+  }
+  allocator.GetDeleter()(data.first);
+}
+
+} // namespace caffe2
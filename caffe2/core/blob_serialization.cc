@@ -6,6 +6,10 @@
 #include "caffe2/core/blob.h"
 #include "caffe2/utils/proto_utils.h"
 
+#ifdef CAFFE2_USE_ZSTD
+#include <zstd.h>
+#endif
+
 CAFFE2_DEFINE_int(
     caffe2_tensor_chunk_size,
     1000000,
@@ -21,6 +25,25 @@ CAFFE2_DEFINE_bool(
     false,
     "Serialize FLOAT16 tensors using byte_data field");
 
+CAFFE2_DEFINE_bool(
+    caffe2_serialize_using_raw_bytes,
+    false,
+    "Serialize tensors of fundamental types as the raw bytes of their values "
+    "in the byte_data field, which is much faster to write and parse than the "
+    "typed fields. Such tensors can't be read by older versions.");
+
+CAFFE2_DEFINE_int(
+    caffe2_serialize_zstd_level,
+    0,
+    "If positive, compress raw byte tensor chunks with zstd at this level "
+    "(requires caffe2_serialize_using_raw_bytes and building with USE_ZSTD)");
+
+CAFFE2_DEFINE_int(
+    caffe2_max_tensor_deserializer_threads,
+    16,
+    "Maximal number of threads that can be used to write tensor chunks when "
+    "loading blobs");
+
 namespace caffe2 {
 /**
  * @brief StringSerializer is the serializer for String.
@@ -195,6 +218,13 @@ void TensorSerializer::Serialize(
   proto.set_data_type(data_type);
   StoreDeviceDetail(input, &proto);
   auto uniq_ptr = input.GetStaticContext()->CreateContext();
+  if (FLAGS_caffe2_serialize_using_raw_bytes &&
+      data_type != TensorProto_DataType_STRING &&
+      data_type != TensorProto_DataType_UNDEFINED &&
+      data_type != TensorProto_DataType_BYTE) {
+    SerializeRawBytes(input, chunkBegin, chunkSize, &proto, uniq_ptr.get());
+    return;
+  }
   // A lot of copypaste is error prone. Should we create a macro for this?
   switch (data_type) {
     case TensorProto_DataType_FLOAT:
@@ -312,6 +342,57 @@ void TensorSerializer::Serialize(
   }
 }
 
+void TensorSerializer::SerializeRawBytes(
+    const Tensor& input,
+    size_t chunkBegin,
+    int32_t chunkSize,
+    TensorProto* proto,
+    BaseContext* context) {
+  const int kValue = 1;
+  CAFFE_ENFORCE_EQ(
+      reinterpret_cast<const char*>(&kValue)[0],
+      1,
+      "Serialization of raw bytes on big endian platform is not written yet.");
+  const size_t nbytes = chunkSize * input.itemsize();
+  const char* src = static_cast<const char*>(input.raw_data()) +
+      chunkBegin * input.itemsize();
+  if (FLAGS_caffe2_serialize_zstd_level > 0) {
+#ifdef CAFFE2_USE_ZSTD
+    unique_ptr<char[]> buffer;
+    if (input.GetDeviceType() != CPU) {
+      buffer.reset(new char[nbytes]);
+      context->CopyBytesToCPU(nbytes, src, buffer.get());
+      context->FinishDeviceComputation();
+      src = buffer.get();
+    }
+    string* compressed = proto->mutable_byte_data();
+    compressed->resize(ZSTD_compressBound(nbytes));
+    const size_t compressed_size = ZSTD_compress(
+        &(*compressed)[0],
+        compressed->size(),
+        src,
+        nbytes,
+        FLAGS_caffe2_serialize_zstd_level);
+    CAFFE_ENFORCE(
+        !ZSTD_isError(compressed_size),
+        "zstd compression failed: ",
+        ZSTD_getErrorName(compressed_size));
+    compressed->resize(compressed_size);
+    proto->set_data_encoding(TensorProto_DataEncoding_RAW_BYTES_ZSTD);
+    return;
+#else
+    CAFFE_THROW(
+        "caffe2_serialize_zstd_level is set, but Caffe2 was built without "
+        "zstd (USE_ZSTD)");
+#endif
+  }
+  string* bytes = proto->mutable_byte_data();
+  bytes->resize(nbytes);
+  context->CopyBytesToCPU(nbytes, src, &(*bytes)[0]);
+  context->FinishDeviceComputation();
+  proto->set_data_encoding(TensorProto_DataEncoding_RAW_BYTES);
+}
+
 int GetGPUIDForPointer(const void* ptr);
 
 void TensorSerializer::StoreDeviceDetail(
@@ -358,7 +439,7 @@ void Blob::Deserialize(const BlobProto& blob_proto) {
 }
 
 void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
-  auto tensor_proto = blob_proto.tensor();
+  const auto& tensor_proto = blob_proto.tensor();
   Deserialize(
       tensor_proto,
       blob->GetMutableTensor(
@@ -366,17 +447,48 @@ void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
 }
 
 void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
+  vector<TIndex> dims;
+  for (const TIndex d : proto.dims()) {
+    dims.push_back(d);
+  }
+  tensor->Resize(dims);
+  DeserializeChunk(proto, tensor);
+}
+
+void TensorDeserializer::PrepareTensor(
+    const TensorProto& proto,
+    Tensor* tensor) {
+  CAFFE_ENFORCE(
+      proto.data_type() != TensorProto_DataType_UNDEFINED,
+      "Cannot prepare a tensor of a custom type");
+  vector<TIndex> dims;
+  for (const TIndex d : proto.dims()) {
+    dims.push_back(d);
+  }
+  tensor->Resize(dims);
+  // BYTE is restored as uint8.
+  tensor->raw_mutable_data(
+      proto.data_type() == TensorProto_DataType_BYTE
+          ? TypeMeta::Make<uint8_t>()
+          : DataTypeToTypeMeta(proto.data_type()));
+}
+
+bool TensorDeserializer::CanDeserializeConcurrently(const TensorProto& proto) {
+  // Custom types are deserialized element by element through blobs, which
+  // sets the tensor's type from the first element.
+  return proto.data_type() != TensorProto_DataType_UNDEFINED &&
+      proto.device_detail().device_type() == CPU;
+}
+
+void TensorDeserializer::DeserializeChunk(
+    const TensorProto& proto,
+    Tensor* tensor) {
   // We create a local context for deserializing. Since Caffe2 contexts are
   // usually lightweight, this should not involve too much overhead.
   auto uniq_ptr =
       tensor->GetStaticContext()->CreateContext(proto.device_detail());
   auto context = uniq_ptr.get();
   context->SwitchToDevice(0);
-  vector<TIndex> dims;
-  for (const TIndex d : proto.dims()) {
-    dims.push_back(d);
-  }
-  tensor->Resize(dims);
 
   int64_t chunkBegin = 0;
   auto chunkEnd = tensor->size();
@@ -394,6 +506,48 @@ void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
       tensor->size());
   auto chunkSize = chunkEnd - chunkBegin;
 
+  if (proto.data_encoding() != TensorProto_DataEncoding_DEFAULT) {
+    const TypeMeta& meta = DataTypeToTypeMeta(proto.data_type());
+    const size_t nbytes = chunkSize * meta.itemsize();
+    char* dst = static_cast<char*>(tensor->raw_mutable_data(meta)) +
+        chunkBegin * meta.itemsize();
+    if (proto.data_encoding() == TensorProto_DataEncoding_RAW_BYTES) {
+      CAFFE_ENFORCE_EQ(
+          nbytes, proto.byte_data().size(), "Incorrect proto field size.");
+      context->CopyBytesFromCPU(nbytes, proto.byte_data().data(), dst);
+    } else {
+      CAFFE_ENFORCE_EQ(
+          proto.data_encoding(),
+          TensorProto_DataEncoding_RAW_BYTES_ZSTD,
+          "Unknown data encoding");
+#ifdef CAFFE2_USE_ZSTD
+      // Decompress straight into CPU tensors.
+      unique_ptr<char[]> buffer;
+      char* out = dst;
+      if (tensor->GetDeviceType() != CPU) {
+        buffer.reset(new char[nbytes]);
+        out = buffer.get();
+      }
+      const size_t size = ZSTD_decompress(
+          out, nbytes, proto.byte_data().data(), proto.byte_data().size());
+      CAFFE_ENFORCE(
+          !ZSTD_isError(size),
+          "zstd decompression failed: ",
+          ZSTD_getErrorName(size));
+      CAFFE_ENFORCE_EQ(size, nbytes, "Incorrect decompressed size.");
+      if (buffer) {
+        context->CopyBytesFromCPU(nbytes, buffer.get(), dst);
+      }
+#else
+      CAFFE_THROW(
+          "Cannot deserialize a zstd compressed tensor: Caffe2 was built "
+          "without zstd (USE_ZSTD)");
+#endif
+    }
+    context->FinishDeviceComputation();
+    return;
+  }
+
   switch (proto.data_type()) {
     case TensorProto_DataType_FLOAT:
       detail::CopyFromProtoAsIs(
@@ -523,6 +677,90 @@ void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
   context->FinishDeviceComputation();
 }
 
+ParallelTensorDeserializer::ParallelTensorDeserializer(int num_threads)
+#ifdef __ANDROID__
+    : num_threads_(0) {}
+#else
+    : num_threads_(num_threads) {}
+#endif
+
+ParallelTensorDeserializer::~ParallelTensorDeserializer() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ParallelTensorDeserializer::Add(
+    std::unique_ptr<BlobProto> proto,
+    Tensor* tensor) {
+  if (num_threads_ <= 1) {
+    TensorDeserializer().DeserializeChunk(proto->tensor(), tensor);
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Threads are only started once there is something to write.
+    if (threads_.empty()) {
+      for (int i = 0; i < num_threads_; ++i) {
+        threads_.emplace_back([this]() { WorkerMain(); });
+      }
+    }
+    work_done_.wait(lock, [this]() { return pending_ < 2 * num_threads_; });
+    chunks_.emplace_back(std::move(proto), tensor);
+    ++pending_;
+  }
+  work_available_.notify_one();
+}
+
+void ParallelTensorDeserializer::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return pending_ == 0; });
+  if (!error_.empty()) {
+    string error;
+    std::swap(error, error_);
+    CAFFE_THROW(error);
+  }
+}
+
+void ParallelTensorDeserializer::WorkerMain() {
+  TensorDeserializer deserializer;
+  while (true) {
+    std::unique_ptr<BlobProto> proto;
+    Tensor* tensor;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(
+          lock, [this]() { return stop_ || !chunks_.empty(); });
+      if (chunks_.empty()) {
+        return;
+      }
+      proto = std::move(chunks_.front().first);
+      tensor = chunks_.front().second;
+      chunks_.pop_front();
+    }
+    string error;
+    try {
+      deserializer.DeserializeChunk(proto->tensor(), tensor);
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    proto.reset();
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (!error.empty() && error_.empty()) {
+        error_ = error;
+      }
+      --pending_;
+    }
+    work_done_.notify_all();
+  }
+}
+
 namespace {
 // Serialize Tensor
 REGISTER_BLOB_SERIALIZER((TypeMeta::Id<Tensor>()), TensorSerializer);
@@ -1,8 +1,12 @@
 #ifndef CAFFE2_CORE_BLOB_SERIALIZATION_H_
 #define CAFFE2_CORE_BLOB_SERIALIZATION_H_
 
+#include <condition_variable>
+#include <deque>
 #include <limits>
 #include <future>
+#include <mutex>
+#include <thread>
 
 #include <google/protobuf/repeated_field.h>
 
@@ -16,6 +20,9 @@
 CAFFE2_DECLARE_int(caffe2_tensor_chunk_size);
 CAFFE2_DECLARE_int(caffe2_max_tensor_serializer_threads);
 CAFFE2_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+CAFFE2_DECLARE_bool(caffe2_serialize_using_raw_bytes);
+CAFFE2_DECLARE_int(caffe2_serialize_zstd_level);
+CAFFE2_DECLARE_int(caffe2_max_tensor_deserializer_threads);
 
 namespace caffe2 {
 
@@ -70,6 +77,14 @@ class TensorSerializer : public BlobSerializerBase {
  private:
   // A utility function to store the device context detauls.
   void StoreDeviceDetail(const Tensor& input, TensorProto* proto);
+  // Stores the chunk as RAW_BYTES, or RAW_BYTES_ZSTD if
+  // caffe2_serialize_zstd_level is positive.
+  void SerializeRawBytes(
+      const Tensor& input,
+      size_t chunkBegin,
+      int32_t chunkSize,
+      TensorProto* proto,
+      BaseContext* context);
   unique_ptr<BaseContext> context_;
 };
 
@@ -105,6 +120,59 @@ class TensorDeserializer : public BlobDeserializerBase {
  public:
   void Deserialize(const BlobProto& proto, Blob* blob) override;
   void Deserialize(const TensorProto& proto, Tensor* tensor);
+
+  /**
+   * Resizes tensor to the dims of proto and allocates it for the proto's data
+   * type. Memory the tensor already has for the same size and type is kept.
+   */
+  static void PrepareTensor(const TensorProto& proto, Tensor* tensor);
+  /**
+   * Copies the values of proto (a whole tensor or a segment of it) into
+   * tensor, which must have been prepared with PrepareTensor. Different
+   * segments of a tensor can be written concurrently if
+   * CanDeserializeConcurrently(proto).
+   */
+  void DeserializeChunk(const TensorProto& proto, Tensor* tensor);
+  /**
+   * True for CPU tensors of any builtin data type, whatever their
+   * data_encoding. Tensors of custom types have to be deserialized whole.
+   */
+  static bool CanDeserializeConcurrently(const TensorProto& proto);
+};
+
+/**
+ * @brief ParallelTensorDeserializer writes tensor chunks on a pool of threads.
+ *
+ * Each chunk is decoded straight into its tensor, which must already be
+ * prepared with TensorDeserializer::PrepareTensor. This covers every
+ * data_encoding, including the legacy typed fields, so only reading and
+ * parsing the protos happens on the calling thread. At most twice
+ * as many chunks as threads are pending at a time, so Add blocks when the
+ * chunks are read faster than they are written, which bounds the memory held
+ * by parsed chunks. With at most one thread, Add writes the chunk itself.
+ */
+class ParallelTensorDeserializer {
+ public:
+  explicit ParallelTensorDeserializer(int num_threads);
+  ~ParallelTensorDeserializer();
+
+  // Writes proto->tensor() into tensor.
+  void Add(std::unique_ptr<BlobProto> proto, Tensor* tensor);
+  // Waits until all added chunks are written, and throws if any failed.
+  void Wait();
+
+ private:
+  void WorkerMain();
+
+  const int num_threads_;
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  std::deque<std::pair<std::unique_ptr<BlobProto>, Tensor*>> chunks_;
+  int pending_ = 0;
+  bool stop_ = false;
+  string error_;
+  std::vector<std::thread> threads_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1042,6 +1042,140 @@ TEST(CustomChunkSize, BigTensorSerialization) {
   EXPECT_EQ(counter, 1);
 }
 
+std::unique_ptr<OperatorBase> CreateLoadOp(
+    const string& db_source,
+    const string& blob_name,
+    Workspace* ws,
+    bool load_in_place = false) {
+  DeviceOption option;
+  option.set_device_type(CPU);
+  auto op_def = CreateOperatorDef(
+      "Load",
+      "",
+      std::vector<string>{},
+      std::vector<string>({blob_name}),
+      std::vector<Argument>{MakeArgument<string>("db_type", "vector_db"),
+                            MakeArgument<string>("db", db_source),
+                            MakeArgument<bool>("absolute_path", true),
+                            MakeArgument<int>("load_in_place", load_in_place)},
+      option);
+  return CreateOperator(op_def, ws);
+}
+
+void SerializeToVectorDB(
+    const Blob& blob,
+    const string& blob_name,
+    const string& db_source,
+    int chunk_size) {
+  StringMap data;
+  std::mutex mutex;
+  auto acceptor = [&](const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> guard(mutex);
+    data.emplace_back(key, value);
+  };
+  blob.Serialize(blob_name, acceptor, chunk_size);
+  VectorDB::registerData(db_source, std::move(data));
+}
+
+TYPED_TEST(TypedTensorTest, RawBytesSerialization) {
+  const bool using_raw_bytes = FLAGS_caffe2_serialize_using_raw_bytes;
+  const int deserializer_threads = FLAGS_caffe2_max_tensor_deserializer_threads;
+  FLAGS_caffe2_serialize_using_raw_bytes = true;
+  FLAGS_caffe2_max_tensor_deserializer_threads = 4;
+  const int64_t size = 10007;
+  string db_source = (string)std::tmpnam(nullptr);
+  {
+    Blob blob;
+    TensorCPU* tensor = blob.GetMutableTensor(CPU);
+    tensor->Resize(7, size / 7 + 1);
+    auto* data = tensor->template mutable_data<TypeParam>();
+    for (int64_t i = 0; i < tensor->size(); ++i) {
+      data[i] = static_cast<TypeParam>(i);
+    }
+    BlobProto proto;
+    CHECK(proto.ParseFromString(blob.Serialize("test")));
+    EXPECT_EQ(
+        proto.tensor().data_encoding(), TensorProto_DataEncoding_RAW_BYTES);
+    EXPECT_EQ(proto.tensor().byte_data().size(), tensor->nbytes());
+    // Many small chunks, which are written into the tensor concurrently.
+    SerializeToVectorDB(blob, "test", db_source, 100);
+  }
+  {
+    Workspace ws;
+    auto load_op = CreateLoadOp(db_source, "test", &ws);
+    EXPECT_TRUE(load_op->Run());
+    const auto& new_tensor = ws.GetBlob("test")->Get<TensorCPU>();
+    EXPECT_EQ(new_tensor.ndim(), 2);
+    EXPECT_EQ(new_tensor.dim(0), 7);
+    EXPECT_EQ(new_tensor.dim(1), size / 7 + 1);
+    const auto* data = new_tensor.template data<TypeParam>();
+    for (int64_t i = 0; i < new_tensor.size(); ++i) {
+      EXPECT_EQ(static_cast<TypeParam>(i), data[i]);
+    }
+  }
+  FLAGS_caffe2_serialize_using_raw_bytes = using_raw_bytes;
+  FLAGS_caffe2_max_tensor_deserializer_threads = deserializer_threads;
+}
+
+TEST(TensorTest, LoadInPlace) {
+  string db_source = (string)std::tmpnam(nullptr);
+  Blob blob;
+  TensorCPU* source = blob.GetMutableTensor(CPU);
+  source->Resize(10, 1000);
+  for (int i = 0; i < source->size(); ++i) {
+    source->mutable_data<float>()[i] = i;
+  }
+  SerializeToVectorDB(blob, "test", db_source, 1000);
+  Workspace ws;
+  TensorCPU* tensor = ws.CreateBlob("test")->GetMutableTensor(CPU);
+  tensor->Resize(10, 1000);
+  const float* preallocated = tensor->mutable_data<float>();
+  auto load_op = CreateLoadOp(db_source, "test", &ws, true);
+  EXPECT_TRUE(load_op->Run());
+  const auto& new_tensor = ws.GetBlob("test")->Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.data<float>(), preallocated);
+  for (int i = 0; i < new_tensor.size(); ++i) {
+    EXPECT_EQ(new_tensor.data<float>()[i], i);
+  }
+
+  // A tensor of another shape is replaced.
+  tensor->Resize(5, 1000);
+  tensor->mutable_data<float>();
+  SerializeToVectorDB(blob, "test", db_source, 1000);
+  EXPECT_TRUE(load_op->Run());
+  EXPECT_EQ(ws.GetBlob("test")->Get<TensorCPU>().dim(0), 10);
+}
+
+#ifdef CAFFE2_USE_ZSTD
+TEST(TensorTest, ZstdSerialization) {
+  const bool using_raw_bytes = FLAGS_caffe2_serialize_using_raw_bytes;
+  const int zstd_level = FLAGS_caffe2_serialize_zstd_level;
+  FLAGS_caffe2_serialize_using_raw_bytes = true;
+  FLAGS_caffe2_serialize_zstd_level = 3;
+  Blob blob;
+  TensorCPU* tensor = blob.GetMutableTensor(CPU);
+  tensor->Resize(100000);
+  for (int i = 0; i < tensor->size(); ++i) {
+    tensor->mutable_data<int>()[i] = i % 100;
+  }
+  string serialized = blob.Serialize("test");
+  BlobProto proto;
+  CHECK(proto.ParseFromString(serialized));
+  EXPECT_EQ(
+      proto.tensor().data_encoding(), TensorProto_DataEncoding_RAW_BYTES_ZSTD);
+  EXPECT_LT(proto.tensor().byte_data().size(), tensor->nbytes());
+  Blob new_blob;
+  new_blob.Deserialize(serialized);
+  const auto& new_tensor = new_blob.Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.size(), 100000);
+  for (int i = 0; i < new_tensor.size(); ++i) {
+    EXPECT_EQ(new_tensor.data<int>()[i], i % 100);
+  }
+  FLAGS_caffe2_serialize_using_raw_bytes = using_raw_bytes;
+  FLAGS_caffe2_serialize_zstd_level = zstd_level;
+}
+#endif // CAFFE2_USE_ZSTD
+
 TEST(QTensor, QTensorSizingTest) {
   vector<int> dims(3);
   dims[0] = 2;
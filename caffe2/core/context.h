@@ -46,7 +46,8 @@ class CPUContext final : public BaseContext {
   explicit CPUContext(const DeviceOption& option)
       : random_seed_(
             option.has_random_seed() ? option.random_seed()
-                                     : RandomNumberSeed()) {
+                                     : RandomNumberSeed()),
+        numa_node_id_(option.numa_node_id()) {
     CAFFE_ENFORCE_EQ(option.device_type(), CPU);
   }
 
@@ -60,7 +61,11 @@ class CPUContext final : public BaseContext {
     return GetCPUStaticContext();
   }
 
-  inline void SwitchToDevice(int /*stream_id*/) override {}
+  inline void SwitchToDevice(int /*stream_id*/) override {
+    // Blobs created by the operator are placed on its NUMA node. Operator
+    // restores the previous node with an AllocationNUMANodeGuard.
+    SetAllocationNUMANode(numa_node_id_);
+  }
 
   using BaseContext::SwitchToDevice;
 
@@ -164,6 +169,7 @@ class CPUContext final : public BaseContext {
   // TODO(jiayq): instead of hard-coding a generator, make it more flexible.
   int random_seed_{1701};
   std::unique_ptr<rand_gen_type> random_generator_;
+  int numa_node_id_{-1};
 };
 
 template <>
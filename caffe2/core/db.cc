@@ -4,6 +4,7 @@
 
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/parallel_db_reader.h"
 
 namespace caffe2 {
 
@@ -77,6 +78,11 @@ class MiniDBCursor : public Cursor {
     return string(value_.data(), value_len_);
   }
 
+  ValueView valueView() override {
+    CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+    return ValueView{value_.data(), static_cast<size_t>(value_len_)};
+  }
+
   bool Valid() override { return valid_; }
 
  private:
@@ -169,6 +175,37 @@ class MiniDB : public DB {
 REGISTER_CAFFE2_DB(MiniDB, MiniDB);
 REGISTER_CAFFE2_DB(minidb, MiniDB);
 
+void DBReader::ResetParallelReader(int num_readers, int readahead) {
+  CAFFE_ENFORCE(db_ != nullptr, "Reader not initialized.");
+  num_readers_ = num_readers;
+  readahead_ = readahead;
+  parallel_reader_.reset();
+  // Dbs like minidb allow one cursor at a time.
+  cursor_.reset();
+  if (num_readers == 1 || db_->SupportsConcurrentCursors()) {
+    parallel_reader_ = std::make_shared<ParallelDBReader>(
+        db_.get(),
+        num_readers,
+        readahead,
+        ParallelDBReader::STRIDE,
+        num_shards_,
+        shard_id_);
+  } else {
+    parallel_reader_ = std::make_shared<ParallelDBReader>(
+        db_type_,
+        source_,
+        num_readers,
+        readahead,
+        ParallelDBReader::STRIDE,
+        num_shards_,
+        shard_id_);
+  }
+}
+
+void DBReader::ReadParallel(string* key, string* value) const {
+  parallel_reader_->Read(key, value);
+}
+
 void DBReaderSerializer::Serialize(
     const Blob& blob,
     const string& name,
@@ -16,6 +16,18 @@ namespace db {
  */
 enum Mode { READ, WRITE, NEW };
 
+/**
+ * A view of a value held by a cursor, without copying it.
+ */
+struct ValueView {
+  const char* data;
+  size_t size;
+
+  string ToString() const {
+    return string(data, size);
+  }
+};
+
 /**
  * An abstract class for the cursor of the database while reading.
  */
@@ -46,12 +58,25 @@ class Cursor {
    * Returns the current value.
    */
   virtual string value() = 0;
+  /**
+   * Returns a view of the current value, valid until the cursor moves. Dbs
+   * that hold the value in memory (e.g. in LMDB's memory map) return it
+   * without a copy; by default the value is copied into a buffer of the
+   * cursor.
+   */
+  virtual ValueView valueView() {
+    value_buffer_ = value();
+    return ValueView{value_buffer_.data(), value_buffer_.size()};
+  }
   /**
    * Returns whether the current location is valid - for example, if we have
    * reached the end of the database, return false.
    */
   virtual bool Valid() = 0;
 
+ private:
+  string value_buffer_;
+
   DISABLE_COPY_AND_ASSIGN(Cursor);
 };
 
@@ -95,6 +120,14 @@ class DB {
    * ownership of the pointer.
    */
   virtual std::unique_ptr<Transaction> NewTransaction() = 0;
+  /**
+   * Returns whether cursors returned by NewCursor() can be used at the same
+   * time, from different threads. If not, concurrent readers open the db
+   * several times instead.
+   */
+  virtual bool SupportsConcurrentCursors() const {
+    return false;
+  }
 
  protected:
   Mode mode_;
@@ -138,6 +171,8 @@ inline bool DBExists(const string& db_type, const string& full_db_name) {
   }
 }
 
+class ParallelDBReader;
+
 /**
  * A reader wrapper for DB that also allows us to serialize it.
  */
@@ -182,6 +217,7 @@ class DBReader {
       const int32_t shard_id = 0) {
     // Note(jiayq): resetting is needed when we re-open e.g. leveldb where no
     // concurrent access is allowed.
+    parallel_reader_.reset();
     cursor_.reset();
     db_.reset();
     db_type_ = db_type;
@@ -195,6 +231,7 @@ class DBReader {
       unique_ptr<DB>&& db,
       const int32_t num_shards = 1,
       const int32_t shard_id = 0) {
+    parallel_reader_.reset();
     cursor_.reset();
     db_.reset();
     db_ = std::move(db);
@@ -220,8 +257,15 @@ class DBReader {
    * output blob.
    */
   void Read(string* key, string* value) const {
-    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    if (parallel_reader_) {
+      // The lock keeps SeekToFirst from replacing the parallel reader while
+      // it is used. Its readers keep reading ahead in the background, so
+      // this only serializes taking the records.
+      ReadParallel(key, value);
+      return;
+    }
+    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     *key = cursor_->key();
     *value = cursor_->value();
 
@@ -239,11 +283,31 @@ class DBReader {
    * @brief Seeks to the first key. Thread safe.
    */
   void SeekToFirst() const {
-    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    if (parallel_reader_) {
+      // The readers are restarted from the beginning of the shard.
+      const_cast<DBReader*>(this)->ResetParallelReader(
+          num_readers_, readahead_);
+      return;
+    }
+    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     MoveToBeginning();
   }
 
+  /**
+   * Reads the shard of the db with num_readers cursors in background threads
+   * from now on, each keeping up to readahead records ready (see
+   * ParallelDBReader), starting again from the beginning of the shard.
+   * Thread safe.
+   *
+   * The records are returned in the same order as without readahead, but
+   * the underlying cursor is released: cursor() returns nullptr.
+   */
+  void StartReadahead(int num_readers, int readahead) {
+    std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    ResetParallelReader(num_readers, readahead);
+  }
+
   /**
    * Returns the underlying cursor of the db reader.
    *
@@ -277,6 +341,10 @@ class DBReader {
     }
   }
 
+  // Replaces the parallel reader. reader_mutex_ must be held.
+  void ResetParallelReader(int num_readers, int readahead);
+  void ReadParallel(string* key, string* value) const;
+
   string db_type_;
   string source_;
   unique_ptr<DB> db_;
@@ -284,6 +352,11 @@ class DBReader {
   mutable std::mutex reader_mutex_;
   uint32_t num_shards_;
   uint32_t shard_id_;
+  // Set by StartReadahead. A shared_ptr because ParallelDBReader is
+  // incomplete here.
+  std::shared_ptr<ParallelDBReader> parallel_reader_;
+  int num_readers_ = 0;
+  int readahead_ = 0;
 
   DISABLE_COPY_AND_ASSIGN(DBReader);
 };
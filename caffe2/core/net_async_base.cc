@@ -424,6 +424,12 @@ GetAsyncNetCPUThreadPool(int numa_node_id, int pool_size, bool create_new) {
       pool_size = FLAGS_caffe2_net_async_cpu_pool_size;
       LOG(INFO) << "Using default CPU pool size: " << pool_size
                 << "; NUMA node id: " << numa_node_id;
+    } else if (numa_node_id >= 0 && GetNumNUMANodeCPUs(numa_node_id) > 0) {
+      // Pool threads are bound to the node, so there is no point in having
+      // more of them than the node has cores.
+      pool_size = GetNumNUMANodeCPUs(numa_node_id);
+      LOG(INFO) << "Using NUMA node CPU pool size: " << pool_size
+                << "; NUMA node id: " << numa_node_id;
     } else {
       auto num_cores = std::thread::hardware_concurrency();
       CAFFE_ENFORCE(num_cores > 0, "Failed to get number of CPU cores");
@@ -13,6 +13,28 @@ CAFFE2_DEFINE_bool(
 
 namespace caffe2 {
 
+namespace {
+thread_local int gAllocationNUMANode = -1;
+} // namespace
+
+void SetAllocationNUMANode(int numa_node_id) {
+  gAllocationNUMANode = numa_node_id;
+}
+
+int GetAllocationNUMANode() {
+  if (gAllocationNUMANode >= 0) {
+    return gAllocationNUMANode;
+  }
+  return GetCurrentNUMANode();
+}
+
+AllocationNUMANodeGuard::AllocationNUMANodeGuard()
+    : prev_numa_node_id_(gAllocationNUMANode) {}
+
+AllocationNUMANodeGuard::~AllocationNUMANodeGuard() {
+  gAllocationNUMANode = prev_numa_node_id_;
+}
+
 #ifdef CAFFE2_NUMA_ENABLED
 bool IsNUMAEnabled() {
   return FLAGS_caffe2_cpu_numa_enabled && numa_available() >= 0;
@@ -97,6 +119,24 @@ int GetCurrentNUMANode() {
   return numa_node_of_cpu(sched_getcpu());
 }
 
+int GetNumNUMANodeCPUs(int numa_node_id) {
+  if (!IsNUMAEnabled()) {
+    VLOG(1) << "NUMA is not enabled";
+    return -1;
+  }
+  CAFFE_ENFORCE(
+      numa_node_id >= 0 && numa_node_id <= numa_max_node(),
+      "NUMA node id " + caffe2::to_string(numa_node_id) + " is unavailable");
+
+  auto bm = numa_allocate_cpumask();
+  CAFFE_ENFORCE(
+      numa_node_to_cpus(numa_node_id, bm) == 0,
+      "Unable to get CPUs of NUMA node " + caffe2::to_string(numa_node_id));
+  int num_cpus = numa_bitmask_weight(bm);
+  numa_bitmask_free(bm);
+  return num_cpus;
+}
+
 #else // CAFFE2_NUMA_ENABLED
 
 bool IsNUMAEnabled() {
@@ -130,6 +170,11 @@ int GetCurrentNUMANode() {
   return -1;
 }
 
+int GetNumNUMANodeCPUs(int numa_node_id) {
+  VLOG(1) << "NUMA is not enabled";
+  return -1;
+}
+
 #endif // CAFFE2_NUMA_ENABLED
 
 } // namespace caffe2
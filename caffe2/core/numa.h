@@ -19,6 +19,32 @@ void NUMAMove(void* ptr, size_t size, int numa_node_id);
 
 int GetCurrentNUMANode();
 
+// Number of CPUs on the given NUMA node, or -1 if NUMA is not enabled.
+int GetNumNUMANodeCPUs(int numa_node_id);
+
+// The NUMA node that CPU memory allocated by the calling thread is moved to.
+// CPUContext::SwitchToDevice sets it from the operator's
+// DeviceOption::numa_node_id, so that blobs end up on the node requested by
+// the op that creates them, whichever thread happens to run it. When unset
+// (-1), allocations go to the node the thread is currently running on.
+void SetAllocationNUMANode(int numa_node_id);
+int GetAllocationNUMANode();
+
+// Restores the calling thread's allocation node when it goes out of scope,
+// so that the node an operator sets in SwitchToDevice does not leak into
+// later allocations on the same thread.
+class AllocationNUMANodeGuard {
+ public:
+  AllocationNUMANodeGuard();
+  ~AllocationNUMANodeGuard();
+
+ private:
+  AllocationNUMANodeGuard(const AllocationNUMANodeGuard&) = delete;
+  AllocationNUMANodeGuard& operator=(const AllocationNUMANodeGuard&) = delete;
+
+  int prev_numa_node_id_;
+};
+
 } // namespace caffe2
 
 #endif // CAFFE2_CORE_NUMA_H_
@@ -12,6 +12,7 @@
 #include "caffe2/core/blob.h"
 #include "caffe2/core/common.h"
 #include "caffe2/core/net.h"
+#include "caffe2/core/numa.h"
 #include "caffe2/core/observer.h"
 #include "caffe2/core/operator_gradient.h"
 #include "caffe2/core/operator_schema.h"
@@ -427,7 +428,9 @@ class Operator : public OperatorBase {
   explicit Operator(const OperatorDef& operator_def, Workspace* ws)
       : OperatorBase(operator_def, ws), context_(operator_def.device_option()) {
     // In the constructor, we switch to the device so that the child class
-    // constructors will run on that device.
+    // constructors will run on that device. The NUMA allocation node is not
+    // kept past this constructor, though.
+    AllocationNUMANodeGuard numa_guard;
     context_.SwitchToDevice(0);
   }
   ~Operator() noexcept override {}
@@ -443,6 +446,7 @@ class Operator : public OperatorBase {
   }
 
   void WaitEvent(const Event& ev, int stream_id = -1) final {
+    AllocationNUMANodeGuard numa_guard;
     if (stream_id >= 0) {
       context_.SwitchToDevice(stream_id);
     }
@@ -451,6 +455,7 @@ class Operator : public OperatorBase {
 
   void WaitEvents(const std::vector<const Event*>& events, int stream_id = -1)
       final {
+    AllocationNUMANodeGuard numa_guard;
     if (stream_id >= 0) {
       context_.SwitchToDevice(stream_id);
     }
@@ -465,6 +470,8 @@ class Operator : public OperatorBase {
   // Note: Run does not update operator's event and can be used only with
   // non-async executors that do not rely on events
   bool Run(int stream_id = 0) final {
+    // SwitchToDevice may set the NUMA node for allocations of this thread
+    AllocationNUMANodeGuard numa_guard;
     try {
       StartAllObservers();
 
@@ -495,6 +502,7 @@ class Operator : public OperatorBase {
   }
 
   bool RunAsync(int stream_id = 0) final {
+    AllocationNUMANodeGuard numa_guard;
     try {
       StartAllObservers();
 
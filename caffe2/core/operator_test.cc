@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include "caffe2/core/net.h"
+#include "caffe2/core/numa.h"
 #include "caffe2/core/operator.h"
 #include <gtest/gtest.h>
 
@@ -69,6 +70,18 @@ REGISTER_CPU_OPERATOR_WITH_ENGINE(JustTest, BAZ, JustTestAndDoesConstruct);
 REGISTER_CUDA_OPERATOR(JustTest, JustTest);
 REGISTER_CPU_OPERATOR(JustTestWithSomeOutput, JustTestWithSomeOutput);
 
+class RecordAllocationNUMANode final : public Operator<CPUContext> {
+ public:
+  using Operator<CPUContext>::Operator;
+  bool RunOnDevice() override {
+    *OperatorBase::Output<int>(0) = GetAllocationNUMANode();
+    return true;
+  }
+};
+
+OPERATOR_SCHEMA(RecordAllocationNUMANode).NumInputs(0).NumOutputs(1);
+REGISTER_CPU_OPERATOR(RecordAllocationNUMANode, RecordAllocationNUMANode);
+
 TEST(OperatorTest, DeviceTypeRegistryWorks) {
   EXPECT_EQ(gDeviceTypeRegistry()->count(DeviceType::CPU), 1);
 }
@@ -274,6 +287,20 @@ TEST(OperatorTest, TestOutputValues) {
   EXPECT_EQ(ws.GetBlob("output")->Get<int>(), 5);
 }
 
+TEST(OperatorTest, AllocationNUMANodeIsRestored) {
+  OperatorDef op_def;
+  Workspace ws;
+  op_def.set_type("RecordAllocationNUMANode");
+  op_def.add_output("node");
+  op_def.mutable_device_option()->set_numa_node_id(3);
+  const int node = GetAllocationNUMANode();
+  unique_ptr<OperatorBase> op(CreateOperator(op_def, &ws));
+  EXPECT_EQ(GetAllocationNUMANode(), node);
+  EXPECT_TRUE(op->Run());
+  EXPECT_EQ(ws.GetBlob("node")->Get<int>(), 3);
+  EXPECT_EQ(GetAllocationNUMANode(), node);
+}
+
 NetDef GetNetDefForTest() {
   NetDef net_def;
   OperatorDef op_def;
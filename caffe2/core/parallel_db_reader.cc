@@ -0,0 +1,262 @@
+#include "caffe2/core/parallel_db_reader.h"
+
+#include "caffe2/core/logging.h"
+
+namespace caffe2 {
+namespace db {
+
+StrideCursor::StrideCursor(
+    std::unique_ptr<Cursor> cursor,
+    int stride,
+    int offset)
+    : cursor_(std::move(cursor)), stride_(stride), offset_(offset) {
+  CAFFE_ENFORCE(cursor_.get(), "Passed null cursor");
+  CAFFE_ENFORCE_GE(stride_, 1);
+  CAFFE_ENFORCE_GE(offset_, 0);
+  CAFFE_ENFORCE_LT(offset_, stride_);
+  SeekToFirst();
+}
+
+void StrideCursor::Seek(const string& /*key*/) {
+  CAFFE_THROW("StrideCursor does not support seeking to a specific key.");
+}
+
+void StrideCursor::SeekToFirst() {
+  cursor_->SeekToFirst();
+  for (int i = 0; i < offset_ && cursor_->Valid(); ++i) {
+    cursor_->Next();
+  }
+}
+
+void StrideCursor::Next() {
+  for (int i = 0; i < stride_ && cursor_->Valid(); ++i) {
+    cursor_->Next();
+  }
+}
+
+KeyRangeCursor::KeyRangeCursor(
+    std::unique_ptr<Cursor> cursor,
+    const string& begin,
+    const string& end)
+    : cursor_(std::move(cursor)), begin_(begin), end_(end), valid_(false) {
+  CAFFE_ENFORCE(cursor_.get(), "Passed null cursor");
+  CAFFE_ENFORCE(
+      cursor_->SupportsSeek(), "Key ranges need a cursor that can seek.");
+  SeekToFirst();
+}
+
+void KeyRangeCursor::Seek(const string& key) {
+  cursor_->Seek(key < begin_ ? begin_ : key);
+  UpdateValid();
+}
+
+void KeyRangeCursor::SeekToFirst() {
+  if (begin_.empty()) {
+    cursor_->SeekToFirst();
+  } else {
+    cursor_->Seek(begin_);
+  }
+  UpdateValid();
+}
+
+void KeyRangeCursor::Next() {
+  cursor_->Next();
+  UpdateValid();
+}
+
+void KeyRangeCursor::UpdateValid() {
+  valid_ = cursor_->Valid() && (end_.empty() || cursor_->key() < end_);
+}
+
+std::vector<string> SplitKeyRanges(Cursor* cursor, int num_ranges) {
+  CAFFE_ENFORCE_GE(num_ranges, 1);
+  std::vector<string> keys;
+  for (cursor->SeekToFirst(); cursor->Valid(); cursor->Next()) {
+    keys.push_back(cursor->key());
+  }
+  CAFFE_ENFORCE_GE(
+      keys.size(),
+      static_cast<size_t>(num_ranges),
+      "Db has fewer records than key ranges: ",
+      keys.size());
+  std::vector<string> bounds(num_ranges + 1);
+  for (int i = 1; i < num_ranges; ++i) {
+    bounds[i] = keys[keys.size() * i / num_ranges];
+  }
+  return bounds;
+}
+
+ParallelDBReader::ParallelDBReader(
+    const string& db_type,
+    const string& source,
+    int num_readers,
+    int readahead,
+    Sharding sharding,
+    int num_shards,
+    int shard_id) {
+  auto open_db = [db_type, source]() {
+    auto db = CreateDB(db_type, source, READ);
+    CAFFE_ENFORCE(db, "Cannot open db: ", source, " of type ", db_type);
+    return db;
+  };
+  Open(
+      open_db, nullptr, num_readers, readahead, sharding, num_shards, shard_id);
+}
+
+ParallelDBReader::ParallelDBReader(
+    DB* db,
+    int num_readers,
+    int readahead,
+    Sharding sharding,
+    int num_shards,
+    int shard_id) {
+  CAFFE_ENFORCE(db, "Passed null db");
+  CAFFE_ENFORCE(
+      num_readers == 1 || db->SupportsConcurrentCursors(),
+      "The db does not support concurrent cursors, pass its type and source "
+      "to read it with several readers.");
+  Open(nullptr, db, num_readers, readahead, sharding, num_shards, shard_id);
+}
+
+ParallelDBReader::~ParallelDBReader() {
+  stopping_ = true;
+  for (auto& reader : readers_) {
+    {
+      // Taking the lock makes sure the reader is either waiting or sees
+      // stopping_ before it waits.
+      std::lock_guard<std::mutex> guard(reader->mutex);
+    }
+    reader->not_full.notify_all();
+  }
+  for (auto& reader : readers_) {
+    if (reader->thread.joinable()) {
+      reader->thread.join();
+    }
+  }
+}
+
+void ParallelDBReader::Open(
+    const std::function<std::unique_ptr<DB>()>& open_db,
+    DB* db,
+    int num_readers,
+    int readahead,
+    Sharding sharding,
+    int num_shards,
+    int shard_id) {
+  CAFFE_ENFORCE_GE(num_readers, 1);
+  CAFFE_ENFORCE_GE(readahead, 1);
+  CAFFE_ENFORCE_GE(num_shards, 1);
+  CAFFE_ENFORCE_GE(shard_id, 0);
+  CAFFE_ENFORCE_LT(shard_id, num_shards);
+
+  for (int r = 0; r < num_readers; ++r) {
+    readers_.emplace_back(new Reader());
+    auto& reader = *readers_.back();
+    if (!db || (r > 0 && !db->SupportsConcurrentCursors())) {
+      reader.db = open_db();
+      if (!db) {
+        db = reader.db.get();
+      }
+    }
+    reader.records.resize(readahead);
+  }
+
+  std::vector<string> bounds;
+  if (sharding == KEY_RANGE) {
+    // The cursor is released before the readers open theirs, for dbs that
+    // allow one cursor at a time.
+    bounds = SplitKeyRanges(db->NewCursor().get(), num_shards * num_readers);
+  }
+  for (int r = 0; r < num_readers; ++r) {
+    auto& reader = *readers_[r];
+    auto cursor = (reader.db ? reader.db.get() : db)->NewCursor();
+    if (sharding == KEY_RANGE) {
+      // Every reader loops over its own key range of our shard.
+      const int range = shard_id * num_readers + r;
+      reader.cursor.reset(new KeyRangeCursor(
+          std::move(cursor), bounds[range], bounds[range + 1]));
+      reader.step = 1;
+    } else {
+      // Reader r reads records r, r + num_readers, ... of the shard as it
+      // cycles over it, so that taking records from the readers in turn
+      // returns them in the same order as DBReader.
+      reader.cursor.reset(
+          new StrideCursor(std::move(cursor), num_shards, shard_id));
+      reader.step = num_readers;
+    }
+    CAFFE_ENFORCE(
+        reader.cursor->Valid(), "Db has no records in shard ", shard_id);
+    if (sharding == STRIDE) {
+      Advance(reader.cursor.get(), r);
+    }
+  }
+
+  for (auto& reader : readers_) {
+    reader->thread =
+        std::thread(&ParallelDBReader::ReadAhead, this, reader.get());
+  }
+}
+
+void ParallelDBReader::Advance(Cursor* cursor, int steps) {
+  for (int i = 0; i < steps; ++i) {
+    cursor->Next();
+    if (!cursor->Valid()) {
+      cursor->SeekToFirst();
+    }
+  }
+}
+
+void ParallelDBReader::ReadAhead(Reader* reader) {
+  try {
+    while (true) {
+      Record* record;
+      {
+        std::unique_lock<std::mutex> lock(reader->mutex);
+        reader->not_full.wait(lock, [&] {
+          return stopping_ || reader->size < reader->records.size();
+        });
+        if (stopping_) {
+          return;
+        }
+        // Read() only touches ready records, so the next one can be filled
+        // without holding the lock.
+        record = &reader->records
+                      [(reader->head + reader->size) % reader->records.size()];
+      }
+      record->key = reader->cursor->key();
+      const auto value = reader->cursor->valueView();
+      record->value.assign(value.data, value.size);
+      Advance(reader->cursor.get(), reader->step);
+      {
+        std::lock_guard<std::mutex> guard(reader->mutex);
+        ++reader->size;
+      }
+      reader->not_empty.notify_one();
+    }
+  } catch (...) {
+    {
+      std::lock_guard<std::mutex> guard(reader->mutex);
+      reader->error = std::current_exception();
+    }
+    reader->not_empty.notify_all();
+  }
+}
+
+void ParallelDBReader::Read(string* key, string* value) {
+  auto& reader = *readers_[next_reader_++ % readers_.size()];
+  std::unique_lock<std::mutex> lock(reader.mutex);
+  reader.not_empty.wait(lock, [&] { return reader.size > 0 || reader.error; });
+  if (reader.size == 0) {
+    std::rethrow_exception(reader.error);
+  }
+  auto& record = reader.records[reader.head];
+  std::swap(*key, record.key);
+  std::swap(*value, record.value);
+  reader.head = (reader.head + 1) % reader.records.size();
+  --reader.size;
+  lock.unlock();
+  reader.not_full.notify_one();
+}
+
+}  // namespace db
+}  // namespace caffe2
@@ -0,0 +1,202 @@
+#ifndef CAFFE2_CORE_PARALLEL_DB_READER_H_
+#define CAFFE2_CORE_PARALLEL_DB_READER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/db.h"
+
+namespace caffe2 {
+namespace db {
+
+/**
+ * A cursor over every stride-th record of another cursor, starting with the
+ * record at offset. Cursors with the same stride and offsets 0 to stride - 1
+ * split a db into disjoint shards, like DBReader's num_shards and shard_id.
+ */
+class StrideCursor : public Cursor {
+ public:
+  StrideCursor(std::unique_ptr<Cursor> cursor, int stride, int offset);
+
+  void Seek(const string& key) override;
+  void SeekToFirst() override;
+  void Next() override;
+  string key() override {
+    return cursor_->key();
+  }
+  string value() override {
+    return cursor_->value();
+  }
+  ValueView valueView() override {
+    return cursor_->valueView();
+  }
+  bool Valid() override {
+    return cursor_->Valid();
+  }
+
+ private:
+  std::unique_ptr<Cursor> cursor_;
+  const int stride_;
+  const int offset_;
+};
+
+/**
+ * A cursor over the records of another, seekable cursor with keys in
+ * [begin, end). An empty begin (end) leaves the range unbounded below
+ * (above).
+ */
+class KeyRangeCursor : public Cursor {
+ public:
+  KeyRangeCursor(
+      std::unique_ptr<Cursor> cursor,
+      const string& begin,
+      const string& end);
+
+  void Seek(const string& key) override;
+  bool SupportsSeek() override {
+    return true;
+  }
+  void SeekToFirst() override;
+  void Next() override;
+  string key() override {
+    return cursor_->key();
+  }
+  string value() override {
+    return cursor_->value();
+  }
+  ValueView valueView() override {
+    return cursor_->valueView();
+  }
+  bool Valid() override {
+    return valid_;
+  }
+
+ private:
+  void UpdateValid();
+
+  std::unique_ptr<Cursor> cursor_;
+  const string begin_;
+  const string end_;
+  bool valid_;
+};
+
+/**
+ * Returns num_ranges + 1 keys that split the records of a db into num_ranges
+ * key ranges with about the same number of records: range i is [keys[i],
+ * keys[i + 1]), with empty first and last keys for unbounded ranges. Scans
+ * the keys of the whole db once.
+ */
+std::vector<string> SplitKeyRanges(Cursor* cursor, int num_ranges);
+
+/**
+ * Reads a db with several cursors at once. Every cursor reads its own shard
+ * of the records in a background thread, keeping up to `readahead` records
+ * ready, so that parsing the records (and waiting for disk) overlaps with
+ * their consumption.
+ *
+ * With STRIDE sharding, reader i of n reads records i, i + n, ... as it
+ * cycles over the records, and Read() takes records from the readers in
+ * turn, returning them in the same order as DBReader. Every reader still
+ * steps over all records, which is cheap for dbs that don't copy skipped
+ * values (e.g. LMDB). With KEY_RANGE sharding, which needs a db that can
+ * seek, every reader cycles over its own range of keys.
+ *
+ * Dbs whose cursors can be used concurrently (see
+ * DB::SupportsConcurrentCursors) are opened once; others are opened once per
+ * reader.
+ */
+class ParallelDBReader {
+ public:
+  enum Sharding { STRIDE, KEY_RANGE };
+
+  /**
+   * Reads shard shard_id out of num_shards of a db with num_readers cursors.
+   * Shards are strided as in DBReader, or key ranges with KEY_RANGE sharding.
+   */
+  ParallelDBReader(
+      const string& db_type,
+      const string& source,
+      int num_readers,
+      int readahead,
+      Sharding sharding = STRIDE,
+      int num_shards = 1,
+      int shard_id = 0);
+
+  /**
+   * Reads a db that is already open, which needs to support concurrent
+   * cursors if num_readers > 1. The db must outlive the reader.
+   */
+  ParallelDBReader(
+      DB* db,
+      int num_readers,
+      int readahead,
+      Sharding sharding = STRIDE,
+      int num_shards = 1,
+      int shard_id = 0);
+
+  ~ParallelDBReader();
+
+  /**
+   * Reads the next record. Thread safe. The strings of key and value are
+   * swapped with those of the buffered record, so passing the same strings
+   * again avoids allocating memory.
+   *
+   * Rethrows the exception if a reader failed.
+   */
+  void Read(string* key, string* value);
+
+  int num_readers() const {
+    return readers_.size();
+  }
+
+ private:
+  struct Record {
+    string key;
+    string value;
+  };
+
+  struct Reader {
+    std::unique_ptr<DB> db;
+    std::unique_ptr<Cursor> cursor;
+    // The number of records the cursor moves forward after every record.
+    int step = 1;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    // A ring buffer of records, of which `size` starting at `head` are ready.
+    std::vector<Record> records;
+    size_t head = 0;
+    size_t size = 0;
+    std::exception_ptr error;
+  };
+
+  void Open(
+      const std::function<std::unique_ptr<DB>()>& open_db,
+      DB* db,
+      int num_readers,
+      int readahead,
+      Sharding sharding,
+      int num_shards,
+      int shard_id);
+  // Moves a cursor forward, going back to the first record at the end.
+  static void Advance(Cursor* cursor, int steps);
+  void ReadAhead(Reader* reader);
+
+  std::vector<std::unique_ptr<Reader>> readers_;
+  std::atomic<uint64_t> next_reader_{0};
+  std::atomic<bool> stopping_{false};
+
+  DISABLE_COPY_AND_ASSIGN(ParallelDBReader);
+};
+
+}  // namespace db
+}  // namespace caffe2
+
+#endif  // CAFFE2_CORE_PARALLEL_DB_READER_H_
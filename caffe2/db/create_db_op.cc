@@ -3,7 +3,21 @@
 namespace caffe2 {
 REGISTER_CPU_OPERATOR(CreateDB, CreateDBOp<CPUContext>);
 
-OPERATOR_SCHEMA(CreateDB).NumInputs(0).NumOutputs(1);
+OPERATOR_SCHEMA(CreateDB)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .Arg("db_type", "Type of the db, e.g. lmdb, leveldb or minidb.")
+    .Arg("db", "Path of the db.")
+    .Arg("num_shards", "Number of shards the records are split into.")
+    .Arg("shard_id", "The shard this reader reads.")
+    .Arg(
+        "num_readers",
+        "If positive, read the shard with this many cursors in background "
+        "threads.")
+    .Arg(
+        "readahead",
+        "Number of records every background reader keeps ready (default "
+        "64).");
 
 NO_GRADIENT(CreateDB);
 }  // namespace caffe2
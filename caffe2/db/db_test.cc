@@ -1,11 +1,13 @@
 #include <cstdio>
 #include <iomanip>
+#include <map>
 #include <sstream>
 #include <thread>
 
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/db.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/parallel_db_reader.h"
 #include "caffe2/proto/caffe2.pb.h"
 #include <gtest/gtest.h>
 
@@ -196,5 +198,225 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+// A sorted in-memory db whose cursors can seek and be used concurrently.
+class MapCursor : public Cursor {
+ public:
+  explicit MapCursor(const std::map<string, string>* data)
+      : data_(data), iter_(data->begin()) {}
+  void Seek(const string& key) override {
+    iter_ = data_->lower_bound(key);
+  }
+  bool SupportsSeek() override {
+    return true;
+  }
+  void SeekToFirst() override {
+    iter_ = data_->begin();
+  }
+  void Next() override {
+    ++iter_;
+  }
+  string key() override {
+    return iter_->first;
+  }
+  string value() override {
+    return iter_->second;
+  }
+  ValueView valueView() override {
+    return ValueView{iter_->second.data(), iter_->second.size()};
+  }
+  bool Valid() override {
+    return iter_ != data_->end();
+  }
+
+ private:
+  const std::map<string, string>* data_;
+  std::map<string, string>::const_iterator iter_;
+};
+
+class MapDB : public DB {
+ public:
+  MapDB() : DB("<map>", READ) {
+    for (int i = 0; i < kMaxItems; ++i) {
+      std::stringstream ss;
+      ss << std::setw(2) << std::setfill('0') << i;
+      data_[ss.str()] = ss.str();
+    }
+  }
+  void Close() override {}
+  std::unique_ptr<Cursor> NewCursor() override {
+    return make_unique<MapCursor>(&data_);
+  }
+  std::unique_ptr<Transaction> NewTransaction() override {
+    CAFFE_THROW("Not implemented.");
+  }
+  bool SupportsConcurrentCursors() const override {
+    return true;
+  }
+
+ private:
+  std::map<string, string> data_;
+};
+
+static string Key(int i) {
+  std::stringstream ss;
+  ss << std::setw(2) << std::setfill('0') << i;
+  return ss.str();
+}
+
+TEST(DBValueViewTest, MiniDB) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  std::unique_ptr<DB> db(CreateDB("minidb", name, READ));
+  std::unique_ptr<Cursor> cursor(db->NewCursor());
+  for (int i = 0; i < kMaxItems; ++i, cursor->Next()) {
+    EXPECT_EQ(cursor->valueView().ToString(), cursor->value());
+  }
+  EXPECT_FALSE(cursor->Valid());
+}
+
+TEST(ParallelDBReaderTest, ReadsInOrder) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  // Every reader opens the minidb, which allows one cursor at a time.
+  ParallelDBReader reader("minidb", name, 3, 2);
+  EXPECT_EQ(reader.num_readers(), 3);
+  string key;
+  string value;
+  for (int i = 0; i < 2 * kMaxItems + 5; ++i) {
+    reader.Read(&key, &value);
+    EXPECT_EQ(key, Key(i % kMaxItems));
+    EXPECT_EQ(value, Key(i % kMaxItems));
+  }
+}
+
+TEST(ParallelDBReaderTest, Sharded) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  // Same as DBReader("minidb", name, 3, 1), which reads 01, 04 and 07.
+  ParallelDBReader reader(
+      "minidb", name, 2, 1, ParallelDBReader::STRIDE, 3, 1);
+  string key;
+  string value;
+  for (int i = 0; i < 7; ++i) {
+    reader.Read(&key, &value);
+    EXPECT_EQ(key, Key(1 + 3 * (i % 3)));
+  }
+}
+
+TEST(ParallelDBReaderTest, KeyRanges) {
+  MapDB db;
+  Cursor* cursor = db.NewCursor().release();
+  EXPECT_EQ(
+      SplitKeyRanges(cursor, 4),
+      std::vector<string>({"", "02", "05", "07", ""}));
+  delete cursor;
+
+  // The second of two shards, [05, 07) and [07, ) for the two readers.
+  ParallelDBReader reader(&db, 2, 2, ParallelDBReader::KEY_RANGE, 2, 1);
+  std::vector<string> first;
+  std::vector<string> second;
+  string key;
+  string value;
+  for (int i = 0; i < 6; ++i) {
+    reader.Read(&key, &value);
+    first.push_back(key);
+    reader.Read(&key, &value);
+    second.push_back(key);
+  }
+  EXPECT_EQ(first, std::vector<string>({"05", "06", "05", "06", "05", "06"}));
+  EXPECT_EQ(second, std::vector<string>({"07", "08", "09", "07", "08", "09"}));
+}
+
+TEST(ParallelDBReaderTest, ConcurrentConsumers) {
+  const int kConsumers = 4;
+  const int kReads = 5 * kMaxItems;
+  MapDB db;
+  ParallelDBReader reader(&db, 4, 3);
+  std::vector<std::vector<string>> keys(kConsumers);
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kConsumers; ++c) {
+    consumers.emplace_back([&, c] {
+      string key;
+      string value;
+      for (int i = 0; i < kReads; ++i) {
+        reader.Read(&key, &value);
+        EXPECT_EQ(key, value);
+        keys[c].push_back(key);
+      }
+    });
+  }
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+  // Every record is read once per pass over the db.
+  std::map<string, int> counts;
+  for (const auto& consumed : keys) {
+    for (const auto& key : consumed) {
+      ++counts[key];
+    }
+  }
+  EXPECT_EQ(counts.size(), kMaxItems);
+  for (const auto& count : counts) {
+    EXPECT_EQ(count.second, kConsumers * kReads / kMaxItems);
+  }
+}
+
+TEST(ParallelDBReaderTest, NeedsConcurrentCursors) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  std::unique_ptr<DB> db(CreateDB("minidb", name, READ));
+  EXPECT_THROW(ParallelDBReader(db.get(), 2, 1), EnforceNotMet);
+}
+
+TEST(DBReaderTest, Readahead) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  DBReader reader("minidb", name, 2, 0);
+  string key;
+  string value;
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "00");
+  reader.StartReadahead(3, 4);
+  EXPECT_TRUE(reader.cursor() == nullptr);
+  // Readahead starts again from the beginning of the shard.
+  for (int i = 0; i < 7; ++i) {
+    reader.Read(&key, &value);
+    EXPECT_EQ(key, Key(2 * (i % 5)));
+    EXPECT_EQ(value, key);
+  }
+  reader.SeekToFirst();
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "00");
+}
+
+TEST(DBReaderTest, SeekToFirstWhileReading) {
+  const int kConsumers = 4;
+  DBReader reader(make_unique<MapDB>());
+  reader.StartReadahead(2, 2);
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kConsumers; ++c) {
+    consumers.emplace_back([&] {
+      string key;
+      string value;
+      for (int i = 0; i < 5 * kMaxItems; ++i) {
+        reader.Read(&key, &value);
+        EXPECT_EQ(key, value);
+      }
+    });
+  }
+  // Restarts the readers while the consumers use them.
+  for (int i = 0; i < 10; ++i) {
+    reader.SeekToFirst();
+  }
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+  reader.SeekToFirst();
+  string key;
+  string value;
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "00");
+}
+
 }  // namespace db
 }  // namespace caffe2
@@ -23,6 +23,10 @@ class LevelDBCursor : public Cursor {
   void Next() override { iter_->Next(); }
   string key() override { return iter_->key().ToString(); }
   string value() override { return iter_->value().ToString(); }
+  ValueView valueView() override {
+    leveldb::Slice value = iter_->value();
+    return ValueView{value.data(), value.size()};
+  }
   bool Valid() override { return iter_->Valid(); }
 
  private:
@@ -79,6 +83,11 @@ class LevelDB : public DB {
   unique_ptr<Transaction> NewTransaction() override {
     return make_unique<LevelDBTransaction>(db_.get());
   }
+  // LevelDB iterators can be used concurrently, while the db itself can only
+  // be opened once.
+  bool SupportsConcurrentCursors() const override {
+    return true;
+  }
 
  private:
   std::unique_ptr<leveldb::DB> db_;
@@ -68,6 +68,12 @@ class LMDBCursor : public Cursor {
         mdb_value_.mv_size);
   }
 
+  // Points into the memory map, which stays valid for the read transaction.
+  ValueView valueView() override {
+    return ValueView{static_cast<const char*>(mdb_value_.mv_data),
+        mdb_value_.mv_size};
+  }
+
   bool Valid() override { return valid_; }
 
  private:
@@ -133,6 +139,11 @@ class LMDB : public DB {
   unique_ptr<Transaction> NewTransaction() override {
     return make_unique<LMDBTransaction>(mdb_env_);
   }
+  // Every cursor has its own read transaction, which MDB_NOTLS lets us use
+  // from any thread.
+  bool SupportsConcurrentCursors() const override {
+    return mode_ == READ;
+  }
 
  private:
   MDB_env* mdb_env_;
@@ -159,7 +159,13 @@ print("Y:", workspace.FetchBlob("Y"))
         "source_blob_names",
         "*(type: List(string))* If set, used instead of output blob names to "
         "specify which blobs in the db shall be loaded. Must be the same "
-        "length as number of output blobs.");
+        "length as number of output blobs.")
+    .Arg(
+        "load_in_place",
+        "*(type: int; default: 0)* If nonzero, CPU tensors that already exist "
+        "with the shape and type of the saved tensor are filled in place "
+        "instead of being reallocated, e.g. to load into preallocated or "
+        "shared memory.");
 
 OPERATOR_SCHEMA(Save)
     .NumInputs(1, INT_MAX)
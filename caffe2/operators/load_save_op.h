@@ -85,6 +85,8 @@ class LoadOp final : public Operator<Context> {
         load_all_(OperatorBase::GetSingleArgument<int>("load_all", 0)),
         allow_incomplete_(
             OperatorBase::GetSingleArgument<bool>("allow_incomplete", false)),
+        load_in_place_(
+            OperatorBase::GetSingleArgument<int>("load_in_place", 0)),
         blob_names_(
             OperatorBase::GetRepeatedArgument<string>("source_blob_names")) {
     if (InputSize() == 0) {
@@ -135,6 +137,11 @@ class LoadOp final : public Operator<Context> {
   bool RunOnDevice() override {
     int total_loaded_blobs = 0;
     std::unordered_map<string, BlobState> blob_states;
+    // Tensor chunks are written in the background while the next entries are
+    // read and parsed.
+    ParallelTensorDeserializer deserializer(
+        FLAGS_caffe2_max_tensor_deserializer_threads);
+    deserializer_ = &deserializer;
     if (InputSize() > 0) {
       for (int i = 0; i < InputSize(); ++i) {
         const db::DBReader& reader = OperatorBase::Input<db::DBReader>(i);
@@ -152,6 +159,8 @@ class LoadOp final : public Operator<Context> {
         extract(i, cursor.get(), &blob_states, &total_loaded_blobs);
       }
     }
+    deserializer.Wait();
+    deserializer_ = nullptr;
 
     validateBlobStates(blob_states);
     // Loaded all the needed blobs.
@@ -214,16 +223,16 @@ class LoadOp final : public Operator<Context> {
         key_to_dbid_[key] = db_id;
       }
 
-      BlobProto proto;
+      auto proto = caffe2::make_unique<BlobProto>();
       CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
+          proto->ParseFromString(cursor->value()), "Couldn't parse Proto");
       if (!keep_device_) {
         // If we are not keeping the device as the one specified in the
         // proto, we will set the current device.
-        SetCurrentDevice(&proto);
+        SetCurrentDevice(proto.get());
       }
       Blob* blob = ws_->CreateBlob(key);
-      ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+      ProcessBlob(blob, std::move(proto), blob_states, key, &loaded_blobs);
     }
     *total_loaded_blobs += loaded_blobs;
   }
@@ -248,16 +257,16 @@ class LoadOp final : public Operator<Context> {
         }
 
         VLOG(2) << "Deserializing blob " << key;
-        BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
+        auto proto = caffe2::make_unique<BlobProto>();
+        CAFFE_ENFORCE(proto->ParseFromString(cursor->value()));
         if (!keep_device_) {
           // If we are not keeping the device as the one specified in the
           // proto, we will set the current device.
-          SetCurrentDevice(&proto);
+          SetCurrentDevice(proto.get());
         }
         auto blobIndex = output_indices_[key];
         Blob* blob = outputs.at(blobIndex);
-        ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+        ProcessBlob(blob, std::move(proto), blob_states, key, &loaded_blobs);
 
         if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
           break;
@@ -285,12 +294,14 @@ class LoadOp final : public Operator<Context> {
   // chunks. This way we can make sure that all chunks were loaded in the end.
   void ProcessBlob(
       Blob* blob,
-      const BlobProto& proto,
+      std::unique_ptr<BlobProto> proto_ptr,
       std::unordered_map<string, BlobState>* blob_states_ptr,
       const string& key,
       int* loaded_blobs) {
     auto& blob_states = *blob_states_ptr;
-    if (blob_states.count(key) == 0) {
+    const BlobProto& proto = *proto_ptr;
+    const bool first_chunk = blob_states.count(key) == 0;
+    if (first_chunk && !CanLoadInPlace(*blob, proto)) {
       // We reset the blob so that any existing content is destroyed. This
       // is to guaranee correct device placement: if we are deserializing
       // into a TensorCUDA, without explicit Reset we might be loading data
@@ -298,7 +309,42 @@ class LoadOp final : public Operator<Context> {
       // different GPU.
       blob->Reset();
     }
-    blob->Deserialize(proto);
+    UpdateBlobState(proto, blob_states_ptr, key, loaded_blobs);
+    if (proto.has_tensor() &&
+        TensorDeserializer::CanDeserializeConcurrently(proto.tensor())) {
+      // The tensor is allocated with its first chunk, and the chunks are then
+      // written into it in the background.
+      Tensor* tensor = blob->GetMutableTensor(CPU);
+      if (first_chunk) {
+        TensorDeserializer::PrepareTensor(proto.tensor(), tensor);
+      }
+      deserializer_->Add(std::move(proto_ptr), tensor);
+    } else {
+      blob->Deserialize(proto);
+    }
+  }
+
+  bool CanLoadInPlace(const Blob& blob, const BlobProto& proto) {
+    if (!load_in_place_ || !proto.has_tensor() ||
+        !TensorDeserializer::CanDeserializeConcurrently(proto.tensor()) ||
+        !blob.IsType<Tensor>(CPU)) {
+      return false;
+    }
+    const auto& tensor = blob.Get<TensorCPU>();
+    const auto& tensor_proto = proto.tensor();
+    return tensor.meta() == DataTypeToTypeMeta(tensor_proto.data_type()) &&
+        tensor.dims() ==
+        vector<TIndex>(tensor_proto.dims().begin(), tensor_proto.dims().end());
+  }
+
+  // Checks the chunks of the blob seen so far, and counts it as loaded once
+  // all of them are.
+  void UpdateBlobState(
+      const BlobProto& proto,
+      std::unordered_map<string, BlobState>* blob_states_ptr,
+      const string& key,
+      int* loaded_blobs) {
+    auto& blob_states = *blob_states_ptr;
     if (proto.has_content_num_chunks()) {
       if (!blob_states.count(key)) {
         blob_states[key] = BlobState(proto.content_num_chunks());
@@ -399,6 +445,8 @@ class LoadOp final : public Operator<Context> {
   bool keep_device_;
   bool load_all_;
   bool allow_incomplete_;
+  bool load_in_place_;
+  ParallelTensorDeserializer* deserializer_ = nullptr;
   std::map<string, int> output_indices_;
   std::map<string, int> key_to_dbid_;
   std::vector<std::string> blob_names_;
@@ -0,0 +1,21 @@
+#include "caffe2/operators/quantized/int8_add_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Add, int8::Int8AddOp);
+
+OPERATOR_SCHEMA(Int8Add)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}, {1, 0}})
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+Quantized version of Add for inputs of the same shape (broadcasting is not
+supported). The sum is requantized to Y_scale and Y_zero_point.
+)DOC")
+    .Input(0, "A", "First operand")
+    .Input(1, "B", "Second operand, of the same shape as A")
+    .Output(0, "C", "Result, of the same shape as A");
+
+} // namespace caffe2
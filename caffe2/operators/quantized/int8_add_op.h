@@ -0,0 +1,58 @@
+#ifndef CAFFE2_OPERATORS_INT8_ADD_OP_H_
+#define CAFFE2_OPERATORS_INT8_ADD_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Elementwise sum of two uint8 tensors of the same shape, requantized to
+// Y_scale and Y_zero_point.
+class Int8AddOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  Int8AddOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int32_t>("Y_zero_point", 0)) {}
+
+  bool RunOnDevice() override {
+    const auto& A = Inputs()[0]->Get<Int8TensorCPU>();
+    const auto& B = Inputs()[1]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(
+        A.t.dims(), B.t.dims(), "Int8Add does not support broadcasting");
+    // The parameters are read before Y is written, which may alias A or B.
+    const float A_multiplier = A.scale / Y_scale_;
+    const float B_multiplier = B.scale / Y_scale_;
+    const int32_t A_zero_point = A.zero_point;
+    const int32_t B_zero_point = B.zero_point;
+    Y->t.ResizeLike(A.t);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+    const uint8_t* A_data = A.t.data<uint8_t>();
+    const uint8_t* B_data = B.t.data<uint8_t>();
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    for (TIndex i = 0; i < A.t.size(); ++i) {
+      const float sum = A_multiplier * (A_data[i] - A_zero_point) +
+          B_multiplier * (B_data[i] - B_zero_point);
+      Y_data[i] = static_cast<uint8_t>(std::max<float>(
+          kQuantizedMin,
+          std::min<float>(kQuantizedMax, Y_zero_point_ + std::nearbyint(sum))));
+    }
+    return true;
+  }
+
+ private:
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_ADD_OP_H_
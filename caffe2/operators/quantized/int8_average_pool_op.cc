@@ -0,0 +1,19 @@
+#include "caffe2/operators/quantized/int8_average_pool_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8AveragePool, int8::Int8AveragePoolOp);
+
+OPERATOR_SCHEMA(Int8AveragePool)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale (default: input's)")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+Quantized version of AveragePool for 2D NHWC inputs. Unless Y_scale is given,
+the output has the quantization parameters of the input.
+)DOC")
+    .Input(0, "X", "Input data tensor (NHWC)")
+    .Output(0, "Y", "Output data tensor (NHWC)");
+
+} // namespace caffe2
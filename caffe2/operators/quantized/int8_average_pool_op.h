@@ -0,0 +1,89 @@
+#ifndef CAFFE2_OPERATORS_INT8_AVERAGE_POOL_OP_H_
+#define CAFFE2_OPERATORS_INT8_AVERAGE_POOL_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Like AveragePool, padding is not included in the count of each window.
+class Int8AveragePoolOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8AveragePoolOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        has_Y_scale_(OperatorBase::HasArgument("Y_scale")),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int32_t>("Y_zero_point", 0)) {
+    OPERATOR_NEEDS_FEATURE(
+        this->order_ == StorageOrder::NHWC,
+        "Int8AveragePool only supports NHWC order");
+    CAFFE_ENFORCE_EQ(
+        kernel_.size(), 2, "Int8AveragePool only supports 2D pooling");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+    const int N = X.t.dim32(0);
+    const int H = X.t.dim32(1);
+    const int W = X.t.dim32(2);
+    const int C = X.t.dim32(3);
+    ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), C);
+    Y->scale = has_Y_scale_ ? Y_scale_ : X.scale;
+    Y->zero_point = has_Y_scale_ ? Y_zero_point_ : X.zero_point;
+    const int Y_H = Y->t.dim32(1);
+    const int Y_W = Y->t.dim32(2);
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    const float X_multiplier = X.scale / Y->scale;
+
+    acc_.resize(C);
+    for (int n = 0; n < N; ++n) {
+      for (int ph = 0; ph < Y_H; ++ph) {
+        int hstart = ph * stride_h() - pad_t();
+        const int hend = std::min(hstart + kernel_h(), H);
+        hstart = std::max(hstart, 0);
+        for (int pw = 0; pw < Y_W; ++pw) {
+          int wstart = pw * stride_w() - pad_l();
+          const int wend = std::min(wstart + kernel_w(), W);
+          wstart = std::max(wstart, 0);
+          const int count = (hend - hstart) * (wend - wstart);
+          std::fill(acc_.begin(), acc_.end(), 0);
+          for (int h = hstart; h < hend; ++h) {
+            for (int w = wstart; w < wend; ++w) {
+              const uint8_t* x = X_data + ((n * H + h) * W + w) * C;
+              for (int c = 0; c < C; ++c) {
+                acc_[c] += x[c];
+              }
+            }
+          }
+          uint8_t* y = Y_data + ((n * Y_H + ph) * Y_W + pw) * C;
+          const float multiplier = count > 0 ? X_multiplier / count : 0.f;
+          for (int c = 0; c < C; ++c) {
+            y[c] = Requantize(
+                acc_[c] - count * X.zero_point, multiplier, Y->zero_point);
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+ private:
+  bool has_Y_scale_;
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  vector<int32_t> acc_;
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_AVERAGE_POOL_OP_H_
@@ -0,0 +1,23 @@
+#include "caffe2/operators/quantized/int8_concat_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Concat, int8::Int8ConcatOp);
+
+OPERATOR_SCHEMA(Int8Concat)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1, 2)
+    .Arg("Y_scale", "Output tensor quantization scale (default: first input's)")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .Arg("axis", "Which axis to concat on")
+    .Arg(
+        "order",
+        "Either NHWC or NCHW, will concat on C axis, defaults to NHWC")
+    .SetDoc(R"DOC(
+Quantized version of Concat. Inputs with quantization parameters different
+from the output's are requantized.
+)DOC")
+    .Output(0, "concat_result", "Concatenated tensor")
+    .Output(1, "split_info", "The dimensions of the inputs.");
+
+} // namespace caffe2
@@ -0,0 +1,111 @@
+#ifndef CAFFE2_OPERATORS_INT8_CONCAT_OP_H_
+#define CAFFE2_OPERATORS_INT8_CONCAT_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/concat_split_op.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Concatenates uint8 tensors along `axis`. Inputs whose quantization
+// parameters differ from the output's (Y_scale and Y_zero_point, or the first
+// input's by default) are requantized; the others are copied.
+class Int8ConcatOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  Int8ConcatOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        has_Y_scale_(OperatorBase::HasArgument("Y_scale")),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int32_t>("Y_zero_point", 0)) {
+    CAFFE_ENFORCE(
+        !(OperatorBase::HasArgument("axis") &&
+          OperatorBase::HasArgument("order")),
+        "You shouldn't specify both the dim to concat, and the order "
+        "in the case of 4-D images.");
+    if (OperatorBase::HasArgument("axis")) {
+      axis_ = OperatorBase::GetSingleArgument<int>("axis", -1);
+    } else {
+      axis_ = GetDimFromOrderString(
+          OperatorBase::GetSingleArgument<string>("order", "NHWC"));
+    }
+  }
+
+  bool RunOnDevice() override {
+    const auto& X0 = Inputs()[0]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    const int canonical_axis = X0.t.canonical_axis_index(axis_);
+    const float Y_scale = has_Y_scale_ ? Y_scale_ : X0.scale;
+    const int32_t Y_zero_point = has_Y_scale_ ? Y_zero_point_ : X0.zero_point;
+
+    auto Y_dims = X0.t.dims();
+    Y_dims[canonical_axis] = 0;
+    for (int i = 0; i < InputSize(); ++i) {
+      const auto& X = Inputs()[i]->Get<Int8TensorCPU>();
+      CAFFE_ENFORCE_EQ(X.t.ndim(), X0.t.ndim());
+      for (int d = 0; d < X.t.ndim(); ++d) {
+        if (d != canonical_axis) {
+          CAFFE_ENFORCE_EQ(
+              X.t.dim(d), X0.t.dim(d), "Int8Concat: dimension mismatch");
+        }
+      }
+      Y_dims[canonical_axis] += X.t.dim(canonical_axis);
+      CAFFE_ENFORCE(
+          Inputs()[i] != OutputBlob(0), "Int8Concat does not run in place");
+    }
+    Y->t.Resize(Y_dims);
+    Y->scale = Y_scale;
+    Y->zero_point = Y_zero_point;
+
+    int* split_data = nullptr;
+    if (OutputSize() > 1) {
+      auto* split = Output(1);
+      split->Resize(vector<TIndex>(1, InputSize()));
+      split_data = split->template mutable_data<int>();
+    }
+
+    const TIndex outer = X0.t.size_to_dim(canonical_axis);
+    const TIndex Y_inner = Y->t.size_from_dim(canonical_axis);
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    TIndex offset = 0;
+    for (int i = 0; i < InputSize(); ++i) {
+      const auto& X = Inputs()[i]->Get<Int8TensorCPU>();
+      const TIndex inner = X.t.size_from_dim(canonical_axis);
+      const uint8_t* X_data = X.t.data<uint8_t>();
+      const bool same_params =
+          X.scale == Y_scale && X.zero_point == Y_zero_point;
+      const float multiplier = X.scale / Y_scale;
+      for (TIndex o = 0; o < outer; ++o) {
+        const uint8_t* x = X_data + o * inner;
+        uint8_t* y = Y_data + o * Y_inner + offset;
+        if (same_params) {
+          std::copy(x, x + inner, y);
+        } else {
+          for (TIndex j = 0; j < inner; ++j) {
+            y[j] = Requantize(x[j] - X.zero_point, multiplier, Y_zero_point);
+          }
+        }
+      }
+      offset += inner;
+      if (split_data) {
+        split_data[i] = X.t.dim32(canonical_axis);
+      }
+    }
+    return true;
+  }
+
+ private:
+  int axis_;
+  bool has_Y_scale_;
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_CONCAT_OP_H_
@@ -0,0 +1,29 @@
+#include "caffe2/operators/quantized/int8_conv_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Conv, int8::Int8ConvOp);
+
+OPERATOR_SCHEMA(Int8Conv)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .Arg(
+        "static_weights",
+        "If set, the weights are assumed not to change between runs and are "
+        "only packed again when their blob's buffer changes")
+    .SetDoc(R"DOC(
+Quantized version of Conv for NHWC inputs. The input X and the filter W, of
+shape (M, kernel_h, kernel_w, C / group), are uint8 Int8TensorCPUs and the
+bias b is an int32 Int8TensorCPU with zero point 0 and scale
+X_scale * W_scale. Padding uses the input's zero point, i.e. pads with real
+zeros. The products are accumulated in int32 and requantized to Y_scale and
+Y_zero_point.
+)DOC")
+    .Input(0, "X", "Input data blob (NHWC)")
+    .Input(1, "filter", "The filter blob, of shape (M, kernel_h, kernel_w, C / group)")
+    .Input(2, "bias", "The int32 1D bias blob")
+    .Output(0, "Y", "Output data blob (NHWC)");
+
+} // namespace caffe2
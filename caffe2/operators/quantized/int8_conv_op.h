@@ -0,0 +1,165 @@
+#ifndef CAFFE2_OPERATORS_INT8_CONV_OP_H_
+#define CAFFE2_OPERATORS_INT8_CONV_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "caffe2/perfkernels/int8_gemm.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Convolution of a uint8 NHWC input with uint8 weights of shape
+// (M, kernel_h, kernel_w, C / group), computed group by group as a GEMM of
+// the im2col buffer of the input and the packed weights.
+class Int8ConvOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8ConvOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int32_t>("Y_zero_point", 0)),
+        static_weights_(
+            OperatorBase::GetSingleArgument<bool>("static_weights", false)) {
+    OPERATOR_NEEDS_FEATURE(
+        this->order_ == StorageOrder::NHWC,
+        "Int8Conv only supports NHWC order");
+    CAFFE_ENFORCE_EQ(kernel_.size(), 2, "Int8Conv only supports 2D convolution");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    const auto& W = Inputs()[1]->Get<Int8TensorCPU>();
+    const auto& B = Inputs()[2]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+
+    CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+    CAFFE_ENFORCE_EQ(W.t.ndim(), 4);
+    const int N = X.t.dim32(0);
+    const int H = X.t.dim32(1);
+    const int W_in = X.t.dim32(2);
+    const int C = X.t.dim32(3);
+    const int M = W.t.dim32(0);
+    CAFFE_ENFORCE_EQ(C % group_, 0);
+    CAFFE_ENFORCE_EQ(M % group_, 0);
+    const int C_per_group = C / group_;
+    const int M_per_group = M / group_;
+    CAFFE_ENFORCE_EQ(W.t.dim32(1), kernel_h());
+    CAFFE_ENFORCE_EQ(W.t.dim32(2), kernel_w());
+    CAFFE_ENFORCE_EQ(W.t.dim32(3), C_per_group);
+    CAFFE_ENFORCE_EQ(B.t.size(), M);
+    EnforceBiasScale(B, X.scale, W.scale);
+
+    ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), M);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+    const int Y_H = Y->t.dim32(1);
+    const int Y_W = Y->t.dim32(2);
+    const int rows = N * Y_H * Y_W;
+    const int K = kernel_h() * kernel_w() * C_per_group;
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    if (rows == 0) {
+      return true;
+    }
+
+    W_packed_.Pack(W, M, K, static_weights_);
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    const bool is_1x1 = group_ == 1 && kernel_h() == 1 && kernel_w() == 1 &&
+        stride_h() == 1 && stride_w() == 1 && pad_t() == 0 && pad_l() == 0 &&
+        pad_b() == 0 && pad_r() == 0;
+    row_sums_.resize(rows);
+    acc_.resize(static_cast<size_t>(rows) * M_per_group);
+    if (!is_1x1) {
+      col_buffer_.resize(static_cast<size_t>(rows) * K);
+    }
+    const float multiplier = X.scale * W.scale / Y_scale_;
+    for (int g = 0; g < group_; ++g) {
+      const uint8_t* A = X_data;
+      if (!is_1x1) {
+        Im2ColNHWC(
+            X_data, N, H, W_in, C, g * C_per_group, C_per_group, Y_H, Y_W,
+            X.zero_point, col_buffer_.data());
+        A = col_buffer_.data();
+      }
+      ComputeRowSums(rows, K, A, K, row_sums_.data());
+      Int8GemmU8S8(
+          rows,
+          M_per_group,
+          K,
+          A,
+          K,
+          W_packed_.data.data() + g * M_per_group * K,
+          K,
+          acc_.data(),
+          M_per_group);
+      RequantizeGemmOutput(
+          rows,
+          M_per_group,
+          K,
+          acc_.data(),
+          row_sums_.data(),
+          X.zero_point,
+          W_packed_.row_sums.data() + g * M_per_group,
+          W_packed_.zero_point,
+          B.t.data<int32_t>() + g * M_per_group,
+          multiplier,
+          Y_zero_point_,
+          Y_data + g * M_per_group,
+          M);
+    }
+    return true;
+  }
+
+ private:
+  // Writes, for every output position, the kernel_h x kernel_w x C_group
+  // input patch of channels [C_begin, C_begin + C_group) to a row of `col`,
+  // using the input zero point (the quantized zero) for padding.
+  void Im2ColNHWC(
+      const uint8_t* X,
+      int N,
+      int H,
+      int W,
+      int C,
+      int C_begin,
+      int C_group,
+      int Y_H,
+      int Y_W,
+      uint8_t padding,
+      uint8_t* col) {
+    for (int n = 0; n < N; ++n) {
+      for (int y_h = 0; y_h < Y_H; ++y_h) {
+        for (int y_w = 0; y_w < Y_W; ++y_w) {
+          for (int k_h = 0; k_h < kernel_h(); ++k_h) {
+            const int h = y_h * stride_h() - pad_t() + k_h * dilation_h();
+            for (int k_w = 0; k_w < kernel_w(); ++k_w) {
+              const int w = y_w * stride_w() - pad_l() + k_w * dilation_w();
+              if (h < 0 || h >= H || w < 0 || w >= W) {
+                std::fill(col, col + C_group, padding);
+              } else {
+                const uint8_t* src = X + ((n * H + h) * W + w) * C + C_begin;
+                std::copy(src, src + C_group, col);
+              }
+              col += C_group;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  bool static_weights_;
+  PackedInt8Weights W_packed_;
+  vector<uint8_t> col_buffer_;
+  vector<int32_t> row_sums_;
+  vector<int32_t> acc_;
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_CONV_OP_H_
@@ -0,0 +1,29 @@
+#include "caffe2/operators/quantized/int8_fc_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8FC, int8::Int8FCOp);
+
+OPERATOR_SCHEMA(Int8FC)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .Arg(
+        "static_weights",
+        "If set, the weights are assumed not to change between runs and are "
+        "only packed again when their blob's buffer changes")
+    .Arg("axis", "Same as in FC")
+    .Arg("axis_w", "Same as in FC")
+    .SetDoc(R"DOC(
+Quantized version of FC: Y = X * W^T + b, where X and W are uint8
+Int8TensorCPUs and b is an int32 Int8TensorCPU with zero point 0 and scale
+X_scale * W_scale. The products are accumulated in int32 and requantized to
+Y_scale and Y_zero_point.
+)DOC")
+    .Input(0, "X", "input tensor that's coerced into a 2D matrix of size (MxK)")
+    .Input(1, "W", "A tensor that is coerced into a 2D blob of size (KxN)")
+    .Input(2, "b", "1D int32 blob containing N bias values")
+    .Output(0, "Y", "2D output tensor");
+
+} // namespace caffe2
@@ -0,0 +1,88 @@
+#ifndef CAFFE2_OPERATORS_INT8_FC_OP_H_
+#define CAFFE2_OPERATORS_INT8_FC_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "caffe2/perfkernels/int8_gemm.h"
+
+namespace caffe2 {
+namespace int8 {
+
+class Int8FCOp final : public Operator<CPUContext> {
+ public:
+  Int8FCOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        axis_(OperatorBase::GetSingleArgument<int32_t>("axis", 1)),
+        axis_w_(OperatorBase::GetSingleArgument<int32_t>("axis_w", 1)),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int32_t>("Y_zero_point", 0)),
+        static_weights_(
+            OperatorBase::GetSingleArgument<bool>("static_weights", false)) {}
+
+  bool RunOnDevice() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    const auto& W = Inputs()[1]->Get<Int8TensorCPU>();
+    const auto& B = Inputs()[2]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+
+    const auto canonical_axis = X.t.canonical_axis_index(axis_);
+    const int M = X.t.size_to_dim(canonical_axis);
+    const int K = X.t.size_from_dim(canonical_axis);
+    const int N = W.t.size_to_dim(W.t.canonical_axis_index(axis_w_));
+    CAFFE_ENFORCE_EQ(K, W.t.size() / N, "Int8FC: dimension mismatch");
+    CAFFE_ENFORCE_EQ(N, B.t.size(), "Int8FC: dimension mismatch");
+    EnforceBiasScale(B, X.scale, W.scale);
+
+    auto Y_dims = X.t.dims();
+    Y_dims.resize(canonical_axis + 1);
+    Y_dims[canonical_axis] = N;
+    Y->t.Resize(Y_dims);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+    if (M == 0) {
+      Y->t.mutable_data<uint8_t>();
+      return true;
+    }
+
+    W_packed_.Pack(W, N, K, static_weights_);
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    X_row_sums_.resize(M);
+    ComputeRowSums(M, K, X_data, K, X_row_sums_.data());
+    acc_.resize(static_cast<size_t>(M) * N);
+    Int8GemmU8S8(
+        M, N, K, X_data, K, W_packed_.data.data(), K, acc_.data(), N);
+    RequantizeGemmOutput(
+        M,
+        N,
+        K,
+        acc_.data(),
+        X_row_sums_.data(),
+        X.zero_point,
+        W_packed_.row_sums.data(),
+        W_packed_.zero_point,
+        B.t.data<int32_t>(),
+        X.scale * W.scale / Y_scale_,
+        Y_zero_point_,
+        Y->t.mutable_data<uint8_t>(),
+        N);
+    return true;
+  }
+
+ private:
+  int axis_;
+  int axis_w_;
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  bool static_weights_;
+  PackedInt8Weights W_packed_;
+  vector<int32_t> X_row_sums_;
+  vector<int32_t> acc_;
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_FC_OP_H_
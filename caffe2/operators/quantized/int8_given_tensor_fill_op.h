@@ -0,0 +1,83 @@
+#ifndef CAFFE2_OPERATORS_INT8_GIVEN_TENSOR_FILL_OP_H_
+#define CAFFE2_OPERATORS_INT8_GIVEN_TENSOR_FILL_OP_H_
+
+#include <cstring>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Fills an Int8TensorCPU of uint8 values, which are given as the bytes of the
+// string argument `values`.
+class Int8GivenTensorFillOp final : public Operator<CPUContext> {
+ public:
+  Int8GivenTensorFillOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        zero_point_(
+            OperatorBase::GetSingleArgument<int32_t>("Y_zero_point", 0)),
+        shape_(OperatorBase::GetRepeatedArgument<TIndex>("shape")),
+        values_(OperatorBase::GetSingleArgument<string>("values", "")) {}
+
+  bool RunOnDevice() override {
+    auto* output = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    output->t.Resize(shape_);
+    CAFFE_ENFORCE_EQ(
+        output->t.size(),
+        values_.size(),
+        "Int8GivenTensorFill: `values` does not match `shape`");
+    output->scale = scale_;
+    output->zero_point = zero_point_;
+    uint8_t* data = output->t.mutable_data<uint8_t>();
+    if (!values_.empty()) {
+      std::memcpy(data, values_.data(), values_.size());
+    }
+    return true;
+  }
+
+ private:
+  float scale_;
+  int32_t zero_point_;
+  vector<TIndex> shape_;
+  string values_;
+};
+
+// Fills an Int8TensorCPU of int32 values, as used for biases.
+class Int8GivenIntTensorFillOp final : public Operator<CPUContext> {
+ public:
+  Int8GivenIntTensorFillOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        zero_point_(
+            OperatorBase::GetSingleArgument<int32_t>("Y_zero_point", 0)),
+        shape_(OperatorBase::GetRepeatedArgument<TIndex>("shape")),
+        values_(OperatorBase::GetRepeatedArgument<int32_t>("values")) {}
+
+  bool RunOnDevice() override {
+    auto* output = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    output->t.Resize(shape_);
+    CAFFE_ENFORCE_EQ(
+        output->t.size(),
+        values_.size(),
+        "Int8GivenIntTensorFill: `values` does not match `shape`");
+    output->scale = scale_;
+    output->zero_point = zero_point_;
+    std::copy(
+        values_.begin(), values_.end(), output->t.mutable_data<int32_t>());
+    return true;
+  }
+
+ private:
+  float scale_;
+  int32_t zero_point_;
+  vector<TIndex> shape_;
+  vector<int32_t> values_;
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_GIVEN_TENSOR_FILL_OP_H_
@@ -0,0 +1,17 @@
+#include "caffe2/operators/quantized/int8_max_pool_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8MaxPool, int8::Int8MaxPoolOp);
+
+OPERATOR_SCHEMA(Int8MaxPool)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Quantized version of MaxPool for 2D NHWC inputs. The output has the
+quantization parameters of the input.
+)DOC")
+    .Input(0, "X", "Input data tensor (NHWC)")
+    .Output(0, "Y", "Output data tensor (NHWC)");
+
+} // namespace caffe2
@@ -0,0 +1,72 @@
+#ifndef CAFFE2_OPERATORS_INT8_MAX_POOL_OP_H_
+#define CAFFE2_OPERATORS_INT8_MAX_POOL_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Max pooling commutes with the (monotonic) quantization, so the output keeps
+// the input's quantization parameters.
+class Int8MaxPoolOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8MaxPoolOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws) {
+    OPERATOR_NEEDS_FEATURE(
+        this->order_ == StorageOrder::NHWC,
+        "Int8MaxPool only supports NHWC order");
+    CAFFE_ENFORCE_EQ(
+        kernel_.size(), 2, "Int8MaxPool only supports 2D pooling");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+    const int N = X.t.dim32(0);
+    const int H = X.t.dim32(1);
+    const int W = X.t.dim32(2);
+    const int C = X.t.dim32(3);
+    ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), C);
+    Y->scale = X.scale;
+    Y->zero_point = X.zero_point;
+    const int Y_H = Y->t.dim32(1);
+    const int Y_W = Y->t.dim32(2);
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+
+    for (int n = 0; n < N; ++n) {
+      for (int ph = 0; ph < Y_H; ++ph) {
+        int hstart = ph * stride_h() - pad_t();
+        const int hend = std::min(hstart + kernel_h(), H);
+        hstart = std::max(hstart, 0);
+        for (int pw = 0; pw < Y_W; ++pw) {
+          int wstart = pw * stride_w() - pad_l();
+          const int wend = std::min(wstart + kernel_w(), W);
+          wstart = std::max(wstart, 0);
+          uint8_t* y = Y_data + ((n * Y_H + ph) * Y_W + pw) * C;
+          std::fill(y, y + C, static_cast<uint8_t>(kQuantizedMin));
+          for (int h = hstart; h < hend; ++h) {
+            for (int w = wstart; w < wend; ++w) {
+              const uint8_t* x = X_data + ((n * H + h) * W + w) * C;
+              for (int c = 0; c < C; ++c) {
+                y[c] = std::max(y[c], x[c]);
+              }
+            }
+          }
+        }
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_MAX_POOL_OP_H_
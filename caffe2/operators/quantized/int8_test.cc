@@ -0,0 +1,362 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "caffe2/perfkernels/int8_gemm.h"
+#include "caffe2/utils/proto_utils.h"
+
+// Each operator is checked against a float reference computed on the
+// dequantized inputs, so that the only expected error is the rounding of the
+// output to its quantization step.
+
+namespace caffe2 {
+namespace int8 {
+namespace {
+
+std::vector<float> RandomData(TIndex size, float min, float max, int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(min, max);
+  std::vector<float> data(size);
+  for (auto& v : data) {
+    v = dist(gen);
+  }
+  return data;
+}
+
+// Quantizes `data` to the blob `name` and returns its dequantized values.
+std::vector<float> AddInt8Input(
+    const string& name,
+    const vector<TIndex>& shape,
+    const std::vector<float>& data,
+    Workspace* ws) {
+  const auto minmax = std::minmax_element(data.begin(), data.end());
+  const auto params = ChooseQuantizationParams(*minmax.first, *minmax.second);
+  TensorCPU src(shape, CPU);
+  std::copy(data.begin(), data.end(), src.mutable_data<float>());
+  auto* dst = ws->CreateBlob(name)->GetMutable<Int8TensorCPU>();
+  QuantizeTensor(src, params, dst);
+  std::vector<float> dequantized(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    dequantized[i] = DequantizeUint8(
+        dst->scale, dst->zero_point, dst->t.data<uint8_t>()[i]);
+  }
+  return dequantized;
+}
+
+std::vector<float> AddInt8Bias(
+    const string& name,
+    const std::vector<float>& data,
+    float scale,
+    Workspace* ws) {
+  TensorCPU src(vector<TIndex>{static_cast<TIndex>(data.size())}, CPU);
+  std::copy(data.begin(), data.end(), src.mutable_data<float>());
+  auto* dst = ws->CreateBlob(name)->GetMutable<Int8TensorCPU>();
+  QuantizeBias(src, scale, dst);
+  std::vector<float> dequantized(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    dequantized[i] = scale * dst->t.data<int32_t>()[i];
+  }
+  return dequantized;
+}
+
+float Scale(const string& name, Workspace* ws) {
+  return ws->GetBlob(name)->Get<Int8TensorCPU>().scale;
+}
+
+void RunOp(const OperatorDef& def, Workspace* ws) {
+  auto op = CreateOperator(def, ws);
+  ASSERT_NE(op, nullptr);
+  ASSERT_TRUE(op->Run());
+}
+
+// Checks that `name` holds a quantization of `expected` with the given shape,
+// to within one quantization step.
+void ExpectNear(
+    const string& name,
+    const vector<TIndex>& shape,
+    const std::vector<float>& expected,
+    Workspace* ws) {
+  const auto& Y = ws->GetBlob(name)->Get<Int8TensorCPU>();
+  EXPECT_EQ(Y.t.dims(), shape);
+  ASSERT_EQ(Y.t.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    const float actual =
+        DequantizeUint8(Y.scale, Y.zero_point, Y.t.data<uint8_t>()[i]);
+    EXPECT_NEAR(actual, expected[i], Y.scale * 1.01) << "at " << i;
+  }
+}
+
+QuantizationParams OutputParams(const std::vector<float>& expected) {
+  const auto minmax = std::minmax_element(expected.begin(), expected.end());
+  return ChooseQuantizationParams(*minmax.first, *minmax.second);
+}
+
+void AddOutputArgs(const QuantizationParams& params, OperatorDef* def) {
+  def->add_arg()->CopyFrom(MakeArgument<float>("Y_scale", params.scale));
+  def->add_arg()->CopyFrom(
+      MakeArgument<int>("Y_zero_point", params.zero_point));
+}
+
+} // namespace
+
+TEST(Int8GemmTest, MatchesReference) {
+  for (int M : {1, 3, 7}) {
+    for (int N : {1, 4, 5, 9}) {
+      for (int K : {1, 15, 16, 33, 70}) {
+        std::mt19937 gen(M * 100 + N * 10 + K);
+        std::uniform_int_distribution<int> dist(0, 255);
+        std::vector<uint8_t> A(M * K);
+        std::vector<int8_t> B(N * K);
+        for (auto& a : A) {
+          a = dist(gen);
+        }
+        for (auto& b : B) {
+          b = static_cast<int8_t>(dist(gen) - 128);
+        }
+        std::vector<int32_t> C(M * N);
+        Int8GemmU8S8(M, N, K, A.data(), K, B.data(), K, C.data(), N);
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < N; ++j) {
+            int32_t expected = 0;
+            for (int k = 0; k < K; ++k) {
+              expected += A[i * K + k] * B[j * K + k];
+            }
+            EXPECT_EQ(C[i * N + j], expected);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(Int8Test, QuantizeDequantize) {
+  Workspace ws;
+  const vector<TIndex> shape{4, 5};
+  const auto data = RandomData(20, -3, 2, 0);
+  auto* X = ws.CreateBlob("X")->GetMutableTensor(CPU);
+  X->Resize(shape);
+  std::copy(data.begin(), data.end(), X->mutable_data<float>());
+
+  OperatorDef quantize = CreateOperatorDef(
+      "Int8Quantize",
+      "",
+      {"X"},
+      {"X_q"},
+      {MakeArgument<float>("Y_scale", 5.f / 255),
+       MakeArgument<int>("Y_zero_point", 153)});
+  RunOp(quantize, &ws);
+  ExpectNear("X_q", shape, data, &ws);
+
+  RunOp(CreateOperatorDef("Int8Dequantize", "", {"X_q"}, {"Y"}), &ws);
+  const auto& Y = ws.GetBlob("Y")->Get<TensorCPU>();
+  EXPECT_EQ(Y.dims(), shape);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_NEAR(Y.data<float>()[i], data[i], 5.f / 255);
+  }
+}
+
+TEST(Int8Test, FC) {
+  Workspace ws;
+  const int M = 6, K = 37, N = 11;
+  const auto X = AddInt8Input("X", {M, K}, RandomData(M * K, -1, 3, 1), &ws);
+  const auto W = AddInt8Input("W", {N, K}, RandomData(N * K, -2, 1, 2), &ws);
+  const auto B = AddInt8Bias(
+      "B", RandomData(N, -1, 1, 3), Scale("X", &ws) * Scale("W", &ws), &ws);
+
+  std::vector<float> expected(M * N);
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < N; ++n) {
+      float sum = B[n];
+      for (int k = 0; k < K; ++k) {
+        sum += X[m * K + k] * W[n * K + k];
+      }
+      expected[m * N + n] = sum;
+    }
+  }
+  OperatorDef def = CreateOperatorDef("Int8FC", "", {"X", "W", "B"}, {"Y"});
+  AddOutputArgs(OutputParams(expected), &def);
+  RunOp(def, &ws);
+  ExpectNear("Y", {M, N}, expected, &ws);
+  // The packed weights are reused by the second run.
+  RunOp(def, &ws);
+  ExpectNear("Y", {M, N}, expected, &ws);
+}
+
+void TestConv(
+    int kernel,
+    int stride,
+    int pad,
+    int group,
+    int C,
+    int M,
+    int seed) {
+  Workspace ws;
+  const int N = 2, H = 7, W_in = 6;
+  const int C_g = C / group, M_g = M / group;
+  const auto X = AddInt8Input(
+      "X", {N, H, W_in, C}, RandomData(N * H * W_in * C, -1, 2, seed), &ws);
+  const auto W = AddInt8Input(
+      "W",
+      {M, kernel, kernel, C_g},
+      RandomData(M * kernel * kernel * C_g, -1, 1, seed + 1),
+      &ws);
+  const auto B = AddInt8Bias(
+      "B", RandomData(M, -1, 1, seed + 2), Scale("X", &ws) * Scale("W", &ws),
+      &ws);
+
+  const int Y_H = (H + 2 * pad - kernel) / stride + 1;
+  const int Y_W = (W_in + 2 * pad - kernel) / stride + 1;
+  std::vector<float> expected(N * Y_H * Y_W * M);
+  for (int n = 0; n < N; ++n) {
+    for (int y_h = 0; y_h < Y_H; ++y_h) {
+      for (int y_w = 0; y_w < Y_W; ++y_w) {
+        for (int m = 0; m < M; ++m) {
+          const int g = m / M_g;
+          float sum = B[m];
+          for (int k_h = 0; k_h < kernel; ++k_h) {
+            for (int k_w = 0; k_w < kernel; ++k_w) {
+              const int h = y_h * stride - pad + k_h;
+              const int w = y_w * stride - pad + k_w;
+              if (h < 0 || h >= H || w < 0 || w >= W_in) {
+                continue;
+              }
+              for (int c = 0; c < C_g; ++c) {
+                sum += X[((n * H + h) * W_in + w) * C + g * C_g + c] *
+                    W[((m * kernel + k_h) * kernel + k_w) * C_g + c];
+              }
+            }
+          }
+          expected[((n * Y_H + y_h) * Y_W + y_w) * M + m] = sum;
+        }
+      }
+    }
+  }
+  OperatorDef def = CreateOperatorDef(
+      "Int8Conv",
+      "",
+      {"X", "W", "B"},
+      {"Y"},
+      {MakeArgument<int>("kernel", kernel),
+       MakeArgument<int>("stride", stride),
+       MakeArgument<int>("pad", pad),
+       MakeArgument<int>("group", group),
+       MakeArgument<string>("order", "NHWC")});
+  AddOutputArgs(OutputParams(expected), &def);
+  RunOp(def, &ws);
+  ExpectNear("Y", {N, Y_H, Y_W, M}, expected, &ws);
+}
+
+TEST(Int8Test, Conv) {
+  TestConv(3, 1, 1, 1, 5, 8, 10);
+  TestConv(3, 2, 0, 1, 4, 3, 20);
+  TestConv(1, 1, 0, 1, 16, 6, 30);
+  TestConv(3, 1, 1, 2, 6, 4, 40);
+}
+
+TEST(Int8Test, Relu) {
+  Workspace ws;
+  const auto X = AddInt8Input("X", {3, 7}, RandomData(21, -2, 1, 4), &ws);
+  std::vector<float> expected(X.size());
+  for (size_t i = 0; i < X.size(); ++i) {
+    expected[i] = std::max(X[i], 0.f);
+  }
+  RunOp(CreateOperatorDef("Int8Relu", "", {"X"}, {"X"}), &ws);
+  ExpectNear("X", {3, 7}, expected, &ws);
+}
+
+TEST(Int8Test, Add) {
+  Workspace ws;
+  const auto A = AddInt8Input("A", {2, 9}, RandomData(18, -2, 1, 5), &ws);
+  const auto B = AddInt8Input("B", {2, 9}, RandomData(18, -1, 4, 6), &ws);
+  std::vector<float> expected(A.size());
+  for (size_t i = 0; i < A.size(); ++i) {
+    expected[i] = A[i] + B[i];
+  }
+  OperatorDef def = CreateOperatorDef("Int8Add", "", {"A", "B"}, {"Y"});
+  AddOutputArgs(OutputParams(expected), &def);
+  RunOp(def, &ws);
+  ExpectNear("Y", {2, 9}, expected, &ws);
+}
+
+void TestPool(const string& type, int seed) {
+  Workspace ws;
+  const int N = 2, H = 5, W = 6, C = 3, kernel = 3, stride = 2, pad = 1;
+  const auto X = AddInt8Input(
+      "X", {N, H, W, C}, RandomData(N * H * W * C, -1, 2, seed), &ws);
+  const int Y_H = (H + 2 * pad - kernel) / stride + 1;
+  const int Y_W = (W + 2 * pad - kernel) / stride + 1;
+  std::vector<float> expected(N * Y_H * Y_W * C);
+  for (int n = 0; n < N; ++n) {
+    for (int y_h = 0; y_h < Y_H; ++y_h) {
+      for (int y_w = 0; y_w < Y_W; ++y_w) {
+        for (int c = 0; c < C; ++c) {
+          float max = -1e10, sum = 0;
+          int count = 0;
+          for (int h = std::max(y_h * stride - pad, 0);
+               h < std::min(y_h * stride - pad + kernel, H);
+               ++h) {
+            for (int w = std::max(y_w * stride - pad, 0);
+                 w < std::min(y_w * stride - pad + kernel, W);
+                 ++w) {
+              const float x = X[((n * H + h) * W + w) * C + c];
+              max = std::max(max, x);
+              sum += x;
+              ++count;
+            }
+          }
+          expected[((n * Y_H + y_h) * Y_W + y_w) * C + c] =
+              type == "Int8MaxPool" ? max : sum / count;
+        }
+      }
+    }
+  }
+  RunOp(
+      CreateOperatorDef(
+          type,
+          "",
+          {"X"},
+          {"Y"},
+          {MakeArgument<int>("kernel", kernel),
+           MakeArgument<int>("stride", stride),
+           MakeArgument<int>("pad", pad),
+           MakeArgument<string>("order", "NHWC")}),
+      &ws);
+  ExpectNear("Y", {N, Y_H, Y_W, C}, expected, &ws);
+}
+
+TEST(Int8Test, MaxPool) {
+  TestPool("Int8MaxPool", 7);
+}
+
+TEST(Int8Test, AveragePool) {
+  TestPool("Int8AveragePool", 8);
+}
+
+TEST(Int8Test, Concat) {
+  Workspace ws;
+  const auto A = AddInt8Input("A", {2, 2, 3}, RandomData(12, -1, 1, 9), &ws);
+  const auto B = AddInt8Input("B", {2, 2, 2}, RandomData(8, -3, 2, 10), &ws);
+  std::vector<float> expected;
+  for (int i = 0; i < 4; ++i) {
+    expected.insert(expected.end(), A.begin() + i * 3, A.begin() + i * 3 + 3);
+    expected.insert(expected.end(), B.begin() + i * 2, B.begin() + i * 2 + 2);
+  }
+  OperatorDef def = CreateOperatorDef(
+      "Int8Concat", "", {"A", "B"}, {"Y", "split"},
+      {MakeArgument<int>("axis", -1)});
+  AddOutputArgs(OutputParams(expected), &def);
+  RunOp(def, &ws);
+  ExpectNear("Y", {2, 2, 5}, expected, &ws);
+  const auto& split = ws.GetBlob("split")->Get<TensorCPU>();
+  EXPECT_EQ(split.data<int>()[0], 3);
+  EXPECT_EQ(split.data<int>()[1], 2);
+}
+
+} // namespace int8
+} // namespace caffe2
@@ -0,0 +1,190 @@
+#ifndef CAFFE2_OPERATORS_INT8_UTILS_H_
+#define CAFFE2_OPERATORS_INT8_UTILS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/tensor_int8.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Quantized tensors use the affine scheme real = scale * (q - zero_point)
+// with uint8 q, and int32 q for biases (with zero_point 0 and scale equal to
+// the product of the input and weight scales).
+
+constexpr int32_t kQuantizedMin = std::numeric_limits<uint8_t>::min();
+constexpr int32_t kQuantizedMax = std::numeric_limits<uint8_t>::max();
+
+struct QuantizationParams {
+  float scale;
+  int32_t zero_point;
+};
+
+// Returns parameters that represent [min, max] (extended to contain 0, so
+// that zero padding is exact) with uint8 values.
+inline QuantizationParams ChooseQuantizationParams(float min, float max) {
+  min = std::min(min, 0.f);
+  max = std::max(max, 0.f);
+  QuantizationParams params{1.0, 0};
+  if (max == min) {
+    return params;
+  }
+  params.scale = (max - min) / (kQuantizedMax - kQuantizedMin);
+  const float zero_point = kQuantizedMin - min / params.scale;
+  params.zero_point = std::max(
+      kQuantizedMin,
+      std::min(kQuantizedMax, static_cast<int32_t>(std::nearbyint(zero_point))));
+  return params;
+}
+
+inline uint8_t QuantizeUint8(float scale, int32_t zero_point, float value) {
+  const float q = zero_point + std::nearbyint(value / scale);
+  return static_cast<uint8_t>(std::max<float>(
+      kQuantizedMin, std::min<float>(kQuantizedMax, q)));
+}
+
+inline float DequantizeUint8(float scale, int32_t zero_point, uint8_t value) {
+  return scale * (static_cast<int32_t>(value) - zero_point);
+}
+
+// Maps an int32 accumulator with scale `multiplier * output scale` to the
+// output's uint8 representation.
+inline uint8_t Requantize(int32_t acc, float multiplier, int32_t zero_point) {
+  const int32_t q =
+      zero_point + static_cast<int32_t>(std::nearbyint(acc * multiplier));
+  return static_cast<uint8_t>(
+      std::max(kQuantizedMin, std::min(kQuantizedMax, q)));
+}
+
+inline void QuantizeTensor(
+    const TensorCPU& src,
+    const QuantizationParams& params,
+    Int8TensorCPU* dst) {
+  dst->scale = params.scale;
+  dst->zero_point = params.zero_point;
+  dst->t.ResizeLike(src);
+  const float* src_data = src.data<float>();
+  uint8_t* dst_data = dst->t.mutable_data<uint8_t>();
+  for (TIndex i = 0; i < src.size(); ++i) {
+    dst_data[i] = QuantizeUint8(params.scale, params.zero_point, src_data[i]);
+  }
+}
+
+// Quantizes a bias to int32 with the given scale and zero point 0.
+inline void QuantizeBias(const TensorCPU& src, float scale, Int8TensorCPU* dst) {
+  dst->scale = scale;
+  dst->zero_point = 0;
+  dst->t.ResizeLike(src);
+  const float* src_data = src.data<float>();
+  int32_t* dst_data = dst->t.mutable_data<int32_t>();
+  for (TIndex i = 0; i < src.size(); ++i) {
+    dst_data[i] = static_cast<int32_t>(std::nearbyint(src_data[i] / scale));
+  }
+}
+
+// Checks that a bias was quantized for an input with scale `X_scale` and
+// weights with scale `W_scale`.
+inline void EnforceBiasScale(
+    const Int8TensorCPU& B,
+    float X_scale,
+    float W_scale) {
+  CAFFE_ENFORCE(B.t.IsType<int32_t>(), "Int8 bias must be int32");
+  CAFFE_ENFORCE_EQ(B.zero_point, 0, "Int8 bias must have zero point 0");
+  const float expected = X_scale * W_scale;
+  CAFFE_ENFORCE_LE(
+      std::abs(B.scale - expected),
+      1e-4 * expected,
+      "Int8 bias scale must be the product of the input and weight scales");
+}
+
+// Weights of Int8FC and Int8Conv, N rows of K values, in the int8 layout of
+// Int8GemmU8S8: value - 128, so that (value - 128) - (zero_point - 128) is
+// the weight's offset from its zero point, together with the sum of each
+// row.
+struct PackedInt8Weights {
+  const void* source{nullptr};
+  std::vector<int8_t> data;
+  std::vector<int32_t> row_sums;
+  int32_t zero_point{0};
+
+  // Packs W. Weights can be refilled in place, or freed and reallocated at
+  // the same address, without the operator noticing, so they are packed on
+  // every call unless the operator was told they are constant
+  // (`static_weights`). Then W is only packed again if its buffer, size or
+  // zero point differ from the last call.
+  void Pack(const Int8TensorCPU& W, int N, int K, bool constant) {
+    const uint8_t* W_data = W.t.data<uint8_t>();
+    if (constant && source == W_data &&
+        data.size() == static_cast<size_t>(N) * K &&
+        zero_point == W.zero_point - 128) {
+      return;
+    }
+    source = W_data;
+    zero_point = W.zero_point - 128;
+    data.resize(static_cast<size_t>(N) * K);
+    row_sums.assign(N, 0);
+    for (int n = 0; n < N; ++n) {
+      for (int k = 0; k < K; ++k) {
+        const int8_t w = static_cast<int8_t>(W_data[n * K + k] ^ 0x80);
+        data[n * K + k] = w;
+        row_sums[n] += w;
+      }
+    }
+  }
+};
+
+// Computes the sum of each of the M rows of K values of A (with row stride
+// lda), which RequantizeGemmOutput needs to subtract the weight zero point.
+inline void ComputeRowSums(
+    int M,
+    int K,
+    const uint8_t* A,
+    int lda,
+    int32_t* row_sums) {
+  for (int m = 0; m < M; ++m) {
+    int32_t sum = 0;
+    for (int k = 0; k < K; ++k) {
+      sum += A[m * lda + k];
+    }
+    row_sums[m] = sum;
+  }
+}
+
+// Turns the M x N output `acc` of Int8GemmU8S8 for an input with the given
+// row sums and zero point, and packed weights with the given row sums and
+// zero point, into uint8 values of Y (with row stride ldy), adding the int32
+// bias and requantizing by `multiplier`.
+inline void RequantizeGemmOutput(
+    int M,
+    int N,
+    int K,
+    const int32_t* acc,
+    const int32_t* A_row_sums,
+    int32_t A_zero_point,
+    const int32_t* W_row_sums,
+    int32_t W_zero_point,
+    const int32_t* bias,
+    float multiplier,
+    int32_t Y_zero_point,
+    uint8_t* Y,
+    int ldy) {
+  const int32_t offset = K * A_zero_point * W_zero_point;
+  for (int m = 0; m < M; ++m) {
+    const int32_t row_offset = offset - W_zero_point * A_row_sums[m];
+    for (int n = 0; n < N; ++n) {
+      const int32_t value = acc[m * N + n] + row_offset -
+          A_zero_point * W_row_sums[n] + bias[n];
+      Y[m * ldy + n] = Requantize(value, multiplier, Y_zero_point);
+    }
+  }
+}
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_UTILS_H_
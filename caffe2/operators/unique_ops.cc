@@ -37,28 +37,13 @@ bool UniqueOp<CPUContext>::DoRunWithType() {
   }
 
   const T* input = inputTensor.template data<T>();
-  // TODO(dzhulgakov): if perf becomes an issue consider doing hash table
-  // instead of sorting
-  order_.resize(N);
-  std::iota(order_.begin(), order_.end(), 0);
-  std::sort(order_.begin(), order_.end(), [input](const int x, const int y) {
-    return input[x] < input[y];
-  });
-  int K = N;
-  for (int i = 1; i < N; ++i) {
-    K -= input[order_[i]] == input[order_[i - 1]];
-  }
-  uniqueTensor->Resize(K);
-  T* unique = uniqueTensor->template mutable_data<T>();
-  K = 0;
-  T prev = -1;
-  for (int i = 0; i < N; ++i) {
-    if (i == 0 || prev != input[order_[i]]) {
-      prev = unique[K++] = input[order_[i]];
-    }
-    if (remapping) {
-      remapping[order_[i]] = K - 1;
-    }
+  // The kernel is shared with ATen's unique. It deduplicates with hash tables
+  // and splits large inputs across the OpenMP threads.
+  at::UniqueKernel<T> kernel(input, N, /* sorted */ true);
+  uniqueTensor->Resize(kernel.size());
+  kernel.unique(uniqueTensor->template mutable_data<T>(), nullptr);
+  if (remapping) {
+    kernel.inverse(remapping);
   }
   return true;
 }
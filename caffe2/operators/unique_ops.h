@@ -19,6 +19,7 @@
 
 #include <cmath>
 
+#include "ATen/core/Unique.h"
 #include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
@@ -30,7 +31,7 @@ namespace caffe2 {
 /**
  * Deduplicates input indices vector and optionally produces reverse remapping.
  * Current implementation produces a sorted list but it's not guaranteed in
- * general.
+ * general. The CPU implementation is at::UniqueKernel, shared with ATen.
  */
 template <class Context>
 class UniqueOp : public Operator<Context> {
@@ -46,7 +47,6 @@ class UniqueOp : public Operator<Context> {
   bool DoRunWithType();
 
  private:
-  vector<int> order_;
   Tensor thrust_unique_buffer_{Context::GetDeviceType()};
   Tensor cuda_order_buffer_{Context::GetDeviceType()};
   Tensor second_order_buffer_{Context::GetDeviceType()};
@@ -0,0 +1,268 @@
+#include "caffe2/opt/int8_rewrite.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace opt {
+
+namespace {
+
+using ParamsMap = std::unordered_map<std::string, int8::QuantizationParams>;
+
+const char kInt8Suffix[] = "_int8";
+
+bool IsNHWC(const OperatorDef& op) {
+  return ArgumentHelper::GetSingleArgument<OperatorDef, std::string>(
+             op, "order", "NCHW") == "NHWC";
+}
+
+bool Is2D(const OperatorDef& op) {
+  if (ArgumentHelper::HasArgument(op, "kernels")) {
+    return ArgumentHelper::GetRepeatedArgument<OperatorDef, int>(op, "kernels")
+               .size() == 2;
+  }
+  return true;
+}
+
+bool IsFloatParameter(const std::string& name, const Workspace& ws) {
+  const Blob* blob = ws.GetBlob(name);
+  return blob && blob->IsType<Tensor>(CPU) &&
+      blob->Get<TensorCPU>().IsType<float>();
+}
+
+// Returns the indices of the inputs of `op` that are activations, or an empty
+// vector if `op` has no Int8 counterpart that supports its arguments.
+std::vector<int> ActivationInputs(const OperatorDef& op, const Workspace& ws) {
+  const auto& type = op.type();
+  if (type == "FC" || type == "Conv") {
+    if (op.input_size() != 3 || !IsFloatParameter(op.input(1), ws) ||
+        !IsFloatParameter(op.input(2), ws)) {
+      return {};
+    }
+    if (type == "Conv" && (!IsNHWC(op) || !Is2D(op))) {
+      return {};
+    }
+    return {0};
+  }
+  if (type == "MaxPool" || type == "AveragePool") {
+    return IsNHWC(op) && Is2D(op) ? std::vector<int>{0} : std::vector<int>{};
+  }
+  if (type == "Relu") {
+    return {0};
+  }
+  if (type == "Add") {
+    if (op.input_size() != 2 ||
+        ArgumentHelper::GetSingleArgument<OperatorDef, int>(
+            op, "broadcast", 0)) {
+      return {};
+    }
+    return {0, 1};
+  }
+  if (type == "Concat") {
+    if (ArgumentHelper::GetSingleArgument<OperatorDef, int>(
+            op, "add_axis", 0)) {
+      return {};
+    }
+    std::vector<int> inputs(op.input_size());
+    for (int i = 0; i < op.input_size(); ++i) {
+      inputs[i] = i;
+    }
+    return inputs;
+  }
+  return {};
+}
+
+void AddOutputArgs(const int8::QuantizationParams& params, OperatorDef* op) {
+  op->add_arg()->CopyFrom(MakeArgument<float>("Y_scale", params.scale));
+  op->add_arg()->CopyFrom(
+      MakeArgument<int>("Y_zero_point", params.zero_point));
+}
+
+class Int8Rewriter {
+ public:
+  Int8Rewriter(const NetDef& net, const ParamsMap& params, Workspace* ws)
+      : net_(net), params_(params), ws_(ws) {}
+
+  NetDef Run() {
+    NetDef result = net_;
+    result.clear_op();
+    for (const auto& op : net_.op()) {
+      if (!Rewrite(op, &result)) {
+        Keep(op, &result);
+      }
+    }
+    for (const auto& output : net_.external_output()) {
+      RequireFloat(output, &result);
+    }
+    for (const auto& parameter : parameters_) {
+      result.add_external_input(parameter);
+    }
+    return result;
+  }
+
+ private:
+  bool HasParams(const std::string& name) const {
+    return params_.count(name) > 0;
+  }
+
+  // Appends the Int8 version of `op` to `result`, or returns false if it
+  // has none.
+  bool Rewrite(const OperatorDef& op, NetDef* result) {
+    const auto activations = ActivationInputs(op, *ws_);
+    if (activations.empty() || !HasParams(op.output(0))) {
+      return false;
+    }
+    for (int i : activations) {
+      if (!HasParams(op.input(i))) {
+        return false;
+      }
+    }
+
+    std::vector<std::string> inputs(op.input().begin(), op.input().end());
+    for (int i : activations) {
+      inputs[i] = RequireInt8(op.input(i), result);
+    }
+    if (op.type() == "FC" || op.type() == "Conv") {
+      const float X_scale = params_.at(op.input(0)).scale;
+      float W_scale = 0;
+      inputs[1] = QuantizeWeights(op.input(1), &W_scale);
+      inputs[2] = QuantizeBias(op.input(2), X_scale * W_scale);
+    }
+
+    OperatorDef int8_op = op;
+    int8_op.set_type("Int8" + op.type());
+    int8_op.clear_engine();
+    int8_op.clear_input();
+    for (const auto& input : inputs) {
+      int8_op.add_input(input);
+    }
+    int8_op.set_output(0, op.output(0) + kInt8Suffix);
+    if (op.type() != "Relu" && op.type() != "MaxPool") {
+      AddOutputArgs(params_.at(op.output(0)), &int8_op);
+    }
+    if (op.type() == "FC" || op.type() == "Conv") {
+      // The weights were just quantized and nothing else writes them, so
+      // the operator can pack them once instead of on every run.
+      int8_op.add_arg()->CopyFrom(MakeArgument<int>("static_weights", 1));
+    }
+    result->add_op()->CopyFrom(int8_op);
+
+    // Any other output (Concat's split_info) is an ordinary tensor.
+    for (int i = 1; i < op.output_size(); ++i) {
+      MarkFloatWritten(op.output(i));
+    }
+    float_stale_.insert(op.output(0));
+    has_int8_.insert(op.output(0));
+    return true;
+  }
+
+  void Keep(const OperatorDef& op, NetDef* result) {
+    for (const auto& input : op.input()) {
+      RequireFloat(input, result);
+    }
+    result->add_op()->CopyFrom(op);
+    for (const auto& output : op.output()) {
+      MarkFloatWritten(output);
+    }
+  }
+
+  void MarkFloatWritten(const std::string& name) {
+    float_stale_.erase(name);
+    has_int8_.erase(name);
+  }
+
+  std::string RequireInt8(const std::string& name, NetDef* result) {
+    const std::string int8_name = name + kInt8Suffix;
+    if (!has_int8_.count(name)) {
+      const auto& params = params_.at(name);
+      OperatorDef quantize =
+          CreateOperatorDef("Int8Quantize", "", {name}, {int8_name});
+      AddOutputArgs(params, &quantize);
+      result->add_op()->CopyFrom(quantize);
+      has_int8_.insert(name);
+    }
+    return int8_name;
+  }
+
+  void RequireFloat(const std::string& name, NetDef* result) {
+    if (float_stale_.count(name)) {
+      result->add_op()->CopyFrom(CreateOperatorDef(
+          "Int8Dequantize", "", {name + kInt8Suffix}, {name}));
+      float_stale_.erase(name);
+    }
+  }
+
+  // Weights are quantized from their current float values on every rewrite,
+  // replacing any `W_int8` left in the workspace by an earlier one, since the
+  // float weights may have changed since.
+  std::string QuantizeWeights(const std::string& name, float* scale) {
+    const std::string int8_name = name + kInt8Suffix;
+    if (!quantized_weights_.count(name)) {
+      const auto& W = ws_->GetBlob(name)->Get<TensorCPU>();
+      const float* W_data = W.data<float>();
+      const auto minmax = std::minmax_element(W_data, W_data + W.size());
+      int8::QuantizeTensor(
+          W,
+          int8::ChooseQuantizationParams(*minmax.first, *minmax.second),
+          ws_->CreateBlob(int8_name)->GetMutable<int8::Int8TensorCPU>());
+      quantized_weights_.insert(name);
+      parameters_.push_back(int8_name);
+    }
+    *scale = ws_->GetBlob(int8_name)->Get<int8::Int8TensorCPU>().scale;
+    return int8_name;
+  }
+
+  // A bias is quantized with the product of the input and weight scales, so
+  // a bias shared by operators with different inputs gets several versions:
+  // `b_int8`, `b_int8_1`, ...
+  std::string QuantizeBias(const std::string& name, float scale) {
+    auto& versions = quantized_biases_[name];
+    for (const auto& version : versions) {
+      if (version.first == scale) {
+        return version.second;
+      }
+    }
+    std::string int8_name = name + kInt8Suffix;
+    if (!versions.empty()) {
+      int8_name += "_" + caffe2::to_string(versions.size());
+    }
+    int8::QuantizeBias(
+        ws_->GetBlob(name)->Get<TensorCPU>(),
+        scale,
+        ws_->CreateBlob(int8_name)->GetMutable<int8::Int8TensorCPU>());
+    versions.emplace_back(scale, int8_name);
+    parameters_.push_back(int8_name);
+    return int8_name;
+  }
+
+  const NetDef& net_;
+  const ParamsMap& params_;
+  Workspace* ws_;
+  // Activations whose float blob is out of date and whose Int8 version is.
+  std::unordered_set<std::string> float_stale_;
+  // Activations with an up to date Int8 version.
+  std::unordered_set<std::string> has_int8_;
+  // Weights and biases quantized by this rewrite, and the scale of each
+  // version of a bias.
+  std::unordered_set<std::string> quantized_weights_;
+  std::unordered_map<std::string, std::vector<std::pair<float, std::string>>>
+      quantized_biases_;
+  std::vector<std::string> parameters_;
+};
+
+} // namespace
+
+NetDef RewriteForInt8(
+    const NetDef& net,
+    const ParamsMap& activation_params,
+    Workspace* ws) {
+  return Int8Rewriter(net, activation_params, ws).Run();
+}
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,40 @@
+#ifndef CAFFE2_OPT_INT8_REWRITE_H_
+#define CAFFE2_OPT_INT8_REWRITE_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "caffe2/proto/caffe2.pb.h"
+
+namespace caffe2 {
+namespace opt {
+
+// Rewrites the float operators of `net` that have Int8 counterparts (FC,
+// Conv, MaxPool and AveragePool in NHWC order, Relu, Add without broadcasting
+// and Concat) to run on quantized activations.
+//
+// `activation_params` holds the calibrated quantization parameters of the
+// float activations; an operator is rewritten only if all of its activation
+// inputs and outputs have parameters. The quantized version of activation
+// `x` is named `x_int8`, and Int8Quantize and Int8Dequantize operators are
+// inserted where float and quantized operators meet and for the external
+// outputs. Weights and biases are read from `ws` and quantized into blobs
+// `W_int8` and `b_int8` in `ws`, which are added to the external inputs of
+// the returned net. Blobs left by an earlier rewrite are overwritten, so
+// rewriting again after updating the float weights picks up the new values.
+// The Int8FC and Int8Conv operators are created with `static_weights`, so
+// they pack their weights on their first run only; nets instantiated from an
+// earlier rewrite must be created again after rewriting.
+caffe2::NetDef RewriteForInt8(
+    const caffe2::NetDef& net,
+    const std::unordered_map<std::string, int8::QuantizationParams>&
+        activation_params,
+    caffe2::Workspace* ws);
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_INT8_REWRITE_H_
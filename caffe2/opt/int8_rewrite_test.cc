@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/opt/int8_rewrite.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace {
+
+void AddFloatBlob(
+    const std::string& name,
+    const std::vector<TIndex>& shape,
+    int seed,
+    Workspace* ws) {
+  auto* tensor = ws->CreateBlob(name)->GetMutableTensor(CPU);
+  tensor->Resize(shape);
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1, 1);
+  float* data = tensor->mutable_data<float>();
+  for (TIndex i = 0; i < tensor->size(); ++i) {
+    data[i] = dist(gen);
+  }
+}
+
+std::vector<std::string> OpTypes(const NetDef& net) {
+  std::vector<std::string> types;
+  for (const auto& op : net.op()) {
+    types.push_back(op.type());
+  }
+  return types;
+}
+
+// X -> FC -> Relu (in place) -> FC -> Y
+NetDef MLP() {
+  NetDef net;
+  net.set_name("mlp");
+  net.add_external_input("X");
+  for (const auto& p : {"W1", "b1", "W2", "b2"}) {
+    net.add_external_input(p);
+  }
+  net.add_op()->CopyFrom(CreateOperatorDef("FC", "", {"X", "W1", "b1"}, {"H"}));
+  net.add_op()->CopyFrom(CreateOperatorDef("Relu", "", {"H"}, {"H"}));
+  net.add_op()->CopyFrom(CreateOperatorDef("FC", "", {"H", "W2", "b2"}, {"Y"}));
+  net.add_external_output("Y");
+  return net;
+}
+
+// Calibrates the activations of `net` by their range on one run.
+std::unordered_map<std::string, int8::QuantizationParams> Calibrate(
+    const NetDef& net,
+    Workspace* ws) {
+  std::unordered_map<std::string, int8::QuantizationParams> params;
+  EXPECT_TRUE(ws->RunNetOnce(net));
+  for (const auto& name : {"X", "H", "Y"}) {
+    const auto& tensor = ws->GetBlob(name)->Get<TensorCPU>();
+    const float* data = tensor.data<float>();
+    const auto minmax = std::minmax_element(data, data + tensor.size());
+    params[name] =
+        int8::ChooseQuantizationParams(*minmax.first, *minmax.second);
+  }
+  return params;
+}
+
+} // namespace
+
+TEST(Int8RewriteTest, MLP) {
+  Workspace ws;
+  AddFloatBlob("X", {4, 16}, 0, &ws);
+  AddFloatBlob("W1", {32, 16}, 1, &ws);
+  AddFloatBlob("b1", {32}, 2, &ws);
+  AddFloatBlob("W2", {8, 32}, 3, &ws);
+  AddFloatBlob("b2", {8}, 4, &ws);
+  const NetDef net = MLP();
+  const auto params = Calibrate(net, &ws);
+  TensorCPU expected(ws.GetBlob("Y")->Get<TensorCPU>(), CPU);
+
+  const NetDef int8_net = opt::RewriteForInt8(net, params, &ws);
+  EXPECT_EQ(
+      OpTypes(int8_net),
+      std::vector<std::string>(
+          {"Int8Quantize", "Int8FC", "Int8Relu", "Int8FC", "Int8Dequantize"}));
+  for (const auto& p : {"W1_int8", "b1_int8", "W2_int8", "b2_int8"}) {
+    EXPECT_NE(
+        std::find(
+            int8_net.external_input().begin(),
+            int8_net.external_input().end(),
+            p),
+        int8_net.external_input().end());
+  }
+
+  ws.GetBlob("Y")->Reset();
+  ASSERT_TRUE(ws.RunNetOnce(int8_net));
+  const auto& Y = ws.GetBlob("Y")->Get<TensorCPU>();
+  ASSERT_EQ(Y.dims(), expected.dims());
+  // A few quantization steps of each activation.
+  const float tolerance = 4 * params.at("Y").scale;
+  for (TIndex i = 0; i < Y.size(); ++i) {
+    EXPECT_NEAR(Y.data<float>()[i], expected.data<float>()[i], tolerance);
+  }
+}
+
+TEST(Int8RewriteTest, RequantizesOnRewrite) {
+  Workspace ws;
+  AddFloatBlob("X", {4, 16}, 0, &ws);
+  AddFloatBlob("W1", {32, 16}, 1, &ws);
+  AddFloatBlob("b1", {32}, 2, &ws);
+  AddFloatBlob("W2", {8, 32}, 3, &ws);
+  AddFloatBlob("b2", {8}, 4, &ws);
+  const NetDef net = MLP();
+  const auto params = Calibrate(net, &ws);
+  opt::RewriteForInt8(net, params, &ws);
+  const float W1_scale =
+      ws.GetBlob("W1_int8")->Get<int8::Int8TensorCPU>().scale;
+
+  // New float weights, e.g. from a newer checkpoint, over the same workspace.
+  auto* W1 = ws.GetBlob("W1")->GetMutableTensor(CPU);
+  for (TIndex i = 0; i < W1->size(); ++i) {
+    W1->mutable_data<float>()[i] *= 2;
+  }
+  const NetDef int8_net = opt::RewriteForInt8(net, params, &ws);
+  EXPECT_NEAR(
+      ws.GetBlob("W1_int8")->Get<int8::Int8TensorCPU>().scale,
+      2 * W1_scale,
+      1e-6);
+  for (const auto& p : {"W1_int8", "b1_int8", "W2_int8", "b2_int8"}) {
+    EXPECT_NE(
+        std::find(
+            int8_net.external_input().begin(),
+            int8_net.external_input().end(),
+            p),
+        int8_net.external_input().end());
+  }
+}
+
+TEST(Int8RewriteTest, PacksWeightsOnce) {
+  Workspace ws;
+  AddFloatBlob("X", {4, 16}, 0, &ws);
+  AddFloatBlob("W1", {32, 16}, 1, &ws);
+  AddFloatBlob("b1", {32}, 2, &ws);
+  AddFloatBlob("W2", {8, 32}, 3, &ws);
+  AddFloatBlob("b2", {8}, 4, &ws);
+  const NetDef net = MLP();
+  const auto params = Calibrate(net, &ws);
+  const NetDef int8_net = opt::RewriteForInt8(net, params, &ws);
+  for (const auto& op : int8_net.op()) {
+    if (op.type() == "Int8FC") {
+      EXPECT_TRUE(
+          ArgumentHelper(op).GetSingleArgument<bool>("static_weights", false));
+    }
+  }
+
+  NetBase* int8_run = ws.CreateNet(int8_net);
+  ASSERT_NE(int8_run, nullptr);
+  ASSERT_TRUE(int8_run->Run());
+  TensorCPU first(ws.GetBlob("Y")->Get<TensorCPU>(), CPU);
+
+  // Scribble over W1_int8 in place. The first Int8FC packed it on the first
+  // run and must keep using the packed copy.
+  auto& W1 = ws.GetBlob("W1_int8")->GetMutable<int8::Int8TensorCPU>()->t;
+  const uint8_t* W1_buffer = W1.data<uint8_t>();
+  std::fill(W1.mutable_data<uint8_t>(), W1.mutable_data<uint8_t>() + W1.size(), 0);
+  ASSERT_EQ(W1.data<uint8_t>(), W1_buffer);
+  ASSERT_TRUE(int8_run->Run());
+  const auto& Y = ws.GetBlob("Y")->Get<TensorCPU>();
+  ASSERT_EQ(Y.dims(), first.dims());
+  for (TIndex i = 0; i < Y.size(); ++i) {
+    EXPECT_EQ(Y.data<float>()[i], first.data<float>()[i]);
+  }
+}
+
+TEST(Int8RewriteTest, UnsupportedOperators) {
+  Workspace ws;
+  AddFloatBlob("W1", {32, 16}, 1, &ws);
+  AddFloatBlob("b1", {32}, 2, &ws);
+  AddFloatBlob("W2", {8, 32}, 3, &ws);
+  AddFloatBlob("b2", {8}, 4, &ws);
+  NetDef net = MLP();
+  // A float operator between the FCs and an activation without parameters.
+  net.mutable_op(1)->set_type("Sigmoid");
+  std::unordered_map<std::string, int8::QuantizationParams> params;
+  params["X"] = int8::ChooseQuantizationParams(-1, 1);
+  params["H"] = int8::ChooseQuantizationParams(-4, 4);
+
+  const NetDef int8_net = opt::RewriteForInt8(net, params, &ws);
+  EXPECT_EQ(
+      OpTypes(int8_net),
+      std::vector<std::string>(
+          {"Int8Quantize", "Int8FC", "Int8Dequantize", "Sigmoid", "FC"}));
+  EXPECT_EQ(int8_net.op(1).output(0), "H_int8");
+  EXPECT_EQ(int8_net.op(2).input(0), "H_int8");
+  EXPECT_EQ(int8_net.op(2).output(0), "H");
+}
+
+} // namespace caffe2
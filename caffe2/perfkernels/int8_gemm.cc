@@ -0,0 +1,46 @@
+#include "caffe2/perfkernels/int8_gemm.h"
+
+#include "caffe2/core/common.h"
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+void Int8GemmU8S8__base(
+    int M,
+    int N,
+    int K,
+    const std::uint8_t* A,
+    int lda,
+    const std::int8_t* B,
+    int ldb,
+    std::int32_t* C,
+    int ldc) {
+  for (int i = 0; i < M; ++i) {
+    const std::uint8_t* a = A + i * lda;
+    for (int j = 0; j < N; ++j) {
+      const std::int8_t* b = B + j * ldb;
+      std::int32_t acc = 0;
+      for (int k = 0; k < K; ++k) {
+        acc += static_cast<std::int32_t>(a[k]) * static_cast<std::int32_t>(b[k]);
+      }
+      C[i * ldc + j] = acc;
+    }
+  }
+}
+
+void Int8GemmU8S8(
+    int M,
+    int N,
+    int K,
+    const std::uint8_t* A,
+    int lda,
+    const std::int8_t* B,
+    int ldb,
+    std::int32_t* C,
+    int ldc) {
+  AVX2_DO(Int8GemmU8S8, M, N, K, A, lda, B, ldb, C, ldc);
+  BASE_DO(Int8GemmU8S8, M, N, K, A, lda, B, ldb, C, ldc);
+}
+
+} // namespace caffe2
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace caffe2 {
+
+// Int8 matrix product with 32-bit accumulation:
+//
+//   C[i * ldc + j] = sum_k A[i * lda + k] * B[j * ldb + k]
+//
+// for 0 <= i < M and 0 <= j < N, i.e. an M x K matrix of uint8 values times
+// the transpose of an N x K matrix of int8 values. This is the layout of both
+// the im2col'ed input times the weights of a convolution and of X * W^T in a
+// fully connected layer. Zero points are handled by the caller.
+void Int8GemmU8S8(
+    int M,
+    int N,
+    int K,
+    const std::uint8_t* A,
+    int lda,
+    const std::int8_t* B,
+    int ldb,
+    std::int32_t* C,
+    int ldc);
+
+} // namespace caffe2
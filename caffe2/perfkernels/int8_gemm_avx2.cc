@@ -0,0 +1,96 @@
+#include "caffe2/perfkernels/int8_gemm.h"
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+namespace {
+
+inline std::int32_t HorizontalSum(__m256i v) {
+  __m128i sum = _mm_add_epi32(
+      _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+// Loads 16 values and widens them to int16.
+inline __m256i LoadU8(const std::uint8_t* p) {
+  return _mm256_cvtepu8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+inline __m256i LoadS8(const std::int8_t* p) {
+  return _mm256_cvtepi8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+} // namespace
+
+// Computes one row of A against four rows of B at a time, so that every
+// widened chunk of A is reused four times. The products are formed with
+// _mm256_madd_epi16 on values widened to 16 bits, which (unlike
+// _mm256_maddubs_epi16 on the raw bytes) cannot saturate.
+void Int8GemmU8S8__avx2(
+    int M,
+    int N,
+    int K,
+    const std::uint8_t* A,
+    int lda,
+    const std::int8_t* B,
+    int ldb,
+    std::int32_t* C,
+    int ldc) {
+  const int K16 = K - K % 16;
+  for (int i = 0; i < M; ++i) {
+    const std::uint8_t* a = A + i * lda;
+    std::int32_t* c = C + i * ldc;
+    int j = 0;
+    for (; j + 4 <= N; j += 4) {
+      const std::int8_t* b0 = B + (j + 0) * ldb;
+      const std::int8_t* b1 = B + (j + 1) * ldb;
+      const std::int8_t* b2 = B + (j + 2) * ldb;
+      const std::int8_t* b3 = B + (j + 3) * ldb;
+      __m256i acc0 = _mm256_setzero_si256();
+      __m256i acc1 = _mm256_setzero_si256();
+      __m256i acc2 = _mm256_setzero_si256();
+      __m256i acc3 = _mm256_setzero_si256();
+      for (int k = 0; k < K16; k += 16) {
+        const __m256i va = LoadU8(a + k);
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(va, LoadS8(b0 + k)));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(va, LoadS8(b1 + k)));
+        acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(va, LoadS8(b2 + k)));
+        acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(va, LoadS8(b3 + k)));
+      }
+      std::int32_t s0 = HorizontalSum(acc0);
+      std::int32_t s1 = HorizontalSum(acc1);
+      std::int32_t s2 = HorizontalSum(acc2);
+      std::int32_t s3 = HorizontalSum(acc3);
+      for (int k = K16; k < K; ++k) {
+        const std::int32_t ak = a[k];
+        s0 += ak * b0[k];
+        s1 += ak * b1[k];
+        s2 += ak * b2[k];
+        s3 += ak * b3[k];
+      }
+      c[j + 0] = s0;
+      c[j + 1] = s1;
+      c[j + 2] = s2;
+      c[j + 3] = s3;
+    }
+    for (; j < N; ++j) {
+      const std::int8_t* b = B + j * ldb;
+      __m256i acc = _mm256_setzero_si256();
+      for (int k = 0; k < K16; k += 16) {
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(LoadU8(a + k), LoadS8(b + k)));
+      }
+      std::int32_t s = HorizontalSum(acc);
+      for (int k = K16; k < K; ++k) {
+        s += static_cast<std::int32_t>(a[k]) * b[k];
+      }
+      c[j] = s;
+    }
+  }
+}
+
+} // namespace caffe2
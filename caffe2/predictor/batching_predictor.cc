@@ -0,0 +1,294 @@
+#include "caffe2/predictor/batching_predictor.h"
+
+#include <unordered_set>
+
+#include "caffe2/core/context.h"
+
+namespace caffe2 {
+
+struct BatchingPredictor::Request {
+  const TensorVector* inputs = nullptr;
+  std::vector<TensorCPU>* outputs = nullptr;
+  // Requests can be batched if all inputs have at least one dimension and
+  // agree on the first one, which is then the number of rows.
+  bool batchable = false;
+  TIndex rows = 1;
+  std::chrono::steady_clock::time_point deadline;
+
+  bool done = false;
+  bool ok = false;
+  std::exception_ptr error;
+};
+
+class BatchingPredictor::Worker {
+ public:
+  Worker(
+      const NetDef& run_net,
+      const std::vector<std::string>& input_names,
+      Workspace* params_ws)
+      : run_net_(run_net), input_names_(input_names), ws_(params_ws) {
+    // Inputs and every blob the net writes live in the worker's workspace;
+    // only blobs the net merely reads are looked up in the parameters.
+    for (const auto& name : input_names_) {
+      ws_.CreateLocalBlob(name)->GetMutableTensor(CPU);
+    }
+    for (const auto& op : run_net_.op()) {
+      for (const auto& output : op.output()) {
+        ws_.CreateLocalBlob(output);
+      }
+    }
+    CAFFE_ENFORCE(ws_.CreateNet(run_net_));
+  }
+
+  bool run(const std::vector<Request*>& batch);
+
+ private:
+  const NetDef& run_net_;
+  const std::vector<std::string>& input_names_;
+  Workspace ws_;
+  CPUContext context_;
+  // Whether the input blobs share the data of the last request's inputs
+  bool inputs_shared_ = false;
+};
+
+bool BatchingPredictor::Worker::run(const std::vector<Request*>& batch) {
+  if (batch.size() == 1) {
+    const auto& inputs = *batch[0]->inputs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      auto* tensor = ws_.GetBlob(input_names_[i])->GetMutableTensor(CPU);
+      tensor->ResizeLike(*inputs[i]);
+      tensor->ShareData(*inputs[i]);
+    }
+    inputs_shared_ = true;
+    if (!ws_.RunNet(run_net_.name())) {
+      return false;
+    }
+    auto* outputs = batch[0]->outputs;
+    outputs->clear();
+    for (const auto& name : run_net_.external_output()) {
+      const auto* output = ws_.GetBlob(name)->GetMutableTensor(CPU);
+      outputs->emplace_back(*output, &context_, CPU);
+    }
+    return true;
+  }
+
+  TIndex rows = 0;
+  for (const auto* request : batch) {
+    rows += request->rows;
+  }
+  if (inputs_shared_) {
+    // The input blobs still share the buffers of an earlier single request.
+    // Resize would keep them if they are large enough, and the copies below
+    // would then overwrite the caller's tensors.
+    for (const auto& name : input_names_) {
+      ws_.GetBlob(name)->GetMutableTensor(CPU)->FreeMemory();
+    }
+    inputs_shared_ = false;
+  }
+  for (size_t i = 0; i < input_names_.size(); ++i) {
+    const auto& first = *(*batch[0]->inputs)[i];
+    auto dims = first.dims();
+    dims[0] = rows;
+    auto* tensor = ws_.GetBlob(input_names_[i])->GetMutableTensor(CPU);
+    tensor->Resize(dims);
+    char* dst = static_cast<char*>(tensor->raw_mutable_data(first.meta()));
+    for (const auto* request : batch) {
+      const auto& input = *(*request->inputs)[i];
+      context_.CopyItems<CPUContext, CPUContext>(
+          input.meta(), input.size(), input.raw_data(), dst);
+      dst += input.nbytes();
+    }
+  }
+  if (!ws_.RunNet(run_net_.name())) {
+    return false;
+  }
+
+  for (auto* request : batch) {
+    request->outputs->clear();
+  }
+  for (const auto& name : run_net_.external_output()) {
+    const auto& output = *ws_.GetBlob(name)->GetMutableTensor(CPU);
+    CAFFE_ENFORCE(
+        output.ndim() >= 1 && output.dim(0) == rows,
+        "Output ",
+        name,
+        " of a batch of ",
+        rows,
+        " rows has dims ",
+        output.dims(),
+        "; batched predict nets must preserve the first dimension");
+    const auto& meta = output.meta();
+    const TIndex row_size = output.size_from_dim(1);
+    const char* src = static_cast<const char*>(output.raw_data());
+    for (auto* request : batch) {
+      auto dims = output.dims();
+      dims[0] = request->rows;
+      TensorCPU slice(dims, CPU);
+      context_.CopyItems<CPUContext, CPUContext>(
+          meta,
+          request->rows * row_size,
+          src,
+          slice.raw_mutable_data(meta));
+      src += slice.nbytes();
+      request->outputs->push_back(std::move(slice));
+    }
+  }
+  return true;
+}
+
+BatchingPredictor::BatchingPredictor(
+    const NetDef& init_net,
+    const NetDef& run_net,
+    const BatchingPredictorOptions& options,
+    Workspace* parent,
+    bool run_init)
+    : run_net_(run_net), options_(options), params_ws_(parent) {
+  CAFFE_ENFORCE_GT(options_.num_workers, 0);
+  CAFFE_ENFORCE_GT(options_.max_batch_size, 0);
+  if (run_init) {
+    CAFFE_ENFORCE(params_ws_.RunNetOnce(init_net));
+  }
+  for (const auto& name : run_net_.external_input()) {
+    if (!params_ws_.HasBlob(name)) {
+      input_names_.push_back(name);
+    }
+  }
+  for (int i = 0; i < options_.num_workers; ++i) {
+    workers_.emplace_back(
+        caffe2::make_unique<Worker>(run_net_, input_names_, &params_ws_));
+  }
+  for (auto& worker : workers_) {
+    threads_.emplace_back(&BatchingPredictor::workerLoop, this, worker.get());
+  }
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+bool BatchingPredictor::compatible(const Request& a, const Request& b) {
+  if (!a.batchable || !b.batchable) {
+    return false;
+  }
+  for (size_t i = 0; i < a.inputs->size(); ++i) {
+    const auto& x = *(*a.inputs)[i];
+    const auto& y = *(*b.inputs)[i];
+    if (x.meta() != y.meta() || x.ndim() != y.ndim()) {
+      return false;
+    }
+    for (int d = 1; d < x.ndim(); ++d) {
+      if (x.dim(d) != y.dim(d)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void BatchingPredictor::takeBatch(std::vector<Request*>* batch) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] {
+    return (stop_ && queue_.empty()) || (!collecting_ && !queue_.empty());
+  });
+  if (queue_.empty()) {
+    return;
+  }
+  collecting_ = true;
+  Request* first = queue_.front();
+  queue_.pop_front();
+  batch->push_back(first);
+  TIndex rows = first->rows;
+  while (true) {
+    for (auto it = queue_.begin();
+         it != queue_.end() && rows < options_.max_batch_size;) {
+      if (compatible(*first, **it) &&
+          rows + (*it)->rows <= options_.max_batch_size) {
+        rows += (*it)->rows;
+        batch->push_back(*it);
+        it = queue_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (rows >= options_.max_batch_size || !first->batchable || stop_ ||
+        std::chrono::steady_clock::now() >= first->deadline) {
+      break;
+    }
+    cv_.wait_until(lock, first->deadline);
+  }
+  collecting_ = false;
+  lock.unlock();
+  // Let the next idle worker start collecting.
+  cv_.notify_all();
+}
+
+void BatchingPredictor::workerLoop(Worker* worker) {
+  while (true) {
+    std::vector<Request*> batch;
+    takeBatch(&batch);
+    if (batch.empty()) {
+      return;
+    }
+    num_batches_++;
+    bool ok = false;
+    std::exception_ptr error;
+    try {
+      ok = worker->run(batch);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      for (auto* request : batch) {
+        request->ok = ok;
+        request->error = error;
+        request->done = true;
+      }
+    }
+    done_cv_.notify_all();
+  }
+}
+
+bool BatchingPredictor::run(
+    const TensorVector& inputs,
+    std::vector<TensorCPU>* outputs) {
+  CAFFE_ENFORCE(outputs);
+  CAFFE_ENFORCE_EQ(
+      inputs.size(),
+      input_names_.size(),
+      "Expected one input for each of the predict net's non-parameter "
+      "external inputs");
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  request.batchable = !inputs.empty();
+  for (const auto* input : inputs) {
+    CAFFE_ENFORCE(input);
+    if (input->ndim() == 0 || input->dim(0) != inputs[0]->dim(0)) {
+      request.batchable = false;
+    }
+  }
+  if (request.batchable) {
+    request.rows = inputs[0]->dim(0);
+  }
+  request.deadline = std::chrono::steady_clock::now() + options_.max_latency;
+  num_requests_++;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_.push_back(&request);
+  cv_.notify_all();
+  done_cv_.wait(lock, [&request] { return request.done; });
+  if (request.error) {
+    std::rethrow_exception(request.error);
+  }
+  return request.ok;
+}
+
+} // namespace caffe2
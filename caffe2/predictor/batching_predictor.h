@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/core/workspace.h"
+
+namespace caffe2 {
+
+struct BatchingPredictorOptions {
+  // Number of worker threads. Each worker owns a workspace and a copy of the
+  // predict net, so this is also the number of batches that can run at once.
+  int num_workers = 1;
+  // Upper bound on the number of rows (dim 0 of the inputs) in a batch.
+  // A single request larger than this is run on its own.
+  int max_batch_size = 32;
+  // How long a request may wait for other requests to batch with.
+  std::chrono::microseconds max_latency{1000};
+};
+
+/**
+ * A Predictor for serving concurrent requests.
+ *
+ * `init_net` is run once, and the parameters it creates are shared read-only
+ * by all workers: every worker runs the predict net in a child workspace of
+ * the parameter workspace, with its own inputs and intermediate blobs. The
+ * predict net must not write to its parameters.
+ *
+ * Requests that arrive within `max_latency` of each other are coalesced
+ * along the first dimension (up to `max_batch_size` rows), run as one batch,
+ * and the outputs are split back per request. Requests can only be batched if
+ * their inputs agree in everything but the first dimension, and the predict
+ * net must preserve the first dimension in its outputs (each output row
+ * depends only on the matching input rows).
+ */
+class BatchingPredictor {
+ public:
+  using TensorVector = std::vector<TensorCPU*>;
+
+  // If `run_init` is false, the parameters are expected in `parent`.
+  BatchingPredictor(
+      const NetDef& init_net,
+      const NetDef& run_net,
+      const BatchingPredictorOptions& options = BatchingPredictorOptions(),
+      Workspace* parent = nullptr,
+      bool run_init = true);
+
+  ~BatchingPredictor();
+
+  // Runs the predict net on `inputs`, which are fed to input_names() in
+  // order. Blocks until the batch containing this request has run; the
+  // outputs, one per external output of the predict net, are owned by the
+  // caller. May be called from any number of threads.
+  bool run(const TensorVector& inputs, std::vector<TensorCPU>* outputs);
+
+  const NetDef& def() const {
+    return run_net_;
+  }
+
+  // The external inputs of the predict net that are not parameters, i.e.
+  // that do not exist in the parameter workspace after initialization.
+  const std::vector<std::string>& input_names() const {
+    return input_names_;
+  }
+
+  struct Stats {
+    uint64_t requests;
+    uint64_t batches;
+  };
+  Stats stats() const {
+    return Stats{num_requests_.load(), num_batches_.load()};
+  }
+
+ private:
+  struct Request;
+  class Worker;
+
+  static bool compatible(const Request& a, const Request& b);
+  void takeBatch(std::vector<Request*>* batch);
+  void workerLoop(Worker* worker);
+
+  NetDef run_net_;
+  BatchingPredictorOptions options_;
+  Workspace params_ws_;
+  std::vector<std::string> input_names_;
+
+  std::mutex mutex_;
+  // Signalled when requests are queued, and when a worker is done collecting
+  // a batch.
+  std::condition_variable cv_;
+  // Signalled when a batch has run.
+  std::condition_variable done_cv_;
+  std::deque<Request*> queue_;
+  // Only one worker collects a batch at a time, so that concurrent requests
+  // end up in the same batch rather than being picked up by idle workers.
+  bool collecting_ = false;
+  bool stop_ = false;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::atomic<uint64_t> num_requests_{0};
+  std::atomic<uint64_t> num_batches_{0};
+};
+
+} // namespace caffe2
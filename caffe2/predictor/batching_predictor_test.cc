@@ -0,0 +1,246 @@
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/batching_predictor.h"
+#include "caffe2/predictor/predictor.h"
+#include "caffe2/utils/math.h"
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "simple"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "simple"
+        op {
+          type: "UniformFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 10
+            ints: 4
+          }
+          arg {
+            name: "min"
+            f: -1.0
+          }
+          arg {
+            name: "max"
+            f: 1.0
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 10
+          }
+          arg {
+            name: "value"
+            f: 2.0
+          }
+        }
+)DOC";
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+std::unique_ptr<TensorCPU> randomTensor(
+    const std::vector<TIndex>& dims,
+    CPUContext* ctx) {
+  auto t = caffe2::make_unique<TensorCPU>(dims, CPU);
+  math::RandUniform<float, CPUContext>(
+      t->size(), -1.0, 1.0, t->template mutable_data<float>(), ctx);
+  return t;
+}
+
+} // namespace
+
+class BatchingPredictorTest : public testing::Test {
+ public:
+  void SetUp() override {
+    DeviceOption op;
+    op.set_random_seed(1701);
+    ctx_ = caffe2::make_unique<CPUContext>(op);
+    // The reference predictor shares the batching predictor's parameters.
+    params_ = caffe2::make_unique<Workspace>();
+    CAFFE_ENFORCE(params_->RunNetOnce(parseNetDef(initSpec)));
+    reference_ = caffe2::make_unique<Predictor>(
+        NetDef(), parseNetDef(predictSpec), params_.get(), false);
+  }
+
+  void expectMatchesReference(
+      TensorCPU* input,
+      const std::vector<TensorCPU>& outputs) {
+    Predictor::TensorVector expected;
+    ASSERT_TRUE(reference_->run({input}, &expected));
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_EQ(outputs[0].dims(), expected[0]->dims());
+    for (TIndex i = 0; i < outputs[0].size(); ++i) {
+      EXPECT_NEAR(
+          outputs[0].data<float>()[i], expected[0]->data<float>()[i], 1e-5);
+    }
+  }
+
+  std::unique_ptr<CPUContext> ctx_;
+  std::unique_ptr<Workspace> params_;
+  std::unique_ptr<Predictor> reference_;
+};
+
+TEST_F(BatchingPredictorTest, SingleRequest) {
+  BatchingPredictor predictor(
+      NetDef(),
+      parseNetDef(predictSpec),
+      BatchingPredictorOptions(),
+      params_.get(),
+      false);
+  EXPECT_EQ(predictor.input_names(), std::vector<std::string>{"data"});
+  auto input = randomTensor({3, 4}, ctx_.get());
+  std::vector<TensorCPU> outputs;
+  ASSERT_TRUE(predictor.run({input.get()}, &outputs));
+  expectMatchesReference(input.get(), outputs);
+}
+
+TEST_F(BatchingPredictorTest, SharesParameters) {
+  BatchingPredictorOptions options;
+  options.num_workers = 2;
+  BatchingPredictor predictor(
+      NetDef(), parseNetDef(predictSpec), options, params_.get(), false);
+  auto input = randomTensor({1, 4}, ctx_.get());
+  std::vector<TensorCPU> outputs;
+  ASSERT_TRUE(predictor.run({input.get()}, &outputs));
+  // Running the predictor must not create blobs in the parameter workspace.
+  EXPECT_EQ(params_->Blobs().size(), 2);
+}
+
+TEST_F(BatchingPredictorTest, CoalescesConcurrentRequests) {
+  BatchingPredictorOptions options;
+  options.num_workers = 1;
+  options.max_batch_size = 64;
+  options.max_latency = std::chrono::milliseconds(200);
+  BatchingPredictor predictor(
+      NetDef(), parseNetDef(predictSpec), options, params_.get(), false);
+
+  const int kNumRequests = 8;
+  std::vector<std::unique_ptr<TensorCPU>> inputs;
+  for (int i = 0; i < kNumRequests; ++i) {
+    inputs.push_back(randomTensor({i % 3 + 1, 4}, ctx_.get()));
+  }
+  std::vector<std::vector<TensorCPU>> outputs(kNumRequests);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back([&, i]() {
+      EXPECT_TRUE(predictor.run({inputs[i].get()}, &outputs[i]));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kNumRequests; ++i) {
+    expectMatchesReference(inputs[i].get(), outputs[i]);
+  }
+  auto stats = predictor.stats();
+  EXPECT_EQ(stats.requests, kNumRequests);
+  EXPECT_LT(stats.batches, kNumRequests);
+}
+
+TEST_F(BatchingPredictorTest, RespectsMaxBatchSize) {
+  BatchingPredictorOptions options;
+  options.num_workers = 1;
+  options.max_batch_size = 2;
+  options.max_latency = std::chrono::milliseconds(50);
+  BatchingPredictor predictor(
+      NetDef(), parseNetDef(predictSpec), options, params_.get(), false);
+
+  const int kNumRequests = 6;
+  std::vector<std::unique_ptr<TensorCPU>> inputs;
+  for (int i = 0; i < kNumRequests; ++i) {
+    inputs.push_back(randomTensor({2, 4}, ctx_.get()));
+  }
+  std::vector<std::vector<TensorCPU>> outputs(kNumRequests);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back([&, i]() {
+      EXPECT_TRUE(predictor.run({inputs[i].get()}, &outputs[i]));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kNumRequests; ++i) {
+    expectMatchesReference(inputs[i].get(), outputs[i]);
+  }
+  // Every request already fills a batch.
+  EXPECT_EQ(predictor.stats().batches, kNumRequests);
+}
+
+TEST_F(BatchingPredictorTest, BatchDoesNotWriteToSharedInputs) {
+  BatchingPredictorOptions options;
+  options.num_workers = 1;
+  options.max_batch_size = 64;
+  options.max_latency = std::chrono::milliseconds(200);
+  BatchingPredictor predictor(
+      NetDef(), parseNetDef(predictSpec), options, params_.get(), false);
+
+  // A single request runs on the caller's input without copying it.
+  auto single = randomTensor({3, 4}, ctx_.get());
+  TensorCPU single_copy(*single, ctx_.get(), CPU);
+  std::vector<TensorCPU> outputs;
+  ASSERT_TRUE(predictor.run({single.get()}, &outputs));
+
+  // A smaller batch fits into the buffer the worker's input blob shared.
+  const int kNumRequests = 2;
+  std::vector<std::unique_ptr<TensorCPU>> inputs;
+  for (int i = 0; i < kNumRequests; ++i) {
+    inputs.push_back(randomTensor({1, 4}, ctx_.get()));
+  }
+  std::vector<std::vector<TensorCPU>> batch_outputs(kNumRequests);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back([&, i]() {
+      EXPECT_TRUE(predictor.run({inputs[i].get()}, &batch_outputs[i]));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(predictor.stats().batches, 2);
+  for (int i = 0; i < kNumRequests; ++i) {
+    expectMatchesReference(inputs[i].get(), batch_outputs[i]);
+  }
+
+  for (TIndex i = 0; i < single->size(); ++i) {
+    EXPECT_EQ(single->data<float>()[i], single_copy.data<float>()[i]);
+  }
+  ASSERT_TRUE(predictor.run({single.get()}, &outputs));
+  expectMatchesReference(single.get(), outputs);
+}
+
+} // namespace caffe2
@@ -77,5 +77,39 @@ std::unique_ptr<MetaNetDef> runGlobalInitialization(
   return metaNetDef;
 }
 
+void setNUMANode(NetDef* net, int numa_node_id) {
+  CAFFE_ENFORCE(net);
+  auto isCPU = [](const DeviceOption& option) {
+    return option.device_type() == CPU || option.device_type() == MKLDNN ||
+        option.device_type() == IDEEP;
+  };
+  if (!net->has_device_option() || isCPU(net->device_option())) {
+    net->mutable_device_option()->set_numa_node_id(numa_node_id);
+  }
+  // Ops without a device option inherit the net's.
+  for (auto& op : *net->mutable_op()) {
+    if (op.has_device_option() && isCPU(op.device_option())) {
+      op.mutable_device_option()->set_numa_node_id(numa_node_id);
+    }
+  }
+}
+
+std::vector<std::unique_ptr<Workspace>> createNUMAParameterShards(
+    const NetDef& init_net,
+    int num_numa_nodes) {
+  CAFFE_ENFORCE_GT(num_numa_nodes, 0);
+  std::vector<std::unique_ptr<Workspace>> shards;
+  for (int node = 0; node < num_numa_nodes; ++node) {
+    NetDef pinned_init_net(init_net);
+    setNUMANode(&pinned_init_net, node);
+    shards.emplace_back(caffe2::make_unique<Workspace>());
+    CAFFE_ENFORCE(
+        shards.back()->RunNetOnce(pinned_init_net),
+        "Failed running the init net on NUMA node ",
+        node);
+  }
+  return shards;
+}
+
 } // namespace predictor_utils
 } // namespace caffe2
@@ -19,5 +19,18 @@ std::unique_ptr<MetaNetDef> runGlobalInitialization(
     std::unique_ptr<db::DBReader> db,
     Workspace* master);
 
+// Pins `net` to a NUMA node: sets numa_node_id on the net and on every CPU
+// op, so that async nets run the ops on that node's thread pool and the
+// blobs they create are allocated on that node.
+void setNUMANode(NetDef* net, int numa_node_id);
+
+// Runs `init_net` once per NUMA node, each time pinned to that node and in a
+// workspace of its own, so that every node holds a local copy of the
+// parameters. Predictors running on node i should use the i-th workspace as
+// their parent.
+std::vector<std::unique_ptr<Workspace>> createNUMAParameterShards(
+    const NetDef& init_net,
+    int num_numa_nodes);
+
 } // namespace predictor_utils
 } // namespace caffe2
@@ -50,5 +50,25 @@ class NUMATest(TestCase):
         self.assertEqual(workspace.GetBlobNUMANode("output_blob_1"), 1)
 
 
+@unittest.skipIf(not workspace.IsNUMAEnabled(), "NUMA is not enabled")
+@unittest.skipIf(workspace.GetNumNUMANodes() < 2, "Not enough NUMA nodes")
+class NUMACPUTest(TestCase):
+    def test_numa_simple_net(self):
+        # Ops of a simple net run on the calling thread; their outputs still
+        # have to be allocated on the node given by their device option.
+        net = core.Net("test_numa_simple_net")
+        numa_device_option = caffe2_pb2.DeviceOption()
+        numa_device_option.device_type = caffe2_pb2.CPU
+        for node in range(2):
+            numa_device_option.numa_node_id = node
+            net.ConstantFill([], "output_blob_" + str(node), shape=[1024],
+                             value=3.14, device_option=numa_device_option)
+
+        workspace.RunNetOnce(net)
+
+        self.assertEqual(workspace.GetBlobNUMANode("output_blob_0"), 0)
+        self.assertEqual(workspace.GetBlobNUMANode("output_blob_1"), 1)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -1,10 +1,13 @@
 #include "caffe2/queue/blobs_queue.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <thread>
 
 #include "caffe2/core/blob_stats.h"
 #include "caffe2/core/logging.h"
@@ -22,6 +25,11 @@ static constexpr uint64_t SDT_TIMEOUT = (uint64_t)-1;
 static constexpr uint64_t SDT_ABORT = (uint64_t)-2;
 static constexpr uint64_t SDT_CANCEL = (uint64_t)-3;
 
+namespace {
+// Number of times a read or write retries before it blocks.
+constexpr int kSpinIterations = 100;
+} // namespace
+
 BlobsQueue::BlobsQueue(
     Workspace* ws,
     const std::string& queueName,
@@ -29,15 +37,19 @@ BlobsQueue::BlobsQueue(
     size_t numBlobs,
     bool enforceUniqueName,
     const std::vector<std::string>& fieldNames)
-    : numBlobs_(numBlobs), name_(queueName), stats_(queueName) {
+    : numBlobs_(numBlobs),
+      capacity_(capacity),
+      name_(queueName),
+      stats_(queueName) {
+  CAFFE_ENFORCE_GT(capacity, 0, "Queue capacity must be positive.");
   if (!fieldNames.empty()) {
     CAFFE_ENFORCE_EQ(
         fieldNames.size(), numBlobs, "Wrong number of fieldNames provided.");
     stats_.queue_dequeued_bytes.setDetails(fieldNames);
   }
-  queue_.reserve(capacity);
+  queue_.reset(new Slot[capacity]);
   for (auto i = 0; i < capacity; ++i) {
-    std::vector<Blob*> blobs;
+    auto& blobs = queue_[i].blobs;
     blobs.reserve(numBlobs);
     for (auto j = 0; j < numBlobs; ++j) {
       const auto blobName = queueName + "_" + to_string(i) + "_" + to_string(j);
@@ -49,57 +61,141 @@ BlobsQueue::BlobsQueue(
       }
       blobs.push_back(ws->CreateBlob(blobName));
     }
-    queue_.push_back(blobs);
+    queue_[i].sequence.store(2 * i, std::memory_order_relaxed);
   }
-  DCHECK_EQ(queue_.size(), capacity);
 }
 
-bool BlobsQueue::blockingRead(
-    const std::vector<Blob*>& inputs,
+template <typename TryClaim>
+bool BlobsQueue::waitToClaim(
+    TryClaim tryClaim,
+    std::condition_variable& cv,
+    std::atomic<int>& waiting,
+    float timeout_secs,
+    bool* blocked) {
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(int(timeout_secs * 1000));
+  for (int i = 0; i < kSpinIterations; ++i) {
+    if (tryClaim()) {
+      return true;
+    }
+    if (closing_) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+
+  *blocked = true;
+  std::unique_lock<std::mutex> g(mutex_);
+  waiting.fetch_add(1);
+  // Pairs with the fence in notifyReaders/notifyWriters: either this thread
+  // sees the record (or free slot) published before it, or the notifier
+  // sees that this thread waits.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool claimed = false;
+  auto ready = [&]() {
+    claimed = tryClaim();
+    return claimed || closing_;
+  };
+  if (timeout_secs > 0) {
+    cv.wait_until(g, deadline, ready);
+  } else {
+    cv.wait(g, ready);
+  }
+  waiting.fetch_sub(1);
+  return claimed;
+}
+
+void BlobsQueue::notifyReaders() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waitingReaders_.load(std::memory_order_relaxed) > 0) {
+    // Taking the mutex ensures that a reader that just checked for records
+    // is waiting on the condition variable before it is notified.
+    { std::lock_guard<std::mutex> g(mutex_); }
+    readersCv_.notify_all();
+  }
+}
+
+void BlobsQueue::notifyWriters() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waitingWriters_.load(std::memory_order_relaxed) > 0) {
+    { std::lock_guard<std::mutex> g(mutex_); }
+    writersCv_.notify_all();
+  }
+}
+
+template <typename GetInputs>
+size_t BlobsQueue::read(
+    size_t maxRecords,
+    const GetInputs& getInputs,
     float timeout_secs) {
   Timer readTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  auto canRead = [this]() {
-    CAFFE_ENFORCE_LE(reader_, writer_);
-    return reader_ != writer_;
-  };
   // Decrease queue balance before reading to indicate queue read pressure
   // is being increased (-ve queue balance indicates more reads than writes)
   CAFFE_EVENT(stats_, queue_balance, -1);
-  if (timeout_secs > 0) {
-    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
-    cv_.wait_for(
-        g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
-  } else {
-    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
+  uint64_t position = 0;
+  size_t numRecords = 0;
+  bool blocked = false;
+  const bool claimed = waitToClaim(
+      [&]() { return tryClaimRead(maxRecords, &position, &numRecords); },
+      readersCv_,
+      waitingReaders_,
+      timeout_secs,
+      &blocked);
+  if (blocked) {
+    CAFFE_EVENT(stats_, read_blocked);
   }
-  if (!canRead()) {
+  if (!claimed) {
     if (timeout_secs > 0 && !closing_) {
       LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
       CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
     } else {
       CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
     }
-    return false;
+    return 0;
   }
-  DCHECK(canRead());
-  auto& result = queue_[reader_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  for (auto i = 0; i < result.size(); ++i) {
-    auto bytes = BlobStat::sizeBytes(*result[i]);
-    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
-    using std::swap;
-    swap(*(inputs[i]), *(result[i]));
+  for (size_t i = 0; i < numRecords; ++i) {
+    doRead(position + i, getInputs(i));
+  }
+  notifyWriters();
+  if (numRecords > 1) {
+    CAFFE_EVENT(stats_, queue_balance, 1 - static_cast<int64_t>(numRecords));
   }
-  CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
-  CAFFE_EVENT(stats_, queue_dequeued_records);
-  ++reader_;
-  cv_.notify_all();
+  CAFFE_SDT(queue_read_end, name, (void*)this, size());
+  CAFFE_EVENT(stats_, queue_dequeued_records, numRecords);
+  CAFFE_EVENT(stats_, dequeue_batch_records, numRecords);
+  CAFFE_EVENT(stats_, queue_size, size());
   CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
-  return true;
+  return numRecords;
+}
+
+bool BlobsQueue::blockingRead(
+    const std::vector<Blob*>& inputs,
+    float timeout_secs) {
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  return read(
+             1,
+             [&](size_t /* record */) -> const std::vector<Blob*>& {
+               return inputs;
+             },
+             timeout_secs) == 1;
+}
+
+size_t BlobsQueue::blockingReadMany(
+    const std::vector<std::vector<Blob*>>& records,
+    float timeout_secs) {
+  CAFFE_ENFORCE(!records.empty());
+  for (const auto& inputs : records) {
+    CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  }
+  return read(
+      records.size(),
+      [&](size_t record) -> const std::vector<Blob*>& {
+        return records[record];
+      },
+      timeout_secs);
 }
 
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
@@ -107,16 +203,16 @@ bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_NONBLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  if (!canWrite()) {
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  uint64_t position = 0;
+  if (!tryClaimWrite(&position)) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(position, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -126,17 +222,26 @@ bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  cv_.wait(g, [this]() { return closing_ || canWrite(); });
-  if (!canWrite()) {
+  uint64_t position = 0;
+  bool blocked = false;
+  const bool claimed = waitToClaim(
+      [&]() { return tryClaimWrite(&position); },
+      writersCv_,
+      waitingWriters_,
+      0.0f,
+      &blocked);
+  if (blocked) {
+    CAFFE_EVENT(stats_, write_blocked);
+  }
+  if (!claimed) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
-  DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(position, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -145,29 +250,99 @@ void BlobsQueue::close() {
   closing_ = true;
 
   std::lock_guard<std::mutex> g(mutex_);
-  cv_.notify_all();
+  readersCv_.notify_all();
+  writersCv_.notify_all();
+}
+
+size_t BlobsQueue::size() const {
+  const uint64_t reader = reader_.load(std::memory_order_relaxed);
+  const uint64_t writer = writer_.load(std::memory_order_relaxed);
+  return std::min<uint64_t>(writer - reader, capacity_);
 }
 
-bool BlobsQueue::canWrite() {
-  // writer is always within [reader, reader + size)
-  // we can write if reader is within [reader, reader + size)
-  CAFFE_ENFORCE_LE(reader_, writer_);
-  CAFFE_ENFORCE_LE(writer_, reader_ + queue_.size());
-  return writer_ != reader_ + queue_.size();
+bool BlobsQueue::tryClaimRead(
+    size_t maxRecords,
+    uint64_t* position,
+    size_t* numRecords) {
+  uint64_t pos = reader_.load(std::memory_order_relaxed);
+  while (true) {
+    // The records at pos, pos + 1, ... are readable as long as their writers
+    // are done with them.
+    size_t n = 0;
+    while (n < maxRecords &&
+           queue_[(pos + n) % capacity_].sequence.load(
+               std::memory_order_acquire) == 2 * (pos + n) + 1) {
+      ++n;
+    }
+    if (n == 0) {
+      const uint64_t current = reader_.load(std::memory_order_relaxed);
+      if (current == pos) {
+        return false;
+      }
+      // Another reader took the record at pos.
+      pos = current;
+      continue;
+    }
+    if (reader_.compare_exchange_weak(
+            pos, pos + n, std::memory_order_relaxed)) {
+      *position = pos;
+      *numRecords = n;
+      return true;
+    }
+  }
+}
+
+bool BlobsQueue::tryClaimWrite(uint64_t* position) {
+  uint64_t pos = writer_.load(std::memory_order_relaxed);
+  while (true) {
+    const uint64_t sequence =
+        queue_[pos % capacity_].sequence.load(std::memory_order_acquire);
+    if (sequence == 2 * pos) {
+      if (writer_.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+        *position = pos;
+        return true;
+      }
+    } else if (sequence < 2 * pos) {
+      // The record written capacity_ positions earlier hasn't been read.
+      const uint64_t current = writer_.load(std::memory_order_relaxed);
+      if (current == pos) {
+        return false;
+      }
+      pos = current;
+    } else {
+      // Another writer took the slot at pos.
+      pos = writer_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void BlobsQueue::doRead(uint64_t position, const std::vector<Blob*>& inputs) {
+  auto& slot = queue_[position % capacity_];
+  auto& result = slot.blobs;
+  for (auto i = 0; i < result.size(); ++i) {
+    auto bytes = BlobStat::sizeBytes(*result[i]);
+    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+    using std::swap;
+    swap(*(inputs[i]), *(result[i]));
+  }
+  slot.sequence.store(
+      2 * (position + capacity_), std::memory_order_release);
 }
 
-void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
-  auto& result = queue_[writer_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
+void BlobsQueue::doWrite(uint64_t position, const std::vector<Blob*>& inputs) {
+  auto& slot = queue_[position % capacity_];
+  auto& result = slot.blobs;
   const auto& name = name_.c_str();
   for (auto i = 0; i < result.size(); ++i) {
     using std::swap;
     swap(*(inputs[i]), *(result[i]));
   }
-  CAFFE_SDT(
-      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
-  ++writer_;
-  cv_.notify_all();
+  slot.sequence.store(2 * position + 1, std::memory_order_release);
+  notifyReaders();
+  CAFFE_SDT(queue_write_end, name, (void*)this, capacity_ - size());
+  CAFFE_EVENT(stats_, queue_enqueued_records);
+  CAFFE_EVENT(stats_, queue_size, size());
 }
 
 } // namespace caffe2
@@ -20,6 +20,13 @@ namespace caffe2 {
 // Containing blobs are owned by the workspace.
 // On read, we swap out the underlying data for the blob passed in for blobs
 
+// Readers and writers don't share a lock: every slot of the buffer carries a
+// sequence number that tells whether it holds a record for the reader at
+// that position or is free for the writer at that position, and readers and
+// writers claim positions with a compare-and-swap on their counter. A thread
+// that can't proceed spins for a while before it blocks on a condition
+// variable, which the other side only signals when someone is waiting.
+
 class BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
  public:
   BlobsQueue(
@@ -37,25 +44,82 @@ class BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   bool blockingRead(
       const std::vector<Blob*>& inputs,
       float timeout_secs = 0.0f);
+  // Reads up to records.size() records, records[i] receiving the i-th. Waits
+  // like blockingRead until at least one record is available and then takes
+  // all available ones (up to records.size()) at once. Returns the number of
+  // records read, 0 if the queue was closed or the read timed out.
+  size_t blockingReadMany(
+      const std::vector<std::vector<Blob*>>& records,
+      float timeout_secs = 0.0f);
   bool tryWrite(const std::vector<Blob*>& inputs);
   bool blockingWrite(const std::vector<Blob*>& inputs);
   void close();
   size_t getNumBlobs() const {
     return numBlobs_;
   }
+  // The number of records in the queue. Only a snapshot when other threads
+  // are using the queue.
+  size_t size() const;
 
  private:
-  bool canWrite();
-  void doWrite(const std::vector<Blob*>& inputs);
+  struct Slot {
+    // 2 * pos + 1 if the slot holds the record at position pos, 2 * pos if it
+    // is free for the write at position pos.
+    std::atomic<uint64_t> sequence;
+    std::vector<Blob*> blobs;
+  };
+
+  // Claims up to maxRecords consecutive records (at least one) for reading
+  // and returns the position of the first one, with *numRecords set to their
+  // number. Returns false if the queue is empty.
+  bool tryClaimRead(size_t maxRecords, uint64_t* position, size_t* numRecords);
+  bool tryClaimWrite(uint64_t* position);
+  void doRead(uint64_t position, const std::vector<Blob*>& inputs);
+  void doWrite(uint64_t position, const std::vector<Blob*>& inputs);
+
+  // Reads up to maxRecords records, the i-th into getInputs(i).
+  template <typename GetInputs>
+  size_t read(
+      size_t maxRecords,
+      const GetInputs& getInputs,
+      float timeout_secs);
+
+  // Calls tryClaim until it returns true, first spinning and then blocking
+  // on cv (with `waiting` counting the threads blocked on it). Returns false
+  // if the queue is closed or timeout_secs (if positive) pass first, and sets
+  // *blocked if it had to block.
+  template <typename TryClaim>
+  bool waitToClaim(
+      TryClaim tryClaim,
+      std::condition_variable& cv,
+      std::atomic<int>& waiting,
+      float timeout_secs,
+      bool* blocked);
+
+  // Wakes up readers (writers) blocked in waitToClaim, if any.
+  void notifyReaders();
+  void notifyWriters();
 
   std::atomic<bool> closing_{false};
 
   size_t numBlobs_;
-  std::mutex mutex_; // protects all variables in the class.
-  std::condition_variable cv_;
-  int64_t reader_{0};
-  int64_t writer_{0};
-  std::vector<std::vector<Blob*>> queue_;
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> queue_;
+  // Keep the counters on their own cache lines: every reader and writer
+  // updates one of them.
+  char padding0_[64];
+  std::atomic<uint64_t> reader_{0};
+  char padding1_[64];
+  std::atomic<uint64_t> writer_{0};
+  char padding2_[64];
+
+  // Only used to block and wake up threads that can't proceed.
+  std::mutex mutex_;
+  std::condition_variable readersCv_;
+  std::condition_variable writersCv_;
+  std::atomic<int> waitingReaders_{0};
+  std::atomic<int> waitingWriters_{0};
+
   const std::string name_;
 
   struct QueueStats {
@@ -65,6 +129,13 @@ class BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
     CAFFE_DETAILED_EXPORTED_STAT(queue_dequeued_bytes);
     CAFFE_AVG_EXPORTED_STAT(read_time_ns);
     CAFFE_AVG_EXPORTED_STAT(write_time_ns);
+    CAFFE_EXPORTED_STAT(queue_enqueued_records);
+    CAFFE_STATIC_STAT(queue_size);
+    // Number of reads (writes) that found the queue empty (full) after
+    // spinning and had to block.
+    CAFFE_EXPORTED_STAT(read_blocked);
+    CAFFE_EXPORTED_STAT(write_blocked);
+    CAFFE_AVG_EXPORTED_STAT(dequeue_batch_records);
   } stats_;
 };
 } // namespace caffe2
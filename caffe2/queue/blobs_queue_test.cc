@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/blob.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/queue/blobs_queue.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+void SetValue(Blob* blob, int64_t value) {
+  auto* tensor = blob->GetMutableTensor(CPU);
+  tensor->Resize(1);
+  *tensor->mutable_data<int64_t>() = value;
+}
+
+int64_t GetValue(const Blob& blob) {
+  return *blob.Get<TensorCPU>().data<int64_t>();
+}
+
+bool Write(BlobsQueue* queue, int64_t value) {
+  Blob blob;
+  SetValue(&blob, value);
+  return queue->blockingWrite({&blob});
+}
+
+} // namespace
+
+TEST(BlobsQueueTest, ReadsInWriteOrder) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 4, 1, true);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(Write(queue.get(), i));
+  }
+  EXPECT_EQ(queue->size(), 3);
+  Blob blob;
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(queue->blockingRead({&blob}));
+    EXPECT_EQ(GetValue(blob), i);
+  }
+  EXPECT_EQ(queue->size(), 0);
+}
+
+TEST(BlobsQueueTest, TryWriteFailsWhenFull) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 2, 1, true);
+  Blob blob;
+  SetValue(&blob, 0);
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+  SetValue(&blob, 1);
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+  SetValue(&blob, 2);
+  EXPECT_FALSE(queue->tryWrite({&blob}));
+  EXPECT_TRUE(queue->blockingRead({&blob}));
+  EXPECT_EQ(GetValue(blob), 0);
+  SetValue(&blob, 2);
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+}
+
+TEST(BlobsQueueTest, ReadTimesOut) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 2, 1, true);
+  Blob blob;
+  EXPECT_FALSE(queue->blockingRead({&blob}, 0.05));
+}
+
+TEST(BlobsQueueTest, CloseWakesUpBlockedThreads) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 1, 1, true);
+  EXPECT_TRUE(Write(queue.get(), 0));
+  std::thread writer([&] { EXPECT_FALSE(Write(queue.get(), 1)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  queue->close();
+  writer.join();
+
+  // Records written before closing can still be read, after that reads fail.
+  Blob blob;
+  EXPECT_TRUE(queue->blockingRead({&blob}));
+  EXPECT_EQ(GetValue(blob), 0);
+  EXPECT_FALSE(queue->blockingRead({&blob}));
+}
+
+TEST(BlobsQueueTest, ReadManyTakesAvailableRecords) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 8, 1, true);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(Write(queue.get(), i));
+  }
+  std::vector<Blob> blobs(5);
+  std::vector<std::vector<Blob*>> records;
+  for (auto& blob : blobs) {
+    records.push_back({&blob});
+  }
+  EXPECT_EQ(queue->blockingReadMany(records), 3);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(GetValue(blobs[i]), i);
+  }
+  queue->close();
+  EXPECT_EQ(queue->blockingReadMany(records), 0);
+}
+
+TEST(BlobsQueueTest, ConcurrentProducersAndConsumers) {
+  const int kProducers = 8;
+  const int kConsumers = 4;
+  const int64_t kRecordsPerProducer = 2000;
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 16, 1, true);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (int64_t i = 0; i < kRecordsPerProducer; ++i) {
+        EXPECT_TRUE(Write(queue.get(), p * kRecordsPerProducer + i));
+      }
+    });
+  }
+  std::vector<std::vector<int64_t>> consumed(kConsumers);
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kConsumers; ++c) {
+    consumers.emplace_back([&, c] {
+      std::vector<Blob> blobs(3);
+      std::vector<std::vector<Blob*>> records;
+      for (auto& blob : blobs) {
+        records.push_back({&blob});
+      }
+      while (true) {
+        // Alternate between single and batched reads.
+        size_t read = consumed[c].size() % 2
+            ? queue->blockingReadMany(records)
+            : queue->blockingRead(records[0]);
+        if (read == 0) {
+          break;
+        }
+        for (size_t r = 0; r < read; ++r) {
+          consumed[c].push_back(GetValue(blobs[r]));
+        }
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  queue->close();
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+
+  std::vector<int64_t> all;
+  for (const auto& values : consumed) {
+    // Every producer's records are read in the order it wrote them.
+    std::vector<int64_t> last(kProducers, -1);
+    for (auto value : values) {
+      const auto producer = value / kRecordsPerProducer;
+      EXPECT_GT(value, last[producer]);
+      last[producer] = value;
+    }
+    all.insert(all.end(), values.begin(), values.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(all.size(), kProducers * kRecordsPerProducer);
+  for (int64_t i = 0; i < all.size(); ++i) {
+    EXPECT_EQ(all[i], i);
+  }
+}
+
+TEST(BlobsQueueTest, SafeDequeueConcatenatesRecords) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 8, 1, true);
+  *ws.CreateBlob("queue_ptr")->GetMutable<std::shared_ptr<BlobsQueue>>() =
+      queue;
+  for (int64_t i = 0; i < 3; ++i) {
+    Blob blob;
+    auto* tensor = blob.GetMutableTensor(CPU);
+    tensor->Resize(i + 1, 2);
+    auto* data = tensor->mutable_data<float>();
+    for (int j = 0; j < tensor->size(); ++j) {
+      data[j] = i;
+    }
+    EXPECT_TRUE(queue->blockingWrite({&blob}));
+  }
+  queue->close();
+
+  auto op = CreateOperator(
+      CreateOperatorDef(
+          "SafeDequeueBlobs",
+          "",
+          {"queue_ptr"},
+          {"out", "status"},
+          {MakeArgument<int>("num_records", 5)}),
+      &ws);
+  EXPECT_TRUE(op->Run());
+  const auto& out = ws.GetBlob("out")->Get<TensorCPU>();
+  EXPECT_EQ(out.dims(), std::vector<TIndex>({6, 2}));
+  const float expected[] = {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2};
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(out.data<float>()[i], expected[i]);
+  }
+  EXPECT_FALSE(*ws.GetBlob("status")->Get<TensorCPU>().data<bool>());
+}
+
+} // namespace caffe2
@@ -127,45 +127,75 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
     CAFFE_ENFORCE_GT(numRecords_, 0);
   }
 
+  // Reads numRecords_ records, taking as many as are available at once, and
+  // concatenates them along the first dimension.
   bool dequeueMany(std::shared_ptr<BlobsQueue>& queue) {
     auto size = queue->getNumBlobs();
 
-    if (blobs_.size() != size) {
-      blobs_.resize(size);
-      blobPtrs_.resize(size);
-      for (int col = 0; col < size; ++col) {
-        blobPtrs_.at(col) = &blobs_.at(col);
+    if (blobs_.size() != numRecords_ || blobs_[0].size() != size) {
+      blobs_.resize(numRecords_);
+      blobPtrs_.resize(numRecords_);
+      for (int record = 0; record < numRecords_; ++record) {
+        blobs_[record].resize(size);
+        blobPtrs_[record].resize(size);
+        for (int col = 0; col < size; ++col) {
+          blobPtrs_[record][col] = &blobs_[record][col];
+        }
+      }
+    }
+
+    size_t numRead = 0;
+    while (numRead < numRecords_) {
+      const size_t read = numRead == 0
+          ? queue->blockingReadMany(blobPtrs_)
+          : queue->blockingReadMany(std::vector<std::vector<Blob*>>(
+                blobPtrs_.begin() + numRead, blobPtrs_.end()));
+      if (read == 0) {
+        break;
       }
+      numRead += read;
+    }
+    // if we read at least one record, status is still true
+    if (numRead == 0) {
+      return false;
     }
 
-    const int kTensorGrowthPct = 40;
-    for (int i = 0; i < numRecords_; ++i) {
-      if (!queue->blockingRead(blobPtrs_)) {
-        // if we read at least one record, status is still true
-        return i > 0;
+    for (int col = 0; col < size; ++col) {
+      auto* out = this->Output(col);
+      const auto& first = blobPtrs_[0][col]->template Get<Tensor>();
+      if (numRead == 1) {
+        out->CopyFrom(first);
+        continue;
       }
-      for (int col = 0; col < size; ++col) {
-        auto* out = this->Output(col);
-        const auto& in = blobPtrs_.at(col)->template Get<Tensor>();
-        if (i == 0) {
-          out->CopyFrom(in);
-        } else {
-          auto oldSize = out->size();
-
-          CAFFE_ENFORCE(
-              in.ndim() > 0,
-              "Empty tensor to dequeue at column ",
-              col,
-              " within ",
-              size,
-              " total columns");
-
-          out->Extend(in.dims()[0], kTensorGrowthPct, &context_);
-          auto* dst =
-              (char*)out->raw_mutable_data() + oldSize * in.meta().itemsize();
-          context_.template CopyItems<Context, Context>(
-              in.meta(), in.size(), in.raw_data(), dst);
+      auto dims = first.dims();
+      TIndex outer = 0;
+      for (size_t record = 0; record < numRead; ++record) {
+        const auto& in = blobPtrs_[record][col]->template Get<Tensor>();
+        CAFFE_ENFORCE(
+            in.ndim() > 0,
+            "Empty tensor to dequeue at column ",
+            col,
+            " within ",
+            size,
+            " total columns");
+        CAFFE_ENFORCE(
+            in.meta() == first.meta(),
+            "Records of different types at column ",
+            col);
+        CAFFE_ENFORCE_EQ(in.ndim(), first.ndim());
+        for (int d = 1; d < in.ndim(); ++d) {
+          CAFFE_ENFORCE_EQ(in.dim(d), first.dim(d));
         }
+        outer += in.dim(0);
+      }
+      dims[0] = outer;
+      out->Resize(dims);
+      auto* dst = static_cast<char*>(out->raw_mutable_data(first.meta()));
+      for (size_t record = 0; record < numRead; ++record) {
+        const auto& in = blobPtrs_[record][col]->template Get<Tensor>();
+        context_.template CopyItems<Context, Context>(
+            in.meta(), in.size(), in.raw_data(), dst);
+        dst += in.nbytes();
       }
     }
     return true;
@@ -194,8 +224,8 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
 
  private:
   int numRecords_;
-  std::vector<Blob> blobs_;
-  std::vector<Blob*> blobPtrs_;
+  std::vector<std::vector<Blob>> blobs_;
+  std::vector<std::vector<Blob*>> blobPtrs_;
 };
 
 template <typename Context>
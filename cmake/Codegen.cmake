@@ -94,10 +94,18 @@ if (BUILD_ATEN)
     IF(MSVC)
       LIST(APPEND CPU_CAPABILITY_FLAGS "${MSVC_OPT_FLAG}/arch:AVX2")
     ELSE(MSVC)
-      LIST(APPEND CPU_CAPABILITY_FLAGS "-O3 -mavx2 -mfma")
+      LIST(APPEND CPU_CAPABILITY_FLAGS "-O3 -mavx2 -mfma -mf16c")
     ENDIF(MSVC)
   ENDIF(CXX_AVX2_FOUND)
 
+  # MSVC is excluded in FindSSE.cmake: the AVX512 Vec256 specializations
+  # rely on SLEEF, which is not used on Windows.
+  IF(CXX_AVX512_FOUND)
+    SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_CPU_DEFINITION")
+    LIST(APPEND CPU_CAPABILITY_NAMES "AVX512")
+    LIST(APPEND CPU_CAPABILITY_FLAGS "-O3 ${CXX_AVX512_FLAGS}")
+  ENDIF(CXX_AVX512_FOUND)
+
   list(LENGTH CPU_CAPABILITY_NAMES NUM_CPU_CAPABILITY_NAMES)
   math(EXPR NUM_CPU_CAPABILITY_NAMES "${NUM_CPU_CAPABILITY_NAMES}-1")
 
@@ -759,6 +759,7 @@ if (USE_ZSTD)
   include_directories(SYSTEM ${CMAKE_CURRENT_LIST_DIR}/../third_party/zstd/lib)
   add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/../third_party/zstd/build/cmake)
   set_property(TARGET libzstd_static PROPERTY POSITION_INDEPENDENT_CODE ON)
+  set(CAFFE2_USE_ZSTD 1)
 endif()
 
 # ---[ Onnx
@@ -1066,7 +1067,7 @@ if (BUILD_ATEN)
     add_compile_options(-DUSE_GCC_GET_CPUID)
   ENDIF()
 
-  FIND_PACKAGE(SSE) # checks SSE, AVX and AVX2
+  FIND_PACKAGE(SSE) # checks SSE, AVX, AVX2 and AVX512
   IF (C_SSE2_FOUND)
     MESSAGE(STATUS "SSE2 Found")
     # TODO: Work out correct way to do this.  Note that C_SSE2_FLAGS is often
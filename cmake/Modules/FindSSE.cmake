@@ -79,6 +79,20 @@ SET(AVX2_CODE "
   }
 ")
 
+SET(AVX512_CODE "
+  #include <immintrin.h>
+
+  int main()
+  {
+    __m512 a = _mm512_set1_ps(0);
+    __m512d b = _mm512_set1_pd(0);
+    __mmask16 m = _mm512_cmp_ps_mask(a, a, _CMP_EQ_OQ);
+    a = _mm512_maskz_loadu_ps(m, &b);
+    b = _mm512_roundscale_pd(b, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    return 0;
+  }
+")
+
 MACRO(CHECK_SSE lang type flags)
   SET(__FLAG_I 1)
   SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
@@ -123,3 +137,20 @@ CHECK_SSE(CXX "SSE4_1" " ;-msse4.1;-msse4;/arch:SSE4")
 CHECK_SSE(CXX "SSE4_2" " ;-msse4.2;-msse4;/arch:SSE4")
 CHECK_SSE(CXX "AVX" " ;-mavx;/arch:AVX")
 CHECK_SSE(CXX "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
+
+# Code for AVX512 is only ever selected at runtime (see
+# ATen/native/DispatchStub.cpp), so unlike the checks above the build machine
+# does not need to be able to run it; the compiler only has to accept it.
+INCLUDE(CheckCXXSourceCompiles)
+SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
+SET(CMAKE_REQUIRED_FLAGS "-mavx512f -mavx512dq -mavx512bw -mavx512vl -mfma")
+CHECK_CXX_SOURCE_COMPILES("${AVX512_CODE}" CXX_HAS_AVX512_1)
+SET(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_SAVE})
+IF(CXX_HAS_AVX512_1 AND NOT MSVC)
+  SET(CXX_AVX512_FOUND TRUE CACHE BOOL "CXX AVX512 support")
+  SET(CXX_AVX512_FLAGS "-mavx512f -mavx512dq -mavx512bw -mavx512vl -mfma" CACHE STRING "CXX AVX512 flags")
+ELSE()
+  SET(CXX_AVX512_FOUND FALSE CACHE BOOL "CXX AVX512 support")
+  SET(CXX_AVX512_FLAGS "" CACHE STRING "CXX AVX512 flags")
+ENDIF()
+MARK_AS_ADVANCED(CXX_AVX512_FOUND CXX_AVX512_FLAGS)
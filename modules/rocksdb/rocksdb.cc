@@ -40,6 +40,10 @@ class RocksDBCursor : public Cursor {
   void Next() override { iter_->Next(); }
   string key() override { return iter_->key().ToString(); }
   string value() override { return iter_->value().ToString(); }
+  ValueView valueView() override {
+    rocksdb::Slice value = iter_->value();
+    return ValueView{value.data(), value.size()};
+  }
   bool Valid() override { return iter_->Valid(); }
 
  private:
@@ -101,6 +105,9 @@ class RocksDB : public DB {
   unique_ptr<Transaction> NewTransaction() override {
     return make_unique<RocksDBTransaction>(db_.get());
   }
+  bool SupportsConcurrentCursors() const override {
+    return true;
+  }
 
  private:
   std::unique_ptr<rocksdb::DB> db_;
@@ -817,7 +817,10 @@ if USE_DISTRIBUTED:
 
 if USE_C10D:
     extra_compile_args += ['-DUSE_C10D']
-    main_sources += ['torch/csrc/distributed/c10d/init.cpp']
+    main_sources += [
+        'torch/csrc/distributed/c10d/init.cpp',
+        'torch/csrc/distributed/c10d/reducer.cpp',
+    ]
     main_link_args += [C10D_LIB]
 
 if USE_CUDA:
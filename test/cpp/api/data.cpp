@@ -0,0 +1,356 @@
+#include <catch.hpp>
+
+#include <torch/data.h>
+#include <torch/serialization.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <ATen/Error.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace torch::data;
+
+using Catch::StartsWith;
+
+namespace {
+/// A dataset whose examples are their own index.
+struct RangeDataset : datasets::Dataset<torch::Tensor> {
+  explicit RangeDataset(size_t size) : size_(size) {}
+
+  torch::Tensor get(size_t index) override {
+    return torch::full({1}, static_cast<double>(index), torch::kInt64);
+  }
+
+  size_t size() const override {
+    return size_;
+  }
+
+  size_t size_;
+};
+
+std::vector<int64_t> to_vector(const torch::Tensor& batch) {
+  const at::Tensor values = batch.contiguous().view(-1);
+  const int64_t* data = values.data<int64_t>();
+  return std::vector<int64_t>(data, data + values.numel());
+}
+
+/// Returns the examples of every batch an iteration over `loader` produces.
+template <typename Loader>
+std::vector<std::vector<int64_t>> collect(Loader& loader) {
+  std::vector<std::vector<int64_t>> batches;
+  for (auto& batch : loader) {
+    batches.push_back(to_vector(batch));
+  }
+  return batches;
+}
+
+std::vector<int64_t> flatten(const std::vector<std::vector<int64_t>>& batches) {
+  std::vector<int64_t> values;
+  for (const auto& batch : batches) {
+    values.insert(values.end(), batch.begin(), batch.end());
+  }
+  return values;
+}
+
+std::vector<int64_t> iota(size_t size) {
+  std::vector<int64_t> values(size);
+  std::iota(values.begin(), values.end(), 0);
+  return values;
+}
+
+void write_int32(std::ofstream& stream, uint32_t value) {
+  const char bytes[4] = {char(value >> 24), char(value >> 16), char(value >> 8),
+                         char(value)};
+  stream.write(bytes, sizeof(bytes));
+}
+
+/// Writes `count` images of `rows` by `columns` pixels and their labels in
+/// the MNIST file format. Pixel `p` of image `i` has the value `(i + p) % 256`
+/// and image `i` is labeled `i % 10`.
+std::string write_mnist(size_t count, uint32_t rows, uint32_t columns) {
+  char directory[] = "/tmp/mnist_XXXXXX";
+  REQUIRE(mkdtemp(directory) != nullptr);
+  std::ofstream images(
+      std::string(directory) + "/train-images-idx3-ubyte", std::ios::binary);
+  write_int32(images, 2051);
+  write_int32(images, count);
+  write_int32(images, rows);
+  write_int32(images, columns);
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t p = 0; p < rows * columns; ++p) {
+      images.put(static_cast<char>((i + p) % 256));
+    }
+  }
+  std::ofstream labels(
+      std::string(directory) + "/train-labels-idx1-ubyte", std::ios::binary);
+  write_int32(labels, 2049);
+  write_int32(labels, count);
+  for (size_t i = 0; i < count; ++i) {
+    labels.put(static_cast<char>(i % 10));
+  }
+  return directory;
+}
+
+void remove_mnist(const std::string& directory) {
+  std::remove((directory + "/train-images-idx3-ubyte").c_str());
+  std::remove((directory + "/train-labels-idx1-ubyte").c_str());
+  std::remove(directory.c_str());
+}
+} // namespace
+
+TEST_CASE("data/samplers") {
+  SECTION("sequential") {
+    samplers::SequentialSampler sampler(5);
+    REQUIRE(*sampler.next(2) == std::vector<size_t>({0, 1}));
+    REQUIRE(*sampler.next(2) == std::vector<size_t>({2, 3}));
+    REQUIRE(*sampler.next(2) == std::vector<size_t>({4}));
+    REQUIRE(!sampler.next(2));
+    sampler.reset();
+    REQUIRE(sampler.index() == 0);
+    sampler.seek(3);
+    REQUIRE(*sampler.next(5) == std::vector<size_t>({3, 4}));
+    REQUIRE_THROWS_WITH(sampler.seek(6), StartsWith("Cannot seek"));
+  }
+  SECTION("random/permutation") {
+    samplers::RandomSampler sampler(100, 7);
+    auto indices = *sampler.next(100);
+    REQUIRE(!sampler.next(1));
+    std::vector<size_t> sorted(indices);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<size_t> expected(100);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(sorted == expected);
+    REQUIRE(indices != expected);
+
+    sampler.reset();
+    REQUIRE(sampler.epoch() == 1);
+    REQUIRE(*sampler.next(100) != indices);
+
+    samplers::RandomSampler same_seed(100, 7);
+    REQUIRE(*same_seed.next(100) == indices);
+  }
+  SECTION("random/portable") {
+    // The permutation only depends on the seed and the epoch, not on the
+    // standard library, so that checkpoints resume the same way everywhere.
+    samplers::RandomSampler sampler(10, 7);
+    REQUIRE(
+        *sampler.next(10) ==
+        std::vector<size_t>({9, 2, 7, 4, 8, 3, 6, 5, 0, 1}));
+  }
+  SECTION("random/default_seed") {
+    torch::manual_seed(123);
+    samplers::RandomSampler first(50);
+    torch::manual_seed(123);
+    samplers::RandomSampler second(50);
+    REQUIRE(*first.next(50) == *second.next(50));
+  }
+  SECTION("random/serialization") {
+    samplers::RandomSampler sampler(20, 3);
+    sampler.reset();
+    sampler.next(8);
+
+    std::stringstream stream;
+    torch::save(stream, &sampler);
+    samplers::RandomSampler restored(20, 0);
+    torch::load(stream, &restored);
+
+    REQUIRE(restored.epoch() == 1);
+    REQUIRE(restored.index() == 8);
+    REQUIRE(*restored.next(20) == *sampler.next(20));
+
+    samplers::RandomSampler wrong_size(21, 3);
+    std::stringstream other;
+    torch::save(other, &sampler);
+    REQUIRE_THROWS_WITH(
+        torch::load(other, &wrong_size), StartsWith("Loaded the state"));
+  }
+}
+
+TEST_CASE("data/datasets") {
+  SECTION("tensor") {
+    datasets::TensorDataset dataset(
+        torch::randn({5, 3}), torch::arange(5, torch::kInt64));
+    REQUIRE(dataset.size() == 5);
+    auto example = dataset.get(3);
+    REQUIRE(example.data.sizes().vec() == std::vector<int64_t>({3}));
+    REQUIRE(example.target.toCLong() == 3);
+    REQUIRE_THROWS_WITH(
+        datasets::TensorDataset(torch::randn({5, 3}), torch::randn({4})),
+        StartsWith("TensorDataset needs as many targets as examples"));
+  }
+  SECTION("mnist") {
+    const auto directory = write_mnist(12, 4, 3);
+    datasets::MNIST dataset(directory);
+    REQUIRE(dataset.size() == 12);
+    REQUIRE(
+        dataset.images().sizes().vec() == std::vector<int64_t>({12, 1, 4, 3}));
+    auto example = dataset.get(5);
+    REQUIRE(example.target.toCLong() == 5);
+    REQUIRE(example.data[0][1][2].toCFloat() == Approx((5 + 5) / 255.0));
+    REQUIRE_THROWS_WITH(
+        datasets::MNIST(directory, datasets::MNIST::Mode::kTest),
+        StartsWith("Error opening images file"));
+    remove_mnist(directory);
+  }
+}
+
+TEST_CASE("data/data_loader") {
+  SECTION("collates batches") {
+    auto dataset = datasets::TensorDataset(
+        torch::randn({10, 3, 2}), torch::arange(10, torch::kInt64));
+    auto loader = make_data_loader(
+        dataset, samplers::SequentialSampler(10), DataLoaderOptions(4));
+    std::vector<int64_t> sizes;
+    for (auto& batch : *loader) {
+      sizes.push_back(batch.data.size(0));
+      REQUIRE(batch.data.size(1) == 3);
+      REQUIRE(batch.target.size(0) == batch.data.size(0));
+      for (int64_t i = 0; i < batch.data.size(0); ++i) {
+        const auto index = batch.target[i].toCLong();
+        REQUIRE(batch.data[i].equal(dataset.get(index).data));
+      }
+    }
+    REQUIRE(sizes == std::vector<int64_t>({4, 4, 2}));
+  }
+  SECTION("synchronous and with workers") {
+    for (size_t workers : {0, 1, 3}) {
+      auto loader = make_data_loader(
+          RangeDataset(50),
+          samplers::SequentialSampler(50),
+          DataLoaderOptions(7).workers(workers));
+      auto batches = collect(*loader);
+      REQUIRE(batches.size() == 8);
+      REQUIRE(flatten(batches) == iota(50));
+      // The next iteration is a new epoch.
+      REQUIRE(flatten(collect(*loader)) == iota(50));
+    }
+  }
+  SECTION("drop_last") {
+    auto loader = make_data_loader(
+        RangeDataset(10),
+        samplers::SequentialSampler(10),
+        DataLoaderOptions(4).workers(2).drop_last(true));
+    REQUIRE(collect(*loader).size() == 2);
+  }
+  SECTION("unordered") {
+    auto loader = make_data_loader(
+        RangeDataset(100),
+        DataLoaderOptions(3).workers(4).enforce_ordering(false));
+    auto values = flatten(collect(*loader));
+    std::sort(values.begin(), values.end());
+    REQUIRE(values == iota(100));
+  }
+  SECTION("rethrows exceptions of workers in order") {
+    struct Failing : RangeDataset {
+      using RangeDataset::RangeDataset;
+      torch::Tensor get(size_t index) override {
+        AT_CHECK(index != 5, "Bad example");
+        return RangeDataset::get(index);
+      }
+    };
+    auto loader = make_data_loader(
+        Failing(10),
+        samplers::SequentialSampler(10),
+        DataLoaderOptions(2).workers(2));
+    auto iterator = loader->begin();
+    ++iterator;
+    REQUIRE_THROWS_WITH(++iterator, StartsWith("Bad example"));
+  }
+  SECTION("timeout") {
+    struct Slow : RangeDataset {
+      using RangeDataset::RangeDataset;
+      torch::Tensor get(size_t index) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return RangeDataset::get(index);
+      }
+    };
+    auto loader = make_data_loader(
+        Slow(2),
+        samplers::SequentialSampler(2),
+        DataLoaderOptions(1).workers(1).timeout(std::chrono::milliseconds(10)));
+    REQUIRE_THROWS_WITH(loader->begin(), StartsWith("Timeout"));
+  }
+  SECTION("continues an abandoned epoch") {
+    auto loader = make_data_loader(
+        RangeDataset(30),
+        samplers::SequentialSampler(30),
+        DataLoaderOptions(5).workers(2).max_jobs(4));
+    std::vector<int64_t> values;
+    for (auto& batch : *loader) {
+      values.push_back(batch[0].toCLong());
+      if (values.size() == 2) {
+        break;
+      }
+    }
+    // Batches that were prefetched but not returned are loaded again.
+    auto rest = collect(*loader);
+    REQUIRE(rest.size() == 4);
+    REQUIRE(rest.front().front() == 10);
+    REQUIRE(flatten(collect(*loader)) == iota(30));
+  }
+  SECTION("resumes from a checkpoint") {
+    auto make_loader = [] {
+      return make_data_loader(
+          RangeDataset(40),
+          samplers::RandomSampler(40, 11),
+          DataLoaderOptions(4).workers(3));
+    };
+    auto expected = collect(*make_loader());
+
+    auto loader = make_loader();
+    std::stringstream stream;
+    std::vector<std::vector<int64_t>> seen;
+    for (auto& batch : *loader) {
+      seen.push_back(to_vector(batch));
+      if (seen.size() == 3) {
+        torch::save(stream, loader);
+        break;
+      }
+    }
+
+    auto resumed = make_loader();
+    torch::load(stream, resumed);
+    for (auto& batch : collect(*resumed)) {
+      seen.push_back(batch);
+    }
+    REQUIRE(seen == expected);
+  }
+}
+
+TEST_CASE("data/benchmark", "[.benchmark]") {
+  const size_t kImages = 20000;
+  const auto directory = write_mnist(kImages, 28, 28);
+  datasets::MNIST dataset(directory);
+  remove_mnist(directory);
+
+  for (size_t workers : {0, 1, 2, 4}) {
+    for (bool ordered : {true, false}) {
+      auto loader = make_data_loader(
+          dataset,
+          DataLoaderOptions(64).workers(workers).enforce_ordering(ordered));
+      const auto start = std::chrono::steady_clock::now();
+      size_t examples = 0;
+      for (auto& batch : *loader) {
+        examples += batch.data.size(0);
+      }
+      const std::chrono::duration<double> seconds =
+          std::chrono::steady_clock::now() - start;
+      REQUIRE(examples == kImages);
+      std::cout << "workers=" << workers << " ordered=" << ordered << ": "
+                << examples / seconds.count() << " examples/s\n";
+    }
+  }
+}
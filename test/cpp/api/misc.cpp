@@ -7,10 +7,15 @@
 #include <torch/tensor.h>
 #include <torch/utils.h>
 
+#include <torch/csrc/autograd/engine.h>
+#include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/utils/memory.h>
 
 #include <ATen/optional.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace torch::nn;
 
 template <typename T>
@@ -50,6 +55,148 @@ TEST_CASE("autograd") {
   // Assume everything else is safe from PyTorch tests.
 }
 
+TEST_CASE("autograd/multiple-cpu-workers") {
+  // Worker threads are detached and keep a pointer to their engine, so the
+  // engine is intentionally leaked.
+  static auto* engine = new torch::autograd::Engine();
+  engine->set_num_cpu_threads(4);
+  REQUIRE_THROWS(engine->set_num_cpu_threads(0));
+
+  torch::manual_seed(0);
+  auto x = torch::randn({16, 16}, torch::requires_grad());
+  auto w = torch::randn({16, 16}, torch::requires_grad());
+  auto make_loss = [&]() -> torch::Tensor {
+    // Many independent branches that all end in the AccumulateGrad of x and w.
+    std::vector<at::Tensor> branches;
+    for (int i = 0; i < 32; i++) {
+      branches.push_back(x.mm(w * (i + 1)).tanh().sum());
+    }
+    return torch::stack(branches).sum();
+  };
+
+  auto loss = make_loss();
+  loss.backward();
+  auto expected_x = x.grad().clone();
+  auto expected_w = w.grad().clone();
+  x.grad().zero_();
+  w.grad().zero_();
+
+  for (int iteration = 0; iteration < 10; iteration++) {
+    loss = make_loss();
+    engine->execute(
+        {loss.gradient_edge()},
+        {torch::ones({})},
+        /*keep_graph=*/false,
+        /*create_graph=*/false);
+  }
+  REQUIRE(x.grad().allclose(expected_x * 10));
+  REQUIRE(w.grad().allclose(expected_w * 10));
+
+  REQUIRE_THROWS(engine->set_num_cpu_threads(2));
+}
+
+TEST_CASE("autograd/multiple-cpu-workers/reentrant") {
+  static auto* engine = new torch::autograd::Engine();
+  engine->set_num_cpu_threads(4);
+
+  // A function whose apply() runs backward through itself once more.
+  struct Reentrant : torch::autograd::Function {
+    using torch::autograd::Function::Function;
+    torch::autograd::variable_list apply(
+        torch::autograd::variable_list&& grads) override {
+      if (depth++ == 0) {
+        engine->execute(
+            {torch::autograd::Edge(shared_from_this(), 0)},
+            {grads[0]},
+            /*keep_graph=*/true,
+            /*create_graph=*/false);
+      }
+      depth--;
+      return {grads[0]};
+    }
+    int depth = 0;
+  };
+
+  auto x = torch::randn({4}, torch::requires_grad());
+  auto fn = std::make_shared<Reentrant>(
+      torch::autograd::edge_list{x.gradient_edge()});
+  fn->add_input_metadata(x.type(), x.sizes());
+
+  engine->execute(
+      {torch::autograd::Edge(fn, 0)},
+      {torch::ones({4})},
+      /*keep_graph=*/false,
+      /*create_graph=*/false);
+  REQUIRE(x.grad().allclose(torch::full({4}, 2)));
+}
+
+TEST_CASE("autograd/multiple-cpu-workers/mutually-reentrant") {
+  static auto* engine = new torch::autograd::Engine();
+  engine->set_num_cpu_threads(4);
+
+  // Two functions whose apply() each run backward through the other one.
+  // Both are started at once from two threads, so each nested backward
+  // needs the function that the other worker is in the middle of.
+  static std::atomic<int> started(0);
+  struct MutuallyReentrant : torch::autograd::Function {
+    using torch::autograd::Function::Function;
+    torch::autograd::variable_list apply(
+        torch::autograd::variable_list&& grads) override {
+      const auto self = std::this_thread::get_id();
+      // Only the thread running a function may enter it again.
+      if (depth > 0 && thread != self) {
+        entered_concurrently = true;
+      }
+      if (depth++ == 0) {
+        thread = self;
+        started++;
+        while (started < 2) {
+          std::this_thread::yield();
+        }
+        engine->execute(
+            {torch::autograd::Edge(other.lock(), 0)},
+            {grads[0]},
+            /*keep_graph=*/true,
+            /*create_graph=*/false);
+      }
+      depth--;
+      return {grads[0]};
+    }
+    std::weak_ptr<torch::autograd::Function> other;
+    std::thread::id thread;
+    int depth = 0;
+    bool entered_concurrently = false;
+  };
+
+  auto x = torch::randn({4}, torch::requires_grad());
+  auto y = torch::randn({4}, torch::requires_grad());
+  auto a = std::make_shared<MutuallyReentrant>(
+      torch::autograd::edge_list{x.gradient_edge()});
+  auto b = std::make_shared<MutuallyReentrant>(
+      torch::autograd::edge_list{y.gradient_edge()});
+  a->add_input_metadata(x.type(), x.sizes());
+  b->add_input_metadata(y.type(), y.sizes());
+  a->other = b;
+  b->other = a;
+
+  auto run = [](std::shared_ptr<torch::autograd::Function> fn) {
+    engine->execute(
+        {torch::autograd::Edge(fn, 0)},
+        {torch::ones({4})},
+        /*keep_graph=*/true,
+        /*create_graph=*/false);
+  };
+  std::thread t1(run, a);
+  std::thread t2(run, b);
+  t1.join();
+  t2.join();
+
+  REQUIRE(!a->entered_concurrently);
+  REQUIRE(!b->entered_concurrently);
+  REQUIRE(x.grad().allclose(torch::full({4}, 2)));
+  REQUIRE(y.grad().allclose(torch::full({4}, 2)));
+}
+
 TEST_CASE("nn::init") {
   auto tensor = torch::empty({3, 4}, torch::requires_grad());
   REQUIRE_THROWS_WITH(
@@ -164,6 +164,22 @@ TEST_CASE("rnn") {
       REQUIRE(std::abs(flat[i].toCFloat() - h_out[i]) < 1e-3);
     }
   }
+
+  SECTION("gru with different input and hidden sizes") {
+    GRU model(GRUOptions(4, 8).layers(2));
+    auto x = torch::randn({5, 3, 4}, torch::requires_grad());
+    auto out = model->forward(x);
+    REQUIRE(out.output.size(0) == 5);
+    REQUIRE(out.output.size(1) == 3);
+    REQUIRE(out.output.size(2) == 8);
+    REQUIRE(out.state.size(0) == 2);
+    REQUIRE(out.state.size(1) == 3);
+    REQUIRE(out.state.size(2) == 8);
+
+    out.output.sum().backward();
+    REQUIRE(x.grad().defined());
+    REQUIRE(x.grad().size(2) == 4);
+  }
 }
 
 TEST_CASE("rnn/integration/LSTM") {
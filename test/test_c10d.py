@@ -8,6 +8,7 @@ import unittest
 
 from functools import wraps
 from collections import namedtuple
+from datetime import timedelta
 
 import torch
 from torch import nn
@@ -98,6 +99,11 @@ class StoreTestBase(object):
     def test_set_get(self):
         self._test_set_get(self._create_store())
 
+    def test_multi_set_get(self):
+        fs = self._create_store()
+        fs.multi_set(["key0", "key1"], ["value0", "value1"])
+        self.assertEqual([b"value1", b"value0"], fs.multi_get(["key1", "key0"]))
+
 
 class FileStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -116,6 +122,24 @@ class TCPStoreTest(TestCase, StoreTestBase):
         port = find_free_port()
         return c10d.TCPStore(addr, port, True)
 
+    def test_compare_set(self):
+        store = self._create_store()
+        self.assertEqual(b"first", store.compare_set("key", "", "first"))
+        self.assertEqual(b"first", store.compare_set("key", "wrong", "second"))
+        self.assertEqual(b"second", store.compare_set("key", "first", "second"))
+        self.assertEqual(b"", store.compare_set("missing", "value", "x"))
+
+    def test_watch(self):
+        store = self._create_store()
+        store.set("key", "value0")
+        self.assertEqual(b"value0", store.watch("key", "old"))
+        with self.assertRaises(RuntimeError):
+            store.watch("key", "value0", timeout=timedelta(milliseconds=100))
+        # The reply to the timed out watch isn't taken for a later one
+        store.set("key", "value1")
+        self.assertEqual(b"value1", store.get("key"))
+        self.assertEqual(3, store.add("counter", 3))
+
 
 class RendezvousTest(TestCase):
     def test_unknown_handler(self):
@@ -335,6 +359,210 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         work.wait()
         self.assertEqual(torch.Tensor([float(self.world_size * (self.world_size + 1) / 2)]), x)
 
+    def test_allreduce_compressed_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        def allreduce(x, compression, residual=None, topk_ratio=None):
+            opts = c10d.AllreduceOptions()
+            opts.compression = compression
+            if residual is not None:
+                opts.residual = residual
+            if topk_ratio is not None:
+                opts.topkRatio = topk_ratio
+            work = pg.allreduce([x], opts)
+            work.wait()
+
+        full = torch.arange(16).float() * (self.world_size * (self.world_size + 1) / 2)
+
+        # FP16 is exact for small integers
+        x = torch.arange(16).float() * (self.rank + 1)
+        allreduce(x, c10d.Compression.FP16)
+        self.assertEqual(full, x)
+
+        # What the result misses is in the residuals
+        def assertResiduals(x, residual):
+            pg.allreduce([residual]).wait()
+            self.assertEqual(full, x + residual)
+
+        # INT8 loses at most half a quantization step every time a chunk
+        # is encoded, which happens once per process
+        x = torch.arange(16).float() * (self.rank + 1)
+        residual = torch.zeros(16)
+        allreduce(x, c10d.Compression.INT8, residual)
+        step = full.max().item() / 127
+        self.assertEqual(full, x, prec=0.5 * step * self.world_size)
+        assertResiduals(x, residual)
+
+        # TOPK only passes on the largest element of every chunk of 4 and
+        # keeps the rest
+        x = torch.arange(16).float() * (self.rank + 1)
+        residual = torch.zeros(16)
+        allreduce(x, c10d.Compression.TOPK, residual, topk_ratio=0.25)
+        expected = torch.zeros(16)
+        expected[3::4] = full[3::4]
+        self.assertEqual(expected, x)
+        expected = torch.arange(16).float() * (self.rank + 1)
+        expected[3::4] = 0
+        self.assertEqual(expected, residual)
+        assertResiduals(x, residual)
+
+        # Only float tensors can be compressed
+        with self.assertRaisesRegex(ValueError, "only supports float tensors"):
+            allreduce(torch.arange(16).long(), c10d.Compression.INT8)
+
+    def test_reduce_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Every rank is root once
+        for root in range(self.world_size):
+            x = torch.Tensor([self.rank + 1.0])
+            opts = c10d.ReduceOptions()
+            opts.rootRank = root
+            opts.reduceOp = c10d.ReduceOp.MAX
+            pg.reduce([x], opts).wait()
+            if self.rank == root:
+                self.assertEqual(torch.Tensor([self.world_size]), x)
+
+        # Test overloaded convenience function (defaults to using sum)
+        x = torch.Tensor([self.rank + 1.0])
+        pg.reduce(x, root=0).wait()
+        if self.rank == 0:
+            self.assertEqual(torch.Tensor([float(self.world_size * (self.world_size + 1) / 2)]), x)
+
+    def test_allgather_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        x = torch.Tensor([self.rank, self.rank])
+        outputs = [[torch.zeros(2) for _ in range(self.world_size)]]
+        pg.allgather(outputs, [x]).wait()
+        for i in range(self.world_size):
+            self.assertEqual(torch.Tensor([i, i]), outputs[0][i])
+
+    def test_gather_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Every rank is root once
+        for root in range(self.world_size):
+            x = torch.Tensor([self.rank])
+            outputs = []
+            if self.rank == root:
+                outputs = [[torch.zeros(1) for _ in range(self.world_size)]]
+            opts = c10d.GatherOptions()
+            opts.rootRank = root
+            pg.gather(outputs, [x], opts).wait()
+            if self.rank == root:
+                for i in range(self.world_size):
+                    self.assertEqual(torch.Tensor([i]), outputs[0][i])
+
+    def test_scatter_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Every rank is root once
+        for root in range(self.world_size):
+            inputs = []
+            if self.rank == root:
+                inputs = [[torch.Tensor([root * self.world_size + i]) for i in range(self.world_size)]]
+            x = torch.zeros(1)
+            opts = c10d.ScatterOptions()
+            opts.rootRank = root
+            pg.scatter([x], inputs, opts).wait()
+            self.assertEqual(torch.Tensor([root * self.world_size + self.rank]), x)
+
+    def test_reduce_scatter_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Rank r contributes r * world_size + i to the output of rank i
+        inputs = [[torch.Tensor([self.rank * self.world_size + i]) for i in range(self.world_size)]]
+        x = torch.zeros(1)
+        pg.reduce_scatter([x], inputs, c10d.ReduceScatterOptions()).wait()
+        expected = sum(r * self.world_size + self.rank for r in range(self.world_size))
+        self.assertEqual(torch.Tensor([expected]), x)
+
+    def test_send_recv(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Every rank sends to the next one around the ring
+        dst = (self.rank + 1) % self.world_size
+        src = (self.rank - 1) % self.world_size
+        x = torch.Tensor([self.rank])
+        y = torch.zeros(1)
+        send_work = pg.send([x], dst, 0)
+        pg.recv([y], src, 0).wait()
+        send_work.wait()
+        self.assertEqual(torch.Tensor([src]), y)
+
+        # Rank 0 receives from all others in any order
+        if self.rank == 0:
+            sources = set()
+            for _ in range(self.world_size - 1):
+                y = torch.zeros(1)
+                work = pg.recv_anysource([y], 1)
+                work.wait()
+                self.assertEqual(torch.Tensor([work.source_rank()]), y)
+                sources.add(work.source_rank())
+            self.assertEqual(set(range(1, self.world_size)), sources)
+        else:
+            pg.send([torch.Tensor([self.rank])], 0, 1).wait()
+
+    def test_barrier_tcp_store(self):
+        store = c10d.TCPStore('localhost', self.port, self.rank == 0)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        x = torch.Tensor([self.rank + 1.0])
+        work = pg.allreduce(x)
+        pg.barrier().wait()
+        self.assertTrue(work.isCompleted())
+        self.assertEqual(torch.Tensor([float(self.world_size * (self.world_size + 1) / 2)]), x)
+
+
+class ReducerTest(MultiProcessTestCase):
+    def _create_process_group(self):
+        store = c10d.FileStore(self.file.name)
+        opts = c10d.ProcessGroupGloo.Options()
+        opts.timeout = 5.0
+        opts.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        return c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+
+    def test_reducer_averages_gradients(self):
+        pg = self._create_process_group()
+
+        # Every process starts with the same parameters
+        torch.manual_seed(0)
+        model = nn.Sequential(nn.Linear(2, 10), nn.ReLU(), nn.Linear(10, 4))
+        reference = copy.deepcopy(model)
+        params = list(model.parameters())
+
+        # A tiny cap makes the buckets hold a single parameter or two
+        reducer = c10d.Reducer(params, pg, 160)
+        buckets = reducer.get_bucket_indices()
+        self.assertGreater(len(buckets), 1)
+        self.assertEqual(sorted(i for bucket in buckets for i in bucket), list(range(len(params))))
+        self.assertEqual(len(params) - 1, buckets[0][0])
+
+        def input(rank):
+            return torch.arange(16).view(8, 2) * (rank + 1.0)
+
+        expected = [torch.zeros_like(p) for p in reference.parameters()]
+        for rank in range(self.world_size):
+            reference.zero_grad()
+            reference(input(rank)).sum().backward()
+            for e, p in zip(expected, reference.parameters()):
+                e += p.grad / self.world_size
+
+        # The reducer is reset after every backward pass
+        for _ in range(2):
+            model.zero_grad()
+            model(input(self.rank)).sum().backward()
+            for p, e in zip(params, expected):
+                self.assertEqual(e, p.grad)
+
 
 class ProcessGroupNCCLTest(TestCase):
     MAIN_PROCESS_RANK = 0
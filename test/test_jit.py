@@ -986,6 +986,67 @@ class TestJit(JitTestCase):
         g2result2 = torch.autograd.grad(l3, [da2, db2])
         self.assertEqual(g2result, g2result2)
 
+    def test_ge_plan_cache(self):
+        def foo(a, b):
+            return a * b / (a - b) + b
+
+        a, b = torch.rand(3, 4), torch.rand(3, 4)
+        cache_dir = tempfile.mkdtemp()
+        old_cache_dir = torch._C._jit_get_plan_cache_dir()
+        torch._C._jit_set_plan_cache_dir(cache_dir)
+        try:
+            ge = torch._C.GraphExecutor(foo, (a, b))
+            ge.warm_up((a, b), (torch.rand(2, 2), torch.rand(2, 2)))
+            plans = ge.get_debug_state().execution_plans
+            self.assertEqual(len(plans), 2)
+            self.assertFalse(any(plan.loaded_from_cache for plan in plans.values()))
+            self.assertEqual(len(os.listdir(cache_dir)), 2)
+
+            # a fresh executor loads the cached plans
+            ge = torch._C.GraphExecutor(foo, (a, b))
+            self.assertEqual(ge(a, b), foo(a, b))
+            plans = ge.get_debug_state().execution_plans
+            self.assertEqual(len(plans), 1)
+            self.assertTrue(all(plan.loaded_from_cache for plan in plans.values()))
+            self.assertEqual(len(os.listdir(cache_dir)), 2)
+        finally:
+            torch._C._jit_set_plan_cache_dir(old_cache_dir)
+            shutil.rmtree(cache_dir)
+
+    def test_ge_hoist_parameter_computations(self):
+        class M(torch.jit.ScriptModule):
+            def __init__(self):
+                super(M, self).__init__()
+                self.weight = nn.Parameter(torch.rand(3, 4), requires_grad=False)
+
+            @torch.jit.script_method
+            def forward(self, x):
+                return torch.mm(x, self.weight.t() * 2)
+
+        m = M()
+        x = torch.rand(2, 4)
+        with torch.no_grad():
+            self.assertEqual(m(x), torch.mm(x, m.weight.t() * 2))
+            graph = m.graph_for(x)
+            self.assertNotIn('aten::t', str(graph))
+            self.assertNotIn('aten::mul', str(graph))
+
+            # without freezing, changes through .data are seen
+            m.weight.data.add_(1)
+            self.assertEqual(m(x), torch.mm(x, m.weight.t() * 2))
+
+            m.freeze_parameters()
+            self.assertEqual(m(x), torch.mm(x, m.weight.t() * 2))
+            # updating the parameter in place reruns the hoisted computations
+            m.weight.add_(1)
+            self.assertEqual(m(x), torch.mm(x, m.weight.t() * 2))
+            # and so does loading a state dict, which writes through .data
+            m.load_state_dict({'weight': torch.rand(3, 4)})
+            self.assertEqual(m(x), torch.mm(x, m.weight.t() * 2))
+            m.double()
+            x = x.double()
+            self.assertEqual(m(x), torch.mm(x, m.weight.t() * 2))
+
     def test_trace_annotation(self):
         @torch.jit.trace(torch.rand(1))
         def foo(a):
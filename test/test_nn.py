@@ -8,7 +8,7 @@ import warnings
 import pickle
 from copy import deepcopy
 from itertools import repeat, product
-from functools import wraps, reduce
+from functools import wraps, reduce, partial
 from operator import mul
 from collections import OrderedDict
 import hashlib
@@ -2066,6 +2066,111 @@ class TestNN(NNTestCase):
         self._test_EmbeddingBag(False, 'sum', True)
         self._test_EmbeddingBag(False, 'mean', True)
 
+    def test_embedding_bag_per_sample_weights(self):
+        weight = torch.randn(10, 5, dtype=torch.double, requires_grad=True)
+        input = torch.tensor([3, 1, 1, 9, 4, 0, 1], dtype=torch.long)
+        offsets = torch.tensor([0, 0, 3, 3, 7], dtype=torch.long)
+        per_sample_weights = torch.randn(7, dtype=torch.double, requires_grad=True)
+
+        bags = [(0, 0), (0, 3), (3, 3), (3, 7), (7, 7)]
+        expected = torch.stack([
+            (weight[input[b:e]] * per_sample_weights[b:e].unsqueeze(1)).sum(0)
+            for b, e in bags])
+        output = F.embedding_bag(input, weight, offsets, mode='sum',
+                                 per_sample_weights=per_sample_weights)
+        self.assertEqual(output, expected)
+
+        for sparse in [False, True]:
+            es = nn.EmbeddingBag(10, 5, mode='sum', sparse=sparse).double()
+            es.weight.data.copy_(weight.data)
+            grad = torch.randn(5, 5, dtype=torch.double)
+            es(input, offsets, per_sample_weights).backward(grad)
+            weight.grad = None
+            per_sample_weights.grad = None
+            expected.backward(grad, retain_graph=True)
+            grad_weight = es.weight.grad.to_dense() if sparse else es.weight.grad
+            self.assertEqual(grad_weight, weight.grad)
+
+        def fn(weight, per_sample_weights):
+            return F.embedding_bag(input, weight, offsets, mode='sum',
+                                   per_sample_weights=per_sample_weights)
+        gradcheck(fn, (weight, per_sample_weights))
+
+        with self.assertRaises(NotImplementedError):
+            F.embedding_bag(input, weight, offsets, mode='mean',
+                            per_sample_weights=per_sample_weights)
+
+    def test_embedding_bag_dense_backward_large(self):
+        # Many repeated indices exercise the grouping of the dense backward,
+        # which is compared against the sparse backward.
+        input = torch.randint(0, 50, (1000,), dtype=torch.long)
+        offsets = torch.arange(0, 1000, 7, dtype=torch.long)
+        for mode in ['sum', 'mean']:
+            for scale_grad_by_freq in [False, True]:
+                grads = []
+                for sparse in [False, True]:
+                    es = nn.EmbeddingBag(50, 33, mode=mode, sparse=sparse,
+                                         scale_grad_by_freq=scale_grad_by_freq).double()
+                    es.weight.data.copy_(torch.arange(50 * 33, dtype=torch.double).view(50, 33))
+                    output = es(input, offsets)
+                    output.backward(torch.arange(output.numel(), dtype=torch.double).view_as(output))
+                    grads.append(es.weight.grad.to_dense() if sparse else es.weight.grad)
+                self.assertEqual(grads[0], grads[1])
+
+    def test_embedding_bag_half_cpu(self):
+        weight = torch.randn(20, 17)
+        input = torch.randint(0, 20, (30,), dtype=torch.long)
+        offsets = torch.tensor([0, 4, 4, 19], dtype=torch.long)
+        for mode in ['sum', 'mean', 'max']:
+            expected = F.embedding_bag(input, weight.half().float(), offsets, mode=mode)
+            output = F.embedding_bag(input, weight.half(), offsets, mode=mode)
+            self.assertEqual(output.dtype, torch.half)
+            self.assertEqual(output.float(), expected, prec=5e-2)
+
+    def test_embedding_bag_half_cpu_backward(self):
+        weight = torch.randn(20, 17).half()
+        input = torch.randint(0, 20, (30,), dtype=torch.long)
+        offsets = torch.tensor([0, 4, 4, 19], dtype=torch.long)
+        for mode in ['sum', 'mean', 'max']:
+            weight_half = weight.clone().requires_grad_()
+            weight_float = weight.float().requires_grad_()
+            F.embedding_bag(input, weight_half, offsets, mode=mode).float().sum().backward()
+            F.embedding_bag(input, weight_float, offsets, mode=mode).sum().backward()
+            self.assertEqual(weight_half.grad.dtype, torch.half)
+            self.assertEqual(weight_half.grad.float(), weight_float.grad, prec=5e-2)
+
+        per_sample_weights = torch.randn(30, requires_grad=True)
+        weight_half = weight.clone().requires_grad_()
+        F.embedding_bag(input, weight_half, offsets, mode='sum',
+                        per_sample_weights=per_sample_weights).float().sum().backward()
+        expected = per_sample_weights.detach().clone().requires_grad_()
+        F.embedding_bag(input, weight.float(), offsets, mode='sum',
+                        per_sample_weights=expected).sum().backward()
+        self.assertEqual(per_sample_weights.grad, expected.grad, prec=5e-2)
+
+        with self.assertRaisesRegex(RuntimeError, 'sparse'):
+            F.embedding_bag(input, weight.clone().requires_grad_(), offsets, sparse=True)
+
+    def test_embedding_bag_byte_rowwise(self):
+        weight = torch.randn(20, 13)
+        quantized = torch._fused_8bit_rowwise_quantize(weight)
+        self.assertEqual(quantized.dtype, torch.uint8)
+        self.assertEqual(quantized.shape, (20, 13 + 8))
+        # Each value is within half a quantization step of the original.
+        step = (weight.max(1)[0] - weight.min(1)[0]) / 255
+        rows = torch._embedding_bag_byte_rowwise(quantized, torch.arange(20, dtype=torch.long),
+                                                 torch.arange(20, dtype=torch.long))
+        self.assertTrue(((rows - weight).abs() <= step.unsqueeze(1) / 2 + 1e-5).all())
+
+        input = torch.randint(0, 20, (40,), dtype=torch.long)
+        offsets = torch.tensor([0, 10, 10, 25], dtype=torch.long)
+        per_sample_weights = torch.randn(40)
+        for mode, psw in [(0, None), (1, None), (0, per_sample_weights)]:
+            expected = F.embedding_bag(input, rows, offsets, mode=['sum', 'mean'][mode],
+                                       per_sample_weights=psw)
+            output = torch._embedding_bag_byte_rowwise(quantized, input, offsets, mode, psw)
+            self.assertEqual(output, expected, prec=1e-4)
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     @repeat_test_for_types(ALL_TENSORTYPES)
     def test_embedding_bag_cuda(self, dtype=torch.float):
@@ -4241,6 +4346,157 @@ class TestNN(NNTestCase):
         # Because of dropout randomness, can only compare dropout=0 and dropout=1
         self._test_RNN_cpu_vs_cudnn(1)
 
+    def test_RNN_cpu_fused_vs_autograd(self):
+        # Without dropout, RNNs on CPU run the fused torch._cpu_rnn; compare
+        # it with the per-step implementation
+        from torch.nn._functions.rnn import AutogradRNN, CpuRNN
+        input_size = 5
+        hidden_size = 4
+        num_layers = 2
+        seq_length = 6
+        batch = 4
+        lengths = [6, 4, 4, 1]
+        modules = {'RNN_RELU': partial(nn.RNN, nonlinearity='relu'),
+                   'RNN_TANH': partial(nn.RNN, nonlinearity='tanh'),
+                   'LSTM': nn.LSTM,
+                   'GRU': nn.GRU}
+
+        for mode, bias, bidirectional, batch_first, variable_len \
+                in product(modules.keys(), *[(True, False)] * 4):
+            num_directions = 2 if bidirectional else 1
+            is_lstm = mode == 'LSTM'
+            rnn = modules[mode](input_size, hidden_size, num_layers, bias=bias,
+                                bidirectional=bidirectional, batch_first=batch_first).double()
+            input_val = torch.randn(seq_length, batch, input_size, dtype=torch.double)
+            batch_sizes = None
+            if variable_len:
+                input_val, batch_sizes = rnn_utils.pack_padded_sequence(input_val, lengths)
+            elif batch_first:
+                input_val = input_val.transpose(0, 1)
+            hx_val = [torch.randn(num_layers * num_directions, batch, hidden_size, dtype=torch.double)
+                      for _ in range(2 if is_lstm else 1)]
+
+            def run(factory, grads=None):
+                func = factory(mode, input_size, hidden_size, num_layers=num_layers,
+                               batch_first=batch_first, bidirectional=bidirectional,
+                               variable_length=variable_len)
+                input = input_val.clone().requires_grad_()
+                hx = [h.clone().requires_grad_() for h in hx_val]
+                output, hy = func(input, rnn.all_weights, tuple(hx) if is_lstm else hx[0], batch_sizes)
+                outputs = [output] + (list(hy) if is_lstm else [hy])
+                if grads is None:
+                    grads = [torch.randn_like(o) for o in outputs]
+                inputs = [input] + hx + list(rnn.parameters())
+                return outputs + list(torch.autograd.grad(outputs, inputs, grads)), grads
+
+            expected, grads = run(AutogradRNN)
+            results, _ = run(CpuRNN, grads)
+            self.assertEqual(len(expected), len(results))
+            for x, y in zip(expected, results):
+                self.assertEqual(x, y, prec=1e-10)
+
+    def test_RNN_cpu_fused_gradcheck(self):
+        input_size = 3
+        hidden_size = 2
+        num_layers = 2
+        batch_sizes = [3, 2, 2, 1]
+        for mode, bidirectional, packed in product(range(4), (True, False), (True, False)):
+            num_directions = 2 if bidirectional else 1
+            gate_size = (1, 1, 4, 3)[mode] * hidden_size
+            if packed:
+                input = torch.randn(sum(batch_sizes), input_size, dtype=torch.double, requires_grad=True)
+            else:
+                input = torch.randn(3, 3, input_size, dtype=torch.double, requires_grad=True)
+            hx = torch.randn(num_layers * num_directions, 3, hidden_size, dtype=torch.double,
+                             requires_grad=True)
+            cx = [torch.randn_like(hx, requires_grad=True)] if mode == 2 else []
+            weights = []
+            for layer in range(num_layers):
+                layer_input_size = input_size if layer == 0 else hidden_size * num_directions
+                for _ in range(num_directions):
+                    weights += [torch.randn(gate_size, layer_input_size, dtype=torch.double),
+                                torch.randn(gate_size, hidden_size, dtype=torch.double),
+                                torch.randn(gate_size, dtype=torch.double),
+                                torch.randn(gate_size, dtype=torch.double)]
+            for w in weights:
+                w.requires_grad_()
+
+            def func(input, hx, *args):
+                cx = args[0] if mode == 2 else None
+                output, hy, cy, _ = torch._cpu_rnn(
+                    input, args[len(args) - len(weights):], 4, hx, cx, mode, hidden_size,
+                    num_layers, False, True, bidirectional, batch_sizes if packed else [])
+                return (output, hy, cy) if mode == 2 else (output, hy)
+
+            self.assertTrue(gradcheck(func, [input, hx] + cx + weights))
+
+    def test_RNN_cpu_fused_gradgradcheck(self):
+        # _cpu_rnn_backward is not differentiable, so with create_graph=True
+        # the gradient is computed by recomputing the forward with AutogradRNN
+        from torch.nn._functions.rnn import CpuRNN
+        input_size = 3
+        hidden_size = 2
+        num_layers = 2
+        batch_sizes = [3, 2, 2, 1]
+        for mode, packed in product(('RNN_TANH', 'LSTM', 'GRU'), (True, False)):
+            gate_size = {'RNN_TANH': 1, 'LSTM': 4, 'GRU': 3}[mode] * hidden_size
+            if packed:
+                input = torch.randn(sum(batch_sizes), input_size, dtype=torch.double, requires_grad=True)
+            else:
+                input = torch.randn(4, 3, input_size, dtype=torch.double, requires_grad=True)
+            hx = torch.randn(num_layers * 2, 3, hidden_size, dtype=torch.double, requires_grad=True)
+            cx = [torch.randn_like(hx, requires_grad=True)] if mode == 'LSTM' else []
+            weights = []
+            for layer in range(num_layers):
+                layer_input_size = input_size if layer == 0 else hidden_size * 2
+                for _ in range(2):
+                    weights += [torch.randn(gate_size, layer_input_size, dtype=torch.double),
+                                torch.randn(gate_size, hidden_size, dtype=torch.double),
+                                torch.randn(gate_size, dtype=torch.double),
+                                torch.randn(gate_size, dtype=torch.double)]
+            for w in weights:
+                w.requires_grad_()
+            rnn = CpuRNN(mode, input_size, hidden_size, num_layers=num_layers,
+                         bidirectional=True, variable_length=packed)
+
+            def func(input, hx, *args):
+                hidden = (hx, args[0]) if mode == 'LSTM' else hx
+                weight_arr = args[len(args) - len(weights):]
+                weight = [weight_arr[i:i + 4] for i in range(0, len(weight_arr), 4)]
+                output, hy = rnn(input, weight, hidden, torch.tensor(batch_sizes) if packed else None)
+                return (output,) + (tuple(hy) if mode == 'LSTM' else (hy,))
+
+            self.assertTrue(gradgradcheck(func, [input, hx] + cx + weights))
+
+    def test_RNN_cpu_fused_backward_without_activations(self):
+        # With train=False the forward pass keeps no activations, e.g. in a
+        # trace recorded without grad, and backward recomputes them
+        input = torch.randn(5, 3, 4, dtype=torch.double, requires_grad=True)
+        hx = torch.randn(1, 3, 2, dtype=torch.double, requires_grad=True)
+        cx = torch.randn(1, 3, 2, dtype=torch.double, requires_grad=True)
+        weights = [torch.randn(8, 4, dtype=torch.double, requires_grad=True),
+                   torch.randn(8, 2, dtype=torch.double, requires_grad=True)]
+        grads = []
+        for train in (True, False):
+            output, hy, cy, _ = torch._cpu_rnn(input, weights, 2, hx, cx, 2, 2, 1,
+                                               False, train, False, [])
+            grads.append(torch.autograd.grad(output.sum() + hy.sum() + cy.sum(),
+                                             [input, hx, cx] + weights))
+        for expected, result in zip(*grads):
+            self.assertEqual(expected, result, prec=1e-10)
+
+    def test_RNN_cpu_fused_inference(self):
+        # Without grad, the fused op projects the input in chunks of steps and
+        # doesn't keep the activations
+        for module, bidirectional in product((nn.RNN, nn.LSTM, nn.GRU), (True, False)):
+            rnn = module(8, 6, num_layers=3, bidirectional=bidirectional)
+            input = torch.randn(40, 128, 8)
+            expected_output, expected_hy = rnn(input)
+            with torch.no_grad():
+                output, hy = rnn(input)
+            self.assertEqual(expected_output, output)
+            self.assertEqual(expected_hy, hy)
+
     @unittest.skipIf(not (TEST_CUDNN and TEST_CUDNN_VERSION >= 5103), "needs cudnn >= 5.1")
     def test_RNN_dropout(self):
         # checking the assumption that cuDNN sticks dropout in between
@@ -3220,6 +3220,46 @@ class TestTorch(TestCase):
         # Test that we still have proper sorting with duplicate keys
         self.assertIsOrdered('descending', x, res2val, res2ind, 'random with duplicate keys')
 
+    def test_sort_large(self):
+        # Long slices take the radix sort path on CPU
+        for dtype in [torch.float, torch.double, torch.int, torch.long, torch.short, torch.int8, torch.uint8]:
+            x = torch.rand(8, 1000) * 200
+            x = (x if dtype == torch.uint8 else x - 100).to(dtype)
+            for dim, descending in product([0, 1], [False, True]):
+                y = x if dim == 1 else x.t()
+                values, indices = y.sort(dim, descending)
+                self.assertEqual(values, y.gather(dim, indices), 0)
+                ordered = values.narrow(dim, 0, values.size(dim) - 1)
+                following = values.narrow(dim, 1, values.size(dim) - 1)
+                if descending:
+                    self.assertTrue((ordered >= following).all())
+                else:
+                    self.assertTrue((ordered <= following).all())
+                positions = torch.arange(y.size(dim), dtype=torch.long)
+                positions = positions.view(-1, 1) if dim == 0 else positions.view(1, -1)
+                self.assertEqual(indices.sort(dim)[0], positions.expand_as(indices), 0)
+
+        # NaN sorts last, or first when descending
+        nan, inf = float('nan'), float('inf')
+        x = torch.Tensor([3, nan, -1, 0, 3, -inf, inf, -0.0] * 64)
+        values, indices = x.sort()
+        self.assertEqual(values[:448], x[x == x].sort()[0], 0)
+        self.assertTrue(torch.isnan(values[448:]).all())
+        self.assertTrue(values[:448][1:].ge(values[:448][:-1]).all())
+        values, indices = x.sort(descending=True)
+        self.assertTrue(torch.isnan(values[:64]).all())
+
+        # topk and kthvalue agree with sort on long slices
+        x = torch.randn(4, 5000)
+        sorted_values, sorted_indices = x.sort(1, True)
+        for k in [1, 10, 100, 2000, 5000]:
+            values, indices = x.topk(k)
+            self.assertEqual(values, sorted_values[:, :k], 0)
+            self.assertEqual(indices, sorted_indices[:, :k], 0)
+            values, indices = x.kthvalue(k)
+            self.assertEqual(values, sorted_values[:, 5000 - k], 0)
+            self.assertEqual(indices, sorted_indices[:, 5000 - k], 0)
+
     def test_topk(self):
         def topKViaSort(t, k, dim, dir):
             sorted, indices = t.sort(dim, dir)
@@ -7199,6 +7239,61 @@ class TestTorch(TestCase):
             self.assertTrue(torch.equal(a, b))
             self.assertEqual(i, j)
 
+    def test_serialization_aligned(self):
+        b = self._test_serialization_data()
+        with tempfile.NamedTemporaryFile() as f:
+            f.write(b'x')  # storages are aligned relative to the file
+            torch.save(b, f, storage_alignment=4096)
+            f.seek(1)
+            c = torch.load(f)
+        self._test_serialization_assert(b, c)
+
+        with BytesIOContext() as f:
+            torch.save(b, f, storage_alignment=64)
+            f.seek(0)
+            c = torch.load(f)
+        self._test_serialization_assert(b, c)
+
+        self.assertRaises(ValueError, lambda: torch.save(b, io.BytesIO(), storage_alignment=12))
+
+    @unittest.skipIf(sys.platform == "win32", "Opens the file twice, which is not supported on Windows")
+    def test_serialization_mmap(self):
+        b = self._test_serialization_data()
+        with tempfile.NamedTemporaryFile() as f:
+            torch.save(b, f, storage_alignment=4096)
+            f.flush()
+            c = torch.load(f.name, mmap_mode='c')
+            self.assertEqual(b, c, 0)
+            for i in range(4):
+                self.assertEqual(c[i].data_ptr() % 4096, 0)
+            self.assertEqual(c[0].data_ptr(), c[2].data_ptr())
+
+            # copy-on-write mappings can be modified without changing the file
+            c = torch.load(f.name, mmap_mode='c')
+            c[0].fill_(10)
+            self.assertEqual(torch.load(f.name, mmap_mode='c')[0], b[0], 0)
+
+            # files saved without storage_alignment are read
+            f.seek(0)
+            f.truncate()
+            torch.save(b, f)
+            f.flush()
+            self._test_serialization_assert(b, torch.load(f.name, mmap_mode='c'))
+
+            # files saved with other type sizes can't be mapped
+            f.seek(0)
+            f.truncate()
+            long_size = torch.serialization.LONG_SIZE
+            torch.serialization.LONG_SIZE = 2 * long_size
+            try:
+                torch.save(b, f, storage_alignment=4096)
+            finally:
+                torch.serialization.LONG_SIZE = long_size
+            f.flush()
+            self.assertRaises(RuntimeError, lambda: torch.load(f.name, mmap_mode='c'))
+
+        self.assertRaises(ValueError, lambda: torch.load(io.BytesIO(), mmap_mode='r'))
+
     def test_serialization_offset_filelike(self):
         a = torch.randn(5, 5)
         i = 41
@@ -8328,6 +8423,35 @@ class TestTorch(TestCase):
         self.assertEqual(torch.ByteTensor([7, 42, 128, 133]), byte_unique)
         self.assertEqual(torch.LongTensor([3, 0, 0, 0, 1, 2]), byte_inverse)
 
+        # Tests counts.
+        x_unique, x_counts = x.unique(sorted=True, return_counts=True)
+        self.assertEqual(expected_unique, x_unique)
+        self.assertEqual(torch.LongTensor([1, 3, 2, 1, 1]), x_counts)
+        x_unique, x_inverse, x_counts = torch.unique(
+            x, sorted=True, return_inverse=True, return_counts=True)
+        self.assertEqual(expected_inverse, x_inverse)
+        self.assertEqual(torch.LongTensor([1, 3, 2, 1, 1]), x_counts)
+
+        # Tests inputs large enough to be split across threads.
+        for sort in [False, True]:
+            z = torch.randint(-1000, 1000, (1 << 19,), dtype=torch.long)
+            z_unique, z_inverse, z_counts = z.unique(
+                sorted=sort, return_inverse=True, return_counts=True)
+            self.assertEqual(z_unique.sort()[0], torch.arange(-1000, 1000, dtype=torch.long))
+            self.assertEqual(z_unique[z_inverse], z)
+            self.assertEqual(z_counts, torch.bincount(z + 1000)[(z_unique + 1000)])
+            if sort:
+                self.assertEqual(z_unique, z_unique.sort()[0])
+
+        # NaNs are one value.
+        nan = float('nan')
+        nan_unique, nan_counts = torch.unique(
+            torch.FloatTensor([nan, 1, nan, -0., 0.]), sorted=True, return_counts=True)
+        self.assertEqual(nan_unique[:1], torch.FloatTensor([0]))
+        self.assertEqual(nan_unique[1:2], torch.FloatTensor([1]))
+        self.assertTrue(torch.isnan(nan_unique[2]))
+        self.assertEqual(nan_counts, torch.LongTensor([2, 1, 2]))
+
     @staticmethod
     def _test_bincount(self, device):
         # negative input throws
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <torch/data/collate.h>
+#include <torch/data/data_loader.h>
+#include <torch/data/datasets.h>
+#include <torch/data/example.h>
+#include <torch/data/iterator.h>
+#include <torch/data/samplers.h>
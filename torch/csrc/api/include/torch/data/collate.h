@@ -0,0 +1,50 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+/// Stacks `tensors`, which must all have the same shape, type and device,
+/// along a new first dimension. The batch is allocated once, in page-locked
+/// memory if `pin_memory` is set (for asynchronous copies to CUDA devices),
+/// and every tensor is copied straight into its slice of it.
+Tensor stack(const std::vector<Tensor>& tensors, bool pin_memory);
+} // namespace detail
+
+/// A collation turns the examples of a batch into the batch the
+/// `DataLoader` returns. `Stack` stacks tensors along a new first dimension.
+template <typename ExampleType = Example<>>
+struct Stack;
+
+template <>
+struct Stack<Example<>> {
+  using BatchType = Example<>;
+
+  BatchType operator()(std::vector<Example<>> examples, bool pin_memory) const {
+    std::vector<Tensor> data, targets;
+    data.reserve(examples.size());
+    targets.reserve(examples.size());
+    for (auto& example : examples) {
+      data.push_back(std::move(example.data));
+      targets.push_back(std::move(example.target));
+    }
+    return {detail::stack(data, pin_memory),
+            detail::stack(targets, pin_memory)};
+  }
+};
+
+template <>
+struct Stack<Tensor> {
+  using BatchType = Tensor;
+
+  BatchType operator()(std::vector<Tensor> examples, bool pin_memory) const {
+    return detail::stack(examples, pin_memory);
+  }
+};
+} // namespace data
+} // namespace torch
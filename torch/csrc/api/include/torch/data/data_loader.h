@@ -0,0 +1,337 @@
+#pragma once
+
+#include <torch/data/collate.h>
+#include <torch/data/detail/queue.h>
+#include <torch/data/detail/sequencers.h>
+#include <torch/data/iterator.h>
+#include <torch/cuda.h>
+#include <torch/data/samplers/random.h>
+#include <torch/nn/pimpl.h>
+
+#include <ATen/Error.h>
+#include <ATen/optional.h>
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+/// Options for a `DataLoader`.
+struct DataLoaderOptions {
+  DataLoaderOptions() = default;
+  /* implicit */ DataLoaderOptions(size_t batch_size)
+      : batch_size_(batch_size) {}
+
+  /// The number of examples in a batch.
+  TORCH_ARG(size_t, batch_size) = 1;
+  /// The number of worker threads loading batches. With zero workers, batches
+  /// are loaded on the calling thread when they are requested.
+  TORCH_ARG(size_t, workers) = 0;
+  /// The maximum number of batches being loaded or waiting to be returned,
+  /// which bounds the memory used for prefetching. Defaults to twice the
+  /// number of workers.
+  TORCH_ARG(at::optional<size_t>, max_jobs);
+  /// How long to wait for a worker to produce a batch before throwing.
+  TORCH_ARG(at::optional<std::chrono::milliseconds>, timeout);
+  /// Whether to return batches in the order the sampler produced their
+  /// indices. Otherwise batches are returned as soon as they are loaded,
+  /// so that a slow batch does not hold back the ones after it.
+  TORCH_ARG(bool, enforce_ordering) = true;
+  /// Whether to drop the last batch of an epoch if it is smaller than
+  /// `batch_size`.
+  TORCH_ARG(bool, drop_last) = false;
+  /// Whether to collate batches into page-locked memory, from which they can
+  /// be copied to CUDA devices asynchronously. Requires CUDA.
+  TORCH_ARG(bool, pin_memory) = false;
+};
+
+/// Loads batches from a dataset with a pool of worker threads.
+///
+/// The `Sampler` produces the indices of every batch. Up to `max_jobs`
+/// batches are scheduled ahead of the one being returned; every worker takes
+/// a batch of indices, reads the examples from the dataset and collates them
+/// into a batch with `Collation`. An exception thrown while loading a batch is
+/// rethrown on the thread that requests that batch.
+///
+/// Iterating over the loader (`begin()` to `end()`) goes through one epoch.
+/// If an iteration is abandoned before the end of the epoch, the next one
+/// continues where it stopped: batches that were prefetched but not returned
+/// are loaded again. `save()` and `load()` checkpoint the sampler at the
+/// position of the last batch returned; with `enforce_ordering`, loading the
+/// checkpoint into a new loader resumes the epoch with exactly the batches
+/// that had not been returned yet.
+template <
+    typename Dataset,
+    typename Sampler = samplers::RandomSampler,
+    typename Collation = Stack<typename Dataset::ExampleType>>
+class DataLoader {
+ public:
+  using ExampleType = typename Dataset::ExampleType;
+  using BatchType = typename Collation::BatchType;
+
+  DataLoader(
+      Dataset dataset,
+      Sampler sampler,
+      DataLoaderOptions options,
+      Collation collation = Collation())
+      : dataset_(std::move(dataset)),
+        sampler_(std::move(sampler)),
+        collation_(std::move(collation)),
+        options_(std::move(options)),
+        max_jobs_(options_.max_jobs_.value_or(2 * options_.workers_)) {
+    AT_CHECK(options_.batch_size_ > 0, "batch_size must be positive");
+    AT_CHECK(
+        options_.workers_ == 0 || max_jobs_ > 0,
+        "max_jobs must be positive");
+    AT_CHECK(
+        !options_.pin_memory_ || cuda::is_available(),
+        "pin_memory requires CUDA");
+    position_ = sampler_.index();
+    for (size_t w = 0; w < options_.workers_; ++w) {
+      workers_.emplace_back([this] { this->worker_thread(); });
+    }
+  }
+
+  DataLoader(const DataLoader&) = delete;
+  DataLoader& operator=(const DataLoader&) = delete;
+
+  ~DataLoader() {
+    jobs_.clear();
+    for (size_t w = 0; w < workers_.size(); ++w) {
+      jobs_.push(Job());
+    }
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /// Starts (or continues, see above) an epoch and returns an iterator to its
+  /// first batch.
+  Iterator<BatchType> begin() {
+    reset();
+    return Iterator<BatchType>([this] { return this->next(); });
+  }
+
+  /// Returns the end iterator.
+  Iterator<BatchType> end() {
+    return Iterator<BatchType>();
+  }
+
+  /// Returns the next batch of the current epoch, or `nullopt` at the end of
+  /// the epoch.
+  at::optional<BatchType> next() {
+    if (workers_.empty()) {
+      auto indices = next_indices();
+      if (!indices) {
+        epoch_done_ = true;
+        return at::nullopt;
+      }
+      position_ += indices->size();
+      return load_batch(*indices);
+    }
+    if (in_flight_ == 0) {
+      epoch_done_ = true;
+      return at::nullopt;
+    }
+    Result result = sequencer_->next([this] { return this->pop_result(); });
+    --in_flight_;
+    position_ += result.size;
+    prefetch();
+    if (result.exception) {
+      std::rethrow_exception(result.exception);
+    }
+    return std::move(result.batch);
+  }
+
+  /// Saves the state of the sampler at the position of the last batch
+  /// returned.
+  template <class Archive>
+  void save(Archive& archive) const {
+    Sampler sampler = sampler_;
+    if (epoch_done_) {
+      sampler.reset();
+    } else {
+      sampler.seek(position_);
+    }
+    archive(sampler);
+  }
+
+  /// Loads a state saved by `save()`. The next iteration continues from it.
+  template <class Archive>
+  void load(Archive& archive) {
+    archive(sampler_);
+    position_ = sampler_.index();
+    epoch_done_ = false;
+    abandon_jobs();
+  }
+
+  const DataLoaderOptions& options() const noexcept {
+    return options_;
+  }
+
+ private:
+  /// A batch of indices for a worker to load. A job without a generation
+  /// tells the worker to exit.
+  struct Job {
+    Job() = default;
+    Job(size_t generation, size_t sequence_number, std::vector<size_t> indices)
+        : generation(generation),
+          sequence_number(sequence_number),
+          indices(std::move(indices)) {}
+
+    at::optional<size_t> generation;
+    size_t sequence_number{0};
+    std::vector<size_t> indices;
+  };
+
+  struct Result {
+    size_t generation{0};
+    size_t sequence_number{0};
+    size_t size{0};
+    at::optional<BatchType> batch;
+    std::exception_ptr exception;
+  };
+
+  void reset() {
+    if (epoch_done_) {
+      sampler_.reset();
+      epoch_done_ = false;
+    } else {
+      sampler_.seek(position_);
+    }
+    position_ = sampler_.index();
+    abandon_jobs();
+    if (options_.enforce_ordering_) {
+      sequencer_.reset(
+          new detail::sequencers::OrderedSequencer<Result>(max_jobs_));
+    } else {
+      sequencer_.reset(new detail::sequencers::NoSequencer<Result>());
+    }
+    prefetch();
+  }
+
+  /// Drops the jobs of the current iteration. Results of jobs that a worker
+  /// already started are discarded when they arrive, since their generation
+  /// is out of date.
+  void abandon_jobs() {
+    ++generation_;
+    jobs_.clear();
+    in_flight_ = 0;
+    next_sequence_number_ = 0;
+    sampler_exhausted_ = false;
+  }
+
+  at::optional<std::vector<size_t>> next_indices() {
+    auto indices = sampler_.next(options_.batch_size_);
+    if (indices && options_.drop_last_ &&
+        indices->size() < options_.batch_size_) {
+      return at::nullopt;
+    }
+    return indices;
+  }
+
+  /// Schedules jobs until `max_jobs` are in flight or the sampler runs out of
+  /// indices.
+  void prefetch() {
+    while (!sampler_exhausted_ && in_flight_ < max_jobs_) {
+      auto indices = next_indices();
+      if (!indices) {
+        sampler_exhausted_ = true;
+        break;
+      }
+      jobs_.push(
+          Job(generation_, next_sequence_number_++, std::move(*indices)));
+      ++in_flight_;
+    }
+  }
+
+  Result pop_result() {
+    while (true) {
+      Result result = results_.pop(options_.timeout_);
+      if (result.generation == generation_) {
+        return result;
+      }
+    }
+  }
+
+  BatchType load_batch(const std::vector<size_t>& indices) {
+    std::vector<ExampleType> examples;
+    examples.reserve(indices.size());
+    for (const auto index : indices) {
+      examples.push_back(dataset_.get(index));
+    }
+    return collation_(std::move(examples), options_.pin_memory_);
+  }
+
+  void worker_thread() {
+    while (true) {
+      Job job = jobs_.pop();
+      if (!job.generation) {
+        break;
+      }
+      Result result;
+      result.generation = *job.generation;
+      result.sequence_number = job.sequence_number;
+      result.size = job.indices.size();
+      try {
+        result.batch = load_batch(job.indices);
+      } catch (...) {
+        result.exception = std::current_exception();
+      }
+      results_.push(std::move(result));
+    }
+  }
+
+  Dataset dataset_;
+  Sampler sampler_;
+  Collation collation_;
+  DataLoaderOptions options_;
+  size_t max_jobs_;
+
+  std::vector<std::thread> workers_;
+  detail::Queue<Job> jobs_;
+  detail::Queue<Result> results_;
+  std::unique_ptr<detail::sequencers::Sequencer<Result>> sequencer_;
+
+  /// Incremented whenever the jobs in flight are abandoned.
+  size_t generation_{0};
+  /// The number of jobs of the current generation that were scheduled but
+  /// whose batches were not returned yet.
+  size_t in_flight_{0};
+  size_t next_sequence_number_{0};
+  /// The sampler position after the last batch returned.
+  size_t position_{0};
+  bool sampler_exhausted_{false};
+  bool epoch_done_{false};
+};
+
+/// Creates a `DataLoader` for `dataset` that visits the examples in random
+/// order.
+template <typename Dataset>
+std::unique_ptr<DataLoader<Dataset>> make_data_loader(
+    Dataset dataset,
+    DataLoaderOptions options = DataLoaderOptions()) {
+  const size_t size = dataset.size();
+  return std::unique_ptr<DataLoader<Dataset>>(new DataLoader<Dataset>(
+      std::move(dataset), samplers::RandomSampler(size), std::move(options)));
+}
+
+/// Creates a `DataLoader` for `dataset` that visits the examples in the order
+/// given by `sampler`.
+template <typename Dataset, typename Sampler>
+std::unique_ptr<DataLoader<Dataset, Sampler>> make_data_loader(
+    Dataset dataset,
+    Sampler sampler,
+    DataLoaderOptions options = DataLoaderOptions()) {
+  return std::unique_ptr<DataLoader<Dataset, Sampler>>(
+      new DataLoader<Dataset, Sampler>(
+          std::move(dataset), std::move(sampler), std::move(options)));
+}
+} // namespace data
+} // namespace torch
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/data/datasets/mnist.h>
+#include <torch/data/datasets/tensor.h>
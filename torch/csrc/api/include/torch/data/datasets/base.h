@@ -0,0 +1,30 @@
+#pragma once
+
+#include <torch/data/example.h>
+
+#include <cstddef>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A dataset of `size()` examples that can be accessed in any order.
+///
+/// A `DataLoader` calls `get()` from all of its worker threads at the same
+/// time, so implementations must be safe to call concurrently.
+template <typename ExampleType_ = Example<>>
+class Dataset {
+ public:
+  using ExampleType = ExampleType_;
+
+  virtual ~Dataset() = default;
+
+  /// Returns the example at `index`.
+  virtual ExampleType get(size_t index) = 0;
+
+  /// Returns the number of examples in the dataset.
+  virtual size_t size() const = 0;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <cstddef>
+#include <string>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// The MNIST dataset, read from the IDX files `train-images-idx3-ubyte` and
+/// `train-labels-idx1-ubyte` (or `t10k-images-idx3-ubyte` and
+/// `t10k-labels-idx1-ubyte` for the test set) in the directory `root`.
+///
+/// The files are read completely when the dataset is constructed. Images are
+/// `[1, rows, columns]` float tensors with values in `[0, 1]`, and targets
+/// are int64 scalars.
+class MNIST : public Dataset<Example<>> {
+ public:
+  enum class Mode { kTrain, kTest };
+
+  explicit MNIST(const std::string& root, Mode mode = Mode::kTrain);
+
+  Example<> get(size_t index) override;
+  size_t size() const override;
+
+  /// Returns all images, as a `[N, 1, rows, columns]` tensor.
+  const Tensor& images() const noexcept;
+
+  /// Returns all targets, as an `[N]` tensor.
+  const Tensor& targets() const noexcept;
+
+ private:
+  Tensor images_;
+  Tensor targets_;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <cstddef>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A dataset of examples stored along the first dimension of a data tensor
+/// and a target tensor.
+class TensorDataset : public Dataset<Example<>> {
+ public:
+  TensorDataset(Tensor data, Tensor targets);
+
+  Example<> get(size_t index) override;
+  size_t size() const override;
+
+ private:
+  Tensor data_;
+  Tensor targets_;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
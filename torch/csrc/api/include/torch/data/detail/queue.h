@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ATen/Error.h>
+#include <ATen/optional.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <queue>
+#include <utility>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// A queue that blocks `pop()` until a value is available. It is unbounded;
+/// the `DataLoader` bounds the number of values in flight itself.
+template <typename T>
+class Queue {
+ public:
+  void push(T value) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push(std::move(value));
+    }
+    cv_.notify_one();
+  }
+
+  /// Removes and returns the value at the front of the queue, waiting for one
+  /// to be pushed if it is empty. Throws if `timeout` is given and no value
+  /// arrives in time.
+  T pop(at::optional<std::chrono::milliseconds> timeout = at::nullopt) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (timeout) {
+      if (!cv_.wait_for(lock, *timeout, [this] { return !queue_.empty(); })) {
+        AT_ERROR(
+            "Timeout in DataLoader queue while waiting for next batch"
+            " (timeout was ",
+            timeout->count(),
+            " ms)");
+      }
+    } else {
+      cv_.wait(lock, [this] { return !queue_.empty(); });
+    }
+    T value = std::move(queue_.front());
+    queue_.pop();
+    return value;
+  }
+
+  /// Discards all values in the queue and returns how many there were.
+  size_t clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t size = queue_.size();
+    queue_ = std::queue<T>();
+    return size;
+  }
+
+ private:
+  std::queue<T> queue_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ATen/Error.h>
+#include <ATen/optional.h>
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+namespace sequencers {
+
+/// A `Sequencer` decides in which order the results of the jobs a
+/// `DataLoader` scheduled are returned. `next()` takes a function that
+/// blocks until a worker produces a result and returns it. `Result` has a
+/// `sequence_number` member, the position of its job in the order jobs were
+/// scheduled.
+template <typename Result>
+class Sequencer {
+ public:
+  virtual ~Sequencer() = default;
+  virtual Result next(const std::function<Result()>& get_result) = 0;
+};
+
+/// Returns results as soon as they arrive.
+template <typename Result>
+class NoSequencer : public Sequencer<Result> {
+ public:
+  Result next(const std::function<Result()>& get_result) override {
+    return get_result();
+  }
+};
+
+/// Returns results in the order their jobs were scheduled, holding back
+/// results that arrive early. At most `max_jobs` jobs are in flight, so the
+/// results held back fit a ring buffer of that size.
+template <typename Result>
+class OrderedSequencer : public Sequencer<Result> {
+ public:
+  explicit OrderedSequencer(size_t max_jobs) : buffer_(max_jobs) {}
+
+  Result next(const std::function<Result()>& get_result) override {
+    auto& buffered = buffer(next_sequence_number_);
+    if (buffered) {
+      Result result = std::move(*buffered);
+      buffered = at::nullopt;
+      ++next_sequence_number_;
+      return result;
+    }
+    while (true) {
+      Result result = get_result();
+      if (result.sequence_number == next_sequence_number_) {
+        ++next_sequence_number_;
+        return result;
+      }
+      auto& slot = buffer(result.sequence_number);
+      AT_ASSERT(!slot.has_value());
+      slot = std::move(result);
+    }
+  }
+
+ private:
+  at::optional<Result>& buffer(size_t sequence_number) {
+    return buffer_[sequence_number % buffer_.size()];
+  }
+
+  std::vector<at::optional<Result>> buffer_;
+  size_t next_sequence_number_{0};
+};
+} // namespace sequencers
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <torch/tensor.h>
+
+#include <utility>
+
+namespace torch {
+namespace data {
+
+/// An `Example` from a dataset: a data tensor and the target it is labeled
+/// with. Collating a batch of `Example`s produces another `Example` whose
+/// tensors have an additional, leading batch dimension.
+template <typename Data = Tensor, typename Target = Tensor>
+struct Example {
+  Example() = default;
+  Example(Data data, Target target)
+      : data(std::move(data)), target(std::move(target)) {}
+
+  Data data;
+  Target target;
+};
+} // namespace data
+} // namespace torch
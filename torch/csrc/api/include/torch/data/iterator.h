@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ATen/Error.h>
+#include <ATen/optional.h>
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+namespace torch {
+namespace data {
+
+/// An input iterator over the batches of a `DataLoader`. Advancing it
+/// fetches the next batch; it compares equal to the end iterator once the
+/// epoch is over.
+template <typename Batch>
+class Iterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = Batch;
+  using pointer = Batch*;
+  using reference = Batch&;
+  using iterator_category = std::input_iterator_tag;
+
+  /// Constructs the end iterator.
+  Iterator() = default;
+
+  explicit Iterator(std::function<at::optional<Batch>()> next_batch)
+      : next_batch_(std::move(next_batch)), batch_(next_batch_()) {}
+
+  Iterator& operator++() {
+    AT_CHECK(batch_.has_value(), "Attempted to increment the end iterator");
+    batch_ = next_batch_();
+    return *this;
+  }
+
+  Batch& operator*() {
+    AT_CHECK(batch_.has_value(), "Attempted to dereference the end iterator");
+    return *batch_;
+  }
+
+  Batch* operator->() {
+    return &**this;
+  }
+
+  /// Iterators are only ever compared to the end iterator, so two iterators
+  /// are equal if neither or both of them are at the end.
+  bool operator==(const Iterator& other) const {
+    return batch_.has_value() == other.batch_.has_value();
+  }
+
+  bool operator!=(const Iterator& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  std::function<at::optional<Batch>()> next_batch_;
+  at::optional<Batch> batch_;
+};
+} // namespace data
+} // namespace torch
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ATen/optional.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+
+/// A `Sampler` decides in which order a `DataLoader` visits the examples of a
+/// dataset, one batch of indices at a time.
+///
+/// Samplers are stateful: their position in the current epoch can be read
+/// with `index()` and restored with `seek()`, so that an epoch can be resumed
+/// after a checkpoint (see `DataLoader::save()`).
+class Sampler {
+ public:
+  virtual ~Sampler() = default;
+
+  /// Starts a new epoch.
+  virtual void reset() = 0;
+
+  /// Returns the indices of the next (up to) `batch_size` examples, or
+  /// `nullopt` if the epoch is over.
+  virtual at::optional<std::vector<size_t>> next(size_t batch_size) = 0;
+
+  /// Returns the number of indices returned so far in the current epoch.
+  virtual size_t index() const noexcept = 0;
+
+  /// Moves to position `index` of the current epoch, so that the next batch
+  /// starts with the `index`-th example of the epoch.
+  virtual void seek(size_t index) = 0;
+};
+} // namespace samplers
+} // namespace data
+} // namespace torch
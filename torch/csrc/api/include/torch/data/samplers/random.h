@@ -0,0 +1,74 @@
+#pragma once
+
+#include <torch/data/samplers/base.h>
+
+#include <ATen/optional.h>
+
+#include <cereal/cereal.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+
+/// Returns a random permutation of the indices `0, ..., size - 1` in every
+/// epoch.
+///
+/// The permutation of an epoch is a function of the seed and the epoch
+/// number alone, the same with every compiler and standard library, so the
+/// sampler's state is just the seed, the epoch and the position in the epoch.
+/// Loading it regenerates the permutation, which makes checkpoints small and
+/// lets a resumed run see exactly the examples it would have seen without the
+/// interruption. The seed defaults to the initial seed
+/// of the CPU generator, so `torch::manual_seed()` makes it deterministic.
+class RandomSampler : public Sampler {
+ public:
+  explicit RandomSampler(size_t size);
+  RandomSampler(size_t size, uint64_t seed);
+
+  void reset() override;
+  at::optional<std::vector<size_t>> next(size_t batch_size) override;
+  size_t index() const noexcept override;
+  void seek(size_t index) override;
+
+  /// Returns the number of the current epoch, starting at zero.
+  size_t epoch() const noexcept;
+
+  template <class Archive>
+  void save(Archive& archive) const {
+    const size_t size = indices_.size();
+    archive(
+        CEREAL_NVP(size),
+        CEREAL_NVP(seed_),
+        CEREAL_NVP(epoch_),
+        CEREAL_NVP(index_));
+  }
+
+  template <class Archive>
+  void load(Archive& archive) {
+    size_t size = 0;
+    archive(
+        CEREAL_NVP(size),
+        CEREAL_NVP(seed_),
+        CEREAL_NVP(epoch_),
+        CEREAL_NVP(index_));
+    check_size(size);
+    permute();
+  }
+
+ private:
+  /// Fills `indices_` with the permutation of the current epoch.
+  void permute();
+  void check_size(size_t size) const;
+
+  std::vector<size_t> indices_;
+  uint64_t seed_;
+  size_t epoch_{0};
+  size_t index_{0};
+};
+} // namespace samplers
+} // namespace data
+} // namespace torch
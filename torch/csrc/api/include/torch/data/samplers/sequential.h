@@ -0,0 +1,46 @@
+#pragma once
+
+#include <torch/data/samplers/base.h>
+
+#include <ATen/optional.h>
+
+#include <cereal/cereal.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+
+/// Returns the indices `0, ..., size - 1` in order.
+class SequentialSampler : public Sampler {
+ public:
+  explicit SequentialSampler(size_t size);
+
+  void reset() override;
+  at::optional<std::vector<size_t>> next(size_t batch_size) override;
+  size_t index() const noexcept override;
+  void seek(size_t index) override;
+
+  template <class Archive>
+  void save(Archive& archive) const {
+    archive(CEREAL_NVP(size_), CEREAL_NVP(index_));
+  }
+
+  template <class Archive>
+  void load(Archive& archive) {
+    size_t size = 0;
+    archive(cereal::make_nvp("size_", size), CEREAL_NVP(index_));
+    check_size(size);
+  }
+
+ private:
+  void check_size(size_t size) const;
+
+  size_t size_;
+  size_t index_{0};
+};
+} // namespace samplers
+} // namespace data
+} // namespace torch
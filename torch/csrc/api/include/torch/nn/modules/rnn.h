@@ -12,6 +12,7 @@
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace torch {
@@ -78,10 +79,15 @@ class RNNImplBase : public torch::nn::Cloneable<Derived> {
   virtual Tensor cell_forward(Tensor input, Tensor state, int64_t layer) = 0;
 
   RNNOutput CUDNN_forward(Tensor input, Tensor state);
+  RNNOutput fused_cpu_forward(Tensor input, Tensor state);
   RNNOutput autograd_forward(Tensor input, Tensor state);
 
+  /// Splits the state into the hidden and the cell state (for LSTMs), which
+  /// are zero if the state is undefined.
+  std::pair<Tensor, Tensor> unpack_state(Tensor input, Tensor state) const;
   std::vector<Tensor> flat_weights() const;
   bool use_cudnn(Tensor sample) const;
+  bool use_fused_cpu(Tensor sample) const;
   Tensor create_dropout_state(Tensor input) const;
 
   int64_t number_of_gates_;
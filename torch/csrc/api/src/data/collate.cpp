@@ -0,0 +1,43 @@
+#include <torch/data/collate.h>
+
+#include <torch/tensor.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Error.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+Tensor stack(const std::vector<Tensor>& tensors, bool pin_memory) {
+  AT_CHECK(!tensors.empty(), "Cannot collate an empty batch");
+  const at::Tensor first = tensors.front().data();
+  std::vector<int64_t> sizes = {static_cast<int64_t>(tensors.size())};
+  sizes.insert(sizes.end(), first.sizes().begin(), first.sizes().end());
+
+  at::Tensor batch;
+  if (pin_memory) {
+    AT_CHECK(!first.is_cuda(), "Cannot pin a batch of CUDA tensors");
+    batch = first.type().tensorWithAllocator(
+        sizes, at::detail::getCUDAHooks().getPinnedMemoryAllocator());
+  } else {
+    batch = at::empty(sizes, first.options());
+  }
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const at::Tensor tensor = tensors[i].data();
+    AT_CHECK(
+        tensor.sizes().equals(first.sizes()),
+        "Cannot collate tensors of different sizes: ",
+        first.sizes(),
+        " and ",
+        tensor.sizes());
+    batch.select(0, i).copy_(tensor);
+  }
+  return autograd::make_variable(batch);
+}
+} // namespace detail
+} // namespace data
+} // namespace torch
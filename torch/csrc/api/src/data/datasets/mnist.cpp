@@ -0,0 +1,115 @@
+#include <torch/data/datasets/mnist.h>
+
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <ATen/Error.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace torch {
+namespace data {
+namespace datasets {
+namespace {
+constexpr uint32_t kImageMagicNumber = 2051;
+constexpr uint32_t kTargetMagicNumber = 2049;
+
+std::string join_paths(std::string head, const std::string& tail) {
+  if (!head.empty() && head.back() != '/') {
+    head.push_back('/');
+  }
+  head += tail;
+  return head;
+}
+
+/// Reads a big-endian 32-bit integer, as stored in IDX files.
+uint32_t read_int32(std::ifstream& stream, const std::string& path) {
+  uint8_t bytes[4];
+  stream.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+  AT_CHECK(stream, "Error reading header of ", path);
+  return static_cast<uint32_t>(bytes[0]) << 24 |
+      static_cast<uint32_t>(bytes[1]) << 16 |
+      static_cast<uint32_t>(bytes[2]) << 8 | static_cast<uint32_t>(bytes[3]);
+}
+
+void expect_int32(
+    std::ifstream& stream,
+    const std::string& path,
+    uint32_t expected,
+    const char* what) {
+  const uint32_t value = read_int32(stream, path);
+  AT_CHECK(
+      value == expected,
+      "Expected ",
+      what,
+      " to be ",
+      expected,
+      " in ",
+      path,
+      ", but found ",
+      value);
+}
+
+/// Fills the contiguous uint8 `tensor` with the next bytes of the file.
+void read_bytes(
+    std::ifstream& stream,
+    const std::string& path,
+    Tensor& tensor) {
+  stream.read(
+      reinterpret_cast<char*>(tensor.data().data<uint8_t>()), tensor.numel());
+  AT_CHECK(stream, "Unexpected end of ", path);
+}
+
+Tensor read_images(const std::string& path, int64_t& count) {
+  std::ifstream images(path, std::ios::binary);
+  AT_CHECK(images, "Error opening images file at ", path);
+  expect_int32(images, path, kImageMagicNumber, "the magic number");
+  count = read_int32(images, path);
+  const int64_t rows = read_int32(images, path);
+  const int64_t columns = read_int32(images, path);
+
+  auto tensor = torch::empty({count, 1, rows, columns}, torch::kUInt8);
+  read_bytes(images, path, tensor);
+  return tensor.toType(torch::kFloat32).div_(255);
+}
+
+Tensor read_targets(const std::string& path, int64_t count) {
+  std::ifstream targets(path, std::ios::binary);
+  AT_CHECK(targets, "Error opening targets file at ", path);
+  expect_int32(targets, path, kTargetMagicNumber, "the magic number");
+  expect_int32(targets, path, count, "the number of targets");
+
+  auto tensor = torch::empty({count}, torch::kUInt8);
+  read_bytes(targets, path, tensor);
+  return tensor.toType(torch::kInt64);
+}
+} // namespace
+
+MNIST::MNIST(const std::string& root, Mode mode) {
+  const std::string prefix = mode == Mode::kTrain ? "train" : "t10k";
+  int64_t count = 0;
+  images_ = read_images(join_paths(root, prefix + "-images-idx3-ubyte"), count);
+  targets_ = read_targets(join_paths(root, prefix + "-labels-idx1-ubyte"), count);
+}
+
+Example<> MNIST::get(size_t index) {
+  return {images_[index], targets_[index]};
+}
+
+size_t MNIST::size() const {
+  return images_.size(0);
+}
+
+const Tensor& MNIST::images() const noexcept {
+  return images_;
+}
+
+const Tensor& MNIST::targets() const noexcept {
+  return targets_;
+}
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,34 @@
+#include <torch/data/datasets/tensor.h>
+
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <ATen/Error.h>
+
+#include <cstddef>
+#include <utility>
+
+namespace torch {
+namespace data {
+namespace datasets {
+TensorDataset::TensorDataset(Tensor data, Tensor targets)
+    : data_(std::move(data)), targets_(std::move(targets)) {
+  AT_CHECK(
+      data_.size(0) == targets_.size(0),
+      "TensorDataset needs as many targets as examples, but got ",
+      targets_.size(0),
+      " targets for ",
+      data_.size(0),
+      " examples");
+}
+
+Example<> TensorDataset::get(size_t index) {
+  return {data_[index], targets_[index]};
+}
+
+size_t TensorDataset::size() const {
+  return data_.size(0);
+}
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,110 @@
+#include <torch/data/samplers/random.h>
+
+#include <ATen/Context.h>
+#include <ATen/Error.h>
+#include <ATen/optional.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+namespace {
+/// Returns a uniformly distributed integer in `[0, bound]`. Unlike
+/// `std::uniform_int_distribution`, whose algorithm is left to the standard
+/// library, this only depends on the generator's output, which the standard
+/// fully specifies for `std::mt19937_64`.
+uint64_t uniform_index(std::mt19937_64& generator, uint64_t bound) {
+  if (bound == std::numeric_limits<uint64_t>::max()) {
+    return generator();
+  }
+  const uint64_t range = bound + 1;
+  // Rejects the values in the incomplete last block of `range` values.
+  const uint64_t limit = std::numeric_limits<uint64_t>::max() -
+      std::numeric_limits<uint64_t>::max() % range;
+  uint64_t value;
+  do {
+    value = generator();
+  } while (value >= limit);
+  return value % range;
+}
+} // namespace
+
+RandomSampler::RandomSampler(size_t size)
+    : RandomSampler(
+          size,
+          at::globalContext()
+              .defaultGenerator(at::Backend::CPU)
+              .initialSeed()) {}
+
+RandomSampler::RandomSampler(size_t size, uint64_t seed)
+    : indices_(size), seed_(seed) {
+  permute();
+}
+
+void RandomSampler::reset() {
+  ++epoch_;
+  index_ = 0;
+  permute();
+}
+
+at::optional<std::vector<size_t>> RandomSampler::next(size_t batch_size) {
+  if (index_ >= indices_.size()) {
+    return at::nullopt;
+  }
+  const size_t end = std::min(index_ + batch_size, indices_.size());
+  std::vector<size_t> batch(indices_.begin() + index_, indices_.begin() + end);
+  index_ = end;
+  return batch;
+}
+
+size_t RandomSampler::index() const noexcept {
+  return index_;
+}
+
+void RandomSampler::seek(size_t index) {
+  AT_CHECK(
+      index <= indices_.size(),
+      "Cannot seek to index ",
+      index,
+      " of a sampler of size ",
+      indices_.size());
+  index_ = index;
+}
+
+size_t RandomSampler::epoch() const noexcept {
+  return epoch_;
+}
+
+void RandomSampler::permute() {
+  std::seed_seq seed_sequence{static_cast<uint32_t>(seed_),
+                              static_cast<uint32_t>(seed_ >> 32),
+                              static_cast<uint32_t>(epoch_),
+                              static_cast<uint32_t>(uint64_t(epoch_) >> 32)};
+  std::mt19937_64 generator(seed_sequence);
+  std::iota(indices_.begin(), indices_.end(), 0);
+  // Fisher-Yates, rather than std::shuffle, whose result differs between
+  // standard libraries, so that checkpoints can be resumed with any build.
+  for (size_t i = indices_.size(); i > 1; --i) {
+    std::swap(indices_[i - 1], indices_[uniform_index(generator, i - 1)]);
+  }
+}
+
+void RandomSampler::check_size(size_t size) const {
+  AT_CHECK(
+      size == indices_.size(),
+      "Loaded the state of a sampler of size ",
+      size,
+      " into a sampler of size ",
+      indices_.size());
+}
+} // namespace samplers
+} // namespace data
+} // namespace torch
@@ -0,0 +1,55 @@
+#include <torch/data/samplers/sequential.h>
+
+#include <ATen/Error.h>
+#include <ATen/optional.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+SequentialSampler::SequentialSampler(size_t size) : size_(size) {}
+
+void SequentialSampler::reset() {
+  index_ = 0;
+}
+
+at::optional<std::vector<size_t>> SequentialSampler::next(size_t batch_size) {
+  if (index_ >= size_) {
+    return at::nullopt;
+  }
+  const size_t end = std::min(index_ + batch_size, size_);
+  std::vector<size_t> indices(end - index_);
+  for (auto& index : indices) {
+    index = index_++;
+  }
+  return indices;
+}
+
+size_t SequentialSampler::index() const noexcept {
+  return index_;
+}
+
+void SequentialSampler::seek(size_t index) {
+  AT_CHECK(
+      index <= size_,
+      "Cannot seek to index ",
+      index,
+      " of a sampler of size ",
+      size_);
+  index_ = index;
+}
+
+void SequentialSampler::check_size(size_t size) const {
+  AT_CHECK(
+      size == size_,
+      "Loaded the state of a sampler of size ",
+      size,
+      " into a sampler of size ",
+      size_);
+}
+} // namespace samplers
+} // namespace data
+} // namespace torch
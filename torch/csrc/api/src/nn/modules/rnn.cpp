@@ -100,6 +100,8 @@ template <typename Derived>
 RNNOutput RNNImplBase<Derived>::forward(Tensor input, Tensor state) {
   if (use_cudnn(/*sample=*/input)) {
     return CUDNN_forward(input, state);
+  } else if (use_fused_cpu(/*sample=*/input)) {
+    return fused_cpu_forward(input, state);
   } else {
     return autograd_forward(input, state);
   }
@@ -125,6 +127,41 @@ bool RNNImplBase<Derived>::use_cudnn(Tensor sample) const {
       torch::cudnn_is_acceptable(sample);
 }
 
+template <typename Derived>
+bool RNNImplBase<Derived>::use_fused_cpu(Tensor sample) const {
+  // The fused op has no dropout between layers. Its backward is not
+  // differentiable, so double backward is not supported on this path.
+  return cudnn_mode_.has_value() && !sample.is_cuda() &&
+      (sample.dtype() == torch::kFloat32 ||
+       sample.dtype() == torch::kFloat64) &&
+      (options.dropout_ == 0 || !this->is_training());
+}
+
+template <typename Derived>
+std::pair<Tensor, Tensor> RNNImplBase<Derived>::unpack_state(
+    Tensor input,
+    Tensor state) const {
+  Tensor hx, cx;
+  if (state.defined()) {
+    if (has_cell_state_) {
+      hx = state[0];
+      cx = state[1];
+    } else {
+      hx = state;
+    }
+  } else {
+    hx = torch::zeros(
+        {options.layers_, input.size(1), options.hidden_size_},
+        input.options());
+    if (has_cell_state_) {
+      cx = torch::zeros(
+          {options.layers_, input.size(1), options.hidden_size_},
+          input.options());
+    }
+  }
+  return {hx, cx};
+}
+
 template <typename Derived>
 Tensor RNNImplBase<Derived>::create_dropout_state(Tensor input) const {
   static const int64_t dropout_seed =
@@ -217,23 +254,7 @@ void RNNImplBase<Derived>::flatten_parameters_for_cudnn() {
 template <typename Derived>
 RNNOutput RNNImplBase<Derived>::CUDNN_forward(Tensor input, Tensor state) {
   Tensor hx, cx;
-  if (state.defined()) {
-    if (has_cell_state_) {
-      hx = state[0];
-      cx = state[1];
-    } else {
-      hx = state;
-    }
-  } else {
-    hx = torch::zeros(
-        {options.layers_, input.size(1), options.hidden_size_},
-        input.options());
-    if (has_cell_state_) {
-      cx = torch::zeros(
-          {options.layers_, input.size(1), options.hidden_size_},
-          input.options());
-    }
-  }
+  std::tie(hx, cx) = unpack_state(input, state);
   std::vector<void*> weight_data_ptrs;
   for (auto& p : this->parameters()) {
     weight_data_ptrs.emplace_back(p->data().data_ptr());
@@ -273,6 +294,48 @@ RNNOutput RNNImplBase<Derived>::CUDNN_forward(Tensor input, Tensor state) {
   return {output, hidden_output};
 }
 
+template <typename Derived>
+RNNOutput RNNImplBase<Derived>::fused_cpu_forward(Tensor input, Tensor state) {
+  Tensor hx, cx;
+  std::tie(hx, cx) = unpack_state(input, state);
+  const auto weights = flat_weights();
+
+  // Only keep the activations of all steps if backward can be called.
+  // Without them, backward recomputes the forward pass instead.
+  bool needs_grad = false;
+  if (autograd::GradMode::is_enabled()) {
+    needs_grad = input.requires_grad() || hx.requires_grad() ||
+        (cx.defined() && cx.requires_grad());
+    for (const auto& weight : weights) {
+      needs_grad = needs_grad || weight.requires_grad();
+    }
+  }
+
+  // fused_output = std::tuple<output, hy, cy, reserve>
+  auto fused_output = torch::_cpu_rnn(
+      /*input=*/input,
+      /*weight=*/TensorListView(weights),
+      /*weight_stride0=*/options.with_bias_ ? 4 : 2,
+      /*hx=*/hx,
+      /*cx=*/cx,
+      /*mode=*/static_cast<int64_t>(*cudnn_mode_),
+      /*hidden_size=*/options.hidden_size_,
+      /*num_layers=*/options.layers_,
+      /*batch_first=*/false,
+      /*train=*/needs_grad,
+      /*bidirectional=*/false,
+      /*batch_sizes=*/{});
+
+  Tensor hidden_output = std::get<1>(fused_output);
+  if (has_cell_state_) {
+    auto cy = std::get<2>(fused_output);
+    hidden_output = torch::stack(TensorListView({hidden_output, cy}));
+  }
+
+  Tensor output = std::get<0>(fused_output);
+  return {output, hidden_output};
+}
+
 template <typename Derived>
 void RNNImplBase<Derived>::to(
     torch::Device device,
@@ -388,7 +451,7 @@ Tensor GRUImpl::cell_forward(Tensor input, Tensor state, int64_t layer) {
       : torch::zeros({input.size(0), options.hidden_size_}, input.options());
 
   auto gi = linear(input, w_ih[layer], b_ih[layer]);
-  auto gh = linear(input, w_hh[layer], b_hh[layer]);
+  auto gh = linear(hx, w_hh[layer], b_hh[layer]);
   auto gic = gi.chunk(3, 1);
   auto ghc = gh.chunk(3, 1);
 
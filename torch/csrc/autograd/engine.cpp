@@ -9,9 +9,11 @@
 #include <ATen/DeviceGuard.h>
 #include <ATen/ExpandUtils.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -22,7 +24,6 @@
 #include <unordered_set>
 #include <typeinfo>
 #include <sstream>
-#include <queue>
 #include <TH/TH.h>
 
 #ifdef USE_CUDA
@@ -34,6 +35,7 @@ namespace torch { namespace autograd {
 
 // NB: -1 indicates the CPU worker!
 static constexpr int NO_DEVICE = -2;
+static constexpr int CPU_DEVICE = -1;
 
 // Threads spawned by the engine are assigned a constant 'worker_device'
 // specifying what device they process work for.  This variable is initialized
@@ -52,6 +54,33 @@ static thread_local bool checkpoint_valid = true;
 // executed at the same time). Adding multiple threads per-device or removing
 // engine thread affinity to the device can break this invariant, and we depend
 // on it in a few places (e.g. AccumulateGrad function).
+//
+// Note [Multiple CPU workers]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Engine::set_num_cpu_threads (or TORCH_AUTOGRAD_CPU_THREADS) opts into
+// running several worker threads on the single CPU ready queue, so that
+// independent branches of a wide graph are evaluated concurrently. The
+// invariant above is then kept by the queue itself: a worker that pops a
+// task becomes the owner of its function until the task is done, and a
+// task whose function is owned by another worker is not run but handed to
+// that worker (ReadyQueue::pinned), which runs it once it gets back to its
+// queue. Within one GraphTask a function is queued at most once anyway, so
+// this only affects the same function reached from concurrently executing
+// graphs (e.g. the AccumulateGrad of a shared parameter).
+//
+// No worker ever waits for a function owned by another one, so a function
+// whose apply() calls backward again (e.g. checkpointing) keeps owning it
+// for the whole nested backward. If the nested GraphTask needs a function
+// owned by another worker that is itself in a nested backward, even one
+// that needs our function in turn, that worker runs it from its own loop.
+// A function is therefore only ever reentered by the thread that is already
+// running it, exactly like with a single CPU worker.
+//
+// Because all CPU workers share worker_device == -1, a reentrant GraphTask
+// owned by a CPU worker can be finished by any of them. Instead of pushing
+// a dummy task (which another worker could steal), the finishing worker
+// wakes every thread waiting on the CPU queue; the owner notices that its
+// GraphTask has no outstanding tasks left and returns.
 
 struct FunctionTask {
   GraphTask* base;
@@ -63,24 +92,77 @@ struct FunctionTask {
 
   FunctionTask(GraphTask* base, std::shared_ptr<Function> fn, InputBuffer inputs)
     : base(base)
-    , fn(fn)
+    , fn(std::move(fn))
     , inputs(std::move(inputs)) {}
 };
 
-// Returns true when t2 should be (weakly) BEFORE t1 in the queue.
-struct CompareFunctionTaskTime {
-  bool operator()(FunctionTask const & t1, FunctionTask const & t2) {
-    return t1.fn->sequence_nr() < t2.fn->sequence_nr();
-  }
-};
-
+// Note [ReadyQueue scheduling]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Tasks must come out of a ReadyQueue in sequence_nr order, so the queue is a
+// heap rather than a FIFO, and a mutex-protected one: reentrant backwards and
+// multiple CPU workers both rely on pop() observing pushes and GraphTask
+// completion under the same lock. What we can do is keep the critical section
+// short and avoid the kernel where possible:
+//
+//  - The heap only holds (sequence_nr, slot) pairs. FunctionTasks are moved
+//    once into a slot on push and once out of it on pop; the slots are
+//    recycled through a free list, so in steady state neither sifting the
+//    heap nor allocating storage touches a shared_ptr or an InputBuffer, and
+//    comparisons don't chase Function pointers.
+//  - pop() spins for a short while before parking on the condition variable,
+//    and push() only signals it when some thread is actually parked, so
+//    back-to-back handoffs between workers don't pay for a futex wakeup.
 struct ReadyQueue {
-  std::priority_queue<FunctionTask, std::vector<FunctionTask>, CompareFunctionTaskTime> heap;
+  struct HeapEntry {
+    uint64_t sequence_nr;
+    uint32_t slot;
+  };
+  // Returns true when e2 should be (weakly) BEFORE e1 in the queue.
+  struct CompareHeapEntry {
+    bool operator()(HeapEntry const & e1, HeapEntry const & e2) const {
+      return e1.sequence_nr < e2.sequence_nr;
+    }
+  };
+
+  std::vector<HeapEntry> heap;
+  std::vector<FunctionTask> slots;
+  std::vector<uint32_t> free_slots;
+  // Mirrors heap.size() so that spinning consumers can poll it without
+  // taking the mutex.
+  std::atomic<size_t> num_ready{0};
+  // Number of threads blocked on not_empty. Guarded by mutex.
+  int num_parked = 0;
   std::condition_variable not_empty;
   std::mutex mutex;
 
+  // Set for the CPU queue when several workers share it; then pop() makes
+  // the calling thread the owner of the returned task's function, until
+  // release(). See Note [Multiple CPU workers].
+  bool track_owners = false;
+  struct Owner {
+    std::thread::id thread;
+    int depth;
+  };
+  // Guarded by mutex, like the tasks handed to each owner.
+  std::unordered_map<Function*, Owner> owners;
+  std::unordered_map<std::thread::id, std::deque<FunctionTask>> pinned;
+
   void push(FunctionTask item);
-  FunctionTask pop();
+  // Blocks until a task is available. If owned_task is given, also returns
+  // (with a FunctionTask whose base is nullptr) as soon as owned_task has no
+  // outstanding tasks left. See Note [Multiple CPU workers].
+  FunctionTask pop(GraphTask* owned_task = nullptr);
+  // Gives up the ownership that pop() took of fn.
+  void release(Function* fn);
+  // Wakes all threads blocked in pop() so they re-check their GraphTask.
+  void wake_all();
+
+private:
+  // Called with mutex held. Removes the first task from the heap.
+  FunctionTask take_top();
+  // Called with mutex held. Makes the calling thread the owner of
+  // task.fn, or hands the task to its current owner and returns false.
+  bool claim(FunctionTask& task, bool& handed_over);
 };
 
 // Note [Reentrant backwards]
@@ -182,20 +264,142 @@ struct GraphTask {
     , owner(NO_DEVICE) {}
 };
 
+// Number of times pop() polls an empty queue before parking.
+// See Note [ReadyQueue scheduling]
+static constexpr int POP_SPIN_ITERATIONS = 64;
+
 auto ReadyQueue::push(FunctionTask item) -> void {
+  bool wake;
   {
     std::lock_guard<std::mutex> lock(mutex);
     ++item.base->outstanding_tasks;
-    heap.push(std::move(item));
+    // Dummy tasks (see Note [Reentrant backwards]) carry no function; put
+    // them first, they only exist to wake the owning worker up.
+    uint64_t sequence_nr = item.fn ? item.fn->sequence_nr() : UINT64_MAX;
+    uint32_t slot;
+    if (free_slots.empty()) {
+      slot = static_cast<uint32_t>(slots.size());
+      slots.push_back(std::move(item));
+    } else {
+      slot = free_slots.back();
+      free_slots.pop_back();
+      slots[slot] = std::move(item);
+    }
+    heap.push_back(HeapEntry{sequence_nr, slot});
+    std::push_heap(heap.begin(), heap.end(), CompareHeapEntry());
+    num_ready.store(heap.size(), std::memory_order_relaxed);
+    wake = num_parked > 0;
+  }
+  if (wake) {
+    not_empty.notify_one();
   }
-  not_empty.notify_one();
 }
 
-auto ReadyQueue::pop() -> FunctionTask {
+auto ReadyQueue::pop(GraphTask* owned_task) -> FunctionTask {
+  auto ready = [this, owned_task]{
+    return !heap.empty() || (owned_task && owned_task->outstanding_tasks == 0);
+  };
+  for (int i = 0; i < POP_SPIN_ITERATIONS; ++i) {
+    if (num_ready.load(std::memory_order_relaxed) > 0 ||
+        (owned_task && owned_task->outstanding_tasks == 0)) {
+      break;
+    }
+    std::this_thread::yield();
+  }
   std::unique_lock<std::mutex> lock(mutex);
-  not_empty.wait(lock, [this]{ return !heap.empty(); });
-  auto task = std::move(const_cast<FunctionTask&>(heap.top())); heap.pop();
-  return task;
+  if (!track_owners) {
+    if (!ready()) {
+      ++num_parked;
+      not_empty.wait(lock, ready);
+      --num_parked;
+    }
+    if (heap.empty()) {
+      return FunctionTask(nullptr, nullptr, InputBuffer(0));
+    }
+    return take_top();
+  }
+
+  // See Note [Multiple CPU workers]
+  auto& mine = pinned[std::this_thread::get_id()];
+  FunctionTask result(nullptr, nullptr, InputBuffer(0));
+  bool handed_over = false;
+  while (true) {
+    FunctionTask task(nullptr, nullptr, InputBuffer(0));
+    if (!mine.empty()) {
+      task = std::move(mine.front());
+      mine.pop_front();
+    } else if (!heap.empty()) {
+      task = take_top();
+    } else if (owned_task && owned_task->outstanding_tasks == 0) {
+      break;
+    } else if (handed_over) {
+      // Wake the owners up before going to sleep ourselves.
+      lock.unlock();
+      not_empty.notify_all();
+      handed_over = false;
+      lock.lock();
+      continue;
+    } else {
+      ++num_parked;
+      not_empty.wait(lock);
+      --num_parked;
+      continue;
+    }
+    if (claim(task, handed_over)) {
+      result = std::move(task);
+      break;
+    }
+  }
+  lock.unlock();
+  if (handed_over) {
+    not_empty.notify_all();
+  }
+  return result;
+}
+
+auto ReadyQueue::take_top() -> FunctionTask {
+  std::pop_heap(heap.begin(), heap.end(), CompareHeapEntry());
+  uint32_t slot = heap.back().slot;
+  heap.pop_back();
+  num_ready.store(heap.size(), std::memory_order_relaxed);
+  free_slots.push_back(slot);
+  // The moved-from slot keeps no references; it is reused by a later push.
+  return std::move(slots[slot]);
+}
+
+auto ReadyQueue::claim(FunctionTask& task, bool& handed_over) -> bool {
+  if (!task.fn) {
+    return true;
+  }
+  auto self = std::this_thread::get_id();
+  auto it = owners.find(task.fn.get());
+  if (it == owners.end()) {
+    owners.emplace(task.fn.get(), Owner{self, 1});
+    return true;
+  }
+  if (it->second.thread == self) {
+    // Reentrant backward through a function this thread is running.
+    ++it->second.depth;
+    return true;
+  }
+  pinned[it->second.thread].push_back(std::move(task));
+  handed_over = true;
+  return false;
+}
+
+auto ReadyQueue::release(Function* fn) -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = owners.find(fn);
+  if (--it->second.depth == 0) {
+    owners.erase(it);
+  }
+}
+
+auto ReadyQueue::wake_all() -> void {
+  // Taking the mutex orders this against a waiter that has just checked its
+  // predicate, so the wakeup cannot be lost.
+  { std::lock_guard<std::mutex> lock(mutex); }
+  not_empty.notify_all();
 }
 
 Engine::Engine() : ready_queues() {
@@ -227,10 +431,19 @@ auto Engine::thread_init(int device) -> void {
 // in case this code is to be changed.
 auto Engine::thread_main(GraphTask *graph_task) -> void {
   auto queue = ready_queues[worker_device + 1];
+  // Only a queue shared by several workers needs pop() to watch graph_task;
+  // everywhere else completion is signalled by a dummy task.
+  // See Note [Multiple CPU workers].
+  const bool shared_queue = worker_device == CPU_DEVICE && num_cpu_threads > 1;
+  GraphTask* watched_task = shared_queue ? graph_task : nullptr;
   // Why the test on graph_task->outstanding_tasks?  See
   // Note [Reentrant backwards]
   while (!graph_task || graph_task->outstanding_tasks > 0) {
-    FunctionTask task = queue->pop();
+    FunctionTask task = queue->pop(watched_task);
+    if (!task.base) {
+      // Woken up because graph_task finished on another CPU worker.
+      continue;
+    }
     if (task.fn && !task.base->has_error.load()) {
       GradMode::set_enabled(task.base->grad_mode);
       try {
@@ -239,6 +452,9 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
         thread_on_exception(task, e);
       }
     }
+    if (shared_queue && task.fn) {
+      queue->release(task.fn.get());
+    }
     // Notify downstream about the completion of tasks depending
     // on both where the task was executed, and who owned the overall
     // graph (in case of reentrant execution.)  See Note [Reentrant backwards].
@@ -249,6 +465,12 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
         std::lock_guard<std::mutex> lock(task.base->mutex);
         task.base->not_done.notify_all();
       }
+    } else if (base_owner == CPU_DEVICE && num_cpu_threads > 1) {
+      // The owner is one of several CPU workers, possibly not this one.
+      // See Note [Multiple CPU workers].
+      if (--task.base->outstanding_tasks == 0) {
+        ready_queue(base_owner).wake_all();
+      }
     } else {
       // If it's a task initiated from this thread, decrease the counter, but
       // don't do anything - loop condition will do all checks for us next.
@@ -464,20 +686,20 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
 
 /* Computes the number of dependencies for each function which requires grad */
 auto Engine::compute_dependencies(Function* root, GraphTask& task) -> void {
-  // Just to make sure that they will never be added to the queue again
-  std::unordered_set<Function*> seen;
   std::vector<Function*> queue { root };
 
   // Queue contains all nodes that will start propagating gradients.
   // We no longer have to expand functions that don't require grad.
+  // A function is only added to the queue when it first gets an entry in
+  // dependencies, so it will never be added to the queue again.
   auto& dependencies = task.dependencies;
   while (queue.size() > 0) {
     auto fn = queue.back(); queue.pop_back();
     for (const auto& edge : fn->next_edges()) {
       if (auto next_ptr = edge.function.get()) {
-        dependencies[next_ptr] += 1;
-        const bool was_inserted = seen.insert(next_ptr).second;
-        if (was_inserted) queue.push_back(next_ptr);
+        auto it = dependencies.emplace(next_ptr, 0);
+        it.first->second += 1;
+        if (it.second) queue.push_back(next_ptr);
       }
     }
   }
@@ -593,6 +815,17 @@ auto Engine::ready_queue(int device) -> ReadyQueue& {
   return *ready_queues.at(device + 1);
 }
 
+void Engine::set_num_cpu_threads(int num_threads) {
+  if (num_threads < 1) {
+    throw std::runtime_error("the number of autograd CPU threads must be positive");
+  }
+  if (threads_started.load()) {
+    throw std::runtime_error(
+        "set_num_cpu_threads must be called before the first backward pass");
+  }
+  num_cpu_threads = num_threads;
+}
+
 auto Engine::start_threads() -> void {
   int num_devices = 0;
 #ifdef USE_CUDA
@@ -602,15 +835,29 @@ auto Engine::start_threads() -> void {
     num_devices = 0;
   }
 #endif
+  threads_started = true;
+  if (num_cpu_threads == 0) {
+    num_cpu_threads = 1;
+    if (const char* env_p = std::getenv("TORCH_AUTOGRAD_CPU_THREADS")) {
+      num_cpu_threads = std::max(std::atoi(env_p), 1);
+    }
+  }
   // One for CPU, plus one for every GPU device
   int num_threads = num_devices + 1;
   ready_queues = std::vector<std::shared_ptr<ReadyQueue>>(num_threads);
   for (auto& queue : ready_queues)
     queue.reset(new ReadyQueue());
+  ready_queue(CPU_DEVICE).track_owners = num_cpu_threads > 1;
   for (int i = 0; i < num_threads; ++i) {
     std::thread t(&Engine::thread_init, this, i - 1);
     t.detach();
   }
+  // Additional CPU workers all serve the same CPU ready queue.
+  // See Note [Multiple CPU workers]
+  for (int i = 1; i < num_cpu_threads; ++i) {
+    std::thread t(&Engine::thread_init, this, CPU_DEVICE);
+    t.detach();
+  }
 }
 
 void GraphTask::init_to_execute(Function& graph_root, const edge_list& outputs) {
@@ -8,6 +8,7 @@
 #include "torch/csrc/autograd/input_buffer.h"
 #include "torch/csrc/autograd/anomaly_mode.h"
 
+#include <atomic>
 #include <deque>
 #include <exception>
 #include <functional>
@@ -51,6 +52,11 @@ struct TORCH_API Engine {
 
   bool is_checkpoint_valid();
 
+  /// Sets the number of worker threads that process CPU work. Must be called
+  /// before the first call to `execute()`. When not set, the value of the
+  /// TORCH_AUTOGRAD_CPU_THREADS environment variable is used, or 1.
+  void set_num_cpu_threads(int num_threads);
+
 protected:
   void compute_dependencies(Function* root, GraphTask& task);
   void evaluate_function(FunctionTask& task);
@@ -61,6 +67,9 @@ protected:
   virtual void thread_on_exception(FunctionTask& task, std::exception& e);
 
   std::once_flag start_threads_flag;
+  std::atomic<bool> threads_started{false};
+  // 0 means "not set"; resolved in start_threads()
+  int num_cpu_threads = 0;
   std::vector<std::shared_ptr<ReadyQueue>> ready_queues;
   std::vector<std::function<void()>> final_callbacks;
   std::mutex post_callbacks_lock;
@@ -14,6 +14,7 @@
 #include <pybind11/chrono.h>
 
 #include "torch/csrc/Exceptions.h"
+#include "torch/csrc/distributed/c10d/reducer.h"
 #include "torch/csrc/utils/object_ptr.h"
 #include "torch/csrc/utils/pybind.h"
 
@@ -42,7 +43,28 @@ PyObject* c10d_init(PyObject* _unused) {
 
   py::class_<::c10d::AllreduceOptions>(module, "AllreduceOptions")
       .def(py::init<>())
-      .def_readwrite("reduceOp", &::c10d::AllreduceOptions::reduceOp);
+      .def_readwrite("reduceOp", &::c10d::AllreduceOptions::reduceOp)
+      .def_readwrite("compression", &::c10d::AllreduceOptions::compression)
+      .def_readwrite("topkRatio", &::c10d::AllreduceOptions::topkRatio)
+      .def_readwrite("residual", &::c10d::AllreduceOptions::residual);
+
+  py::class_<::c10d::ReduceOptions>(module, "ReduceOptions")
+      .def(py::init<>())
+      .def_readwrite("reduceOp", &::c10d::ReduceOptions::reduceOp)
+      .def_readwrite("rootRank", &::c10d::ReduceOptions::rootRank)
+      .def_readwrite("rootTensor", &::c10d::ReduceOptions::rootTensor);
+
+  py::class_<::c10d::GatherOptions>(module, "GatherOptions")
+      .def(py::init<>())
+      .def_readwrite("rootRank", &::c10d::GatherOptions::rootRank);
+
+  py::class_<::c10d::ScatterOptions>(module, "ScatterOptions")
+      .def(py::init<>())
+      .def_readwrite("rootRank", &::c10d::ScatterOptions::rootRank);
+
+  py::class_<::c10d::ReduceScatterOptions>(module, "ReduceScatterOptions")
+      .def(py::init<>())
+      .def_readwrite("reduceOp", &::c10d::ReduceScatterOptions::reduceOp);
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp")
       .value("SUM", ::c10d::ReduceOp::SUM)
@@ -50,6 +72,12 @@ PyObject* c10d_init(PyObject* _unused) {
       .value("MIN", ::c10d::ReduceOp::MIN)
       .value("MAX", ::c10d::ReduceOp::MAX);
 
+  py::enum_<::c10d::Compression>(module, "Compression")
+      .value("NONE", ::c10d::Compression::NONE)
+      .value("FP16", ::c10d::Compression::FP16)
+      .value("INT8", ::c10d::Compression::INT8)
+      .value("TOPK", ::c10d::Compression::TOPK);
+
   auto store =
       shared_ptr_class_<::c10d::Store>(module, "Store")
           // Convert from std::string to std::vector<uint8>.
@@ -79,6 +107,64 @@ PyObject* c10d_init(PyObject* _unused) {
           .def(
               "wait",
               &::c10d::Store::wait,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys)
+                  -> std::vector<py::bytes> {
+                auto values = store.multiGet(keys);
+                std::vector<py::bytes> result;
+                for (const auto& value : values) {
+                  result.emplace_back(
+                      reinterpret_cast<const char*>(value.data()),
+                      value.size());
+                }
+                return result;
+              },
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "compare_set",
+              [](::c10d::Store& store,
+                 const std::string& key,
+                 const std::string& expected_value,
+                 const std::string& desired_value) -> py::bytes {
+                auto value = store.compareSet(
+                    key,
+                    std::vector<uint8_t>(
+                        expected_value.begin(), expected_value.end()),
+                    std::vector<uint8_t>(
+                        desired_value.begin(), desired_value.end()));
+                return py::bytes(
+                    reinterpret_cast<char*>(value.data()), value.size());
+              },
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "watch",
+              [](::c10d::Store& store,
+                 const std::string& key,
+                 const std::string& value,
+                 const std::chrono::milliseconds& timeout) -> py::bytes {
+                auto newValue = store.watch(
+                    key, std::vector<uint8_t>(value.begin(), value.end()),
+                    timeout);
+                return py::bytes(
+                    reinterpret_cast<char*>(newValue.data()), newValue.size());
+              },
+              py::arg("key"),
+              py::arg("value"),
+              py::arg("timeout") = ::c10d::Store::kDefaultTimeout,
               py::call_guard<py::gil_scoped_release>());
 
   shared_ptr_class_<::c10d::FileStore>(module, "FileStore", store)
@@ -121,6 +207,58 @@ PyObject* c10d_init(PyObject* _unused) {
               },
               py::arg("tensor"),
               py::arg("op") = ::c10d::ReduceOp::SUM,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "reduce",
+              &::c10d::ProcessGroup::reduce,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "reduce",
+              [](::c10d::ProcessGroup& pg,
+                 at::Tensor& x,
+                 int rootRank,
+                 ::c10d::ReduceOp op) {
+                ::c10d::ReduceOptions opts;
+                opts.reduceOp = op;
+                opts.rootRank = rootRank;
+                std::vector<at::Tensor> xs = {x};
+                return pg.reduce(xs, opts);
+              },
+              py::arg("tensor"),
+              py::arg("root"),
+              py::arg("op") = ::c10d::ReduceOp::SUM,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "allgather",
+              &::c10d::ProcessGroup::allgather,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "gather",
+              &::c10d::ProcessGroup::gather,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "scatter",
+              &::c10d::ProcessGroup::scatter,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "reduce_scatter",
+              &::c10d::ProcessGroup::reduce_scatter,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "send",
+              &::c10d::ProcessGroup::send,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "recv",
+              &::c10d::ProcessGroup::recv,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "recv_anysource",
+              &::c10d::ProcessGroup::recvAnysource,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "barrier",
+              &::c10d::ProcessGroup::barrier,
               py::call_guard<py::gil_scoped_release>());
 
   auto processGroupGloo = shared_ptr_class_<::c10d::ProcessGroupGloo>(
@@ -189,11 +327,23 @@ PyObject* c10d_init(PyObject* _unused) {
       .def(py::init<const std::shared_ptr<::c10d::Store>&, int, int>());
 #endif
 
+  shared_ptr_class_<Reducer>(module, "Reducer")
+      .def(
+          py::init<
+              std::vector<torch::autograd::Variable>,
+              std::shared_ptr<::c10d::ProcessGroup>,
+              int64_t>(),
+          py::arg("parameters"),
+          py::arg("process_group"),
+          py::arg("bucket_bytes_cap") = 25 * 1024 * 1024)
+      .def("get_bucket_indices", &Reducer::get_bucket_indices);
+
   shared_ptr_class_<::c10d::ProcessGroup::Work>(module, "Work")
       .def("isCompleted", &::c10d::ProcessGroup::Work::isCompleted)
       .def("isSuccess", &::c10d::ProcessGroup::Work::isSuccess)
       .def("exception", &::c10d::ProcessGroup::Work::exception)
       .def("synchronize", &::c10d::ProcessGroup::Work::synchronize)
+      .def("source_rank", &::c10d::ProcessGroup::Work::sourceRank)
       .def(
           "wait",
           &::c10d::ProcessGroup::Work::wait,
@@ -0,0 +1,192 @@
+#include "torch/csrc/distributed/c10d/reducer.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "torch/csrc/autograd/function_hook.h"
+
+namespace torch {
+namespace distributed {
+namespace c10d {
+
+namespace {
+
+using torch::autograd::Variable;
+using torch::autograd::variable_list;
+
+struct LambdaPostHook : public torch::autograd::FunctionPostHook {
+  explicit LambdaPostHook(std::function<void()> fn) : fn_(std::move(fn)) {}
+
+  variable_list operator()(
+      const variable_list& outputs,
+      const variable_list& /* unused */) override {
+    fn_();
+    return outputs;
+  }
+
+ protected:
+  std::function<void()> fn_;
+};
+
+} // namespace
+
+Reducer::Reducer(
+    std::vector<torch::autograd::Variable> parameters,
+    std::shared_ptr<::c10d::ProcessGroup> process_group,
+    int64_t bucket_bytes_cap)
+    : variables_(std::move(parameters)),
+      process_group_(std::move(process_group)),
+      locators_(variables_.size()),
+      ready_(variables_.size(), false),
+      next_bucket_(0) {
+  AT_CHECK(bucket_bytes_cap > 0, "bucket_bytes_cap must be positive");
+
+  // Assign the parameters to buckets in reverse order, with a bucket
+  // per type that is open until adding the next parameter would make it
+  // larger than bucket_bytes_cap.
+  std::unordered_map<const at::Type*, size_t> open_buckets;
+  std::vector<int64_t> bucket_numel;
+  for (size_t i = variables_.size(); i-- > 0;) {
+    const auto& variable = variables_[i];
+    if (!variable.requires_grad()) {
+      continue;
+    }
+    const auto& type = variable.data().type();
+    const int64_t numel = variable.numel();
+    const int64_t element_size = type.elementSizeInBytes();
+    auto it = open_buckets.find(&type);
+    if (it == open_buckets.end() ||
+        (bucket_numel[it->second] + numel) * element_size > bucket_bytes_cap) {
+      buckets_.emplace_back();
+      bucket_numel.push_back(0);
+      open_buckets[&type] = buckets_.size() - 1;
+    }
+
+    const size_t bucket_index = open_buckets[&type];
+    auto& bucket = buckets_[bucket_index];
+    locators_[i] = VariableLocator{bucket_index, bucket.variable_indices.size()};
+    bucket.variable_indices.push_back(i);
+    bucket.offsets.push_back(bucket_numel[bucket_index]);
+    bucket_numel[bucket_index] += numel;
+  }
+
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    auto& bucket = buckets_[i];
+    const auto& type = variables_[bucket.variable_indices[0]].data().type();
+    bucket.contents = at::zeros({bucket_numel[i]}, type);
+    bucket.pending = bucket.variable_indices.size();
+  }
+
+  // Hook into the gradient accumulators, which run once the gradient of
+  // their parameter has been accumulated into its .grad.
+  for (size_t i = 0; i < variables_.size(); i++) {
+    if (!variables_[i].requires_grad()) {
+      continue;
+    }
+    auto grad_accumulator = variables_[i].grad_accumulator();
+    std::unique_ptr<torch::autograd::FunctionPostHook> hook(
+        new LambdaPostHook([this, i] { mark_variable_ready(i); }));
+    hooks_.push_back(hook.get());
+    grad_accumulator->add_post_hook(std::move(hook));
+    grad_accumulators_.push_back(std::move(grad_accumulator));
+  }
+}
+
+Reducer::~Reducer() {
+  for (size_t i = 0; i < grad_accumulators_.size(); i++) {
+    auto& hooks = grad_accumulators_[i]->post_hooks();
+    auto hook = hooks_[i];
+    hooks.erase(
+        std::remove_if(
+            hooks.begin(),
+            hooks.end(),
+            [hook](const std::unique_ptr<torch::autograd::FunctionPostHook>&
+                       other) { return other.get() == hook; }),
+        hooks.end());
+  }
+}
+
+std::vector<std::vector<size_t>> Reducer::get_bucket_indices() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::vector<size_t>> indices;
+  for (const auto& bucket : buckets_) {
+    indices.push_back(bucket.variable_indices);
+  }
+  return indices;
+}
+
+void Reducer::mark_variable_ready(size_t index) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AT_CHECK(
+      !ready_[index],
+      "Parameter ",
+      index,
+      " got a gradient twice in one backward pass, which the reducer "
+      "does not support");
+  ready_[index] = true;
+
+  auto& variable = variables_[index];
+  const auto& grad = variable.grad();
+  AT_CHECK(
+      !grad.requires_grad(),
+      "The reducer only works with gradients that don't require grad");
+
+  // Copy the gradient into its bucket
+  const auto& locator = locators_[index];
+  auto& bucket = buckets_[locator.bucket_index];
+  const auto offset = bucket.offsets[locator.intra_bucket_index];
+  bucket.contents.narrow(0, offset, variable.numel())
+      .view(variable.sizes())
+      .copy_(torch::autograd::as_variable_ref(grad).data());
+  if (--bucket.pending > 0) {
+    return;
+  }
+
+  // Start the allreduce of all buckets that are full, in order
+  while (next_bucket_ < buckets_.size() &&
+         buckets_[next_bucket_].pending == 0) {
+    auto& next = buckets_[next_bucket_];
+    std::vector<at::Tensor> tensors = {next.contents};
+    next.work = process_group_->allreduce(tensors);
+    next_bucket_++;
+  }
+
+  if (next_bucket_ == buckets_.size()) {
+    finalize_backward();
+  }
+}
+
+void Reducer::finalize_backward() {
+  // Reset the state for the next backward pass first, so that a failed
+  // reduction leaves the reducer usable.
+  next_bucket_ = 0;
+  std::fill(ready_.begin(), ready_.end(), false);
+  std::vector<std::shared_ptr<::c10d::ProcessGroup::Work>> work;
+  for (auto& bucket : buckets_) {
+    bucket.pending = bucket.variable_indices.size();
+    work.push_back(std::move(bucket.work));
+  }
+
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    if (!work[i]->wait()) {
+      throw std::runtime_error(work[i]->exception().what());
+    }
+
+    // Average the reduced gradients and unflatten them in place
+    auto& bucket = buckets_[i];
+    bucket.contents.div_(process_group_->getSize());
+    for (size_t j = 0; j < bucket.variable_indices.size(); j++) {
+      auto& variable = variables_[bucket.variable_indices[j]];
+      torch::autograd::as_variable_ref(variable.grad())
+          .data()
+          .copy_(bucket.contents.narrow(0, bucket.offsets[j], variable.numel())
+                     .view(variable.sizes()));
+    }
+  }
+}
+
+} // namespace c10d
+} // namespace distributed
+} // namespace torch
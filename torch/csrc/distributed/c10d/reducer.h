@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+
+#include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/variable.h"
+
+namespace torch {
+namespace distributed {
+namespace c10d {
+
+// Averages the gradients of a set of parameters over a process group
+// while the backward pass is still running.
+//
+// The parameters are packed into buckets of at most bucket_bytes_cap
+// bytes (a parameter larger than that gets a bucket of its own), in
+// reverse order, which is roughly the order their gradients become
+// ready during the backward pass. Every bucket owns a flat tensor that
+// gradients are copied into by post hooks on the gradient accumulators
+// of the parameters. As soon as a bucket is full, an asynchronous
+// allreduce of it is started, so that the reduction overlaps with the
+// rest of the backward pass and small parameters share a collective.
+//
+// Buckets are reduced in order, so all processes start the same
+// collectives in the same order even if their gradients become ready in
+// a different order. Once the last bucket has been started, the
+// reducer waits for all of them and copies the averaged gradients back
+// into the .grad of the parameters.
+//
+// Every parameter must get a gradient in every backward pass, and
+// gradients must not require grad themselves.
+class Reducer {
+ public:
+  explicit Reducer(
+      std::vector<torch::autograd::Variable> parameters,
+      std::shared_ptr<::c10d::ProcessGroup> process_group,
+      int64_t bucket_bytes_cap = 25 * 1024 * 1024);
+
+  ~Reducer();
+
+  // The indices of the parameters in every bucket, in bucket order.
+  std::vector<std::vector<size_t>> get_bucket_indices() const;
+
+ protected:
+  struct Bucket {
+    // The gradients of the parameters of this bucket, flattened and
+    // concatenated.
+    at::Tensor contents;
+    std::vector<size_t> variable_indices;
+    std::vector<int64_t> offsets;
+
+    // The number of parameters whose gradient is not in contents yet.
+    size_t pending;
+    std::shared_ptr<::c10d::ProcessGroup::Work> work;
+  };
+
+  struct VariableLocator {
+    size_t bucket_index;
+    size_t intra_bucket_index;
+  };
+
+  // Called by the post hook of parameter index.
+  void mark_variable_ready(size_t index);
+
+  // Waits for all buckets and writes the averaged gradients back.
+  void finalize_backward();
+
+  mutable std::mutex mutex_;
+  std::vector<torch::autograd::Variable> variables_;
+  std::shared_ptr<::c10d::ProcessGroup> process_group_;
+
+  // The accumulators are kept alive so that the hooks stay registered:
+  // the variables themselves only hold weak references to them.
+  std::vector<std::shared_ptr<torch::autograd::Function>> grad_accumulators_;
+  std::vector<torch::autograd::FunctionPostHook*> hooks_;
+
+  std::vector<Bucket> buckets_;
+  std::vector<VariableLocator> locators_;
+  std::vector<bool> ready_;
+  // The first bucket whose allreduce has not been started yet.
+  size_t next_bucket_;
+};
+
+} // namespace c10d
+} // namespace distributed
+} // namespace torch
@@ -268,6 +268,27 @@ static PyObject *THPStorage_(setFromFile)(THPStorage *self, PyObject *args)
 }
 #endif // !defined(THD_GENERIC_FILE)
 
+#if !defined(THC_GENERIC_FILE) && !defined(THD_GENERIC_FILE)
+static PyObject * THPStorage_(newFromMapping)(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  PyObject *mapping;
+  long long offset;
+  long long size;
+  if (!PyArg_ParseTuple(args, "OLL", &mapping, &offset, &size)) {
+    return NULL;
+  }
+  THPUtils_assert(THPByteStorage_Check(mapping), "_new_from_mapping expects "
+      "a torch.ByteStorage, but got %s", THPUtils_typename(mapping));
+  THWStorage *storage = THPStorage_(newFromMappingRaw)(
+      ((THPByteStorage*)mapping)->cdata, offset, size);
+  if (storage == nullptr)
+    return nullptr;
+  return THPStorage_(New)(storage);
+  END_HANDLE_TH_ERRORS
+}
+#endif
+
 #ifdef THC_GENERIC_FILE
 PyObject * THPStorage_(getDevice)(THPStorage *self)
 {
@@ -308,6 +329,7 @@ static PyMethodDef THPStorage_(methods)[] = {
 #endif // !defined(THD_GENERIC_FILE)
 #if !defined(THC_GENERIC_FILE) && !defined(THD_GENERIC_FILE)
   {"from_buffer", (PyCFunction)THPStorage_(fromBuffer), METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
+  {"_new_from_mapping", (PyCFunction)THPStorage_(newFromMapping), METH_VARARGS | METH_STATIC, NULL},
 #endif
   {"from_file", (PyCFunction)THPStorage_(fromFile), METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
 #ifdef THC_GENERIC_FILE
@@ -142,6 +142,34 @@ THWStorage * THPStorage_(readFileRaw)(io file, THWStorage *_storage)
 template THWStorage* THPStorage_(readFileRaw<int>)(int fd, THWStorage* storage);
 template THWStorage* THPStorage_(readFileRaw<PyObject*>)(PyObject* fd, THWStorage* storage);
 
+#ifndef THC_GENERIC_FILE
+static void THPStorage_(freeMapping)(void *mapping)
+{
+  THByteStorage_free((THByteStorage*)mapping);
+}
+
+// Returns a storage of `size` elements whose data are the bytes of `mapping`
+// (typically a file mapped with THMapAllocator) starting at `offset`, without
+// copying them. The storage keeps the mapping alive, and can't be resized.
+THWStorage * THPStorage_(newFromMappingRaw)(THByteStorage *mapping, int64_t offset, int64_t size)
+{
+  int64_t mapping_size = THByteStorage_size(mapping);
+  THPUtils_assert(offset >= 0 && size >= 0 &&
+      offset + size * (int64_t)sizeof(real) <= mapping_size,
+      "storage of %ld bytes at offset %ld is out of bounds of a mapping of "
+      "%ld bytes", (long)(size * sizeof(real)), (long)offset, (long)mapping_size);
+  uint8_t *data = THByteStorage_data(mapping) + offset;
+  THPUtils_assert((uintptr_t)data % alignof(real) == 0,
+      "storage at offset %ld is not aligned", (long)offset);
+  THByteStorage_retain(mapping);
+  THWStorage *storage = THWStorage_(newWithDataAndAllocator)(
+      at::DataPtr(data, mapping, &THPStorage_(freeMapping), at::kCPU),
+      size, /* allocator */ nullptr);
+  storage->resizable = false;
+  return storage;
+}
+#endif
+
 #undef SYSCHECK
 
 #endif
@@ -8,4 +8,8 @@ void THPStorage_(writeFileRaw)(THWStorage *self, io fd);
 template <class io>
 THWStorage * THPStorage_(readFileRaw)(io fd, THWStorage *storage);
 
+#ifndef THC_GENERIC_FILE
+THWStorage * THPStorage_(newFromMappingRaw)(THByteStorage *mapping, int64_t offset, int64_t size);
+#endif
+
 #endif
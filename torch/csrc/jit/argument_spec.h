@@ -102,6 +102,11 @@ struct ArgumentSpec {
   size_t hashCode() const {
     return hash_code;
   }
+  // the raw encoding compared by operator==, used to persist plans keyed
+  // by their spec (see plan_cache.h)
+  at::ArrayRef<int64_t> encoding() const {
+    return data;
+  }
 
 private:
   ArrayRef<ArgumentInfoPOD> tensor_info() const {
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/stat.h>
+
+// Helpers shared by the on-disk caches of the JIT: the fuser's cache of
+// compiled CPU kernels and the GraphExecutor plan cache.
+
+namespace torch { namespace jit {
+
+// 64-bit FNV-1a hash, used to name cache entries. Both caches store the
+// full key in the entry and compare it on load, so collisions are harmless.
+inline uint64_t fnv1a(const std::string & str) {
+  uint64_t h = 14695981039346656037ULL;
+  for(unsigned char c : str) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// Like mkdir -p. Returns false, with errno set, if a directory could not be
+// created.
+inline bool makeDirectories(const std::string & path) {
+  for(size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+    std::string prefix = path.substr(0, pos);
+    if(mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+    if(pos == std::string::npos)
+      return true;
+  }
+}
+
+inline bool readFile(const std::string & path, std::string & contents) {
+  std::ifstream in(path, std::ios::binary);
+  if(!in)
+    return false;
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  contents = ss.str();
+  return true;
+}
+
+}}
@@ -5,12 +5,16 @@
 #include "torch/csrc/jit/code_template.h"
 #include "torch/csrc/jit/resource_guard.h"
 #include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/disk_cache.h"
 
 #include "torch/csrc/utils/disallow_copy.h"
 #include "torch/csrc/variable_tensor_functions.h"
 #include <torch/csrc/jit/assertions.h>
 
 #include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/SmallVector.h"
 
 #ifdef USE_CUDA
 #include "ATen/cuda/CUDAContext.h"
@@ -23,11 +27,17 @@
 
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
 #include <dlfcn.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 namespace torch { namespace jit {
@@ -496,6 +506,453 @@ void compressContiguous(
   JIT_ASSERT(!cont.back() || strides.back() == 1);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Interpretation
+//
+// CPU fusion groups are normally run by lowering the subgraph into a small
+// straight-line program over float registers and interpreting it in-process,
+// so that no C++ compiler is needed at runtime and a new kernel costs
+// microseconds instead of a compiler invocation. Each register holds one
+// block of kBlockSize elements: a launch walks the iteration space block by
+// block, loads every input block (converting to float, like the generated
+// code does), runs every instruction over the whole block, and stores the
+// output blocks. The per-instruction loops are simple enough to be
+// auto-vectorized, and blocks are spread across threads with at::parallel_for.
+
+namespace interp {
+
+constexpr int64_t kBlockSize = 256;
+
+#define FORALL_INTERP_OPS(_) \
+  _(Abs, abs)                \
+  _(Sigmoid, sigmoid)        \
+  _(Relu, relu)              \
+  _(Log, log)                \
+  _(Log10, log10)            \
+  _(Log1p, log1p)            \
+  _(Log2, log2)              \
+  _(Lgamma, lgamma)          \
+  _(Exp, exp)                \
+  _(Expm1, expm1)            \
+  _(Cos, cos)                \
+  _(Acos, acos)              \
+  _(Cosh, cosh)              \
+  _(Sin, sin)                \
+  _(Asin, asin)              \
+  _(Sinh, sinh)              \
+  _(Tan, tan)                \
+  _(Atan, atan)              \
+  _(Tanh, tanh)              \
+  _(Sqrt, sqrt)              \
+  _(Rsqrt, rsqrt)            \
+  _(Ceil, ceil)              \
+  _(Floor, floor)            \
+  _(Round, round)            \
+  _(Trunc, trunc)            \
+  _(Frac, frac)              \
+  _(Reciprocal, reciprocal)  \
+  _(Neg, neg)                \
+  _(TypeAs, type_as)         \
+  _(Atan2, atan2)            \
+  _(Min, min)                \
+  _(Max, max)                \
+  _(And, __and__)            \
+  _(Or, __or__)              \
+  _(Div, div)                \
+  _(Mul, mul)                \
+  _(Eq, eq)                  \
+  _(Ne, ne)                  \
+  _(Ge, ge)                  \
+  _(Gt, gt)                  \
+  _(Le, le)                  \
+  _(Lt, lt)                  \
+  _(Fmod, fmod)              \
+  _(Remainder, remainder)    \
+  _(Pow, pow)                \
+  _(Add, add)                \
+  _(Sub, sub)                \
+  _(SigmoidBackward, _sigmoid_backward) \
+  _(TanhBackward, _tanh_backward)
+
+enum class OpCode : uint8_t {
+#define DEFINE_OPCODE(op, _) op,
+  FORALL_INTERP_OPS(DEFINE_OPCODE)
+#undef DEFINE_OPCODE
+};
+
+static const char * opName(OpCode op) {
+  switch(op) {
+#define DEFINE_CASE(op, name) case OpCode::op: return #name;
+    FORALL_INTERP_OPS(DEFINE_CASE)
+#undef DEFINE_CASE
+  }
+  return "unknown";
+}
+
+static OpCode opCodeFor(Node * n) {
+  static std::unordered_map<NodeKind, OpCode> op_codes = {
+#define DEFINE_ENTRY(op, name) {aten::name, OpCode::op},
+    FORALL_INTERP_OPS(DEFINE_ENTRY)
+#undef DEFINE_ENTRY
+  };
+  auto it = op_codes.find(n->kind());
+  if(it == op_codes.end()) {
+    throw std::runtime_error(std::string("the CPU fusion interpreter does not support ") +
+                             n->kind().toQualString());
+  }
+  return it->second;
+}
+
+// Every instruction reads up to three registers and writes one.
+// Constants (e.g. the alpha of add) live in registers that are filled once
+// per launch and never reused.
+struct Instruction {
+  OpCode op;
+  int out;
+  int in[3];
+};
+
+using LoadFn = void(*)(TensorInfo * t, size_t nDim, bool contiguous,
+                       int64_t start, int64_t n, float * dst);
+using StoreFn = void(*)(TensorInfo * t, size_t nDim, bool contiguous,
+                        int64_t start, int64_t n, const float * src);
+
+// Walks the (compressed) index space of t from linear index start, calling
+// f(offset) for n consecutive elements. Incrementing a multi-index instead of
+// recomputing it with divisions keeps strided access cheap.
+template<typename F>
+static void forEachOffset(TensorInfo * t, size_t nDim, int64_t start, int64_t n, F f) {
+  const uint32_t * sizes = t->sizes(nDim);
+  const uint32_t * strides = t->strides(nDim);
+  at::SmallVector<int64_t, 6> index(nDim);
+  int64_t offset = 0;
+  int64_t linear = start;
+  for(int64_t d = nDim - 1; d >= 0; --d) {
+    index[d] = linear % sizes[d];
+    linear /= sizes[d];
+    offset += index[d] * strides[d];
+  }
+  const int64_t last = nDim - 1;
+  for(int64_t i = 0; i < n; ++i) {
+    f(i, offset);
+    offset += strides[last];
+    int64_t d = last;
+    while(++index[d] == sizes[d] && d > 0) {
+      offset -= index[d] * strides[d];
+      index[d] = 0;
+      --d;
+      offset += strides[d];
+    }
+  }
+}
+
+template<typename scalar_t>
+static void loadTensor(TensorInfo * t, size_t nDim, bool contiguous,
+                       int64_t start, int64_t n, float * dst) {
+  auto data = static_cast<scalar_t*>(t->data);
+  if(contiguous) {
+    data += start;
+    for(int64_t i = 0; i < n; ++i)
+      dst[i] = static_cast<float>(data[i]);
+  } else {
+    forEachOffset(t, nDim, start, n, [&](int64_t i, int64_t offset) {
+      dst[i] = static_cast<float>(data[offset]);
+    });
+  }
+}
+
+template<typename scalar_t>
+static void storeTensor(TensorInfo * t, size_t nDim, bool contiguous,
+                        int64_t start, int64_t n, const float * src) {
+  auto data = static_cast<scalar_t*>(t->data);
+  if(contiguous) {
+    data += start;
+    for(int64_t i = 0; i < n; ++i)
+      data[i] = static_cast<scalar_t>(src[i]);
+  } else {
+    forEachOffset(t, nDim, start, n, [&](int64_t i, int64_t offset) {
+      data[offset] = static_cast<scalar_t>(src[i]);
+    });
+  }
+}
+
+// A kernel argument, in the order launch_with_tensors passes them.
+struct Formal {
+  size_t nDim;
+  // nDim == 1 and the innermost stride is 1: a plain array.
+  bool contiguous;
+  int reg;
+  LoadFn load;
+  StoreFn store;
+};
+
+static void runInstruction(const Instruction & inst, float * regs, int64_t n) {
+  float * o = regs + inst.out * kBlockSize;
+  const float * a = regs + inst.in[0] * kBlockSize;
+  const float * b = regs + inst.in[1] * kBlockSize;
+  const float * c = regs + inst.in[2] * kBlockSize;
+  switch(inst.op) {
+#define UNARY_CASE(op, expr)                         \
+    case OpCode::op:                                 \
+      for(int64_t i = 0; i < n; ++i) {               \
+        const float x = a[i];                        \
+        o[i] = (expr);                               \
+      }                                              \
+      break;
+#define BINARY_CASE(op, expr)                        \
+    case OpCode::op:                                 \
+      for(int64_t i = 0; i < n; ++i) {               \
+        const float x = a[i];                        \
+        const float y = b[i];                        \
+        o[i] = (expr);                               \
+      }                                              \
+      break;
+#define TERNARY_CASE(op, expr)                       \
+    case OpCode::op:                                 \
+      for(int64_t i = 0; i < n; ++i) {               \
+        const float x = a[i];                        \
+        const float y = b[i];                        \
+        const float z = c[i];                        \
+        o[i] = (expr);                               \
+      }                                              \
+      break;
+    UNARY_CASE(Abs, std::fabs(x))
+    UNARY_CASE(Sigmoid, 1.f / (1.f + std::exp(-x)))
+    UNARY_CASE(Relu, x < 0 ? 0.f : x)
+    UNARY_CASE(Log, std::log(x))
+    UNARY_CASE(Log10, std::log10(x))
+    UNARY_CASE(Log1p, std::log1p(x))
+    UNARY_CASE(Log2, std::log2(x))
+    UNARY_CASE(Lgamma, std::lgamma(x))
+    UNARY_CASE(Exp, std::exp(x))
+    UNARY_CASE(Expm1, std::expm1(x))
+    UNARY_CASE(Cos, std::cos(x))
+    UNARY_CASE(Acos, std::acos(x))
+    UNARY_CASE(Cosh, std::cosh(x))
+    UNARY_CASE(Sin, std::sin(x))
+    UNARY_CASE(Asin, std::asin(x))
+    UNARY_CASE(Sinh, std::sinh(x))
+    UNARY_CASE(Tan, std::tan(x))
+    UNARY_CASE(Atan, std::atan(x))
+    UNARY_CASE(Tanh, std::tanh(x))
+    UNARY_CASE(Sqrt, std::sqrt(x))
+    UNARY_CASE(Rsqrt, 1.f / std::sqrt(x))
+    UNARY_CASE(Ceil, std::ceil(x))
+    UNARY_CASE(Floor, std::floor(x))
+    UNARY_CASE(Round, std::round(x))
+    UNARY_CASE(Trunc, std::trunc(x))
+    UNARY_CASE(Frac, x - std::trunc(x))
+    UNARY_CASE(Reciprocal, 1.f / x)
+    UNARY_CASE(Neg, -x)
+    UNARY_CASE(TypeAs, x)
+    BINARY_CASE(Atan2, std::atan2(x, y))
+    BINARY_CASE(Min, std::fmin(x, y))
+    BINARY_CASE(Max, std::fmax(x, y))
+    BINARY_CASE(And, x && y)
+    BINARY_CASE(Or, x || y)
+    BINARY_CASE(Div, x / y)
+    BINARY_CASE(Mul, x * y)
+    BINARY_CASE(Eq, x == y)
+    BINARY_CASE(Ne, x != y)
+    BINARY_CASE(Ge, x >= y)
+    BINARY_CASE(Gt, x > y)
+    BINARY_CASE(Le, x <= y)
+    BINARY_CASE(Lt, x < y)
+    BINARY_CASE(Fmod, std::fmod(x, y))
+    // matches at::remainder: the result has the sign of the divisor
+    BINARY_CASE(Remainder, x - y * std::floor(x / y))
+    BINARY_CASE(Pow, std::pow(x, y))
+    TERNARY_CASE(Add, x + z * y)
+    TERNARY_CASE(Sub, x - z * y)
+    BINARY_CASE(SigmoidBackward, x * y * (1.f - y))
+    BINARY_CASE(TanhBackward, x * (1.f - y * y))
+#undef UNARY_CASE
+#undef BINARY_CASE
+#undef TERNARY_CASE
+  }
+}
+
+struct Program {
+  std::vector<Instruction> instructions;
+  std::vector<std::pair<int, float>> constants;
+  // inputs followed by the flattened outputs
+  std::vector<Formal> formals;
+  size_t num_inputs = 0;
+  int num_registers = 0;
+
+  void run(uint32_t numel, void ** arguments) const {
+    // arguments[0] points at numel, the TensorInfos follow
+    TensorInfo ** infos = reinterpret_cast<TensorInfo**>(arguments + 1);
+    at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      std::vector<float> regs(num_registers * kBlockSize);
+      for(auto & c : constants)
+        std::fill_n(regs.data() + c.first * kBlockSize, kBlockSize, c.second);
+      for(int64_t start = begin; start < end; start += kBlockSize) {
+        int64_t n = std::min(kBlockSize, end - start);
+        for(size_t i = 0; i < num_inputs; ++i) {
+          auto & f = formals[i];
+          f.load(infos[i], f.nDim, f.contiguous, start, n, regs.data() + f.reg * kBlockSize);
+        }
+        for(auto & inst : instructions)
+          runInstruction(inst, regs.data(), n);
+        for(size_t i = num_inputs; i < formals.size(); ++i) {
+          auto & f = formals[i];
+          f.store(infos[i], f.nDim, f.contiguous, start, n, regs.data() + f.reg * kBlockSize);
+        }
+      }
+    });
+  }
+
+  std::string str() const {
+    std::ostringstream out;
+    for(size_t i = 0; i < formals.size(); ++i) {
+      out << (i < num_inputs ? "load t" : "store t") << i << " <-> r" << formals[i].reg
+          << " (nDim = " << formals[i].nDim << (formals[i].contiguous ? ", contiguous" : "") << ")\n";
+    }
+    for(auto & c : constants)
+      out << "r" << c.first << " = " << c.second << "\n";
+    for(auto & inst : instructions) {
+      out << "r" << inst.out << " = " << opName(inst.op) << "(r" << inst.in[0]
+          << ", r" << inst.in[1] << ", r" << inst.in[2] << ")\n";
+    }
+    return out.str();
+  }
+};
+
+// Lowers the fusion group into a Program. Registers are recycled once the
+// last use of a value has been emitted, so the working set of a launch stays
+// within a few blocks per live value rather than one per node.
+static Program lower(AnnotatedGraph & agraph, std::vector<ConcatDesc> & concat_desc) {
+  Graph & subgraph = *agraph.graph;
+  Program program;
+
+  std::vector<Value*> flat_outputs;
+  std::vector<const TensorDesc*> flat_output_desc;
+  {
+    size_t i = 0;
+    for(auto o : subgraph.outputs()) {
+      auto & desc = agraph.output_desc[i++];
+      if(o->node()->kind() != prim::FusedConcat) {
+        concat_desc.emplace_back();
+        flat_outputs.push_back(o);
+        flat_output_desc.push_back(&desc);
+      } else {
+        auto cat = o->node();
+        concat_desc.emplace_back(desc, cat->inputs().size(), cat->i(attr::dim));
+        for(auto c : cat->inputs()) {
+          flat_outputs.push_back(c);
+          flat_output_desc.push_back(concat_desc.back().subtensorDesc.get());
+        }
+      }
+    }
+  }
+
+  // Index of the last instruction reading each value; values that are
+  // stored to an output stay live until the end.
+  const size_t live_forever = std::numeric_limits<size_t>::max();
+  std::unordered_map<Value*, size_t> last_use;
+  {
+    size_t idx = 0;
+    for(auto n : subgraph.nodes()) {
+      if(n->kind() == prim::FusedConcat || n->kind() == prim::Constant)
+        continue;
+      for(auto in : n->inputs())
+        last_use[in] = idx;
+      idx++;
+    }
+    for(auto o : flat_outputs)
+      last_use[o] = live_forever;
+  }
+
+  std::unordered_map<Value*, int> reg_of;
+  std::vector<int> free_regs;
+  auto allocate = [&](Value * v) {
+    int reg;
+    if(!free_regs.empty()) {
+      reg = free_regs.back();
+      free_regs.pop_back();
+    } else {
+      reg = program.num_registers++;
+    }
+    reg_of[v] = reg;
+    return reg;
+  };
+
+  auto addFormal = [&](Value * v, const TensorDesc & desc) {
+    Formal f;
+    f.nDim = desc.nDim();
+    f.contiguous = f.nDim == 1 && desc.lastIsContiguous();
+    auto it = reg_of.find(v);
+    f.reg = it != reg_of.end() ? it->second : allocate(v);
+    AT_DISPATCH_ALL_TYPES_AND_HALF(at::CPU(desc.scalar_type), "fused_cpu_kernel", [&] {
+      f.load = &loadTensor<scalar_t>;
+      f.store = &storeTensor<scalar_t>;
+    });
+    program.formals.push_back(f);
+  };
+
+  {
+    size_t i = 0;
+    for(auto p : subgraph.inputs())
+      addFormal(p, agraph.input_desc[i++]);
+    program.num_inputs = program.formals.size();
+  }
+
+  size_t idx = 0;
+  for(auto n : subgraph.nodes()) {
+    // FusedConcat nodes work by narrowing the output Tensors before the kernel runs
+    if(n->kind() == prim::FusedConcat)
+      continue;
+    if(n->kind() == prim::Constant) {
+      auto val = toIValue(n->output()).value();
+      float c = val.isDouble() ? static_cast<float>(val.toDouble())
+                               : static_cast<float>(val.toInt());
+      program.constants.emplace_back(program.num_registers++, c);
+      reg_of[n->output()] = program.constants.back().first;
+      continue;
+    }
+    Instruction inst;
+    inst.op = opCodeFor(n);
+    JIT_ASSERT(n->inputs().size() <= 3);
+    for(size_t j = 0; j < 3; ++j) {
+      inst.in[j] = j < n->inputs().size() ? reg_of.at(n->inputs()[j]) : 0;
+    }
+    if((inst.op == OpCode::Add || inst.op == OpCode::Sub) && n->inputs().size() == 2) {
+      // no alpha given, it defaults to 1
+      program.constants.emplace_back(program.num_registers++, 1.f);
+      inst.in[2] = program.constants.back().first;
+    }
+    // Allocating before freeing the inputs keeps out from aliasing them.
+    inst.out = allocate(n->output());
+    if(last_use.count(n->output()) == 0) {
+      // dead value, its register can be reused right away
+      free_regs.push_back(inst.out);
+      reg_of.erase(n->output());
+    }
+    for(auto in : n->inputs()) {
+      if(in->node()->kind() == prim::Constant || last_use.at(in) != idx)
+        continue;
+      auto it = reg_of.find(in);
+      if(it != reg_of.end()) {
+        free_regs.push_back(it->second);
+        reg_of.erase(it);
+      }
+    }
+    program.instructions.push_back(inst);
+    idx++;
+  }
+
+  for(size_t i = 0; i < flat_outputs.size(); ++i)
+    addFormal(flat_outputs[i], *flat_output_desc[i]);
+  // Every formal needs a valid register even if nothing was computed.
+  program.num_registers = std::max(program.num_registers, 1);
+  return program;
+}
+
+#undef FORALL_INTERP_OPS
+
+} // namespace interp
+
 } // anonymous namespace
 
 void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs, at::ArrayRef<at::Tensor> outputs) {
@@ -779,27 +1236,68 @@ static void disas(const std::string & so_file) {
   JIT_ASSERT(r == 0);
 }
 
+// On-disk cache of compiled CPU kernels (FusionCompilerConfig::cache_dir).
+// An entry is a pair of files named after a hash of the compilation unit and
+// the compiler command: <hash>.so and <hash>.cpp. The .cpp file holds the
+// exact text that was hashed, so a hash collision is detected by comparing it
+// instead of loading the wrong kernel. Entries are written to temporary files
+// and renamed into place, .so first, so concurrent processes never observe a
+// partially written entry. See also disk_cache.h.
 struct CPUFusionFunction : public CompiledFusionFunction {
   CPUFusionFunction(const std::string & name, AnnotatedGraph & agraph, FusionCompilerConfig & config)
   : CompiledFusionFunction(name, agraph) {
-    TempFile so_file(so_template, 3);
-    TempFile cpp_file(cpp_template, 4);
-
     std::stringstream cu;
     concat_desc = codegen::emitCompilationUnit(cu, name, agraph, false);
     compilation_unit = cu.str();
-    cpp_file.write(compilation_unit);
-    cpp_file.sync();
-    runCompiler(config, cpp_file.name(), so_file.name());
-    if(config.debug) {
-      disas(so_file.name());
+    if(config.cache_dir.empty()) {
+      TempFile so_file(so_template, 3);
+      compileAndLoad(config, so_file.name());
+    } else {
+      loadCached(config);
     }
-    so_lib.reset(new DynamicLibrary(so_file.name().c_str()));
 #pragma GCC diagnostic ignored "-Wpedantic"
     kernel = reinterpret_cast<void(*)(uint32_t, void**)>(so_lib->sym(name.c_str()));
 #pragma GCC diagnostic pop
   }
 protected:
+  void compileAndLoad(FusionCompilerConfig & config, const std::string & so_file) {
+    TempFile cpp_file(cpp_template, 4);
+    cpp_file.write(compilation_unit);
+    cpp_file.sync();
+    runCompiler(config, cpp_file.name(), so_file);
+    if(config.debug) {
+      disas(so_file);
+    }
+    so_lib.reset(new DynamicLibrary(so_file.c_str()));
+  }
+  void loadCached(FusionCompilerConfig & config) {
+    // runCompiler may turn openmp off, so the key is computed up front and
+    // describes the configuration we are going to try.
+    std::string key = "// " + config.cxx + (config.openmp ? " -fopenmp" : "") + "\n" + compilation_unit;
+    std::ostringstream base;
+    base << config.cache_dir << "/" << std::hex << fnv1a(key);
+    std::string so_path = base.str() + ".so";
+    std::string cpp_path = base.str() + ".cpp";
+    std::string cached;
+    if(readFile(cpp_path, cached) && cached == key && access(so_path.c_str(), R_OK) == 0) {
+      so_lib.reset(new DynamicLibrary(so_path.c_str()));
+      return;
+    }
+    if(!makeDirectories(config.cache_dir)) {
+      AT_ERROR("failed to create fuser cache directory ", config.cache_dir, ": ", strerror(errno));
+    }
+    TempFile so_file(config.cache_dir + "/tmpXXXXXX.so", 3);
+    compileAndLoad(config, so_file.name());
+    TempFile key_file(config.cache_dir + "/tmpXXXXXX.cpp", 4);
+    key_file.write(key);
+    key_file.sync();
+    // Losing a race against another process publishing the same entry is
+    // harmless, so failures to publish are ignored.
+    if(rename(so_file.name().c_str(), so_path.c_str()) == 0) {
+      rename(key_file.name().c_str(), cpp_path.c_str());
+    }
+  }
+
   virtual at::Backend backend() const override {
     return at::kCPU;
   }
@@ -810,6 +1308,26 @@ protected:
   void (*kernel)(uint32_t, void**) = nullptr;
 };
 
+// Runs CPU fusion groups in-process, see "Interpretation" above.
+struct InterpretedFusionFunction : public CompiledFusionFunction {
+  InterpretedFusionFunction(const std::string & name, AnnotatedGraph & agraph, FusionCompilerConfig & config)
+  : CompiledFusionFunction(name, agraph)
+  , program(interp::lower(agraph, concat_desc)) {
+    compilation_unit = program.str();
+    if(config.debug) {
+      std::cerr << name << ":\n" << compilation_unit;
+    }
+  }
+protected:
+  virtual at::Backend backend() const override {
+    return at::kCPU;
+  }
+  virtual void launch_raw(uint32_t numel, void ** arguments) override {
+    program.run(numel, arguments);
+  }
+  interp::Program program;
+};
+
 std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(AnnotatedGraph & agraph) {
   std::stringstream key;
   key << *agraph.graph << "\n";
@@ -832,7 +1350,19 @@ std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(AnnotatedGr
 #endif
     } else {
       JIT_ASSERT(canCompileOnCPU());
-      raw_func = new CPUFusionFunction(name, agraph, config_);
+      raw_func = nullptr;
+      if(!config_.cpu_interpreter) {
+        try {
+          raw_func = new CPUFusionFunction(name, agraph, config_);
+        } catch(const std::exception & e) {
+          std::cerr << "warning: pytorch jit fuser failed to compile a CPU kernel with " << config_.cxx
+                    << " (" << e.what() << "), using the fusion interpreter instead\n";
+          config_.cpu_interpreter = true; // disable for future compiles
+        }
+      }
+      if(config_.cpu_interpreter) {
+        raw_func = new InterpretedFusionFunction(name, agraph, config_);
+      }
     }
     it = cache.emplace(key_, std::shared_ptr<CompiledFusionFunction>(raw_func)).first;
   }
@@ -890,11 +1420,23 @@ FusionCompiler::FusionCompiler() {
   }
   if(!programExists(config_.cxx)) {
     config_.cxx = "";
+    config_.cpu_interpreter = true;
   }
   const char * debug_env = getenv("PYTORCH_FUSION_DEBUG");
   config_.debug = debug_env && atoi(debug_env) != 0;
+  const char * backend_env = getenv("PYTORCH_FUSION_CPU_BACKEND");
+  if(backend_env && strcmp(backend_env, "interpreter") == 0) {
+    config_.cpu_interpreter = true;
+  }
+  const char * cache_env = getenv("PYTORCH_FUSION_CACHE_DIR");
+  if(cache_env) {
+    config_.cache_dir = cache_env;
+  }
 }
 
+FusionCompiler::FusionCompiler(FusionCompilerConfig config)
+  : config_(std::move(config)) {}
+
 //TODO: thread safety
 FusionCompiler & sharedFusionCompiler() {
   static FusionCompiler compiler;
@@ -953,6 +1495,8 @@ void FusionCompiler::debugLaunchGraph(Graph & graph, int device, at::ArrayRef<at
 
 FusionCompiler::FusionCompiler() {}
 
+FusionCompiler::FusionCompiler(FusionCompilerConfig) {}
+
 FusionCompiler & sharedFusionCompiler() {
   throw std::runtime_error("NYI: fuser is not supported on Windows.");
 }
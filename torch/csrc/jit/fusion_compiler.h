@@ -125,12 +125,20 @@ struct FusionCompilerConfig {
   std::string cxx = "g++"; // compiler location
   bool debug = false; // emit debugging information about fusions
   bool openmp = true;
+  // CPU fusion groups are compiled with cxx. They are run by an in-process
+  // interpreter instead when no working compiler is found, or when
+  // PYTORCH_FUSION_CPU_BACKEND=interpreter asks for it.
+  bool cpu_interpreter = false;
+  // if not empty, kernels compiled with cxx are kept in this directory
+  // and reused by later processes (PYTORCH_FUSION_CACHE_DIR)
+  std::string cache_dir;
 };
 
 // caching compiler
 struct FusionCompiler {
   TH_DISALLOW_COPY_AND_ASSIGN(FusionCompiler);
   FusionCompiler();
+  explicit FusionCompiler(FusionCompilerConfig config);
 
   // ignores types in graph, and uses specific contiguity annotations
   std::shared_ptr<CompiledFusionFunction> getOrCompile(AnnotatedGraph & agraph);
@@ -148,7 +156,7 @@ struct FusionCompiler {
   // the graph each time
   void debugLaunchGraph(Graph & graph, int device, at::ArrayRef<at::Tensor> inputs, at::ArrayRef<at::Tensor> outputs);
   bool canCompileOnCPU() const {
-    return config_.cxx.size() > 0;
+    return config_.cpu_interpreter || config_.cxx.size() > 0;
   }
 private:
   FusionCompilerConfig config_;
@@ -6,6 +6,7 @@
 #include "torch/csrc/jit/autodiff.h"
 #include "torch/csrc/jit/interpreter.h"
 #include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/plan_cache.h"
 #include "torch/csrc/jit/tracer.h"
 #include "torch/csrc/jit/passes/batch_mm.h"
 #include "torch/csrc/jit/passes/common_subexpression_elimination.h"
@@ -13,6 +14,7 @@
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/passes/erase_number_types.h"
 #include "torch/csrc/jit/passes/graph_fuser.h"
+#include "torch/csrc/jit/passes/hoist_parameter_computations.h"
 #include "torch/csrc/jit/passes/inplace_check.h"
 #include "torch/csrc/jit/passes/peephole.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
@@ -29,7 +31,10 @@
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/jit/script/compiler.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <iostream>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -99,15 +104,125 @@ private:
   std::vector<IValue> ivalue_captures;
 };
 
+// bumped by invalidateParameterCaches, which makes every ParameterPrologue
+// recompute its outputs
+std::atomic<size_t> parameter_cache_generation{0};
+
+// the part of a plan that only depends on module parameters, see
+// HoistParameterComputations.
+//
+// Parameters are routinely changed without bumping their version counters:
+// optimizers and load_state_dict write through .data, which has a version
+// counter of its own. So the outputs are only kept while the parameters are
+// frozen (GraphExecutor::setParametersFrozen), and even then only for as
+// long as the parameters are the same tensors, neither their version
+// counters nor those of the outputs (which views of them share) change, and
+// invalidateParameterCaches is not called (which load_state_dict and _apply
+// of script modules do).
+struct ParameterPrologue {
+  ParameterPrologue(std::shared_ptr<Graph> graph)
+      : f(graph),
+        graph(graph),
+        num_parameters(graph->inputs().size()) {}
+
+  // push the outputs for the parameters at the end of stack
+  void run(Stack & stack, bool parameters_frozen) {
+    auto parameters = last(stack, num_parameters);
+    if (!parameters_frozen) {
+      Stack prologue_stack(parameters.begin(), parameters.end());
+      InterpreterState(f).runOneStage(prologue_stack);
+      stack.insert(stack.end(), prologue_stack.begin(), prologue_stack.end());
+      return;
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!isCurrent(parameters)) {
+      // read before running the prologue, so that an invalidation while it
+      // runs is not missed
+      size_t current_generation = parameter_cache_generation.load();
+      Stack prologue_stack(parameters.begin(), parameters.end());
+      InterpreterState(f).runOneStage(prologue_stack);
+      outputs = std::move(prologue_stack);
+      remember(parameters, current_generation);
+    }
+    stack.insert(stack.end(), outputs.begin(), outputs.end());
+  }
+
+  std::shared_ptr<Graph> get_graph() const {
+    return graph;
+  }
+
+private:
+  static uint32_t version(const at::Tensor & t) {
+    return t.defined() ? autograd::as_variable_ref(t).current_version() : 0;
+  }
+  static const at::TensorImpl * dataImpl(const at::Tensor & t) {
+    return t.defined() ? autograd::as_variable_ref(t).data().get() : nullptr;
+  }
+
+  bool isCurrent(at::ArrayRef<IValue> parameters) const {
+    if (!cached || generation != parameter_cache_generation.load())
+      return false;
+    for (size_t i = 0; i < num_parameters; ++i) {
+      const auto & t = parameters[i].toTensor();
+      if (t.get() != cached_parameters[i].get() ||
+          dataImpl(t) != cached_data[i] ||
+          version(t) != versions[i])
+        return false;
+    }
+    size_t v = num_parameters;
+    for (const IValue & output : outputs) {
+      if (output.isTensor() && version(output.toTensor()) != versions[v++])
+        return false;
+    }
+    return true;
+  }
+
+  void remember(at::ArrayRef<IValue> parameters, size_t current_generation) {
+    cached = true;
+    generation = current_generation;
+    cached_parameters.clear();
+    cached_data.clear();
+    versions.clear();
+    for (const IValue & parameter : parameters) {
+      const auto & t = parameter.toTensor();
+      // keeping the parameters alive makes sure their TensorImpls are not
+      // reused by other tensors
+      cached_parameters.push_back(t);
+      cached_data.push_back(dataImpl(t));
+      versions.push_back(version(t));
+    }
+    for (const IValue & output : outputs) {
+      if (output.isTensor())
+        versions.push_back(version(output.toTensor()));
+    }
+  }
+
+  Code f;
+  std::shared_ptr<Graph> graph;
+  const size_t num_parameters;
+
+  // guards the cached outputs, plans run concurrently
+  std::mutex mutex;
+  bool cached = false;
+  size_t generation = 0;
+  std::vector<at::Tensor> cached_parameters;
+  std::vector<const at::TensorImpl*> cached_data;
+  // of the parameters followed by those of the tensor outputs
+  std::vector<uint32_t> versions;
+  Stack outputs;
+};
+
 // an optimized way of executing the subgraph computed directly on
 // tensors rather than Variables.
 // This will unwrap Variables, run the plan, and re-wrap them.
 // It can optionally also have a gradient which is hooked up
 // to the output Variables if present.
 struct ExecutionPlan {
-  ExecutionPlan(std::shared_ptr<Graph>& graph)
+  ExecutionPlan(std::shared_ptr<Graph>& graph,
+                std::shared_ptr<Graph> prologue = nullptr)
       : f(graph),
         graph(graph),
+        prologue(prologue ? new ParameterPrologue(std::move(prologue)) : nullptr),
         num_inputs(graph->inputs().size()),
         num_outputs(graph->outputs().size()) {}
   ExecutionPlan(std::shared_ptr<Graph>& graph, Gradient grad)
@@ -118,10 +233,13 @@ struct ExecutionPlan {
         num_inputs(graph->inputs().size()),
         num_outputs(graph->outputs().size()) {}
 
-  void run(Stack & stack) const {
+  void run(Stack & stack, bool parameters_frozen = false) const {
     if (grad) {
       return runWithGrad(stack);
     }
+    if (prologue) {
+      prologue->run(stack, parameters_frozen);
+    }
     InterpreterState(f).runOneStage(stack);
   }
 
@@ -133,6 +251,8 @@ struct ExecutionPlan {
     ExecutionPlanState state;
     state.f = &f;
     state.graph = graph.get();
+    state.prologue_graph = prologue ? prologue->get_graph().get() : nullptr;
+    state.loaded_from_cache = loaded_from_cache;
     if (grad) {
       state.grad = &grad;
       state.grad_executor = std::unique_ptr<GraphExecutorState>(
@@ -144,6 +264,9 @@ struct ExecutionPlan {
     return state;
   }
 
+  // true if the plan was read from the plan cache, see plan_cache.h
+  bool loaded_from_cache = false;
+
 private:
   void detachVariables(Stack & stack) const {
     // It would be nice to use an ArrayRef here, but unfortunately those can only
@@ -215,6 +338,9 @@ private:
   Code f;
   // optimized graph for debugging and testing
   std::shared_ptr<Graph> graph;
+  // computations hoisted out of graph, whose outputs are additional inputs
+  // of graph. Only used in plans without gradient.
+  std::unique_ptr<ParameterPrologue> prologue;
   // description of gradient as a graph
   Gradient grad; // if(grad) is false when this is unused
   // executor for df, including code caches
@@ -229,8 +355,8 @@ private:
 // a Graph can be created via tracing, or via a language-based frontend
 // GraphExecutor runs it. It can run the same graph on many different sizes
 // and different requires_grad states, and handles specializations for each situation.
-// GraphExecutor is completely unaware of tracing or module parameters to keep the
-// tracing concerns separated.
+// GraphExecutor is completely unaware of tracing to keep the tracing concerns
+// separated, and only knows how many of its inputs are module parameters.
 struct GraphExecutorImpl {
 
   GraphExecutorImpl(std::shared_ptr<Graph> graph, bool optimize, bool symbolically_differentiable)
@@ -276,7 +402,24 @@ struct GraphExecutorImpl {
     // go down the route where we treat the inputs as tensors
     // and fully optimize
     auto & implementation = getOrCompile(inputs);
-    return implementation.run(stack);
+    return implementation.run(stack, parameters_frozen);
+  }
+
+  // compile the plan that run() would use for inputs matching spec ahead of
+  // time, so that the first call with such inputs does not pay for it
+  void warmUp(const ArgumentSpec & spec) {
+    if(spec.size() != num_inputs) {
+      std::stringstream ss;
+      ss << "expected " << num_inputs << " inputs but got a spec for " << spec.size() << " inputs";
+      throw std::runtime_error(ss.str());
+    }
+    bool needs_gradient = argumentSpecRequiresGradient(spec) ||
+        (may_introduce_gradient && autograd::GradMode::is_enabled());
+    if(!optimize || (!symbolically_differentiable && needs_gradient)) {
+      getOrCreateAutogradFallback();
+      return;
+    }
+    getOrCompile(ArgumentSpec(spec));
   }
 
   std::shared_ptr<Graph> graphFor(const Stack& stack) const {
@@ -402,16 +545,16 @@ private:
   const ExecutionPlan & getOrCompile(at::ArrayRef<IValue> inputs) {
     // outside lock guard, to minimize the time holding the lock on the fast path
     // ArgumentSpec even computes its hashCode here.
-    ArgumentSpec spec(autograd::GradMode::is_enabled(), inputs);
-    {
-      std::lock_guard<std::mutex> lock(compile_mutex);
-      auto it = plan_cache.find(spec);
-      if(it != plan_cache.end())
-        return it->second;
-      auto plan = compileSpec(spec);
-      auto r = plan_cache.emplace(std::move(spec), std::move(plan));
-      return r.first->second;
-    }
+    return getOrCompile(ArgumentSpec(autograd::GradMode::is_enabled(), inputs));
+  }
+  const ExecutionPlan & getOrCompile(ArgumentSpec spec) {
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    auto it = plan_cache.find(spec);
+    if(it != plan_cache.end())
+      return it->second;
+    auto plan = compileSpec(spec);
+    auto r = plan_cache.emplace(std::move(spec), std::move(plan));
+    return r.first->second;
   }
 
   bool argumentSpecRequiresGradient(const ArgumentSpec & spec) {
@@ -423,13 +566,41 @@ private:
   }
 
   ExecutionPlan compileSpec(const ArgumentSpec & spec) {
+    // try the persistent plan cache first, see plan_cache.h
+    std::string key;
+    const bool persist = !getPlanCacheDir().empty() && planCacheKey(*graph, spec, key);
+    Gradient plan;
+    if(persist && loadPlan(key, plan)) {
+      // an entry written by a different build may refer to operators that
+      // no longer exist; it is removed, then recompiled and stored below
+      try {
+        auto loaded = makePlan(std::move(plan));
+        loaded.loaded_from_cache = true;
+        return loaded;
+      } catch(std::exception & e) {
+        std::cerr << "warning: discarding unusable JIT plan cache entry: " << e.what() << "\n";
+        removePlan(key);
+      }
+    }
+
+    plan = optimizeSpec(spec);
+    if(persist)
+      storePlan(key, plan);
+    return makePlan(std::move(plan));
+  }
+
+  // specializes and optimizes the graph for spec. plan.df is only set if
+  // some input in spec requires grad.
+  Gradient optimizeSpec(const ArgumentSpec & spec) {
     auto graph_ = graph->copy();
 
     specializeToSpec(graph_, spec);
 
     if(!argumentSpecRequiresGradient(spec)) {
       runOptimization(graph_, /*graphMustSupportVariables=*/false);
-      return ExecutionPlan(graph_);
+      Gradient plan;
+      plan.f = graph_;
+      return plan;
     }
     JIT_ASSERT(symbolically_differentiable);
 
@@ -439,9 +610,21 @@ private:
       requires_grads.push_back(spec.at(i).requires_grad());
 
     Gradient gradient = differentiate(graph_, requires_grads);
-    graph_ = gradient.f;
-    runOptimization(graph_, /*graphMustSupportVariables=*/false);
-    return ExecutionPlan(graph_, std::move(gradient));
+    runOptimization(gradient.f, /*graphMustSupportVariables=*/false);
+    return gradient;
+  }
+
+  // plans are stored in the persistent plan cache before hoisting, so it
+  // also applies to plans loaded from there
+  ExecutionPlan makePlan(Gradient plan) {
+    auto graph_ = plan.f;
+    if(!plan) {
+      // parameters that require grad need their gradients computed, so only
+      // plans without gradient hoist computations on parameters
+      auto prologue = HoistParameterComputations(graph_, num_parameter_inputs);
+      return ExecutionPlan(graph_, std::move(prologue));
+    }
+    return ExecutionPlan(graph_, std::move(plan));
   }
   // the unoptimized starting graph
   // this is never mutated
@@ -453,6 +636,11 @@ private:
   const bool optimize;
   const size_t num_inputs;
   const size_t num_outputs;
+  // the last num_parameter_inputs inputs are module parameters, see
+  // ParameterPrologue
+  size_t num_parameter_inputs = 0;
+  // whether the results of computations on them may be reused across calls
+  std::atomic<bool> parameters_frozen{false};
 
   // GraphExecutor optimizes more aggresively when we _know_ the graph will be
   // symbolically differentiable.
@@ -491,6 +679,21 @@ GraphExecutor::GraphExecutor(std::shared_ptr<Graph> graph, bool optimize)
 GraphExecutor::GraphExecutor(std::shared_ptr<Graph> graph, bool optimize, bool symbolically_differentiable)
 : pImpl(new GraphExecutorImpl(std::move(graph), optimize, symbolically_differentiable)) {}
 
+GraphExecutor GraphExecutor::withParameters(std::shared_ptr<Graph> graph, bool optimize, size_t num_parameter_inputs) {
+  GraphExecutor executor(std::move(graph), optimize);
+  JIT_ASSERT(num_parameter_inputs <= executor.pImpl->num_inputs);
+  executor.pImpl->num_parameter_inputs = num_parameter_inputs;
+  return executor;
+}
+
+void GraphExecutor::setParametersFrozen(bool frozen) {
+  pImpl->parameters_frozen = frozen;
+}
+
+void invalidateParameterCaches() {
+  ++parameter_cache_generation;
+}
+
 void GraphExecutor::run(Stack & inputs) {
   return pImpl->run(inputs);
 }
@@ -499,6 +702,15 @@ std::shared_ptr<Graph> GraphExecutor::graph() const {
   return pImpl->graph;
 }
 
+void GraphExecutor::warmUp(const ArgumentSpec& spec) {
+  pImpl->warmUp(spec);
+}
+
+void GraphExecutor::warmUp(const Stack& inputs) {
+  auto num_inputs = std::min(inputs.size(), pImpl->num_inputs);
+  pImpl->warmUp(ArgumentSpec(autograd::GradMode::is_enabled(), last(inputs, num_inputs)));
+}
+
 std::shared_ptr<Graph> GraphExecutor::graphFor(const Stack& inputs) const {
   return pImpl->graphFor(inputs);
 }
@@ -17,6 +17,10 @@ struct GraphExecutorState;
 struct ExecutionPlanState {
   Code* f;
   Graph* graph;
+  // computations on module parameters hoisted out of graph, or nullptr
+  Graph* prologue_graph;
+  // true if the plan was read from the on-disk plan cache
+  bool loaded_from_cache;
 
   // Those two fields are optional
   Gradient* grad;
@@ -38,10 +42,26 @@ struct TORCH_API GraphExecutor {
   GraphExecutor(std::shared_ptr<Graph> graph, bool optimize = true);
   // note: if not specified, symbolically_differentiable is computed from the graph.
   GraphExecutor(std::shared_ptr<Graph> graph, bool optimize, bool symbolically_differentiable);
+  // the last num_parameter_inputs inputs of graph are module parameters.
+  // When no gradient is needed, the computations that only depend on them
+  // (e.g. transposed weights) run in a prologue of the plan (see
+  // HoistParameterComputations).
+  static GraphExecutor withParameters(std::shared_ptr<Graph> graph, bool optimize, size_t num_parameter_inputs);
   void run(Stack & inputs);
+  // promise that the parameters are not modified other than in place, by
+  // replacing them, or followed by a call to invalidateParameterCaches.
+  // The results of the prologue are then reused across calls until one of
+  // these happens.
+  void setParametersFrozen(bool frozen);
   explicit operator bool() const {
     return pImpl != nullptr;
   }
+  // Compile the plans used for inputs matching spec (or the example inputs)
+  // before the first call to run() with such inputs. With a plan cache
+  // directory configured, plans compiled by an earlier process are loaded
+  // instead (see plan_cache.h).
+  void warmUp(const ArgumentSpec& spec);
+  void warmUp(const Stack& inputs);
   std::shared_ptr<Graph> graph() const;
   std::shared_ptr<Graph> graphFor(const Stack& inputs) const;
   GraphExecutorState getDebugState();
@@ -49,6 +69,10 @@ private:
   std::shared_ptr<GraphExecutorImpl> pImpl;
 };
 
+// makes all executors recompute the results they keep for frozen parameters,
+// see GraphExecutor::setParametersFrozen
+TORCH_API void invalidateParameterCaches();
+
 // These passes need to run before it is valid to pass to the interpreter
 // regardless of whether sizes have been specialized or not.
 TORCH_API void runRequiredPasses(const std::shared_ptr<Graph>& g);
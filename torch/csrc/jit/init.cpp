@@ -18,11 +18,14 @@
 #include "torch/csrc/jit/passes/onnx/fixup_onnx_loop.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/decompose_addmm.h"
+#include "torch/csrc/jit/passes/hoist_parameter_computations.h"
 #include "torch/csrc/jit/passes/constant_propagation.h"
 #include "torch/csrc/jit/passes/loop_unrolling.h"
 #include "torch/csrc/jit/passes/to_batch.h"
 #include "torch/csrc/jit/passes/specialize_undef.h"
 #include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/interpreter.h"
+#include "torch/csrc/jit/plan_cache.h"
 #include "torch/csrc/jit/script/init.h"
 #include "torch/csrc/jit/script/python_tree_views.h"
 #include "torch/csrc/jit/batched/BatchTensor.h"
@@ -96,6 +99,7 @@ void initJITBindings(PyObject *module) {
    .def("_jit_pass_onnx_block", BlockToONNX)
    .def("_jit_pass_fixup_onnx_loops", FixupONNXLoops)
    .def("_jit_pass_decompose_addmm", DecomposeAddmm)
+   .def("_jit_pass_hoist_parameter_computations", HoistParameterComputations)
     .def("_jit_pass_specialize_undef", specializeUndef)
    .def("_jit_differentiate", [](Graph &g, const std::vector<bool>& requires_grad) {
        // the python binding slightly differs in semantics
@@ -103,7 +107,12 @@ void initJITBindings(PyObject *module) {
        // jit::differentiate mutates the input Graph
        auto g_clone = g.copy();
        return differentiate(g_clone, requires_grad);
-   });
+   })
+   .def("_jit_get_plan_cache_dir", getPlanCacheDir)
+   .def("_jit_set_plan_cache_dir", setPlanCacheDir)
+   .def("_jit_invalidate_parameter_caches", invalidateParameterCaches)
+   .def("_jit_get_register_dispatch", registerDispatchEnabled)
+   .def("_jit_set_register_dispatch", setRegisterDispatchEnabled);
 
   py::class_<ArgumentSpec>(m, "ArgumentSpec")
       .def("__repr__", [](ArgumentSpec& self) {
@@ -123,6 +132,12 @@ void initJITBindings(PyObject *module) {
     .def_property_readonly("code", [](ExecutionPlanState& s) {
       return s.f;
     })
+    .def_property_readonly("prologue_graph", [](ExecutionPlanState& s) {
+      return s.prologue_graph;
+    })
+    .def_property_readonly("loaded_from_cache", [](ExecutionPlanState& s) {
+      return s.loaded_from_cache;
+    })
     .def_property_readonly("grad_executor", [](ExecutionPlanState& s) {
       return s.grad_executor.get();
     });
@@ -191,6 +206,11 @@ void initJITBindings(PyObject *module) {
       .def("get_debug_state", [](GraphExecutor& ge) {
         return ge.getDebugState();
       })
+      .def("warm_up", [](GraphExecutor& ge, py::args example_inputs) {
+        for (auto inputs : example_inputs) {
+          ge.warmUp(createStack(py::cast<py::tuple>(inputs)));
+        }
+      })
       .def("__call__", [](GraphExecutor& ge, py::args args) -> py::object {
         auto stack = createStack(args);
         ge.run(stack);
@@ -14,6 +14,9 @@
 #include "torch/csrc/jit/operator.h"
 #include "torch/csrc/variable_tensor_functions.h"
 
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <memory>
@@ -375,15 +378,65 @@ struct UseList {
   ListHandle<bool> free_flags;
 };
 
+// Note [Register dispatch]
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// Every instruction has a callback that implements it on the Stack: the
+// interpreter pushes the input registers, runs the callback and pops the
+// outputs back into registers. That is the only way to call an Operator,
+// but for the instructions the interpreter itself generates (assignments
+// between registers, branches, drops and constants) the round trip through
+// the Stack, and the refcount traffic of copying values onto it, can cost
+// more than the work itself, which matters for scripts over small tensors.
+//
+// So each instruction also records an OpCode. With register dispatch
+// (the default) the interpreter executes everything but Call directly on
+// the registers, dispatching through a table of labels where the compiler
+// supports computed gotos. Operators themselves are still resolved once,
+// when the Code is built. The stack-only loop is kept for comparison and
+// can be selected with PYTORCH_JIT_INTERPRETER=stack or
+// setRegisterDispatchEnabled(false).
+#define FORALL_OPCODES(_) \
+  _(Call)     /* push inputs, run callback, pop outputs */ \
+  _(Assign)   /* copy or move input registers into output registers */ \
+  _(Jump)     /* relative jump */ \
+  _(JumpZ)    /* relative jump if the condition is 0 */ \
+  _(JumpNZ)   /* relative jump if the condition is not 0 */ \
+  _(Drop)     /* release the moved input registers */ \
+  _(Constant) /* copy a constant into the output register */
+
+enum class OpCode : uint8_t {
+#define DEFINE_OPCODE(name) name,
+  FORALL_OPCODES(DEFINE_OPCODE)
+#undef DEFINE_OPCODE
+};
+
 // one instruction plus meta-data
 struct Instruction {
   Operation callback;
   UseList inputs;
   ListHandle<int> outputs;
+  OpCode op = OpCode::Call;
+  int jump_offset = 0; // Jump, JumpZ, JumpNZ
+  IValue constant; // Constant
   Symbol debug_name; // used in dump to understand the generated code
   std::shared_ptr<SourceLocation> debug_location; // for error reporting
 };
 
+static bool defaultRegisterDispatch() {
+  const char * env = std::getenv("PYTORCH_JIT_INTERPRETER");
+  return !(env && std::strcmp(env, "stack") == 0);
+}
+
+static std::atomic<bool> register_dispatch_enabled(defaultRegisterDispatch());
+
+void setRegisterDispatchEnabled(bool enabled) {
+  register_dispatch_enabled = enabled;
+}
+
+bool registerDispatchEnabled() {
+  return register_dispatch_enabled;
+}
+
 
 int relativeJump(int from_inst, int to_inst) {
   return to_inst - (from_inst + 1);
@@ -406,6 +459,8 @@ struct CodeImpl {
       auto t = pop(stack).toInt();
       return (t == 0) ? offset : 0;
     };
+    inst.op = OpCode::JumpZ;
+    inst.jump_offset = offset;
     inst.debug_name = prim::JumpZ;
   }
 
@@ -418,6 +473,8 @@ struct CodeImpl {
       auto t = pop(stack).toInt();
       return (t != 0) ? offset : 0;
     };
+    inst.op = OpCode::JumpNZ;
+    inst.jump_offset = offset;
     inst.debug_name = prim::JumpNZ;
   }
 
@@ -428,6 +485,8 @@ struct CodeImpl {
     inst.callback = [=](Stack & stack) {
       return offset;
     };
+    inst.op = OpCode::Jump;
+    inst.jump_offset = offset;
     inst.debug_name = prim::Jump;
   }
 
@@ -519,6 +578,16 @@ struct CodeImpl {
   size_t insertInstruction(Node * n) {
     auto inst = insertInstruction(n->kind(), n->getSourceLocation(), n->inputs(), moveFlags(n) , n->outputs());
     instructions[inst].callback = getInterpreterOperation(n);
+    if(n->kind() == prim::Drop) {
+      instructions[inst].op = OpCode::Drop;
+    } else if(n->kind() == prim::Constant) {
+      // lists are left to the callback, which creates a fresh list on each run
+      auto type = n->output()->type();
+      if(type->isSubtypeOf(DynamicType::get()) || type->isSubtypeOf(NumberType::get())) {
+        instructions[inst].constant = *toIValue(n->output());
+        instructions[inst].op = OpCode::Constant;
+      }
+    }
     return inst;
   }
   size_t insertInstruction(Symbol sym,
@@ -557,6 +626,22 @@ struct CodeImpl {
     // We don't need to manipulate the stack in any way, because all inputs are also outputs,
     // and the interpreter will take care of putting them in correct places.
     instructions[inst].callback = [](Stack& stack) { return 0; };
+    // The assignment is parallel: all inputs are read before any output is
+    // written. Assigning in order gives the same result unless an output
+    // register is read by a later input, in which case we keep using the
+    // stack. Leading inputs without an output (the loop condition) are left
+    // on the stack for the branch that follows.
+    auto extra = inputs.size() - outputs.size();
+    bool sequential = true;
+    for(size_t i = 0; i < outputs.size(); ++i) {
+      int out = get(instructions[inst].outputs, i);
+      for(size_t j = i + 1; j < outputs.size(); ++j) {
+        if(get(instructions[inst].inputs.values, extra + j) == out)
+          sequential = false;
+      }
+    }
+    if(sequential)
+      instructions[inst].op = OpCode::Assign;
     return inst;
   }
 
@@ -692,6 +777,132 @@ struct InterpreterStateImpl {
     registers(function->register_size) {
   }
   void runOneStage(Stack & stack) {
+    if(registerDispatchEnabled()) {
+      runOneStageRegisters(stack);
+    } else {
+      runOneStageStack(stack);
+    }
+  }
+
+  // see Note [Register dispatch]
+  void runOneStageRegisters(Stack & stack) {
+    size_t pc = current_pc;
+    const size_t last = function->stage_end[current_stage];
+    const Instruction * instructions = function->instructions.data();
+    IValue * regs = registers.data();
+    try {
+#if defined(__GNUC__)
+#define LABEL_ADDRESS(name) &&op_##name,
+      static const void * const dispatch_table[] = {
+        FORALL_OPCODES(LABEL_ADDRESS)
+      };
+#undef LABEL_ADDRESS
+#define DISPATCH() \
+      if(pc >= last) goto stage_done; \
+      goto *dispatch_table[static_cast<uint8_t>(instructions[pc].op)];
+#define OP(name) op_##name
+      DISPATCH();
+#else
+#define DISPATCH() continue;
+#define OP(name) case OpCode::name
+      while(pc < last) switch(instructions[pc].op) {
+#endif
+      OP(Call): {
+        auto & inst = instructions[pc];
+        loadTensorsFromRegisters(inst.inputs, stack);
+        pc += 1 + inst.callback(stack);
+        const size_t base = stack.size() - inst.outputs.size;
+        for(int i = 0; i < inst.outputs.size; i++) {
+          regs[get(inst.outputs, i)] = std::move(stack[base + i]);
+        }
+        stack.erase(stack.begin() + base, stack.end());
+        DISPATCH();
+      }
+      OP(Assign): {
+        auto & inst = instructions[pc];
+        const int extra = inst.inputs.values.size - inst.outputs.size;
+        for(int i = 0; i < extra; i++) {
+          int reg = get(inst.inputs.values, i);
+          if(get(inst.inputs.free_flags, i)) {
+            stack.push_back(std::move(regs[reg]));
+          } else {
+            stack.push_back(regs[reg]);
+          }
+        }
+        for(int i = 0; i < inst.outputs.size; i++) {
+          int in = get(inst.inputs.values, extra + i);
+          int out = get(inst.outputs, i);
+          if(get(inst.inputs.free_flags, extra + i)) {
+            // IValue's move assignment swaps, so go through a temporary to
+            // leave the input register empty (and release the old output)
+            IValue v = std::move(regs[in]);
+            regs[out] = std::move(v);
+          } else {
+            regs[out] = regs[in];
+          }
+        }
+        pc++;
+        DISPATCH();
+      }
+      OP(Jump): {
+        pc += 1 + instructions[pc].jump_offset;
+        DISPATCH();
+      }
+      OP(JumpZ): {
+        auto & inst = instructions[pc];
+        pc += 1 + (popCondition(inst, stack) == 0 ? inst.jump_offset : 0);
+        DISPATCH();
+      }
+      OP(JumpNZ): {
+        auto & inst = instructions[pc];
+        pc += 1 + (popCondition(inst, stack) != 0 ? inst.jump_offset : 0);
+        DISPATCH();
+      }
+      OP(Drop): {
+        auto & inst = instructions[pc];
+        for(int i = 0; i < inst.inputs.values.size; i++) {
+          if(get(inst.inputs.free_flags, i))
+            regs[get(inst.inputs.values, i)] = IValue();
+        }
+        pc++;
+        DISPATCH();
+      }
+      OP(Constant): {
+        auto & inst = instructions[pc];
+        regs[get(inst.outputs, 0)] = inst.constant;
+        pc++;
+        DISPATCH();
+      }
+#if defined(__GNUC__)
+stage_done:;
+#else
+      }
+#endif
+#undef DISPATCH
+#undef OP
+    } catch(std::exception & e) {
+      if(!instructions[pc].debug_location)
+        throw; // rethrow original exception
+      // throw a new exception with enhanced debugging information
+      instructions[pc].debug_location->wrapAndRethrowException(e, "operation failed in interpreter");
+    }
+    current_pc = pc;
+    current_stage++;
+  }
+
+  // the condition of a branch is either its input register or, for loops,
+  // left on the stack by the preceding Assign
+  int64_t popCondition(const Instruction & inst, Stack & stack) {
+    if(inst.inputs.values.size == 0)
+      return pop(stack).toInt();
+    int reg = get(inst.inputs.values, 0);
+    int64_t c = registers[reg].toInt();
+    if(get(inst.inputs.free_flags, 0))
+      registers[reg] = IValue();
+    return c;
+  }
+
+  void runOneStageStack(Stack & stack) {
     // std::cout << "running stage: " << current_stage << " of " << function->stage_end.size() << "\n";
     // std::cout << *function->graph << "\n";
     // function->dump(std::cout);
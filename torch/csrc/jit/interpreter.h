@@ -43,6 +43,13 @@ private:
   friend std::ostream & operator<<(std::ostream & out, const Code & code);
 };
 
+// Whether InterpreterState executes the instructions the interpreter
+// generates itself (assignments, branches, drops, constants) directly on its
+// registers instead of through the Stack. On by default; disabling it is
+// only useful to compare against the stack-based loop.
+TORCH_API void setRegisterDispatchEnabled(bool enabled);
+TORCH_API bool registerDispatchEnabled();
+
 struct InterpreterState {
   InterpreterState(const Code & code);
   // advance the interpreter state by running one stage. Returning the
@@ -0,0 +1,183 @@
+#include "torch/csrc/jit/passes/hoist_parameter_computations.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// operators that write to one of their inputs (add_, copy_, __iadd__, the
+// out= variants)
+bool isInplace(Node* n) {
+  if (!n->kind().is_aten()) {
+    return false;
+  }
+  const std::string name = n->kind().toUnqualString();
+  if (name.compare(0, 2, "__") == 0) {
+    return name.compare(0, 3, "__i") == 0;
+  }
+  const size_t size = name.size();
+  return (size > 1 && name[size - 1] == '_') ||
+      (size > 4 && name.compare(size - 4, 4, "_out") == 0);
+}
+
+// operators that must run on every call because their results differ
+bool isNondeterministic(Node* n) {
+  static const char* prefixes[] = {
+    "rand", "dropout", "feature_dropout", "alpha_dropout",
+    "feature_alpha_dropout", "bernoulli", "normal", "multinomial", "rrelu",
+    "poisson",
+  };
+  if (n->kind() == prim::Print) {
+    return true;
+  }
+  if (!n->kind().is_aten()) {
+    return false;
+  }
+  const char* name = n->kind().toUnqualString();
+  return std::any_of(
+      std::begin(prefixes), std::end(prefixes), [&](const char* prefix) {
+        return std::strncmp(name, prefix, std::strlen(prefix)) == 0;
+      });
+}
+
+bool mayModifyParameters(Block* block) {
+  for (Node* n : block->nodes()) {
+    if (n->kind() == prim::PythonOp || isInplace(n)) {
+      return true;
+    }
+    for (Block* b : n->blocks()) {
+      if (mayModifyParameters(b)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<Graph> HoistParameterComputations(
+    std::shared_ptr<Graph>& graph,
+    size_t num_parameters) {
+  JIT_ASSERT(num_parameters <= graph->inputs().size());
+  if (num_parameters == 0 || mayModifyParameters(graph->block())) {
+    return nullptr;
+  }
+  const size_t first_parameter = graph->inputs().size() - num_parameters;
+
+  // Values the prologue can compute fall into two sets: those that depend on
+  // some parameter, which are computed only in the prologue, and those that
+  // only depend on constants, which are recomputed in the prologue where it
+  // needs them.
+  std::unordered_set<Value*> parameter_values;
+  std::unordered_set<Value*> constant_values;
+  for (size_t i = first_parameter; i < graph->inputs().size(); ++i) {
+    parameter_values.insert(graph->inputs()[i]);
+  }
+  std::unordered_set<Value*> graph_outputs(
+      graph->outputs().begin(), graph->outputs().end());
+
+  std::vector<Node*> hoisted;
+  for (Node* n : graph->nodes()) {
+    if (!n->blocks().empty() || isNondeterministic(n)) {
+      continue;
+    }
+    bool depends_on_parameter = false;
+    bool invariant = true;
+    for (Value* input : n->inputs()) {
+      if (parameter_values.count(input) > 0) {
+        depends_on_parameter = true;
+      } else if (constant_values.count(input) == 0) {
+        invariant = false;
+        break;
+      }
+    }
+    if (!invariant) {
+      continue;
+    }
+    if (!depends_on_parameter) {
+      for (Value* output : n->outputs()) {
+        constant_values.insert(output);
+      }
+      continue;
+    }
+    bool is_graph_output = std::any_of(
+        n->outputs().begin(), n->outputs().end(),
+        [&](Value* output) { return graph_outputs.count(output) > 0; });
+    if (is_graph_output) {
+      continue;
+    }
+    for (Value* output : n->outputs()) {
+      parameter_values.insert(output);
+    }
+    hoisted.push_back(n);
+  }
+
+  // the hoisted values the rest of graph uses become outputs of the prologue
+  std::unordered_set<Node*> hoisted_set(hoisted.begin(), hoisted.end());
+  std::vector<Value*> hoisted_outputs;
+  for (Node* n : hoisted) {
+    for (Value* output : n->outputs()) {
+      bool used_outside = std::any_of(
+          output->uses().begin(), output->uses().end(),
+          [&](const Use& use) { return hoisted_set.count(use.user) == 0; });
+      if (used_outside) {
+        hoisted_outputs.push_back(output);
+      }
+    }
+  }
+  if (hoisted_outputs.empty()) {
+    return nullptr;
+  }
+
+  auto prologue = std::make_shared<Graph>();
+  std::unordered_map<Value*, Value*> value_map;
+  for (size_t i = first_parameter; i < graph->inputs().size(); ++i) {
+    Value* input = graph->inputs()[i];
+    value_map[input] = prologue->addInput()->copyMetadata(input);
+  }
+  std::function<Node*(Node*)> clone;
+  std::function<Value*(Value*)> map_value = [&](Value* v) -> Value* {
+    auto it = value_map.find(v);
+    if (it != value_map.end()) {
+      return it->second;
+    }
+    // only values that depend on constants alone are not mapped yet
+    JIT_ASSERT(constant_values.count(v) > 0);
+    clone(v->node());
+    return value_map.at(v);
+  };
+  clone = [&](Node* n) -> Node* {
+    Node* r = prologue->appendNode(prologue->createClone(n, map_value));
+    for (size_t i = 0; i < n->outputs().size(); ++i) {
+      value_map[n->outputs()[i]] = r->outputs()[i];
+    }
+    return r;
+  };
+  for (Node* n : hoisted) {
+    clone(n);
+  }
+  for (Value* output : hoisted_outputs) {
+    prologue->registerOutput(value_map.at(output));
+    output->replaceAllUsesWith(graph->addInput()->copyMetadata(output));
+  }
+  // the hoisted nodes are now only used by hoisted nodes that come after
+  // them, so they can be destroyed in reverse order
+  for (auto it = hoisted.rbegin(); it != hoisted.rend(); ++it) {
+    (*it)->destroy();
+  }
+  EliminateDeadCode(graph);
+  return prologue;
+}
+
+}}
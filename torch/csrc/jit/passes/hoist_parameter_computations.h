@@ -0,0 +1,25 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Moves the computations of graph that only depend on its last
+// num_parameters inputs (module parameters) and constants, e.g. the
+// transposed and concatenated weights that DecomposeAddmm and BatchMM
+// produce, into a separate prologue graph. The prologue takes the
+// parameters as inputs and returns the values graph still needs, which are
+// appended to the inputs of graph, so that running the prologue and then
+// graph computes the same as before, and the prologue results can be reused
+// for as long as the parameters do not change.
+//
+// Nothing is hoisted from graphs with in-place operations or Python
+// operations, which could modify the parameters, and values that are
+// outputs of graph are not hoisted, since callers may modify them.
+//
+// Returns nullptr if there is nothing to hoist.
+TORCH_API std::shared_ptr<Graph> HoistParameterComputations(
+    std::shared_ptr<Graph>& graph,
+    size_t num_parameters);
+
+}}
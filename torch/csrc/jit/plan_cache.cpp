@@ -0,0 +1,598 @@
+#include "torch/csrc/jit/plan_cache.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/disk_cache.h"
+#include "torch/csrc/jit/fusion_compiler.h"
+#include "torch/csrc/jit/operator.h"
+#include "torch/csrc/jit/type.h"
+
+#include "ATen/DeviceGuard.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// Bump whenever the encoding below or the meaning of a cached plan changes.
+constexpr uint64_t kPlanCacheVersion = 1;
+
+// Plans refer to operators and IR details that can change between builds
+// without anyone bumping kPlanCacheVersion, so the key also includes the git
+// version CMake passes in and the schemas of the operators the graph calls
+// (see writeOperatorSchemas).
+#ifndef TORCH_BUILD_VERSION
+#define TORCH_BUILD_VERSION "unknown"
+#endif
+constexpr char kBuildVersion[] = TORCH_BUILD_VERSION;
+constexpr char kPlanMagic[] = "PYTORCH_JIT_PLAN";
+
+struct Writer {
+  void writeU64(uint64_t v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+  }
+  void writeI64(int64_t v) {
+    writeU64(static_cast<uint64_t>(v));
+  }
+  void writeDouble(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    writeU64(bits);
+  }
+  void writeString(const std::string & s) {
+    writeU64(s.size());
+    out.append(s);
+  }
+  void writeI64s(at::ArrayRef<int64_t> vs) {
+    writeU64(vs.size());
+    for(int64_t v : vs)
+      writeI64(v);
+  }
+  void writeSizes(const std::vector<size_t> & vs) {
+    writeU64(vs.size());
+    for(size_t v : vs)
+      writeU64(v);
+  }
+  std::string out;
+};
+
+struct Reader {
+  Reader(const std::string & in)
+  : in(in), pos(0) {}
+  void read(void * dst, size_t n) {
+    if(in.size() - pos < n)
+      throw std::runtime_error("truncated plan cache entry");
+    std::memcpy(dst, in.data() + pos, n);
+    pos += n;
+  }
+  uint64_t readU64() {
+    uint64_t v;
+    read(&v, sizeof(v));
+    return v;
+  }
+  int64_t readI64() {
+    return static_cast<int64_t>(readU64());
+  }
+  double readDouble() {
+    uint64_t bits = readU64();
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+  // counts are checked against the remaining input so that a corrupt entry
+  // fails cleanly instead of requesting a huge allocation
+  size_t readCount(size_t element_size = 1) {
+    uint64_t n = readU64();
+    if(n > (in.size() - pos) / element_size)
+      throw std::runtime_error("corrupt plan cache entry");
+    return n;
+  }
+  std::string readString() {
+    size_t n = readCount();
+    std::string s = in.substr(pos, n);
+    pos += n;
+    return s;
+  }
+  std::vector<int64_t> readI64s() {
+    std::vector<int64_t> vs(readCount(sizeof(int64_t)));
+    for(auto & v : vs)
+      v = readI64();
+    return vs;
+  }
+  std::vector<size_t> readSizes() {
+    std::vector<size_t> vs(readCount(sizeof(uint64_t)));
+    for(auto & v : vs)
+      v = readU64();
+    return vs;
+  }
+  bool done() const {
+    return pos == in.size();
+  }
+  const std::string & in;
+  size_t pos;
+};
+
+// Graph encoding
+//
+// Values are numbered in the order they are defined (graph and block inputs,
+// then node outputs in program order, recursing into blocks after the node
+// that owns them), so uses are encoded as indices into that numbering.
+//
+//   graph    := block
+//   block    := #inputs value_def* #nodes node* #outputs value_ref*
+//   node     := kind stage #inputs value_ref* #outputs value_def* attrs #blocks block*
+//   value_def:= type has_name name?
+//   attrs    := #attrs (name kind payload)*
+//
+// Subgraph attributes are encoded as nested graphs with their own numbering.
+
+struct GraphEncoder {
+  void encodeGraph(const Graph & g) {
+    encodeBlock(g.block());
+  }
+  void encodeBlock(const Block * b) {
+    w.writeU64(b->inputs().size());
+    for(auto v : b->inputs())
+      encodeValueDef(v);
+    size_t num_nodes = 0;
+    for(auto it = b->nodes().begin(); it != b->nodes().end(); ++it)
+      num_nodes++;
+    w.writeU64(num_nodes);
+    for(auto n : b->nodes())
+      encodeNode(n);
+    w.writeU64(b->outputs().size());
+    for(auto v : b->outputs())
+      encodeValueRef(v);
+  }
+  void encodeNode(const Node * n) {
+    if(n->kind() == prim::PythonOp)
+      throw std::runtime_error("cannot serialize graphs containing Python ops");
+    w.writeString(n->kind().toQualString());
+    w.writeU64(n->stage());
+    w.writeU64(n->inputs().size());
+    for(auto v : n->inputs())
+      encodeValueRef(v);
+    w.writeU64(n->outputs().size());
+    for(auto v : n->outputs())
+      encodeValueDef(v);
+    encodeAttributes(n);
+    w.writeU64(n->blocks().size());
+    for(auto b : n->blocks())
+      encodeBlock(b);
+  }
+  void encodeValueDef(const Value * v) {
+    JIT_ASSERT(value_ids.count(v) == 0);
+    value_ids.emplace(v, value_ids.size());
+    encodeType(v->type());
+    w.writeU64(v->hasUniqueName());
+    if(v->hasUniqueName())
+      w.writeString(v->uniqueName());
+  }
+  void encodeValueRef(const Value * v) {
+    auto it = value_ids.find(v);
+    JIT_ASSERTM(it != value_ids.end(), "value used before it is defined");
+    w.writeU64(it->second);
+  }
+  void encodeType(const TypePtr & t) {
+    w.writeU64(static_cast<uint64_t>(t->kind()));
+    switch(t->kind()) {
+      case TypeKind::TensorType: {
+        auto tt = t->expect<TensorType>();
+        w.writeU64(static_cast<uint64_t>(tt->scalarType()));
+        w.writeI64(tt->device());
+        w.writeI64s(tt->sizes());
+        w.writeI64s(tt->strides());
+      } break;
+      case TypeKind::TupleType: {
+        auto elements = t->expect<TupleType>()->elements();
+        w.writeU64(elements.size());
+        for(auto & e : elements)
+          encodeType(e);
+      } break;
+      case TypeKind::ListType:
+        encodeType(t->expect<ListType>()->getElementType());
+        break;
+      default:
+        break;
+    }
+  }
+  void encodeTensor(const at::Tensor & t) {
+    w.writeU64(t.defined());
+    if(!t.defined())
+      return;
+    w.writeU64(static_cast<uint64_t>(t.type().scalarType()));
+    w.writeI64(t.type().is_cuda() ? t.get_device() : -1);
+    w.writeI64s(t.sizes());
+    auto cpu = t.toBackend(at::kCPU).contiguous();
+    w.writeString(std::string(
+        static_cast<const char*>(cpu.data_ptr()),
+        cpu.numel() * cpu.type().elementSizeInBytes()));
+  }
+  void encodeAttributes(const Node * n) {
+    auto names = n->attributeNames();
+    w.writeU64(names.size());
+    for(auto name : names) {
+      auto kind = n->kindOf(name);
+      w.writeString(name.toQualString());
+      w.writeU64(static_cast<uint64_t>(kind));
+      switch(kind) {
+        case AttributeKind::f:
+          w.writeDouble(n->f(name));
+          break;
+        case AttributeKind::fs:
+          w.writeU64(n->fs(name).size());
+          for(double v : n->fs(name))
+            w.writeDouble(v);
+          break;
+        case AttributeKind::i:
+          w.writeI64(n->i(name));
+          break;
+        case AttributeKind::is:
+          w.writeI64s(n->is(name));
+          break;
+        case AttributeKind::s:
+          w.writeString(n->s(name));
+          break;
+        case AttributeKind::ss:
+          w.writeU64(n->ss(name).size());
+          for(auto & s : n->ss(name))
+            w.writeString(s);
+          break;
+        case AttributeKind::t:
+          encodeTensor(n->t(name));
+          break;
+        case AttributeKind::ts:
+          w.writeU64(n->ts(name).size());
+          for(auto & t : n->ts(name))
+            encodeTensor(t);
+          break;
+        case AttributeKind::g:
+          w.writeString(serializeGraph(*n->g(name)));
+          break;
+        case AttributeKind::gs:
+          w.writeU64(n->gs(name).size());
+          for(auto & g : n->gs(name))
+            w.writeString(serializeGraph(*g));
+          break;
+      }
+    }
+  }
+  Writer w;
+  std::unordered_map<const Value*, size_t> value_ids;
+};
+
+struct GraphDecoder {
+  GraphDecoder(const std::string & data)
+  : r(data), graph(std::make_shared<Graph>()) {}
+
+  std::shared_ptr<Graph> decodeGraph() {
+    decodeBlock(graph->block());
+    if(!r.done())
+      throw std::runtime_error("trailing data in serialized graph");
+    return graph;
+  }
+  void decodeBlock(Block * b) {
+    size_t num_inputs = r.readU64();
+    for(size_t i = 0; i < num_inputs; ++i)
+      decodeValueDef(b->addInput());
+    size_t num_nodes = r.readU64();
+    for(size_t i = 0; i < num_nodes; ++i)
+      decodeNode(b);
+    size_t num_outputs = r.readU64();
+    for(size_t i = 0; i < num_outputs; ++i)
+      b->registerOutput(decodeValueRef());
+  }
+  void decodeNode(Block * b) {
+    auto kind = Symbol::fromQualString(r.readString());
+    if(kind == prim::PythonOp)
+      throw std::runtime_error("cannot deserialize Python ops");
+    Node * n = graph->create(kind, 0);
+    b->appendNode(n);
+    n->setStage(r.readU64());
+    size_t num_inputs = r.readU64();
+    for(size_t i = 0; i < num_inputs; ++i)
+      n->addInput(decodeValueRef());
+    size_t num_outputs = r.readU64();
+    for(size_t i = 0; i < num_outputs; ++i)
+      decodeValueDef(n->addOutput());
+    decodeAttributes(n);
+    size_t num_blocks = r.readU64();
+    for(size_t i = 0; i < num_blocks; ++i)
+      decodeBlock(n->addBlock());
+  }
+  void decodeValueDef(Value * v) {
+    values.push_back(v);
+    v->setType(decodeType());
+    if(r.readU64())
+      v->setUniqueName(r.readString());
+  }
+  Value * decodeValueRef() {
+    size_t id = r.readU64();
+    if(id >= values.size())
+      throw std::runtime_error("corrupt value reference in serialized graph");
+    return values[id];
+  }
+  TypePtr decodeType() {
+    auto kind = static_cast<TypeKind>(r.readU64());
+    switch(kind) {
+      case TypeKind::DynamicType:
+        return DynamicType::get();
+      case TypeKind::TensorType: {
+        auto scalar_type = static_cast<at::ScalarType>(r.readU64());
+        int device = r.readI64();
+        auto sizes = r.readI64s();
+        auto strides = r.readI64s();
+        return TensorType::create(scalar_type, device, sizes, strides);
+      }
+      case TypeKind::TupleType: {
+        std::vector<TypePtr> elements(r.readCount(sizeof(uint64_t)));
+        for(auto & e : elements)
+          e = decodeType();
+        return TupleType::create(std::move(elements));
+      }
+      case TypeKind::ListType:
+        return ListType::create(decodeType());
+      case TypeKind::NumberType:
+        return NumberType::get();
+      case TypeKind::FloatType:
+        return FloatType::get();
+      case TypeKind::IntType:
+        return IntType::get();
+      case TypeKind::NoneType:
+        return NoneType::get();
+    }
+    throw std::runtime_error("unknown type kind in serialized graph");
+  }
+  at::Tensor decodeTensor() {
+    if(!r.readU64())
+      return at::Tensor();
+    auto scalar_type = static_cast<at::ScalarType>(r.readU64());
+    int device = r.readI64();
+    auto sizes = r.readI64s();
+    auto data = r.readString();
+    auto t = at::CPU(scalar_type).tensor(sizes);
+    if(data.size() != t.numel() * t.type().elementSizeInBytes())
+      throw std::runtime_error("tensor size mismatch in serialized graph");
+    std::memcpy(t.data_ptr(), data.data(), data.size());
+    if(device >= 0) {
+      at::DeviceGuard guard(device);
+      t = t.toBackend(at::kCUDA);
+    }
+    return t;
+  }
+  void decodeAttributes(Node * n) {
+    size_t num_attributes = r.readU64();
+    for(size_t i = 0; i < num_attributes; ++i) {
+      auto name = Symbol::fromQualString(r.readString());
+      auto kind = static_cast<AttributeKind>(r.readU64());
+      switch(kind) {
+        case AttributeKind::f:
+          n->f_(name, r.readDouble());
+          break;
+        case AttributeKind::fs: {
+          std::vector<double> vs(r.readCount(sizeof(double)));
+          for(auto & v : vs)
+            v = r.readDouble();
+          n->fs_(name, std::move(vs));
+        } break;
+        case AttributeKind::i:
+          n->i_(name, r.readI64());
+          break;
+        case AttributeKind::is:
+          n->is_(name, r.readI64s());
+          break;
+        case AttributeKind::s:
+          n->s_(name, r.readString());
+          break;
+        case AttributeKind::ss: {
+          std::vector<std::string> ss(r.readCount(sizeof(uint64_t)));
+          for(auto & s : ss)
+            s = r.readString();
+          n->ss_(name, std::move(ss));
+        } break;
+        case AttributeKind::t:
+          n->t_(name, decodeTensor());
+          break;
+        case AttributeKind::ts: {
+          std::vector<at::Tensor> ts(r.readCount(sizeof(uint64_t)));
+          for(auto & t : ts)
+            t = decodeTensor();
+          n->ts_(name, std::move(ts));
+        } break;
+        case AttributeKind::g:
+          n->g_(name, deserializeGraph(r.readString()));
+          break;
+        case AttributeKind::gs: {
+          std::vector<std::shared_ptr<Graph>> gs(r.readCount(sizeof(uint64_t)));
+          for(auto & g : gs)
+            g = deserializeGraph(r.readString());
+          n->gs_(name, std::move(gs));
+        } break;
+        default:
+          throw std::runtime_error("unknown attribute kind in serialized graph");
+      }
+    }
+  }
+  Reader r;
+  std::shared_ptr<Graph> graph;
+  std::vector<Value*> values;
+};
+
+std::string defaultPlanCacheDir() {
+  const char * env = std::getenv("PYTORCH_JIT_PLAN_CACHE_DIR");
+  return env ? env : "";
+}
+
+std::mutex & planCacheDirMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::string & planCacheDirRef() {
+  static std::string dir = defaultPlanCacheDir();
+  return dir;
+}
+
+// Writes the schema of the operator every node of b resolves to, so that
+// entries written by a build whose operators differ are never loaded.
+void writeOperatorSchemas(Writer & w, const Block * b) {
+  for(auto n : b->nodes()) {
+    if(auto op = findOperatorFor(n)) {
+      std::ostringstream schema;
+      schema << op->schema;
+      w.writeString(schema.str());
+    }
+    for(auto sub : n->blocks())
+      writeOperatorSchemas(w, sub);
+  }
+}
+
+std::string planPath(const std::string & dir, const std::string & key) {
+  std::stringstream path;
+  path << dir << "/" << std::hex << fnv1a(key) << ".plan";
+  return path.str();
+}
+
+} // anonymous namespace
+
+std::string serializeGraph(const Graph & graph) {
+  GraphEncoder encoder;
+  encoder.encodeGraph(graph);
+  return std::move(encoder.w.out);
+}
+
+std::shared_ptr<Graph> deserializeGraph(const std::string & data) {
+  return GraphDecoder(data).decodeGraph();
+}
+
+std::string getPlanCacheDir() {
+  std::lock_guard<std::mutex> guard(planCacheDirMutex());
+  return planCacheDirRef();
+}
+
+void setPlanCacheDir(std::string dir) {
+  std::lock_guard<std::mutex> guard(planCacheDirMutex());
+  planCacheDirRef() = std::move(dir);
+}
+
+bool planCacheKey(const Graph & graph, const ArgumentSpec & spec, std::string & key) {
+  Writer w;
+  w.writeString(kPlanMagic);
+  w.writeU64(kPlanCacheVersion);
+  w.writeString(kBuildVersion);
+  // the fuser only creates CPU fusion groups if it can compile them
+#ifndef _WIN32
+  w.writeU64(sharedFusionCompiler().canCompileOnCPU());
+#else
+  // there is no fuser on Windows
+  w.writeU64(0);
+#endif
+  w.writeU64(spec.size());
+  w.writeI64s(spec.encoding());
+  try {
+    w.writeString(serializeGraph(graph));
+  } catch(std::exception &) {
+    return false;
+  }
+  writeOperatorSchemas(w, graph.block());
+  key = std::move(w.out);
+  return true;
+}
+
+// Entry layout: key, forward graph, has_gradient, and if it does, the df
+// graph followed by the remaining fields of Gradient.
+bool loadPlan(const std::string & key, Gradient & plan) {
+  auto dir = getPlanCacheDir();
+  if(dir.empty())
+    return false;
+  std::string contents;
+  if(!readFile(planPath(dir, key), contents))
+    return false;
+  try {
+    Reader r(contents);
+    if(r.readString() != key)
+      return false;
+    Gradient result;
+    result.f = deserializeGraph(r.readString());
+    if(r.readU64()) {
+      result.df = deserializeGraph(r.readString());
+      result.f_real_outputs = r.readU64();
+      result.df_input_vjps = r.readSizes();
+      result.df_input_captured_inputs = r.readSizes();
+      result.df_input_captured_outputs = r.readSizes();
+      result.df_output_vjps = r.readSizes();
+    }
+    if(!r.done())
+      return false;
+    plan = std::move(result);
+    return true;
+  } catch(std::exception & e) {
+    std::cerr << "warning: ignoring unreadable JIT plan cache entry " << planPath(dir, key)
+              << ": " << e.what() << "\n";
+    return false;
+  }
+}
+
+void removePlan(const std::string & key) {
+  auto dir = getPlanCacheDir();
+  if(dir.empty())
+    return;
+  std::remove(planPath(dir, key).c_str());
+}
+
+void storePlan(const std::string & key, const Gradient & plan) {
+  auto dir = getPlanCacheDir();
+  if(dir.empty())
+    return;
+  Writer w;
+  try {
+    w.writeString(key);
+    w.writeString(serializeGraph(*plan.f));
+    w.writeU64(static_cast<bool>(plan));
+    if(plan) {
+      w.writeString(serializeGraph(*plan.df));
+      w.writeU64(plan.f_real_outputs);
+      w.writeSizes(plan.df_input_vjps);
+      w.writeSizes(plan.df_input_captured_inputs);
+      w.writeSizes(plan.df_input_captured_outputs);
+      w.writeSizes(plan.df_output_vjps);
+    }
+  } catch(std::exception &) {
+    return;
+  }
+  // The cache is an optimization: failing to write an entry only means the
+  // next process compiles the plan again. Entries are written to a private
+  // temporary file and renamed into place, so readers never see partial
+  // entries and concurrent writers of the same entry are harmless.
+  if(!makeDirectories(dir))
+    return;
+  auto path = planPath(dir, key);
+  static std::atomic<uint64_t> tmp_counter{0};
+  auto tmp_path = path + ".tmp" + std::to_string(getpid()) + "." + std::to_string(tmp_counter++);
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    out.write(w.out.data(), w.out.size());
+    if(!out) {
+      out.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if(std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    std::remove(tmp_path.c_str());
+}
+
+}}
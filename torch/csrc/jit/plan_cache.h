@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "torch/csrc/WindowsTorchApiMacro.h"
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/argument_spec.h"
+#include "torch/csrc/jit/autodiff.h"
+
+namespace torch { namespace jit {
+
+// On-disk cache of the plans GraphExecutor compiles for each ArgumentSpec.
+//
+// Specializing and optimizing a graph for a new ArgumentSpec (shape analysis,
+// differentiation, fusion, ...) happens once per process. When a cache
+// directory is configured, GraphExecutor stores the result of that work, the
+// optimized forward graph and, for plans that require grad, the Gradient
+// describing its backward, so that a restarted process can load it instead.
+//
+// Entries are keyed by the unoptimized graph, the schemas of the operators it
+// calls, the ArgumentSpec, the version of the build that wrote them and the
+// settings that influence optimization. The full key is stored in each entry
+// and compared on load, so hash collisions never return the wrong plan.
+// Fusion groups are stored as graphs; their kernels are recompiled when the
+// plan is first run, which for the CPU codegen backend hits the fuser's own
+// PYTORCH_FUSION_CACHE_DIR.
+//
+// The directory defaults to PYTORCH_JIT_PLAN_CACHE_DIR; an empty string
+// disables the cache. Graphs containing Python ops are never persisted.
+
+TORCH_API std::string getPlanCacheDir();
+TORCH_API void setPlanCacheDir(std::string dir);
+
+// Computes the cache key of the plan for `graph` under `spec`.
+// Returns false if `graph` cannot be serialized.
+TORCH_API bool planCacheKey(const Graph& graph, const ArgumentSpec& spec, std::string& key);
+
+// A plan is described by a Gradient: plan.f is the optimized graph that is
+// run forward, and plan.df is only set if the plan computes a gradient.
+// loadPlan returns false if there is no valid entry for key.
+TORCH_API bool loadPlan(const std::string& key, Gradient& plan);
+TORCH_API void storePlan(const std::string& key, const Gradient& plan);
+// Deletes the entry for key, e.g. one that loaded but could not be run.
+TORCH_API void removePlan(const std::string& key);
+
+// Binary serialization of a Graph, including value types and attributes.
+// serializeGraph throws if the graph contains nodes that cannot be
+// serialized (e.g. PythonOps).
+TORCH_API std::string serializeGraph(const Graph& graph);
+TORCH_API std::shared_ptr<Graph> deserializeGraph(const std::string& data);
+
+}}
@@ -401,6 +401,7 @@ void initJitScriptBindings(PyObject* module) {
   py::class_<Module, std::shared_ptr<Module>>(m, "ScriptModule")
       .def(py::init<>())
       .def("_set_optimized", &Module::set_optimized)
+      .def("_set_parameters_frozen", &Module::set_parameters_frozen)
       .def(
           "_define",
           [](std::shared_ptr<Module> m,
@@ -532,6 +533,11 @@ void initJitScriptBindings(PyObject* module) {
     .def("graph_for", [](Method& self, py::args args) {
       return self.graph_for(createStack(args));
     })
+    .def("warm_up", [](Method& self, py::args example_inputs) {
+      for (auto inputs : example_inputs) {
+        self.warm_up(createStack(py::cast<py::tuple>(inputs)));
+      }
+    })
     .def("set_arg_and_return_types", [](Method &self, TypedDef &typed_def, bool method) {
       std::vector<Argument> arg_type_args, return_type_args;
       size_t i = 0;
@@ -60,7 +60,18 @@ struct Method {
     }
     get_executor().run(stack);
   }
-  std::shared_ptr<Graph> graph_for(const Stack& inputs) {
+  // compile ahead of time the plan used for inputs like these,
+  // see GraphExecutor::warmUp
+  void warm_up(Stack inputs) {
+    for(at::Tensor* tp : member_inputs) {
+      inputs.push_back(*tp);
+    }
+    get_executor().warmUp(inputs);
+  }
+  std::shared_ptr<Graph> graph_for(Stack inputs) {
+    for(at::Tensor* tp : member_inputs) {
+      inputs.push_back(*tp);
+    }
     return get_executor().graphFor(inputs);
   }
   std::shared_ptr<Graph> graph() const {
@@ -136,6 +147,14 @@ struct Method {
     return member_inputs;
   }
 
+  // see GraphExecutor::setParametersFrozen
+  void set_parameters_frozen(bool frozen) {
+    parameters_frozen = frozen;
+    if (executor) {
+      executor.setParametersFrozen(frozen);
+    }
+  }
+
   Method& setSchema(FunctionSchema schema_) {
     schema.reset(new FunctionSchema(std::move(schema_)));
     return *this;
@@ -155,11 +174,13 @@ private:
 
   GraphExecutor& get_executor() {
     std::call_once(executor_init, [&]{
-      executor = GraphExecutor(graph(), optimize);
+      executor = GraphExecutor::withParameters(graph(), optimize, member_inputs.size());
+      executor.setParametersFrozen(parameters_frozen);
     });
     return executor;
   }
 
+  bool parameters_frozen = false;
   GraphExecutor executor; // for execution
   // member_inputs are a list of additional arguments appended to graph that are
   // inputs that come from the members of the Module or its submodules.
@@ -231,6 +252,17 @@ struct Module {
     optimize = o;
   }
 
+  // freezes (or unfreezes) the parameters of the methods of this module and
+  // its submodules, see GraphExecutor::setParametersFrozen
+  void set_parameters_frozen(bool frozen) {
+    for (auto & method : methods) {
+      method.value->set_parameters_frozen(frozen);
+    }
+    for (auto & submodule : modules) {
+      submodule.value.module->set_parameters_frozen(frozen);
+    }
+  }
+
   void register_parameter(const std::string & name, autograd::Variable v, bool is_buffer) {
     if(auto p = parameters.find(name)){
       *p->slot() = v;
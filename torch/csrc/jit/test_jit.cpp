@@ -26,6 +26,7 @@
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/passes/lower_grad_of.h"
+#include "torch/csrc/jit/passes/hoist_parameter_computations.h"
 #include "torch/csrc/variable_tensor_functions.h"
 
 #include "torch/csrc/autograd/variable.h"
@@ -33,6 +34,7 @@
 #include "torch/csrc/jit/passes/shape_analysis.h"
 
 #include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/plan_cache.h"
 #include "torch/csrc/jit/script/compiler.h"
 #include "torch/csrc/jit/script/module.h"
 #include "torch/csrc/jit/ivalue.h"
@@ -44,6 +46,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -54,6 +57,9 @@
 #include <utility>
 #include <vector>
 
+#include <dirent.h>
+#include <unistd.h>
+
 namespace torch { namespace jit {
 
 using Var = SymbolicVariable;
@@ -131,8 +137,13 @@ Value * appendNewNode(NodeKind kind, Graph& graph, ArrayRef<Value*> inputs) {
 }
 
 
-static void fusionTests() {
-  FusionCompiler comp;
+// On CPU, cpu_interpreter selects the fusion interpreter instead of the
+// cxx code generator.
+static void fusionTests(at::Backend backend = at::kCUDA, bool cpu_interpreter = false) {
+  FusionCompilerConfig config;
+  config.cpu_interpreter = cpu_interpreter;
+  FusionCompiler comp(config);
+  const int device = backend == at::kCPU ? kCPUDevice : 0;
 
   auto testSimple = [&] {
     Graph graph;
@@ -140,10 +151,10 @@ static void fusionTests() {
     Var i1 = Var::asNewInput(graph);
     auto o0 = i0 * i1;
     o0.addAsOutput();
-    auto a = at::rand({3,4}, at::kCUDA);
-    auto b = at::rand({4,3}, at::kCUDA).transpose(0,1);
-    auto o = at::zeros({3,4}, at::kCUDA);
-    comp.debugLaunchGraph(graph, 0, {a,b}, {o});
+    auto a = at::rand({3,4}, backend);
+    auto b = at::rand({4,3}, backend).transpose(0,1);
+    auto o = at::zeros({3,4}, backend);
+    comp.debugLaunchGraph(graph, device, {a,b}, {o});
     auto o2 = a*b;
     float max_diff = (o2 - o).abs().max().toCDouble();
     //std::cout << "max diff: " << max_diff << "\n";
@@ -184,12 +195,12 @@ static void fusionTests() {
     for(size_t i = 0; i < graph.inputs().size(); i++) {
       std::vector<int64_t> dims = {128, 128, 32};
       std::swap(dims[ti],dims[tj]);
-      inputs.push_back(at::rand(dims, at::kCUDA).transpose(ti, tj));
+      inputs.push_back(at::rand(dims, backend).transpose(ti, tj));
     }
     for(size_t i = 0; i < graph.outputs().size(); i++) {
       std::vector<int64_t> dims = {128, 128, 32};
       std::swap(dims[toi],dims[toj]);
-      outputs.push_back(at::zeros(dims, at::kCUDA).transpose(toi,toj));
+      outputs.push_back(at::zeros(dims, backend).transpose(toi,toj));
     }
 
     auto t22 = inputs[4].sigmoid();
@@ -204,7 +215,7 @@ static void fusionTests() {
 
 
     //auto out0 = inputs[0]*inputs[1];
-    comp.debugLaunchGraph(graph, 0, inputs, outputs);
+    comp.debugLaunchGraph(graph, device, inputs, outputs);
     REQUIRE(out0.is_same_size(outputs.front()));
     float max_diff = (outputs.front() - out0).abs().max().toCDouble();
     REQUIRE(max_diff < 1e-6);
@@ -232,14 +243,14 @@ static void fusionTests() {
     o0.addAsOutput();
     Var(createFusedConcat(graph, {i0, o0}, dim)).addAsOutput();
 
-    auto a = at::rand({3,4,5}, at::kCUDA);
-    auto b = at::rand({4,3,5}, at::kCUDA).transpose(0,1);
-    auto o = at::zeros({3,4,5}, at::kCUDA);
+    auto a = at::rand({3,4,5}, backend);
+    auto b = at::rand({4,3,5}, backend).transpose(0,1);
+    auto o = at::zeros({3,4,5}, backend);
 
     auto o_r = a*b;
     auto o2_r = at::cat({a, o_r}, dim);
-    auto o2 = at::zeros(o2_r.sizes(), at::kCUDA);
-    comp.debugLaunchGraph(graph, 0, {a,b}, {o, o2});
+    auto o2 = at::zeros(o2_r.sizes(), backend);
+    comp.debugLaunchGraph(graph, device, {a,b}, {o, o2});
 
     float max_diff = (o_r - o).abs().max().toCDouble();
     REQUIRE(max_diff == 0);
@@ -836,6 +847,138 @@ void testGraphExecutor() {
   REQUIRE(almostEqual(Variable(stack[1].toTensor()).data(), r1));
 }
 
+void testHoistParameterComputations() {
+  // y = x.mm((w * 2).t()), with parameter w
+  auto build = [] {
+    auto g = std::make_shared<Graph>();
+    Var x = g->addInput();
+    Var w = g->addInput();
+    (x.mm((w * 2).t())).addAsOutput();
+    return g;
+  };
+
+  auto g = build();
+  auto prologue = HoistParameterComputations(g, 1);
+  REQUIRE(prologue != nullptr);
+  g->lint();
+  prologue->lint();
+  // the prologue computes (w * 2).t(), which becomes the last input of g
+  REQUIRE(prologue->inputs().size() == 1);
+  REQUIRE(prologue->outputs().size() == 1);
+  REQUIRE(prologue->outputs()[0]->node()->kind() == aten::t);
+  REQUIRE(g->inputs().size() == 3);
+  for(Node * n : g->nodes()) {
+    REQUIRE(n->kind() != aten::t);
+    REQUIRE(n->kind() != aten::mul);
+  }
+  // outputs of the graph are not hoisted
+  auto only_params = std::make_shared<Graph>();
+  Var w = only_params->addInput();
+  w.t().addAsOutput();
+  REQUIRE(HoistParameterComputations(only_params, 1) == nullptr);
+
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+  auto x = v(at::randn({2, 4}, at::kCPU));
+  auto weight = v(at::randn({3, 4}, at::kCPU));
+  auto expected = [&] { return x.data().mm((weight.data() * 2).t()); };
+
+  auto executor = GraphExecutor::withParameters(build(), true, 1);
+  auto check = [&] {
+    auto stack = createStack({x, weight});
+    executor.run(stack);
+    REQUIRE(almostEqual(Variable(stack[0].toTensor()).data(), expected()));
+  };
+  check();
+  auto state = executor.getDebugState();
+  REQUIRE(state.execution_plans.size() == 1);
+  REQUIRE(state.execution_plans.begin()->second.prologue_graph != nullptr);
+
+  // changes through .data keep the version counter, and are only seen
+  // because the parameters are not frozen
+  weight.data().add_(1);
+  check();
+
+  executor.setParametersFrozen(true);
+  check();
+  check();
+  // modifying the parameter in place bumps its version and invalidates the
+  // prologue results
+  weight.add_(1);
+  check();
+  // as does invalidateParameterCaches, e.g. after load_state_dict
+  weight.data().add_(1);
+  invalidateParameterCaches();
+  check();
+}
+
+void testPlanCache() {
+  constexpr int batch_size = 4;
+  constexpr int input_size = 16;
+
+  int hidden_size = 2*input_size;
+
+  // graphs survive a round trip through serialization, types included
+  auto g = build_lstm();
+  auto data = serializeGraph(*g);
+  REQUIRE(serializeGraph(*deserializeGraph(data)) == data);
+
+  char dir[] = "/tmp/pytorch_plan_cacheXXXXXX";
+  REQUIRE(mkdtemp(dir) != nullptr);
+  auto old_dir = getPlanCacheDir();
+  setPlanCacheDir(dir);
+
+  auto v = [](at::Tensor t, bool requires_grad) {
+    return autograd::make_variable(t, requires_grad);
+  };
+  auto input = at::randn({batch_size, input_size}, at::kCPU);
+  auto hx    = at::randn({batch_size, hidden_size}, at::kCPU);
+  auto cx    = at::randn({batch_size, hidden_size}, at::kCPU);
+  auto w_ih  = t_def(at::randn({4 * hidden_size, input_size}, at::kCPU));
+  auto w_hh  = t_def(at::randn({4 * hidden_size, hidden_size}, at::kCPU));
+  at::Tensor r0, r1;
+  std::tie(r0, r1) = lstm(input, hx, cx, w_ih, w_hh);
+
+  for(bool requires_grad : {false, true}) {
+    auto stack = createStack({v(input, false), v(hx, false), v(cx, false),
+                              v(w_ih, requires_grad), v(w_hh, requires_grad)});
+    ArgumentSpec spec(autograd::GradMode::is_enabled(), stack);
+
+    // warming up compiles the plan and writes it to the cache
+    GraphExecutor first(build_lstm());
+    first.warmUp(stack);
+    auto first_plans = first.getDebugState().execution_plans;
+    REQUIRE(first_plans.size() == 1);
+    REQUIRE(!first_plans.begin()->second.loaded_from_cache);
+    std::string key;
+    REQUIRE(planCacheKey(*build_lstm(), spec, key));
+    Gradient plan;
+    REQUIRE(loadPlan(key, plan));
+    REQUIRE(static_cast<bool>(plan) == requires_grad);
+    REQUIRE(serializeGraph(*plan.f) == serializeGraph(*first.graphFor(stack)));
+
+    // a new executor picks up the cached plan and computes the same result
+    GraphExecutor second(build_lstm());
+    second.run(stack);
+    auto second_plans = second.getDebugState().execution_plans;
+    REQUIRE(second_plans.size() == 1);
+    REQUIRE(second_plans.begin()->second.loaded_from_cache);
+    REQUIRE(stack.size() == 2);
+    REQUIRE(almostEqual(Variable(stack[0].toTensor()).data(), r0));
+    REQUIRE(almostEqual(Variable(stack[1].toTensor()).data(), r1));
+  }
+
+  setPlanCacheDir(old_dir);
+  if(DIR * d = opendir(dir)) {
+    while(dirent * entry = readdir(d)) {
+      std::string name = entry->d_name;
+      if(name != "." && name != "..")
+        unlink((std::string(dir) + "/" + name).c_str());
+    }
+    closedir(d);
+  }
+  rmdir(dir);
+}
+
 void testBlocks(std::ostream & out) {
   Graph g;
   auto a = Var::asNewInput(g, "a");
@@ -887,6 +1030,18 @@ const static auto cf_examples = R"JIT(
       a *= a
       i += 1
     return a
+  def fib_test(a, n):
+    b = a
+    while n > 0:
+      a, b = b, a + b
+      n -= 1
+    return a
+  def swap_test(a, n):
+    b = a + 1
+    while n > 0:
+      a, b = b, a
+      n -= 1
+    return a
 )JIT";
 void testControlFlow() {
   script::Module cu;
@@ -904,11 +1059,19 @@ void testControlFlow() {
   auto run_binary = [&](const std::string & name, int64_t a, int64_t b) {
     return V(run(name, {L(a), L(b)})[0]);
   };
-  REQUIRE(2 == run_binary("if_test", 1, 2));
-  REQUIRE(3 == run_binary("if_test", 3, 2));
-  REQUIRE(2 == run_binary("if_one", 2, 3));
-  REQUIRE(2 == run_binary("if_one", 3, 2));
-  REQUIRE(256 == run_binary("while_test",2,0));
+  auto old_dispatch = registerDispatchEnabled();
+  for(bool register_dispatch : {true, false}) {
+    setRegisterDispatchEnabled(register_dispatch);
+    REQUIRE(2 == run_binary("if_test", 1, 2));
+    REQUIRE(3 == run_binary("if_test", 3, 2));
+    REQUIRE(2 == run_binary("if_one", 2, 3));
+    REQUIRE(2 == run_binary("if_one", 3, 2));
+    REQUIRE(256 == run_binary("while_test",2,0));
+    REQUIRE(8 == run_binary("fib_test", 1, 5));
+    REQUIRE(2 == run_binary("swap_test", 1, 3));
+    REQUIRE(1 == run_binary("swap_test", 1, 2));
+  }
+  setRegisterDispatchEnabled(old_dispatch);
 }
 
 void testIValue() {
@@ -965,6 +1128,8 @@ TORCH_API std::string runJITCPPTests() {
   testIValue();
   testControlFlow();
   testGraphExecutor();
+  testHoistParameterComputations();
+  testPlanCache();
   testBlocks(out);
   testCreateAutodiffSubgraphs(out);
   testDifferentiate(out);
@@ -974,6 +1139,8 @@ TORCH_API std::string runJITCPPTests() {
   interpStageTest();
   codeTemplateTest();
   fusionTests();
+  fusionTests(at::kCPU, /*cpu_interpreter=*/true);
+  fusionTests(at::kCPU);
   attributesTest();
   internedStringsTests();
   fromQualStringTests();
@@ -1006,6 +1173,12 @@ TEST_CASE( "jit test CPU", "[cpu]" ) {
     attributesTest();
   SECTION( "interned strings" )
     internedStringsTests();
+  SECTION( "fusion" )
+    fusionTests(at::kCPU, /*cpu_interpreter=*/true);
+  SECTION( "plan cache" )
+    testPlanCache();
+  SECTION( "hoist parameter computations" )
+    testHoistParameterComputations();
 }
 
 TEST_CASE( "jit test CUDA", "[cuda]" ) {
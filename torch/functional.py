@@ -290,7 +290,7 @@ def isnan(tensor):
     return tensor != tensor
 
 
-def unique(input, sorted=False, return_inverse=False):
+def unique(input, sorted=False, return_inverse=False, return_counts=False):
     r"""Returns the unique scalar elements of the input tensor as a 1-D tensor.
 
     Arguments:
@@ -299,6 +299,8 @@ def unique(input, sorted=False, return_inverse=False):
             before returning as output.
         return_inverse (bool): Whether to also return the indices for where
             elements in the original input ended up in the returned unique list.
+        return_counts (bool): Whether to also return the number of times each
+            unique element occurs in the input.
 
     Returns:
         (Tensor, Tensor (optional)): A tensor or a tuple of tensors containing
@@ -309,6 +311,10 @@ def unique(input, sorted=False, return_inverse=False):
               2nd returned tensor (same shape as input) representing the indices
               for where elements in the original input map to in the output;
               otherwise, this function will only return a single tensor.
+            - **counts** (*Tensor*): (optional) if :attr:`return_counts` is
+              True, a tensor of the same length as the output, holding the
+              number of occurrences of each unique element. It is returned
+              after the inverse indices, if those are requested too.
 
     Example::
 
@@ -331,7 +337,24 @@ def unique(input, sorted=False, return_inverse=False):
         tensor([[ 0,  2],
                 [ 1,  2]])
 
+        >>> output, counts = torch.unique(
+                torch.tensor([1, 3, 2, 3], dtype=torch.long), sorted=True, return_counts=True)
+        >>> output
+        tensor([ 1,  2,  3])
+        >>> counts
+        tensor([ 1,  1,  2])
+
     """
+    if return_counts:
+        output, inverse_indices, counts = torch._unique2(
+            input,
+            sorted=sorted,
+            return_inverse=return_inverse,
+            return_counts=True,
+        )
+        if return_inverse:
+            return output, inverse_indices, counts
+        return output, counts
     output, inverse_indices = torch._unique(
         input,
         sorted=sorted,
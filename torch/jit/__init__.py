@@ -631,6 +631,34 @@ class ScriptModule(with_metaclass(ScriptMeta, torch._C.ScriptModule, Module)):
         else:
             super(ScriptModule, self).__setattr__(attr, _get_valid_constant(value))
 
+    def freeze_parameters(self, frozen=True):
+        r"""Promises that the parameters and buffers of this module and its
+        submodules are not going to change, so that results computed only
+        from them (e.g. transposed weights) can be reused across calls of its
+        script methods when no gradient is needed.
+
+        In-place operations on the parameters, :meth:`load_state_dict` and
+        methods like :meth:`cuda` or :meth:`half` still take effect. Other
+        changes through ``.data``, like the updates of an optimizer, don't
+        while the module is frozen.
+
+        Returns:
+            Module: self
+        """
+        self._set_parameters_frozen(frozen)
+        return self
+
+    def _apply(self, fn):
+        result = Module._apply(self, fn)
+        torch._C._jit_invalidate_parameter_caches()
+        return result
+
+    def _load_from_state_dict(self, *args, **kwargs):
+        Module._load_from_state_dict(self, *args, **kwargs)
+        # load_state_dict copies into the parameters through .data, which
+        # frozen parameters would not notice
+        torch._C._jit_invalidate_parameter_caches()
+
     def __dir__(self):
         return sorted(Module.__dir__(self) + self._method_names())
 
@@ -1,11 +1,84 @@
 #include "ProcessGroup.hpp"
 
+#include <string>
+
 namespace c10d {
 
 ProcessGroup::Work::~Work() {}
 
+int ProcessGroup::Work::sourceRank() const {
+  throw std::runtime_error(
+      "sourceRank() may only be called on work returned by recvAnysource()");
+}
+
 ProcessGroup::ProcessGroup(int rank, int size) : rank_(rank), size_(size) {}
 
 ProcessGroup::~ProcessGroup() {}
 
+namespace {
+
+[[noreturn]] void throwUnsupported(const char* name) {
+  throw std::runtime_error(
+      std::string("This process group does not support ") + name);
+}
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::reduce(
+    std::vector<at::Tensor>& /* unused */,
+    const ReduceOptions& /* unused */) {
+  throwUnsupported("reduce");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::allgather(
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    std::vector<at::Tensor>& /* unused */) {
+  throwUnsupported("allgather");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::gather(
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    std::vector<at::Tensor>& /* unused */,
+    const GatherOptions& /* unused */) {
+  throwUnsupported("gather");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::scatter(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const ScatterOptions& /* unused */) {
+  throwUnsupported("scatter");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::reduce_scatter(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const ReduceScatterOptions& /* unused */) {
+  throwUnsupported("reduce_scatter");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::send(
+    std::vector<at::Tensor>& /* unused */,
+    int /* unused */,
+    int /* unused */) {
+  throwUnsupported("send");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::recv(
+    std::vector<at::Tensor>& /* unused */,
+    int /* unused */,
+    int /* unused */) {
+  throwUnsupported("recv");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::recvAnysource(
+    std::vector<at::Tensor>& /* unused */,
+    int /* unused */) {
+  throwUnsupported("recvAnysource");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::barrier() {
+  throwUnsupported("barrier");
+}
+
 } // namespace c10d
@@ -73,6 +73,10 @@ class ProcessGroup {
 
     // Returns exception if wait() returned false.
     virtual const std::exception& exception() const = 0;
+
+    // Returns the rank that the tensors of a completed recv or
+    // recvAnysource were received from. Throws for any other work.
+    virtual int sourceRank() const;
   };
 
   explicit ProcessGroup(int rank, int size);
@@ -94,6 +98,71 @@ class ProcessGroup {
       std::vector<at::Tensor>& data,
       const AllreduceOptions& opts = AllreduceOptions()) = 0;
 
+  // The functions below are not supported by every implementation;
+  // the default implementations throw.
+
+  // Reduces the tensors of all processes into the tensor
+  // opts.rootTensor of process opts.rootRank. The contents of the
+  // tensors of other processes are unspecified after the reduction.
+  virtual std::shared_ptr<Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions());
+
+  // Gathers the input tensors of all processes. Every vector
+  // outputTensors[i] holds getSize() * inputTensors.size() tensors, of
+  // which tensor r * inputTensors.size() + j receives input tensor j
+  // of process r.
+  virtual std::shared_ptr<Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors);
+
+  // Gathers the single input tensor of all processes into the getSize()
+  // tensors of outputTensors[0] on process opts.rootRank. Other
+  // processes pass an empty outputTensors.
+  virtual std::shared_ptr<Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const GatherOptions& opts = GatherOptions());
+
+  // Scatters the getSize() tensors of inputTensors[0] on process
+  // opts.rootRank, sending tensor r to the single output tensor of
+  // process r. Other processes pass an empty inputTensors.
+  virtual std::shared_ptr<Work> scatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ScatterOptions& opts = ScatterOptions());
+
+  // Reduces the getSize() tensors of inputTensors[0] over all
+  // processes, storing the reduction of the tensors with index r in the
+  // single output tensor of process r.
+  virtual std::shared_ptr<Work> reduce_scatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions());
+
+  // Point to point communication of a single tensor. A send matches
+  // the recv with the same tag on the destination process, and sends
+  // with the same destination and tag are received in order.
+  virtual std::shared_ptr<Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag);
+
+  virtual std::shared_ptr<Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag);
+
+  // Receives from whichever process sends with this tag first, see
+  // Work::sourceRank.
+  virtual std::shared_ptr<Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int tag);
+
+  // Completes once all processes have called barrier and the work that
+  // this process queued before calling it has completed.
+  virtual std::shared_ptr<Work> barrier();
+
  protected:
   const int rank_;
   const int size_;
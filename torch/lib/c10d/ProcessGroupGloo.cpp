@@ -1,7 +1,9 @@
 #include "ProcessGroupGloo.hpp"
 
+#include <gloo/allgather_ring.h>
 #include <gloo/allreduce_halving_doubling.h>
 #include <gloo/allreduce_ring_chunked.h>
+#include <gloo/barrier_all_to_all.h>
 #include <gloo/broadcast_one_to_all.h>
 #include <gloo/cuda_allreduce_halving_doubling.h>
 #include <gloo/cuda_allreduce_ring_chunked.h>
@@ -9,6 +11,12 @@
 #include <gloo/rendezvous/context.h>
 #include <gloo/transport/tcp/device.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
 #include <THC.h>
 
 #include <c10d/private/CUDAUtils.hpp>
@@ -125,6 +133,418 @@ void synchronizeStreams(THCState* thcState, AlgorithmEntry* entry) {
   }
 }
 
+// Point to point operations use slots with this prefix and the tag in
+// the lower bits, which never collide with the slots of the collectives
+// (see ::gloo::Context::nextSlot).
+constexpr uint64_t kSendRecvSlotPrefix = 0x01;
+
+uint64_t sendRecvSlot(int tag) {
+  return (kSendRecvSlotPrefix << 56) | static_cast<uint32_t>(tag);
+}
+
+// Gathers count elements from every process into outPtr on the root,
+// which holds contextSize * count elements. Every process sends its
+// input straight to the root.
+template <typename T>
+class GatherToOne : public ::gloo::Algorithm {
+ public:
+  GatherToOne(
+      const std::shared_ptr<::gloo::Context>& context,
+      T* inPtr,
+      T* outPtr,
+      size_t count,
+      int rootRank)
+      : ::gloo::Algorithm(context),
+        inPtr_(inPtr),
+        outPtr_(outPtr),
+        bytes_(count * sizeof(T)),
+        rootRank_(rootRank),
+        slot_(context_->nextSlot()) {
+    if (contextRank_ == rootRank_) {
+      buffer_ = context_->createUnboundBuffer(outPtr_, bytes_ * contextSize_);
+    } else {
+      buffer_ = context_->createUnboundBuffer(inPtr_, bytes_);
+    }
+  }
+
+  void run() override {
+    if (contextRank_ != rootRank_) {
+      buffer_->send(rootRank_, slot_);
+      buffer_->waitSend();
+      return;
+    }
+    for (int i = 0; i < contextSize_; i++) {
+      if (i != contextRank_) {
+        buffer_->recv(i, slot_, i * bytes_, bytes_);
+      }
+    }
+    std::memcpy(
+        reinterpret_cast<char*>(outPtr_) + contextRank_ * bytes_,
+        inPtr_,
+        bytes_);
+    for (int i = 1; i < contextSize_; i++) {
+      buffer_->waitRecv();
+    }
+  }
+
+ protected:
+  T* inPtr_;
+  T* outPtr_;
+  const size_t bytes_;
+  const int rootRank_;
+  const uint64_t slot_;
+  std::unique_ptr<::gloo::transport::UnboundBuffer> buffer_;
+};
+
+// Scatters contextSize * count elements at inPtr on the root, sending
+// count elements to outPtr on every process.
+template <typename T>
+class ScatterFromOne : public ::gloo::Algorithm {
+ public:
+  ScatterFromOne(
+      const std::shared_ptr<::gloo::Context>& context,
+      T* inPtr,
+      T* outPtr,
+      size_t count,
+      int rootRank)
+      : ::gloo::Algorithm(context),
+        inPtr_(inPtr),
+        outPtr_(outPtr),
+        bytes_(count * sizeof(T)),
+        rootRank_(rootRank),
+        slot_(context_->nextSlot()) {
+    if (contextRank_ == rootRank_) {
+      buffer_ = context_->createUnboundBuffer(inPtr_, bytes_ * contextSize_);
+    } else {
+      buffer_ = context_->createUnboundBuffer(outPtr_, bytes_);
+    }
+  }
+
+  void run() override {
+    if (contextRank_ != rootRank_) {
+      buffer_->recv(rootRank_, slot_);
+      buffer_->waitRecv();
+      return;
+    }
+    for (int i = 0; i < contextSize_; i++) {
+      if (i != contextRank_) {
+        buffer_->send(i, slot_, i * bytes_, bytes_);
+      }
+    }
+    std::memcpy(
+        outPtr_,
+        reinterpret_cast<char*>(inPtr_) + contextRank_ * bytes_,
+        bytes_);
+    for (int i = 1; i < contextSize_; i++) {
+      buffer_->waitSend();
+    }
+  }
+
+ protected:
+  T* inPtr_;
+  T* outPtr_;
+  const size_t bytes_;
+  const int rootRank_;
+  const uint64_t slot_;
+  std::unique_ptr<::gloo::transport::UnboundBuffer> buffer_;
+};
+
+// Reduces contextSize chunks of count elements at ptr over all
+// processes, leaving the reduction of chunk i in chunk i of process i
+// (the other chunks are left partially reduced).
+//
+// This is the first half of a ring allreduce: in step s, every process
+// sends chunk (rank - s - 1) to its right neighbor and reduces chunk
+// (rank - s - 2) received from its left neighbor, so every process
+// sends and receives (contextSize - 1) * count elements.
+template <typename T>
+class ReduceScatterRing : public ::gloo::Algorithm {
+ public:
+  ReduceScatterRing(
+      const std::shared_ptr<::gloo::Context>& context,
+      T* ptr,
+      size_t count,
+      const ::gloo::ReductionFunction<T>* fn)
+      : ::gloo::Algorithm(context),
+        ptr_(ptr),
+        count_(count),
+        fn_(fn),
+        slot_(context_->nextSlot()),
+        tmp_(count) {
+    sendBuffer_ =
+        context_->createUnboundBuffer(ptr_, count_ * contextSize_ * sizeof(T));
+    recvBuffer_ = context_->createUnboundBuffer(tmp_.data(), count_ * sizeof(T));
+  }
+
+  void run() override {
+    const int left = (contextRank_ + contextSize_ - 1) % contextSize_;
+    const int right = (contextRank_ + 1) % contextSize_;
+    const size_t bytes = count_ * sizeof(T);
+    for (int s = 0; s < contextSize_ - 1; s++) {
+      const int sendChunk = (contextRank_ - s - 1 + 2 * contextSize_) % contextSize_;
+      const int recvChunk = (contextRank_ - s - 2 + 2 * contextSize_) % contextSize_;
+      sendBuffer_->send(right, slot_, sendChunk * bytes, bytes);
+      recvBuffer_->recv(left, slot_);
+      recvBuffer_->waitRecv();
+      sendBuffer_->waitSend();
+      fn_->call(ptr_ + recvChunk * count_, tmp_.data(), count_);
+    }
+  }
+
+ protected:
+  T* ptr_;
+  const size_t count_;
+  const ::gloo::ReductionFunction<T>* fn_;
+  const uint64_t slot_;
+  std::vector<T> tmp_;
+  std::unique_ptr<::gloo::transport::UnboundBuffer> sendBuffer_;
+  std::unique_ptr<::gloo::transport::UnboundBuffer> recvBuffer_;
+};
+
+// Elements that share a scale in the INT8 encoding.
+constexpr int64_t kInt8BucketSize = 256;
+
+// The INT8 encoding of count elements is a float scale for every bucket
+// of kInt8BucketSize elements, followed by an int8_t per element, the
+// element divided by the scale of its bucket and rounded.
+size_t int8EncodedBytes(int64_t count) {
+  const auto buckets = (count + kInt8BucketSize - 1) / kInt8BucketSize;
+  return buckets * sizeof(float) + count;
+}
+
+// Encodes count elements at data into out, and adds what the encoding
+// loses (data minus what out decodes to) to lost.
+void encodeInt8(const float* data, int64_t count, uint8_t* out, float* lost) {
+  const auto buckets = (count + kInt8BucketSize - 1) / kInt8BucketSize;
+  auto scales = reinterpret_cast<float*>(out);
+  auto values = reinterpret_cast<int8_t*>(out + buckets * sizeof(float));
+  for (int64_t b = 0; b < buckets; b++) {
+    const int64_t begin = b * kInt8BucketSize;
+    const int64_t end = std::min(count, begin + kInt8BucketSize);
+    float max = 0;
+    for (int64_t i = begin; i < end; i++) {
+      max = std::max(max, std::fabs(data[i]));
+    }
+    const float scale = max / 127;
+    scales[b] = scale;
+    for (int64_t i = begin; i < end; i++) {
+      long value = scale > 0 ? std::lround(data[i] / scale) : 0;
+      value = std::max(-127L, std::min(127L, value));
+      values[i] = static_cast<int8_t>(value);
+      lost[i] += data[i] - value * scale;
+    }
+  }
+}
+
+void decodeInt8AndAdd(const uint8_t* in, int64_t count, float* out) {
+  const auto buckets = (count + kInt8BucketSize - 1) / kInt8BucketSize;
+  auto scales = reinterpret_cast<const float*>(in);
+  auto values = reinterpret_cast<const int8_t*>(in + buckets * sizeof(float));
+  for (int64_t i = 0; i < count; i++) {
+    out[i] += values[i] * scales[i / kInt8BucketSize];
+  }
+}
+
+// The TOPK encoding of k elements is their int32_t indices followed by
+// their values.
+size_t topkEncodedBytes(int64_t k) {
+  return k * (sizeof(int32_t) + sizeof(float));
+}
+
+int64_t topkCount(int64_t count, double ratio) {
+  if (!(ratio > 0 && ratio <= 1)) {
+    throw std::invalid_argument("topkRatio must be in (0, 1]");
+  }
+  return std::max<int64_t>(1, std::ceil(count * ratio));
+}
+
+// Encodes the k elements of largest magnitude of count elements at data
+// into out, and adds the other elements to lost.
+void encodeTopk(
+    const float* data,
+    int64_t count,
+    int64_t k,
+    uint8_t* out,
+    float* lost) {
+  std::vector<int32_t> indices(count);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::nth_element(
+      indices.begin(),
+      indices.begin() + k - 1,
+      indices.end(),
+      [data](int32_t a, int32_t b) {
+        return std::fabs(data[a]) > std::fabs(data[b]);
+      });
+  auto outIndices = reinterpret_cast<int32_t*>(out);
+  auto outValues = reinterpret_cast<float*>(out + k * sizeof(int32_t));
+  std::copy(indices.begin(), indices.begin() + k, outIndices);
+  for (int64_t i = 0; i < k; i++) {
+    outValues[i] = data[outIndices[i]];
+  }
+  for (int64_t i = k; i < count; i++) {
+    lost[indices[i]] += data[indices[i]];
+  }
+}
+
+void decodeTopkAndAdd(const uint8_t* in, int64_t k, float* out) {
+  auto indices = reinterpret_cast<const int32_t*>(in);
+  auto values = reinterpret_cast<const float*>(in + k * sizeof(int32_t));
+  for (int64_t i = 0; i < k; i++) {
+    out[indices[i]] += values[i];
+  }
+}
+
+// Sums contextSize chunks of count floats at ptr over all processes,
+// sending every chunk INT8 or TOPK encoded (TOPK keeping k elements per
+// chunk). What the encodings lose is added to the contextSize * count
+// floats at lost; summed over all processes, it is exactly what the
+// result misses.
+//
+// This is a ring allreduce. The reduce-scatter is the one of
+// ReduceScatterRing, except that every process decodes the partial sum
+// it receives, adds it to its own chunk and encodes that again to pass
+// it on. The allgather then passes the encoded reduced chunks around the
+// ring. Every process sends 2 * (contextSize - 1) encoded chunks of
+// count elements, so its traffic doesn't grow with the group.
+class CompressedAllreduceRing : public ::gloo::Algorithm {
+ public:
+  CompressedAllreduceRing(
+      const std::shared_ptr<::gloo::Context>& context,
+      float* ptr,
+      float* lost,
+      size_t count,
+      Compression compression,
+      int64_t k)
+      : ::gloo::Algorithm(context),
+        ptr_(ptr),
+        lost_(lost),
+        count_(count),
+        compression_(compression),
+        k_(k),
+        bytes_(
+            compression == Compression::TOPK ? topkEncodedBytes(k)
+                                             : int8EncodedBytes(count)),
+        slot_(context_->nextSlot()) {
+    for (int i = 0; i < 2; i++) {
+      messages_[i].resize(bytes_);
+      buffers_[i] = context_->createUnboundBuffer(messages_[i].data(), bytes_);
+    }
+  }
+
+  void run() override {
+    const int left = (contextRank_ + contextSize_ - 1) % contextSize_;
+    const int right = (contextRank_ + 1) % contextSize_;
+    for (int s = 0; s < contextSize_ - 1; s++) {
+      const int sendChunk = (contextRank_ - s - 1 + 2 * contextSize_) % contextSize_;
+      const int recvChunk = (contextRank_ - s - 2 + 2 * contextSize_) % contextSize_;
+      encode(sendChunk, messages_[0].data());
+      buffers_[0]->send(right, slot_);
+      buffers_[1]->recv(left, slot_);
+      buffers_[1]->waitRecv();
+      buffers_[0]->waitSend();
+      decodeAndAdd(messages_[1].data(), recvChunk);
+    }
+
+    // Chunk rank is now reduced over all processes. Its encoding is what
+    // every process decodes, including this one.
+    int cur = 0;
+    encode(contextRank_, messages_[cur].data());
+    decode(messages_[cur].data(), contextRank_);
+    for (int s = 0; s < contextSize_ - 1; s++) {
+      const int recvChunk = (contextRank_ - s - 1 + contextSize_) % contextSize_;
+      buffers_[cur]->send(right, slot_);
+      buffers_[1 - cur]->recv(left, slot_);
+      buffers_[1 - cur]->waitRecv();
+      buffers_[cur]->waitSend();
+      cur = 1 - cur;
+      decode(messages_[cur].data(), recvChunk);
+    }
+  }
+
+ protected:
+  void encode(int chunk, uint8_t* out) {
+    const auto data = ptr_ + chunk * count_;
+    const auto lost = lost_ + chunk * count_;
+    if (compression_ == Compression::TOPK) {
+      encodeTopk(data, count_, k_, out, lost);
+    } else {
+      encodeInt8(data, count_, out, lost);
+    }
+  }
+
+  void decodeAndAdd(const uint8_t* in, int chunk) {
+    const auto out = ptr_ + chunk * count_;
+    if (compression_ == Compression::TOPK) {
+      decodeTopkAndAdd(in, k_, out);
+    } else {
+      decodeInt8AndAdd(in, count_, out);
+    }
+  }
+
+  void decode(const uint8_t* in, int chunk) {
+    std::fill(ptr_ + chunk * count_, ptr_ + (chunk + 1) * count_, 0.0f);
+    decodeAndAdd(in, chunk);
+  }
+
+  float* ptr_;
+  float* lost_;
+  const size_t count_;
+  const Compression compression_;
+  const int64_t k_;
+  const size_t bytes_;
+  const uint64_t slot_;
+  std::vector<uint8_t> messages_[2];
+  std::unique_ptr<::gloo::transport::UnboundBuffer> buffers_[2];
+};
+
+void assertCPU(const std::vector<at::Tensor>& tensors, const char* name) {
+  for (const auto& tensor : tensors) {
+    if (tensor.type().backend() != at::kCPU) {
+      throw std::invalid_argument(
+          std::string("ProcessGroupGloo::") + name +
+          " only supports CPU tensors");
+    }
+  }
+}
+
+// Checks that every tensor in every vector of tensors has the type and
+// sizes of reference, and that there are count tensors in every vector.
+void assertTensorLists(
+    const std::vector<std::vector<at::Tensor>>& tensors,
+    const at::Tensor& reference,
+    size_t count) {
+  for (const auto& vec : tensors) {
+    if (vec.size() != count) {
+      throw std::invalid_argument(
+          "expected " + std::to_string(count) + " tensors, got " +
+          std::to_string(vec.size()));
+    }
+    std::vector<at::Tensor> all(1, reference);
+    all.insert(all.end(), vec.begin(), vec.end());
+    assertSameSizeAndType(all);
+  }
+}
+
+// Sizes of a tensor that stacks n tensors of the given sizes.
+std::vector<int64_t> stackedSizes(int64_t n, at::IntList sizes) {
+  std::vector<int64_t> result = {n};
+  result.insert(result.end(), sizes.begin(), sizes.end());
+  return result;
+}
+
+const at::Tensor& checkSingleTensor(const std::vector<at::Tensor>& tensors) {
+  if (tensors.size() != 1) {
+    throw std::invalid_argument(
+        "point to point operations take a single tensor");
+  }
+  const auto& tensor = tensors[0];
+  if (tensor.type().backend() != at::kCPU || !tensor.is_contiguous()) {
+    throw std::invalid_argument(
+        "point to point operations take a contiguous CPU tensor");
+  }
+  return tensor;
+}
+
 } // namespace
 
 ProcessGroupGloo::WorkGloo::WorkGloo() : completed_(false), cuda_(false) {}
@@ -170,7 +590,7 @@ void ProcessGroupGloo::WorkGloo::finish(const AlgorithmEntry& entry) {
   {
     std::unique_lock<std::mutex> lock(m_);
     completed_ = true;
-    cuda_ = entry.key.type->is_cuda();
+    cuda_ = entry.key.type != nullptr && entry.key.type->is_cuda();
 
     // Populate devices and events so that we can later synchronize
     // with the operation associated with this work finishing.
@@ -200,6 +620,75 @@ void ProcessGroupGloo::WorkGloo::finishWithException(
   cv_.notify_all();
 }
 
+ProcessGroupGloo::PointToPointWork::PointToPointWork(
+    at::Tensor tensor,
+    std::unique_ptr<::gloo::transport::UnboundBuffer> buffer,
+    bool isSend,
+    int srcRank)
+    : tensor_(std::move(tensor)),
+      buffer_(std::move(buffer)),
+      isSend_(isSend),
+      srcRank_(srcRank),
+      completed_(false) {
+  waiter_ = std::thread([this] {
+    std::unique_ptr<::gloo::Exception> ex;
+    int srcRank = srcRank_;
+    try {
+      if (isSend_) {
+        buffer_->waitSend();
+      } else {
+        buffer_->waitRecv(&srcRank);
+      }
+    } catch (const ::gloo::Exception& e) {
+      ex = std::unique_ptr<::gloo::Exception>(new ::gloo::Exception(e));
+    }
+    {
+      std::unique_lock<std::mutex> lock(m_);
+      srcRank_ = srcRank;
+      ex_ = std::move(ex);
+      completed_ = true;
+    }
+    cv_.notify_all();
+  });
+}
+
+ProcessGroupGloo::PointToPointWork::~PointToPointWork() {
+  // The buffer must not go away while the transport still uses it.
+  waiter_.join();
+}
+
+bool ProcessGroupGloo::PointToPointWork::isCompleted() const {
+  return completed_;
+}
+
+bool ProcessGroupGloo::PointToPointWork::isSuccess() const {
+  return !ex_;
+}
+
+void ProcessGroupGloo::PointToPointWork::synchronize() {}
+
+bool ProcessGroupGloo::PointToPointWork::wait() {
+  std::unique_lock<std::mutex> lock(m_);
+  while (!completed_) {
+    cv_.wait(lock);
+  }
+  return !ex_;
+}
+
+const std::exception& ProcessGroupGloo::PointToPointWork::exception() const {
+  return *ex_;
+}
+
+int ProcessGroupGloo::PointToPointWork::sourceRank() const {
+  if (isSend_) {
+    return ProcessGroup::Work::sourceRank();
+  }
+  if (!completed_) {
+    throw std::runtime_error("sourceRank() called before the recv completed");
+  }
+  return srcRank_;
+}
+
 ProcessGroupGloo::Options::Options()
     : timeout(std::chrono::milliseconds(10 * 1000)),
       threads(2),
@@ -301,11 +790,36 @@ void ProcessGroupGloo::createAlgorithm(AlgorithmEntry& entry) {
   const auto& key = entry.key;
   switch (key.collectiveType) {
     case CollectiveType::ALLREDUCE:
+      if (key.compression == Compression::INT8 ||
+          key.compression == Compression::TOPK) {
+        createCompressedAllreduce(entry);
+        return;
+      }
       GENERATE_ALL_TYPES(key.type->scalarType(), createAllreduce, entry);
       return;
     case CollectiveType::BROADCAST:
       GENERATE_ALL_TYPES(key.type->scalarType(), createBroadcast, entry);
       return;
+    case CollectiveType::REDUCE:
+      // Gloo has no reduction to a single process, so reduce runs an
+      // allreduce and only the root copies out the result.
+      GENERATE_ALL_TYPES(key.type->scalarType(), createAllreduce, entry);
+      return;
+    case CollectiveType::ALLGATHER:
+      GENERATE_ALL_TYPES(key.type->scalarType(), createAllgather, entry);
+      return;
+    case CollectiveType::GATHER:
+      GENERATE_ALL_TYPES(key.type->scalarType(), createGather, entry);
+      return;
+    case CollectiveType::SCATTER:
+      GENERATE_ALL_TYPES(key.type->scalarType(), createScatter, entry);
+      return;
+    case CollectiveType::REDUCE_SCATTER:
+      GENERATE_ALL_TYPES(key.type->scalarType(), createReduceScatter, entry);
+      return;
+    case CollectiveType::BARRIER:
+      createBarrier(entry);
+      return;
     case CollectiveType::UNUSED:
       break;
   }
@@ -400,6 +914,67 @@ void ProcessGroupGloo::createBroadcast(AlgorithmEntry& entry) {
       "Unhandled backend: " + std::string(at::toString(backend)));
 }
 
+template <typename T>
+void ProcessGroupGloo::createAllgather(AlgorithmEntry& entry) {
+  auto ptrs = getDataPointers<T>(entry.src);
+  entry.algorithm =
+      std::unique_ptr<::gloo::Algorithm>(new ::gloo::AllgatherRing<T>(
+          contexts_[0],
+          std::vector<const T*>(ptrs.begin(), ptrs.end()),
+          getDataPointers<T>(entry.dst)[0],
+          entry.src[0].numel()));
+}
+
+template <typename T>
+void ProcessGroupGloo::createGather(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+  entry.algorithm = std::unique_ptr<::gloo::Algorithm>(new GatherToOne<T>(
+      contexts_[0],
+      getDataPointers<T>(entry.src)[0],
+      entry.dst.empty() ? nullptr : getDataPointers<T>(entry.dst)[0],
+      entry.src[0].numel(),
+      key.srcRank));
+}
+
+template <typename T>
+void ProcessGroupGloo::createScatter(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+  entry.algorithm = std::unique_ptr<::gloo::Algorithm>(new ScatterFromOne<T>(
+      contexts_[0],
+      entry.src.empty() ? nullptr : getDataPointers<T>(entry.src)[0],
+      getDataPointers<T>(entry.dst)[0],
+      entry.dst[0].numel(),
+      key.srcRank));
+}
+
+template <typename T>
+void ProcessGroupGloo::createReduceScatter(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+  entry.algorithm =
+      std::unique_ptr<::gloo::Algorithm>(new ReduceScatterRing<T>(
+          contexts_[0],
+          getDataPointers<T>(entry.src)[0],
+          entry.src[0][0].numel(),
+          reductionFunction<T>(key.reduceOp)));
+}
+
+void ProcessGroupGloo::createCompressedAllreduce(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+  entry.algorithm =
+      std::unique_ptr<::gloo::Algorithm>(new CompressedAllreduceRing(
+          contexts_[0],
+          getDataPointers<float>(entry.src)[0],
+          getDataPointers<float>(entry.dst)[0],
+          entry.src[0].numel() / getSize(),
+          key.compression,
+          key.topkCount));
+}
+
+void ProcessGroupGloo::createBarrier(AlgorithmEntry& entry) {
+  entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
+      new ::gloo::BarrierAllToAll(contexts_[0]));
+}
+
 // Constructs an AlgorithmEntry instance, except for the algorithm
 // itself. It allocates the temporary input/output tensors necessary
 // to have a fixed address to pass to the Gloo algorithms. The
@@ -423,8 +998,15 @@ EntryType ProcessGroupGloo::construct(const AlgorithmKey& key) {
     entry->src[i] = key.type->tensor(srcSizes[i]);
   }
 
+  // Allocate destination tensors for this entry (CPU only)
+  auto& dstSizes = key.dstSizes;
+  entry->dst.resize(dstSizes.size());
+  for (size_t i = 0; i < dstSizes.size(); i++) {
+    entry->dst[i] = key.type->tensor(dstSizes[i]);
+  }
+
   // If these are CUDA tensors, create streams and events
-  if (key.type->is_cuda()) {
+  if (key.type != nullptr && key.type->is_cuda()) {
     entry->streams.resize(key.devices.size());
     entry->events.resize(key.devices.size());
     for (size_t i = 0; i < key.devices.size(); i++) {
@@ -471,6 +1053,16 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::enqueue(
     AlgorithmEntry* entry) {
   auto work = std::make_shared<WorkGloo>();
   std::unique_lock<std::mutex> lock(queueMutex_);
+  pendingWork_.erase(
+      std::remove_if(
+          pendingWork_.begin(),
+          pendingWork_.end(),
+          [](const std::weak_ptr<WorkGloo>& pending) {
+            auto work = pending.lock();
+            return !work || work->isCompleted();
+          }),
+      pendingWork_.end());
+  pendingWork_.push_back(work);
   queue_.push_back(std::make_tuple(entry, work));
   queueProduceCV_.notify_one();
   return work;
@@ -527,10 +1119,26 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
   assertSameSizeAndType(tensors);
+  if (opts.compression != Compression::NONE) {
+    if (tensors[0].type().scalarType() != at::kFloat ||
+        opts.reduceOp != ReduceOp::SUM) {
+      throw std::invalid_argument(
+          "compressed allreduce only supports float tensors and "
+          "ReduceOp::SUM");
+    }
+    if (opts.compression != Compression::FP16) {
+      return allreduceEncoded(tensors, opts);
+    }
+  }
 
   AlgorithmKey key;
   key.collectiveType = CollectiveType::ALLREDUCE;
   key.type = &tensors[0].type();
+  if (opts.compression == Compression::FP16) {
+    // Reduces a half precision copy; copying back converts it to float.
+    key.type = &key.type->toScalarType(at::kHalf);
+    key.compression = opts.compression;
+  }
   key.srcSizes = getSizes(tensors);
   key.devices = getDevices(tensors);
   key.reduceOp = opts.reduceOp;
@@ -569,4 +1177,352 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   return enqueue(entry);
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduceEncoded(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  assertCPU(tensors, "allreduce");
+  if (tensors.size() != 1 || !tensors[0].is_contiguous()) {
+    throw std::invalid_argument(
+        "INT8 and TOPK allreduce take a single contiguous tensor");
+  }
+  auto tensor = tensors[0];
+  auto residual = opts.residual;
+  if (residual.defined() &&
+      (residual.type() != tensor.type() ||
+       !residual.sizes().equals(tensor.sizes()) ||
+       !residual.is_contiguous())) {
+    throw std::invalid_argument(
+        "residual must be a contiguous tensor of the type and sizes of the "
+        "input");
+  }
+
+  // Every process reduces one chunk of the tensor, padded with zeros so
+  // that the chunks are of equal size.
+  const int size = getSize();
+  const auto count = tensor.numel();
+  const auto chunk = (count + size - 1) / size;
+  if (chunk > std::numeric_limits<int32_t>::max()) {
+    throw std::invalid_argument("tensor is too large for TOPK allreduce");
+  }
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::ALLREDUCE;
+  key.type = &tensor.type();
+  key.srcSizes = {{size * chunk}};
+  key.dstSizes = {{size * chunk}};
+  key.devices = getDevices(tensors);
+  key.reduceOp = opts.reduceOp;
+  key.compression = opts.compression;
+  if (key.compression == Compression::TOPK) {
+    key.topkCount = topkCount(chunk, opts.topkRatio);
+  }
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Encoding happens on the worker thread, so it doesn't hold up the
+  // caller (which must not touch tensor or residual until the work is
+  // done, like with every other collective).
+  entry->run = [=]() mutable {
+    auto data = entry->src[0].narrow(0, 0, count);
+    data.copy_(tensor.view({count}));
+    if (residual.defined()) {
+      data.add_(residual.view({count}));
+    }
+    if (count < size * chunk) {
+      entry->src[0].narrow(0, count, size * chunk - count).zero_();
+    }
+    entry->dst[0].zero_();
+
+    entry->algorithm->run();
+
+    tensor.view({count}).copy_(data);
+    if (residual.defined()) {
+      residual.view({count}).copy_(entry->dst[0].narrow(0, 0, count));
+    }
+  };
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduce(
+    std::vector<at::Tensor>& tensors,
+    const ReduceOptions& opts) {
+  assertSameSizeAndType(tensors);
+  assertCPU(tensors, "reduce");
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::REDUCE;
+  key.type = &tensors[0].type();
+  key.srcSizes = getSizes(tensors);
+  key.devices = getDevices(tensors);
+  key.reduceOp = opts.reduceOp;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Copy input tensors
+  for (size_t i = 0; i < tensors.size(); i++) {
+    entry->src[i].copy_(tensors[i]);
+  }
+
+  const bool isRoot = getRank() == opts.rootRank;
+  const int rootTensor = opts.rootTensor;
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    if (isRoot) {
+      tensors[rootTensor].copy_(entry->src[rootTensor]);
+    }
+  };
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allgather(
+    std::vector<std::vector<at::Tensor>>& outputTensors,
+    std::vector<at::Tensor>& inputTensors) {
+  assertSameSizeAndType(inputTensors);
+  assertCPU(inputTensors, "allgather");
+  if (outputTensors.size() != inputTensors.size()) {
+    throw std::invalid_argument(
+        "allgather requires a vector of output tensors per input tensor");
+  }
+  assertTensorLists(
+      outputTensors, inputTensors[0], getSize() * inputTensors.size());
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::ALLGATHER;
+  key.type = &inputTensors[0].type();
+  key.srcSizes = getSizes(inputTensors);
+  key.dstSizes = {stackedSizes(
+      getSize() * inputTensors.size(), inputTensors[0].sizes())};
+  key.devices = getDevices(inputTensors);
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Copy input tensors
+  for (size_t i = 0; i < inputTensors.size(); i++) {
+    entry->src[i].copy_(inputTensors[i]);
+  }
+
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    for (auto& outputs : outputTensors) {
+      for (size_t i = 0; i < outputs.size(); i++) {
+        outputs[i].copy_(entry->dst[0][i]);
+      }
+    }
+  };
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::gather(
+    std::vector<std::vector<at::Tensor>>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const GatherOptions& opts) {
+  if (inputTensors.size() != 1) {
+    throw std::invalid_argument("gather takes a single input tensor");
+  }
+  assertCPU(inputTensors, "gather");
+  const bool isRoot = getRank() == opts.rootRank;
+  if (isRoot) {
+    if (outputTensors.size() != 1) {
+      throw std::invalid_argument(
+          "gather takes a single vector of output tensors on the root");
+    }
+    assertTensorLists(outputTensors, inputTensors[0], getSize());
+  } else if (!outputTensors.empty()) {
+    throw std::invalid_argument(
+        "gather takes no output tensors on processes other than the root");
+  }
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::GATHER;
+  key.type = &inputTensors[0].type();
+  key.srcSizes = getSizes(inputTensors);
+  if (isRoot) {
+    key.dstSizes = {stackedSizes(getSize(), inputTensors[0].sizes())};
+  }
+  key.devices = getDevices(inputTensors);
+  key.srcRank = opts.rootRank;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Copy input tensor
+  entry->src[0].copy_(inputTensors[0]);
+
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    if (isRoot) {
+      auto& outputs = outputTensors[0];
+      for (size_t i = 0; i < outputs.size(); i++) {
+        outputs[i].copy_(entry->dst[0][i]);
+      }
+    }
+  };
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::scatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ScatterOptions& opts) {
+  if (outputTensors.size() != 1) {
+    throw std::invalid_argument("scatter takes a single output tensor");
+  }
+  assertCPU(outputTensors, "scatter");
+  const bool isRoot = getRank() == opts.rootRank;
+  if (isRoot) {
+    if (inputTensors.size() != 1) {
+      throw std::invalid_argument(
+          "scatter takes a single vector of input tensors on the root");
+    }
+    assertTensorLists(inputTensors, outputTensors[0], getSize());
+  } else if (!inputTensors.empty()) {
+    throw std::invalid_argument(
+        "scatter takes no input tensors on processes other than the root");
+  }
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::SCATTER;
+  key.type = &outputTensors[0].type();
+  if (isRoot) {
+    key.srcSizes = {stackedSizes(getSize(), outputTensors[0].sizes())};
+  }
+  key.dstSizes = getSizes(outputTensors);
+  key.devices = getDevices(outputTensors);
+  key.srcRank = opts.rootRank;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Copy input tensors
+  if (isRoot) {
+    for (size_t i = 0; i < inputTensors[0].size(); i++) {
+      entry->src[0][i].copy_(inputTensors[0][i]);
+    }
+  }
+
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    outputTensors[0].copy_(entry->dst[0]);
+  };
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduce_scatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  if (outputTensors.size() != 1 || inputTensors.size() != 1) {
+    throw std::invalid_argument(
+        "reduce_scatter takes a single output tensor and a single vector "
+        "of input tensors");
+  }
+  assertCPU(outputTensors, "reduce_scatter");
+  assertTensorLists(inputTensors, outputTensors[0], getSize());
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::REDUCE_SCATTER;
+  key.type = &outputTensors[0].type();
+  key.srcSizes = {stackedSizes(getSize(), outputTensors[0].sizes())};
+  key.devices = getDevices(outputTensors);
+  key.reduceOp = opts.reduceOp;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Copy input tensors
+  for (size_t i = 0; i < inputTensors[0].size(); i++) {
+    entry->src[0][i].copy_(inputTensors[0][i]);
+  }
+
+  const int rank = getRank();
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    outputTensors[0].copy_(entry->src[0][rank]);
+  };
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::send(
+    std::vector<at::Tensor>& tensors,
+    int dstRank,
+    int tag) {
+  const auto& tensor = checkSingleTensor(tensors);
+  auto buffer = contexts_[0]->createUnboundBuffer(
+      tensor.data_ptr(), tensor.numel() * tensor.type().elementSizeInBytes());
+  buffer->send(dstRank, sendRecvSlot(tag));
+  return std::make_shared<PointToPointWork>(tensor, std::move(buffer), true);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::recv(
+    std::vector<at::Tensor>& tensors,
+    int srcRank,
+    int tag) {
+  const auto& tensor = checkSingleTensor(tensors);
+  auto buffer = contexts_[0]->createUnboundBuffer(
+      tensor.data_ptr(), tensor.numel() * tensor.type().elementSizeInBytes());
+  buffer->recv(srcRank, sendRecvSlot(tag));
+  return std::make_shared<PointToPointWork>(
+      tensor, std::move(buffer), false, srcRank);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::recvAnysource(
+    std::vector<at::Tensor>& tensors,
+    int tag) {
+  const auto& tensor = checkSingleTensor(tensors);
+  std::vector<int> srcRanks;
+  for (int i = 0; i < getSize(); i++) {
+    if (i != getRank()) {
+      srcRanks.push_back(i);
+    }
+  }
+  auto buffer = contexts_[0]->createUnboundBuffer(
+      tensor.data_ptr(), tensor.numel() * tensor.type().elementSizeInBytes());
+  buffer->recv(srcRanks, sendRecvSlot(tag));
+  return std::make_shared<PointToPointWork>(tensor, std::move(buffer), false);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::barrier() {
+  // Work queued before the barrier may still be running on other
+  // threads; the barrier only completes once that work has completed.
+  std::vector<std::shared_ptr<WorkGloo>> priorWork;
+  {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    for (const auto& pending : pendingWork_) {
+      auto work = pending.lock();
+      if (work && !work->isCompleted()) {
+        priorWork.push_back(std::move(work));
+      }
+    }
+  }
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::BARRIER;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  entry->run = [=]() mutable {
+    // All earlier work was dequeued before the barrier was, so waiting
+    // for it cannot block the worker threads it runs on.
+    for (auto& work : priorWork) {
+      std::unique_lock<std::mutex> lock(work->m_);
+      while (!work->completed_) {
+        work->cv_.wait(lock);
+      }
+    }
+    entry->algorithm->run();
+  };
+
+  return enqueue(entry);
+}
+
 } // namespace c10d
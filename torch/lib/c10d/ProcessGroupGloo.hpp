@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -12,6 +13,7 @@
 #include <gloo/context.h>
 #include <gloo/rendezvous/store.h>
 #include <gloo/transport/device.h>
+#include <gloo/transport/unbound_buffer.h>
 
 #include <torch/csrc/utils/hash.h>
 
@@ -43,7 +45,8 @@ struct AlgorithmKey {
         (devices == other.devices) && (srcSizes == other.srcSizes) &&
         (dstSizes == other.dstSizes) && (srcRank == other.srcRank) &&
         (dstRank == other.dstRank) && (srcTensor == other.srcTensor) &&
-        (dstTensor == other.dstTensor) && (reduceOp == other.reduceOp);
+        (dstTensor == other.dstTensor) && (reduceOp == other.reduceOp) &&
+        (compression == other.compression) && (topkCount == other.topkCount);
   }
 
   CollectiveType collectiveType = CollectiveType::UNUSED;
@@ -56,6 +59,8 @@ struct AlgorithmKey {
   int srcTensor = -1;
   int dstTensor = -1;
   ReduceOp reduceOp = ReduceOp::UNUSED;
+  Compression compression = Compression::NONE;
+  int64_t topkCount = 0;
 
   // This function is called by torch::hash<AlgorithmKey>
   static size_t hash(const AlgorithmKey& k) {
@@ -69,7 +74,9 @@ struct AlgorithmKey {
         k.dstRank,
         k.srcTensor,
         k.dstTensor,
-        k.reduceOp);
+        k.reduceOp,
+        k.compression,
+        k.topkCount);
   }
 };
 
@@ -163,6 +170,20 @@ namespace c10d {
 // number can be automatically tuned, but only if we let a single
 // process take charge, and have it broadcast the limits.
 //
+// Collectives that Gloo has no algorithm for (gather, scatter and
+// reduce_scatter) are implemented here as Gloo algorithms on top of
+// unbound buffers, so they are cached like any other. Since algorithms
+// take their slots from the context when they are created, every
+// process must create the same algorithms in the same order, which
+// holds as long as the calls are made in the same order (the keys of
+// the root and the other processes may differ).
+//
+// Allreduce with Compression::FP16 runs the regular algorithm on a half
+// precision copy of the tensors. INT8 and TOPK run a ring allreduce that
+// encodes every chunk it sends, re-encoding the partial sums on the way
+// (see CompressedAllreduceRing), so every process sends about 2 encoded
+// tensors instead of about 2 full tensors, whatever the size of the group.
+//
 class ProcessGroupGloo : public ProcessGroup {
  public:
   class WorkGloo : public ProcessGroup::Work {
@@ -212,6 +233,44 @@ class ProcessGroupGloo : public ProcessGroup {
     friend class ProcessGroupGloo;
   };
 
+  // Work returned by send, recv and recvAnysource.
+  //
+  // Point to point operations use the memory of the tensor directly and
+  // don't go through the worker threads, so they start as soon as they
+  // are called. Gloo can only wait for an unbound buffer, so every
+  // operation has a thread of its own that waits for it to complete and
+  // then marks the work as completed.
+  //
+  class PointToPointWork : public ProcessGroup::Work {
+   public:
+    explicit PointToPointWork(
+        at::Tensor tensor,
+        std::unique_ptr<::gloo::transport::UnboundBuffer> buffer,
+        bool isSend,
+        int srcRank = -1);
+    virtual ~PointToPointWork();
+
+    bool isCompleted() const override;
+    bool isSuccess() const override;
+    void synchronize() override;
+    bool wait() override;
+    const std::exception& exception() const override;
+    int sourceRank() const override;
+
+   protected:
+    // Keeps the memory alive until the operation completes.
+    at::Tensor tensor_;
+    std::unique_ptr<::gloo::transport::UnboundBuffer> buffer_;
+    const bool isSend_;
+    int srcRank_;
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::atomic<bool> completed_;
+    std::unique_ptr<::gloo::Exception> ex_;
+    std::thread waiter_;
+  };
+
   struct Options {
     explicit Options();
 
@@ -243,6 +302,51 @@ class ProcessGroupGloo : public ProcessGroup {
       std::vector<at::Tensor>& tensors,
       const AllreduceOptions& opts = AllreduceOptions()) override;
 
+  // The functions below only support CPU tensors.
+
+  std::shared_ptr<Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  std::shared_ptr<Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
+  std::shared_ptr<Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  std::shared_ptr<Work> scatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  std::shared_ptr<Work> reduce_scatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  // Point to point operations require a single contiguous tensor.
+  // Tags must be agreed upon by the sender and the receiver; any tag
+  // can be used without interfering with the collectives.
+
+  std::shared_ptr<Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  std::shared_ptr<Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int tag) override;
+
+  std::shared_ptr<Work> barrier() override;
+
  protected:
   using KeyType = AlgorithmKey;
   using EntryType = std::unique_ptr<AlgorithmEntry>;
@@ -266,6 +370,27 @@ class ProcessGroupGloo : public ProcessGroup {
   template <typename T>
   void createBroadcast(AlgorithmEntry& entry);
 
+  template <typename T>
+  void createAllgather(AlgorithmEntry& entry);
+
+  template <typename T>
+  void createGather(AlgorithmEntry& entry);
+
+  template <typename T>
+  void createScatter(AlgorithmEntry& entry);
+
+  template <typename T>
+  void createReduceScatter(AlgorithmEntry& entry);
+
+  void createCompressedAllreduce(AlgorithmEntry& entry);
+
+  void createBarrier(AlgorithmEntry& entry);
+
+  // Allreduce with Compression::INT8 or Compression::TOPK.
+  std::shared_ptr<Work> allreduceEncoded(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts);
+
   // Construct creates AlgorithmEntry for specified key.
   EntryType construct(const KeyType& key);
 
@@ -289,6 +414,11 @@ class ProcessGroupGloo : public ProcessGroup {
   std::condition_variable queueProduceCV_;
   std::condition_variable queueConsumeCV_;
 
+  // Work that was enqueued and may not have completed yet, so that a
+  // barrier can wait for it. Guarded by queueMutex_ and pruned on every
+  // enqueue.
+  std::vector<std::weak_ptr<WorkGloo>> pendingWork_;
+
   // Store copy of pointer to THCState retrieved from ::at::globalContext().
   THCState* thcState_;
 };
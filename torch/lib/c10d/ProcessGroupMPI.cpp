@@ -277,6 +277,10 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
   checkSingleTensor(tensors);
+  if (opts.compression != Compression::NONE) {
+    throw std::runtime_error(
+        "ProcessGroupMPI does not support compressed allreduce");
+  }
   std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
       [opts](std::unique_ptr<WorkEntry>& entry) {
         auto data = (*entry->src)[0];
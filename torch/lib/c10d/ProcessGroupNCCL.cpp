@@ -356,6 +356,10 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
   tensorCheckHelper(tensors, tensors);
+  if (opts.compression != Compression::NONE) {
+    throw std::runtime_error(
+        "ProcessGroupNCCL does not support compressed allreduce");
+  }
 
   auto devices = getDevices(tensors);
   auto key = getKeyFromDevices(devices);
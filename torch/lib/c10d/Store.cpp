@@ -8,4 +8,38 @@ constexpr std::chrono::milliseconds Store::kNoTimeout;
 // Define destructor symbol for abstract base class.
 Store::~Store() {}
 
+void Store::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument("multiSet needs a value for every key");
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    set(keys[i], values[i]);
+  }
+}
+
+std::vector<std::vector<uint8_t>> Store::multiGet(
+    const std::vector<std::string>& keys) {
+  std::vector<std::vector<uint8_t>> values;
+  for (const auto& key : keys) {
+    values.push_back(get(key));
+  }
+  return values;
+}
+
+std::vector<uint8_t> Store::compareSet(
+    const std::string& /* unused */,
+    const std::vector<uint8_t>& /* unused */,
+    const std::vector<uint8_t>& /* unused */) {
+  throw std::runtime_error("compareSet is not supported by this store");
+}
+
+std::vector<uint8_t> Store::watch(
+    const std::string& /* unused */,
+    const std::vector<uint8_t>& /* unused */,
+    const std::chrono::milliseconds& /* unused */) {
+  throw std::runtime_error("watch is not supported by this store");
+}
+
 } // namespace c10d
@@ -30,6 +30,30 @@ class Store {
   virtual void wait(
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout = kDefaultTimeout) = 0;
+
+  // Batched versions of set and get. By default they set and get every
+  // key separately.
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  // Atomically sets key to desiredValue if its value is expectedValue (an
+  // empty expectedValue also matches a key that doesn't exist). Returns
+  // the value of key afterwards, which is empty if it doesn't exist.
+  virtual std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue);
+
+  // Waits until key exists and has a value other than value, and returns
+  // that value.
+  virtual std::vector<uint8_t> watch(
+      const std::string& key,
+      const std::vector<uint8_t>& value,
+      const std::chrono::milliseconds& timeout = kDefaultTimeout);
 };
 
 } // namespace c10d
@@ -1,27 +1,71 @@
 #include "TCPStore.hpp"
 
-#include <poll.h>
+#include <sys/epoll.h>
 
 #include <unistd.h>
 #include <algorithm>
+#include <cerrno>
 #include <system_error>
 
 namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  COMPARE_SET,
+  WATCH
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+// The number of events handled per epoll_wait call.
+constexpr int kMaxEvents = 256;
+
+std::vector<std::string> recvKeys(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+  return keys;
+}
+
+void sendKeys(int socket, const std::vector<std::string>& keys) {
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(socket, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(socket, keys[i], (i != (nkeys - 1)));
+  }
+}
+
 } // anonymous namespace
 
 // TCPStoreDaemon class methods
 // Simply start the daemon thread
 TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
     : storeListenSocket_(storeListenSocket) {
+  // Create the control pipe
+  if (pipe(controlPipeFd_.data()) == -1) {
+    throw std::runtime_error(
+        "Failed to create the control pipe to start the "
+        "TCPStoreDaemon run");
+  }
+  SYSCHECK(epollFd_ = ::epoll_create1(EPOLL_CLOEXEC));
+  // Push the read end of the pipe to signal the stopping of the daemon run
+  for (int fd : {storeListenSocket_, controlPipeFd_[0]}) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event));
+  }
   daemonThread_ = std::thread(&TCPStoreDaemon::run, this);
 }
 
@@ -32,9 +76,7 @@ TCPStoreDaemon::~TCPStoreDaemon() {
   join();
   // Close unclosed sockets
   for (auto socket : sockets_) {
-    if (socket != -1) {
-      ::close(socket);
-    }
+    ::close(socket);
   }
   // Now close the rest control pipe
   for (auto fd : controlPipeFd_) {
@@ -42,6 +84,7 @@ TCPStoreDaemon::~TCPStoreDaemon() {
       ::close(fd);
     }
   }
+  ::close(epollFd_);
 }
 
 void TCPStoreDaemon::join() {
@@ -49,72 +92,54 @@ void TCPStoreDaemon::join() {
 }
 
 void TCPStoreDaemon::run() {
-  // Create the control pipe
-  if (pipe(controlPipeFd_.data()) == -1) {
-    throw std::runtime_error(
-        "Failed to create the control pipe to start the "
-        "TCPStoreDaemon run");
-  }
-
-  std::vector<struct pollfd> fds;
-  fds.push_back({.fd = storeListenSocket_, .events = POLLIN});
-  // Push the read end of the pipe to signal the stopping of the daemon run
-  fds.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
+  std::vector<struct epoll_event> events(kMaxEvents);
 
   // receive the queries
-  bool finished = false;
-  while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
-    }
-
-    SYSCHECK(::poll(fds.data(), fds.size(), -1));
-
-    // TCPStore's listening socket has an event and it should now be able to
-    // accept new connections.
-    if (fds[0].revents != 0) {
-      if (fds[0].revents ^ POLLIN) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent on the master's listening socket: " +
-                std::to_string(fds[0].revents));
-      }
-      int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
-      sockets_.push_back(sockFd);
-      fds.push_back({.fd = sockFd, .events = POLLIN});
-    }
-    // The pipe receives an event which tells us to shutdown the daemon
-    if (fds[1].revents != 0) {
-      // Will be POLLUP when the pipe is closed
-      if (fds[1].revents ^ POLLHUP) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent on the control pipe's reading fd: " +
-                std::to_string(fds[1].revents));
+  while (true) {
+    int numEvents = ::epoll_wait(epollFd_, events.data(), events.size(), -1);
+    if (numEvents == -1) {
+      if (errno == EINTR) {
+        continue;
       }
-      finished = true;
-      break;
+      throw std::system_error(errno, std::system_category());
     }
-    // Skipping the fds[0] and fds[1],
-    // fds[0] is master's listening socket
-    // fds[1] is control pipe's reading fd
-    for (size_t fdIdx = 2; fdIdx < fds.size(); ++fdIdx) {
-      if (fds[fdIdx].revents == 0) {
+
+    for (int i = 0; i < numEvents; i++) {
+      const int fd = events[i].data.fd;
+      const auto revents = events[i].events;
+
+      // TCPStore's listening socket has an event and it should now be able
+      // to accept new connections.
+      if (fd == storeListenSocket_) {
+        if (revents ^ EPOLLIN) {
+          throw std::system_error(
+              ECONNABORTED,
+              std::system_category(),
+              "Unexpected epoll event on the master's listening socket: " +
+                  std::to_string(revents));
+        }
+        addSocket(std::get<0>(tcputil::accept(storeListenSocket_)));
         continue;
       }
 
-      if (fds[fdIdx].revents ^ POLLIN) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent: " + std::to_string(fds[fdIdx].revents) +
-                " on socket: " + std::to_string(fds[fdIdx].fd));
+      // The pipe receives an event which tells us to shutdown the daemon.
+      // Will be EPOLLHUP when the pipe is closed.
+      if (fd == controlPipeFd_[0]) {
+        if (revents ^ EPOLLHUP) {
+          throw std::system_error(
+              ECONNABORTED,
+              std::system_category(),
+              "Unexpected epoll event on the control pipe's reading fd: " +
+                  std::to_string(revents));
+        }
+        return;
       }
-      // Now query the socket that has the event
+
+      // Now query the socket that has the event. A client that went away
+      // shows up as readable (and possibly hung up or failed), and the
+      // query fails on the closed connection.
       try {
-        query(fds[fdIdx].fd);
+        query(fd);
       } catch (...) {
         // There was an error when processing query. Probably an exception
         // occurred in recv/send what would indicate that socket on the other
@@ -123,34 +148,7 @@ void TCPStoreDaemon::run() {
         // exception, other connections will get an exception once they try to
         // use the store. We will go ahead and close this connection whenever
         // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
-        --fdIdx;
-        continue;
+        closeSocket(fd);
       }
     }
   }
@@ -164,11 +162,60 @@ void TCPStoreDaemon::stop() {
   }
 }
 
+void TCPStoreDaemon::addSocket(int socket) {
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = socket;
+  SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket, &event));
+  sockets_.insert(socket);
+}
+
+void TCPStoreDaemon::closeSocket(int socket) {
+  // Remove all the tracking state of the socket. This has to happen before
+  // closing it, because the next accepted socket may get the same fd.
+  auto parked = parkedKeys_.find(socket);
+  if (parked != parkedKeys_.end()) {
+    for (const auto& key : parked->second) {
+      auto waiting = waitingSockets_.find(key);
+      if (waiting != waitingSockets_.end()) {
+        auto& vec = waiting->second;
+        vec.erase(std::remove(vec.begin(), vec.end(), socket), vec.end());
+        if (vec.empty()) {
+          waitingSockets_.erase(waiting);
+        }
+      }
+      auto watching = watchingSockets_.find(key);
+      if (watching != watchingSockets_.end()) {
+        auto& vec = watching->second;
+        vec.erase(
+            std::remove_if(
+                vec.begin(),
+                vec.end(),
+                [socket](const std::pair<int, std::vector<uint8_t>>& w) {
+                  return w.first == socket;
+                }),
+            vec.end());
+        if (vec.empty()) {
+          watchingSockets_.erase(watching);
+        }
+      }
+    }
+    parkedKeys_.erase(parked);
+  }
+  keysAwaited_.erase(socket);
+  pendingGets_.erase(socket);
+
+  // Closing the socket also removes it from the epoll set
+  ::close(socket);
+  sockets_.erase(socket);
+}
+
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
-// type of query | number of args | size of arg1 | arg1 | ...
+// or, in the case of set, get, check and wait
+// type of query | number of keys | size of key1 | key1 | ...
+// where set also sends the value after every key.
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
@@ -179,6 +226,9 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::ADD) {
     addHandler(socket);
 
+  } else if (qt == QueryType::COMPARE_SET) {
+    compareSetHandler(socket);
+
   } else if (qt == QueryType::GET) {
     getHandler(socket);
 
@@ -188,61 +238,161 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::WAIT) {
     waitHandler(socket);
 
+  } else if (qt == QueryType::WATCH) {
+    watchHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
 }
 
+// Sends the values of keys, which must all exist.
+void TCPStoreDaemon::sendValues(
+    int socket,
+    const std::vector<std::string>& keys) const {
+  for (size_t i = 0; i < keys.size(); i++) {
+    tcputil::sendVector<uint8_t>(
+        socket, tcpStore_.at(keys[i]), (i != (keys.size() - 1)));
+  }
+}
+
+// Parks socket until all keys exist. Whatever is pending for the socket
+// (see pendingGets_) is sent then.
+void TCPStoreDaemon::parkSocket(
+    int socket,
+    const std::vector<std::string>& keys) {
+  size_t missing = 0;
+  for (auto& key : keys) {
+    if (tcpStore_.count(key) == 0) {
+      waitingSockets_[key].push_back(socket);
+      parkedKeys_[socket].push_back(key);
+      missing++;
+    }
+  }
+  keysAwaited_[socket] = missing;
+}
+
 void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
   auto socketsToWait = waitingSockets_.find(key);
-  if (socketsToWait != waitingSockets_.end()) {
-    for (int socket : socketsToWait->second) {
-      if (--keysAwaited_[socket] == 0) {
+  if (socketsToWait == waitingSockets_.end()) {
+    return;
+  }
+  auto sockets = std::move(socketsToWait->second);
+  waitingSockets_.erase(socketsToWait);
+  for (int socket : sockets) {
+    if (--keysAwaited_[socket] > 0) {
+      continue;
+    }
+    keysAwaited_.erase(socket);
+    parkedKeys_.erase(socket);
+    try {
+      auto pendingGet = pendingGets_.find(socket);
+      if (pendingGet != pendingGets_.end()) {
+        auto keys = std::move(pendingGet->second);
+        pendingGets_.erase(pendingGet);
+        sendValues(socket, keys);
+      } else {
         tcputil::sendValue<WaitResponseType>(
             socket, WaitResponseType::STOP_WAITING);
       }
+    } catch (...) {
+      // The client went away, which its socket reports as readable; it
+      // is closed once the next query on it fails.
     }
-    waitingSockets_.erase(socketsToWait);
   }
 }
 
-void TCPStoreDaemon::setHandler(int socket) {
-  std::string key = tcputil::recvString(socket);
-  tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
-  // On "set", wake up all clients that have been waiting
+void TCPStoreDaemon::wakeupWatchingClients(const std::string& key) {
+  auto watching = watchingSockets_.find(key);
+  if (watching == watchingSockets_.end()) {
+    return;
+  }
+  const auto& value = tcpStore_.at(key);
+  auto& watchers = watching->second;
+  auto changed = std::stable_partition(
+      watchers.begin(),
+      watchers.end(),
+      [&value](const std::pair<int, std::vector<uint8_t>>& w) {
+        return w.second == value;
+      });
+  for (auto it = changed; it != watchers.end(); ++it) {
+    parkedKeys_.erase(it->first);
+    try {
+      tcputil::sendVector<uint8_t>(it->first, value);
+    } catch (...) {
+      // See wakeupWaitingClients
+    }
+  }
+  watchers.erase(changed, watchers.end());
+  if (watchers.empty()) {
+    watchingSockets_.erase(watching);
+  }
+}
+
+// On every change of a value, wake up all clients that have been waiting
+// for or watching it.
+void TCPStoreDaemon::setValue(
+    const std::string& key,
+    std::vector<uint8_t> value) {
+  tcpStore_[key] = std::move(value);
   wakeupWaitingClients(key);
+  wakeupWatchingClients(key);
+}
+
+void TCPStoreDaemon::setHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    setValue(key, tcputil::recvVector<uint8_t>(socket));
+  }
 }
 
 void TCPStoreDaemon::addHandler(int socket) {
   std::string key = tcputil::recvString(socket);
   int64_t addVal = tcputil::recvValue<int64_t>(socket);
 
-  if (tcpStore_.find(key) != tcpStore_.end()) {
-    auto buf = reinterpret_cast<const char*>(tcpStore_[key].data());
-    auto len = tcpStore_[key].size();
+  auto it = tcpStore_.find(key);
+  if (it != tcpStore_.end()) {
+    auto buf = reinterpret_cast<const char*>(it->second.data());
+    auto len = it->second.size();
     addVal += std::stoll(std::string(buf, len));
   }
   auto addValStr = std::to_string(addVal);
-  tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
   // Now send the new value
   tcputil::sendValue<int64_t>(socket, addVal);
-  // On "add", wake up all clients that have been waiting
-  wakeupWaitingClients(key);
+  setValue(key, std::vector<uint8_t>(addValStr.begin(), addValStr.end()));
 }
 
-void TCPStoreDaemon::getHandler(int socket) const {
+void TCPStoreDaemon::compareSetHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  auto data = tcpStore_.at(key);
-  tcputil::sendVector<uint8_t>(socket, data);
+  auto expectedValue = tcputil::recvVector<uint8_t>(socket);
+  auto desiredValue = tcputil::recvVector<uint8_t>(socket);
+
+  auto it = tcpStore_.find(key);
+  if (it == tcpStore_.end() ? expectedValue.empty()
+                            : it->second == expectedValue) {
+    tcputil::sendVector<uint8_t>(socket, desiredValue);
+    setValue(key, std::move(desiredValue));
+  } else if (it == tcpStore_.end()) {
+    tcputil::sendVector<uint8_t>(socket, {});
+  } else {
+    tcputil::sendVector<uint8_t>(socket, it->second);
+  }
 }
 
-void TCPStoreDaemon::checkHandler(int socket) const {
-  SizeType nargs;
-  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
-  std::vector<std::string> keys(nargs);
-  for (size_t i = 0; i < nargs; i++) {
-    keys[i] = tcputil::recvString(socket);
+void TCPStoreDaemon::getHandler(int socket) {
+  auto keys = recvKeys(socket);
+  if (checkKeys(keys)) {
+    sendValues(socket, keys);
+  } else {
+    parkSocket(socket, keys);
+    pendingGets_[socket] = std::move(keys);
   }
+}
+
+void TCPStoreDaemon::checkHandler(int socket) const {
+  auto keys = recvKeys(socket);
   // Now we have received all the keys
   if (checkKeys(keys)) {
     tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::READY);
@@ -252,20 +402,24 @@ void TCPStoreDaemon::checkHandler(int socket) const {
 }
 
 void TCPStoreDaemon::waitHandler(int socket) {
-  SizeType nargs;
-  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
-  std::vector<std::string> keys(nargs);
-  for (size_t i = 0; i < nargs; i++) {
-    keys[i] = tcputil::recvString(socket);
-  }
+  auto keys = recvKeys(socket);
   if (checkKeys(keys)) {
     tcputil::sendValue<WaitResponseType>(
         socket, WaitResponseType::STOP_WAITING);
   } else {
-    for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
-    }
-    keysAwaited_[socket] = keys.size();
+    parkSocket(socket, keys);
+  }
+}
+
+void TCPStoreDaemon::watchHandler(int socket) {
+  std::string key = tcputil::recvString(socket);
+  auto value = tcputil::recvVector<uint8_t>(socket);
+  auto it = tcpStore_.find(key);
+  if (it != tcpStore_.end() && it->second != value) {
+    tcputil::sendVector<uint8_t>(socket, it->second);
+  } else {
+    watchingSockets_[key].emplace_back(socket, std::move(value));
+    parkedKeys_[socket].push_back(key);
   }
 }
 
@@ -304,34 +458,49 @@ TCPStore::~TCPStore() {
   }
 }
 
+// Receives the reply to the request just sent with recv. If that times
+// out, the request is still pending in the daemon, which would send the
+// reply later on and have it taken for the reply to the next request.
+// Closing the connection makes the daemon drop the request, so a new
+// one is opened before the timeout is reported.
+template <typename F>
+auto TCPStore::recvReply(F recv) -> decltype(recv()) {
+  try {
+    return recv();
+  } catch (const std::system_error& e) {
+    if (e.code().value() == EAGAIN || e.code().value() == EWOULDBLOCK) {
+      ::close(storeSocket_);
+      storeSocket_ = -1;
+      storeSocket_ = tcputil::connect(tcpStoreAddr_, tcpStorePort_);
+    }
+    throw;
+  }
+}
+
 void TCPStore::set(const std::string& key, const std::vector<uint8_t>& data) {
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::SET);
-  tcputil::sendString(storeSocket_, key, true);
-  tcputil::sendVector<uint8_t>(storeSocket_, data);
+  multiSet({key}, {data});
 }
 
 std::vector<uint8_t> TCPStore::get(const std::string& key) {
-  wait({key});
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET);
-  tcputil::sendString(storeSocket_, key);
-  return tcputil::recvVector<uint8_t>(storeSocket_);
+  return multiGet({key})[0];
 }
 
 int64_t TCPStore::add(const std::string& key, int64_t value) {
+  setTimeout(kDefaultTimeout);
   tcputil::sendValue<QueryType>(storeSocket_, QueryType::ADD);
   tcputil::sendString(storeSocket_, key, true);
   tcputil::sendValue<int64_t>(storeSocket_, value);
-  return tcputil::recvValue<int64_t>(storeSocket_);
+  return recvReply(
+      [this] { return tcputil::recvValue<int64_t>(storeSocket_); });
 }
 
 bool TCPStore::check(const std::vector<std::string>& keys) {
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::CHECK);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
-  }
-  auto checkResponse = tcputil::recvValue<CheckResponseType>(storeSocket_);
+  setTimeout(kDefaultTimeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::CHECK, true);
+  sendKeys(storeSocket_, keys);
+  auto checkResponse = recvReply([this] {
+    return tcputil::recvValue<CheckResponseType>(storeSocket_);
+  });
   if (checkResponse == CheckResponseType::READY) {
     return true;
   } else if (checkResponse == CheckResponseType::NOT_READY) {
@@ -344,27 +513,87 @@ bool TCPStore::check(const std::vector<std::string>& keys) {
 void TCPStore::wait(
     const std::vector<std::string>& keys,
     const std::chrono::milliseconds& timeout) {
-  // Set the socket timeout if there is a wait timeout
-  if (timeout != kNoTimeout) {
-    struct timeval timeoutTV = {.tv_sec = timeout.count() / 1000,
-                                .tv_usec = (timeout.count() % 1000) * 1000};
-    SYSCHECK(::setsockopt(
-        storeSocket_,
-        SOL_SOCKET,
-        SO_RCVTIMEO,
-        reinterpret_cast<char*>(&timeoutTV),
-        sizeof(timeoutTV)));
-  }
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
+  setTimeout(timeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT, true);
+  sendKeys(storeSocket_, keys);
+  auto waitResponse = recvReply([this] {
+    return tcputil::recvValue<WaitResponseType>(storeSocket_);
+  });
+  if (waitResponse != WaitResponseType::STOP_WAITING) {
+    throw std::runtime_error("Stop_waiting response is expected");
+  }
+}
+
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument("multiSet needs a value for every key");
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::SET, true);
   SizeType nkeys = keys.size();
   tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
   for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
+    tcputil::sendString(storeSocket_, keys[i], true);
+    tcputil::sendVector<uint8_t>(storeSocket_, values[i], (i != (nkeys - 1)));
   }
-  auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
-  if (waitResponse != WaitResponseType::STOP_WAITING) {
-    throw std::runtime_error("Stop_waiting response is expected");
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  // The daemon holds back the values until all keys exist
+  setTimeout(kDefaultTimeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET, true);
+  sendKeys(storeSocket_, keys);
+  return recvReply([this, &keys] {
+    std::vector<std::vector<uint8_t>> values(keys.size());
+    for (auto& value : values) {
+      value = tcputil::recvVector<uint8_t>(storeSocket_);
+    }
+    return values;
+  });
+}
+
+std::vector<uint8_t> TCPStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  setTimeout(kDefaultTimeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::COMPARE_SET, true);
+  tcputil::sendString(storeSocket_, key, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, expectedValue, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, desiredValue);
+  return recvReply(
+      [this] { return tcputil::recvVector<uint8_t>(storeSocket_); });
+}
+
+std::vector<uint8_t> TCPStore::watch(
+    const std::string& key,
+    const std::vector<uint8_t>& value,
+    const std::chrono::milliseconds& timeout) {
+  setTimeout(timeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WATCH, true);
+  tcputil::sendString(storeSocket_, key, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, value);
+  return recvReply(
+      [this] { return tcputil::recvVector<uint8_t>(storeSocket_); });
+}
+
+// Sets the receive timeout of the socket, which bounds how long the
+// reply to a request can take. Every request that gets a reply sets it,
+// since it lasts until it is set again.
+void TCPStore::setTimeout(const std::chrono::milliseconds& timeout) {
+  struct timeval timeoutTV = {.tv_sec = 0, .tv_usec = 0};
+  if (timeout != kNoTimeout) {
+    timeoutTV = {.tv_sec = timeout.count() / 1000,
+                 .tv_usec = (timeout.count() % 1000) * 1000};
   }
+  SYSCHECK(::setsockopt(
+      storeSocket_,
+      SOL_SOCKET,
+      SO_RCVTIMEO,
+      reinterpret_cast<char*>(&timeoutTV),
+      sizeof(timeoutTV)));
 }
 
 } // namespace c10d
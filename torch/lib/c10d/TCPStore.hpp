@@ -3,12 +3,22 @@
 #include <memory>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <c10d/Store.hpp>
 #include <c10d/Utils.hpp>
 
 namespace c10d {
 
+// TCPStoreDaemon serves the store to the TCPStore clients from a single
+// thread. It waits for requests with epoll, so the work done per wakeup
+// only depends on the number of sockets that have something to say, not
+// on the number of connected clients.
+//
+// Requests that can't be answered yet (wait, get of a missing key and
+// watch) park their socket until the keys they need change, after which
+// the answer is sent right away. Every client only has one request in
+// flight, so a parked socket doesn't send anything until it is answered.
 class TCPStoreDaemon {
  public:
   explicit TCPStoreDaemon(int storeListenSocket);
@@ -20,16 +30,25 @@ class TCPStoreDaemon {
   void run();
   void stop();
 
+  void addSocket(int socket);
+  void closeSocket(int socket);
+
   void query(int socket);
 
   void setHandler(int socket);
   void addHandler(int socket);
-  void getHandler(int socket) const;
+  void compareSetHandler(int socket);
+  void getHandler(int socket);
   void checkHandler(int socket) const;
   void waitHandler(int socket);
+  void watchHandler(int socket);
 
   bool checkKeys(const std::vector<std::string>& keys) const;
+  void setValue(const std::string& key, std::vector<uint8_t> value);
+  void sendValues(int socket, const std::vector<std::string>& keys) const;
+  void parkSocket(int socket, const std::vector<std::string>& keys);
   void wakeupWaitingClients(const std::string& key);
+  void wakeupWatchingClients(const std::string& key);
 
   std::thread daemonThread_;
   std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
@@ -37,9 +56,19 @@ class TCPStoreDaemon {
   std::unordered_map<std::string, std::vector<int>> waitingSockets_;
   // From socket -> number of keys awaited
   std::unordered_map<int, size_t> keysAwaited_;
-
-  std::vector<int> sockets_;
+  // From socket -> the keys to send once none are awaited (get)
+  std::unordered_map<int, std::vector<std::string>> pendingGets_;
+  // From key -> the sockets watching it and the value they know
+  std::unordered_map<
+      std::string,
+      std::vector<std::pair<int, std::vector<uint8_t>>>>
+      watchingSockets_;
+  // From socket -> the keys it is parked on, to clean up when it closes
+  std::unordered_map<int, std::vector<std::string>> parkedKeys_;
+
+  std::unordered_set<int> sockets_;
   int storeListenSocket_;
+  int epollFd_ = -1;
   std::vector<int> controlPipeFd_{-1, -1};
 };
 
@@ -64,7 +93,31 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout = kDefaultTimeout) override;
 
+  // Sets all keys in a single message.
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  // Waits for and gets all keys in a single round trip.
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue) override;
+
+  std::vector<uint8_t> watch(
+      const std::string& key,
+      const std::vector<uint8_t>& value,
+      const std::chrono::milliseconds& timeout = kDefaultTimeout) override;
+
  protected:
+  void setTimeout(const std::chrono::milliseconds& timeout);
+
+  template <typename F>
+  auto recvReply(F recv) -> decltype(recv());
+
   bool isServer_;
   int storeSocket_ = -1;
   int masterListenSocket_ = -1;
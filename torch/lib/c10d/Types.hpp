@@ -2,11 +2,19 @@
 
 #include <cstdint>
 
+#include <ATen/ATen.h>
+
 namespace c10d {
 
 enum class CollectiveType : std::uint8_t {
   BROADCAST,
   ALLREDUCE,
+  REDUCE,
+  ALLGATHER,
+  GATHER,
+  SCATTER,
+  REDUCE_SCATTER,
+  BARRIER,
   UNUSED,
 };
 
@@ -18,6 +26,23 @@ enum class ReduceOp : std::uint8_t {
   UNUSED,
 };
 
+// Lossy encodings of the tensor that an allreduce sends over the wire,
+// trading accuracy for bandwidth (only for a single float tensor and
+// ReduceOp::SUM).
+//
+// FP16 casts to half precision and runs the regular allreduce on that.
+// INT8 quantizes every element to 8 bits with one scale per bucket of
+// 256 elements, and TOPK only sends the topkRatio fraction of the
+// elements with the largest magnitude together with their indices. Both
+// run a ring allreduce that decodes the partial sums it receives and
+// encodes them again before passing them on.
+enum class Compression : std::uint8_t {
+  NONE = 0,
+  FP16,
+  INT8,
+  TOPK,
+};
+
 struct BroadcastOptions {
   int rootRank = 0;
   int rootTensor = 0;
@@ -25,6 +50,35 @@ struct BroadcastOptions {
 
 struct AllreduceOptions {
   ReduceOp reduceOp = ReduceOp::SUM;
+  Compression compression = Compression::NONE;
+  double topkRatio = 0.01;
+
+  // Error feedback for INT8 and TOPK: if defined, a float tensor with the
+  // sizes of the input that is added to the input before it is encoded,
+  // and that is overwritten with what the encodings of this process lost
+  // afterwards (the residuals of all processes add up to the difference
+  // between the exact sum and the result). Using the same residual for
+  // every allreduce of a tensor makes sure that no part of it is dropped
+  // for good, only delayed.
+  at::Tensor residual;
+};
+
+struct ReduceOptions {
+  ReduceOp reduceOp = ReduceOp::SUM;
+  int rootRank = 0;
+  int rootTensor = 0;
+};
+
+struct GatherOptions {
+  int rootRank = 0;
+};
+
+struct ScatterOptions {
+  int rootRank = 0;
+};
+
+struct ReduceScatterOptions {
+  ReduceOp reduceOp = ReduceOp::SUM;
 };
 
 } // namespace c10d
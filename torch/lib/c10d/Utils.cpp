@@ -21,7 +21,11 @@ namespace tcputil {
 
 namespace {
 
-constexpr int LISTEN_QUEUE_SIZE = 64;
+// The TCPStore daemon listens for every process of a job at once. When
+// the queue overflows, connections are dropped and retried (or reset),
+// which stalls startup for large jobs. Linux caps this at the
+// net.core.somaxconn sysctl.
+constexpr int LISTEN_QUEUE_SIZE = 2048;
 
 void setSocketNoDelay(int socket) {
   int flag = 1;
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <c10d/TCPStore.hpp>
+
+using namespace ::c10d;
+
+// Measures how long a rendezvous of size ranks takes on a TCPStore, with
+// every rank a thread that has its own connection. Every rank publishes
+// its address, counts itself in, waits until all ranks are in and then
+// gets the addresses of its neighbors.
+//
+// Usage: rendezvous [port] [size...]
+//
+// Running with thousands of ranks needs as many file descriptors (see
+// ulimit -n) and a net.core.somaxconn at least that large.
+int main(int argc, char** argv) {
+  PortType port = argc > 1 ? atoi(argv[1]) : 29500;
+  std::vector<int> sizes;
+  for (int i = 2; i < argc; i++) {
+    sizes.push_back(atoi(argv[i]));
+  }
+  if (sizes.empty()) {
+    sizes = {1024, 4096};
+  }
+
+  for (auto size : sizes) {
+    using Clock = std::chrono::steady_clock;
+    TCPStore server("127.0.0.1", port, true);
+    const auto prefix = std::to_string(size) + "/";
+    std::vector<double> latencies(size);
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for (auto rank = 0; rank < size; rank++) {
+      threads.emplace_back([&, rank] {
+        TCPStore store("127.0.0.1", port);
+        auto addr = "127.0.0.1:" + std::to_string(rank);
+        store.set(
+            prefix + std::to_string(rank),
+            std::vector<uint8_t>(addr.begin(), addr.end()));
+        if (store.add(prefix + "arrived", 1) == size) {
+          store.set(prefix + "ready", {1});
+        }
+        store.wait({prefix + "ready"}, std::chrono::minutes(10));
+        store.multiGet({prefix + std::to_string((rank + 1) % size),
+                        prefix + std::to_string((rank + size - 1) % size)});
+        latencies[rank] =
+            std::chrono::duration<double, std::milli>(Clock::now() - start)
+                .count();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << size << " ranks: median " << latencies[size / 2]
+              << " ms, max " << latencies.back() << " ms" << std::endl;
+  }
+}
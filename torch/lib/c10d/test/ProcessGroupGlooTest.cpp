@@ -14,10 +14,38 @@
 #include <c10d/CUDAUtils.hpp>
 #include <c10d/FileStore.hpp>
 #include <c10d/ProcessGroupGloo.hpp>
+#include <c10d/TCPStore.hpp>
 #include <c10d/test/TestUtils.hpp>
 
 using namespace c10d::test;
 
+using WorkVector = std::vector<std::shared_ptr<::c10d::ProcessGroup::Work>>;
+
+std::shared_ptr<::gloo::transport::Device> createLoopbackDevice() {
+  ::gloo::transport::tcp::attr attr;
+  attr.hostname = "127.0.0.1";
+  return ::gloo::transport::tcp::CreateDevice(attr);
+}
+
+void waitWork(const WorkVector& work) {
+  for (auto& w : work) {
+    if (!w->wait()) {
+      throw w->exception();
+    }
+  }
+}
+
+void checkValue(const at::Tensor& tensor, float expected) {
+  auto data = tensor.data<float>();
+  for (auto i = 0; i < tensor.numel(); i++) {
+    if (data[i] != expected) {
+      throw std::runtime_error(
+          "expected " + std::to_string(expected) + ", got " +
+          std::to_string(data[i]));
+    }
+  }
+}
+
 class SignalTest {
  public:
   SignalTest(const std::string& path) : path_(path) {}
@@ -124,6 +152,7 @@ class CollectiveTest {
     // Use tiny timeout to make this test run fast
     ::c10d::ProcessGroupGloo::Options options;
     options.timeout = std::chrono::milliseconds(50);
+    options.devices.push_back(createLoopbackDevice());
 
     pg_ = std::unique_ptr<::c10d::ProcessGroupGloo>(
         new ::c10d::ProcessGroupGloo(store, rank, size, options));
@@ -244,7 +273,364 @@ void testBroadcast(const std::string& path, const at::Backend b) {
   }
 }
 
+void testCompressedAllreduce(const std::string& path) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  auto run = [&](std::vector<std::vector<at::Tensor>>& inputs,
+                 std::vector<::c10d::AllreduceOptions>& options) {
+    WorkVector work(size);
+    for (auto i = 0; i < size; i++) {
+      work[i] = tests[i].getProcessGroup().allreduce(inputs[i], options[i]);
+    }
+    waitWork(work);
+  };
+  auto check = [](const at::Tensor& tensor, const at::Tensor& expected) {
+    if (!tensor.allclose(expected)) {
+      throw std::runtime_error("compressed allreduce got wrong values");
+    }
+  };
+
+  // FP16 is exact for small integers
+  {
+    std::vector<std::vector<at::Tensor>> inputs(size);
+    std::vector<::c10d::AllreduceOptions> options(size);
+    for (auto i = 0; i < size; i++) {
+      inputs[i] = {at::ones(at::CPU(at::kFloat), {16, 16}) * i};
+      options[i].compression = ::c10d::Compression::FP16;
+    }
+    run(inputs, options);
+    for (auto i = 0; i < size; i++) {
+      checkValue(inputs[i][0], (size * (size - 1)) / 2);
+    }
+  }
+
+  // What the result misses is in the residuals
+  auto checkResiduals = [&](std::vector<std::vector<at::Tensor>>& inputs,
+                            std::vector<at::Tensor>& originals,
+                            std::vector<::c10d::AllreduceOptions>& options) {
+    auto exact = at::zeros_like(originals[0]);
+    auto sum = inputs[0][0].clone();
+    for (auto i = 0; i < size; i++) {
+      exact += originals[i];
+      sum += options[i].residual;
+    }
+    check(sum, exact);
+  };
+
+  // INT8 scales every bucket of 256 elements on its own, so the ones in
+  // the second half of every chunk of 512 elements are exact, however
+  // large the first element of the chunk is.
+  {
+    std::vector<std::vector<at::Tensor>> inputs(size);
+    std::vector<at::Tensor> originals(size);
+    std::vector<::c10d::AllreduceOptions> options(size);
+    for (auto i = 0; i < size; i++) {
+      auto input = at::ones(at::CPU(at::kFloat), {size, 512}) * (i + 1);
+      input.select(1, 0).fill_(1000);
+      originals[i] = input.clone();
+      inputs[i] = {input};
+      options[i].compression = ::c10d::Compression::INT8;
+      options[i].residual = at::zeros(at::CPU(at::kFloat), {size, 512});
+    }
+    run(inputs, options);
+    for (auto i = 0; i < size; i++) {
+      check(inputs[i][0], inputs[0][0]);
+      check(
+          inputs[i][0].narrow(1, 256, 256),
+          at::ones(at::CPU(at::kFloat), {size, 256}) * ((size * (size + 1)) / 2));
+    }
+    checkResiduals(inputs, originals, options);
+  }
+
+  // TOPK with k = 1 per chunk of 64 elements only keeps the last element
+  // of every chunk on the way, so everything else ends up in the residual.
+  {
+    std::vector<std::vector<at::Tensor>> inputs(size);
+    std::vector<at::Tensor> originals(size);
+    std::vector<::c10d::AllreduceOptions> options(size);
+    for (auto i = 0; i < size; i++) {
+      auto input =
+          at::arange(at::CPU(at::kFloat), size * 64).view({size, 64}) * (i + 1);
+      originals[i] = input.clone();
+      inputs[i] = {input};
+      options[i].compression = ::c10d::Compression::TOPK;
+      options[i].topkRatio = 1.0 / 64;
+      options[i].residual = at::zeros(at::CPU(at::kFloat), {size, 64});
+    }
+    run(inputs, options);
+    for (auto i = 0; i < size; i++) {
+      auto expected = originals[0] * ((size * (size + 1)) / 2);
+      expected.narrow(1, 0, 63).zero_();
+      check(inputs[i][0], expected);
+      expected = originals[i].clone();
+      expected.select(1, 63).zero_();
+      check(options[i].residual, expected);
+    }
+    checkResiduals(inputs, originals, options);
+  }
+}
+
+void testReduce(const std::string& path) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // Every rank is root once
+  for (auto root = 0; root < size; root++) {
+    std::vector<std::vector<at::Tensor>> inputs(size);
+    for (auto i = 0; i < size; i++) {
+      inputs[i] = {at::ones(at::CPU(at::kFloat), {16, 16}) * i};
+    }
+
+    ::c10d::ReduceOptions options;
+    options.rootRank = root;
+    WorkVector work(size);
+    for (auto i = 0; i < size; i++) {
+      work[i] = tests[i].getProcessGroup().reduce(inputs[i], options);
+    }
+    waitWork(work);
+
+    checkValue(inputs[root][0], (size * (size - 1)) / 2);
+  }
+}
+
+void testAllgather(const std::string& path) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  std::vector<std::vector<at::Tensor>> inputs(size);
+  std::vector<std::vector<std::vector<at::Tensor>>> outputs(size);
+  for (auto i = 0; i < size; i++) {
+    inputs[i] = {at::ones(at::CPU(at::kFloat), {16, 16}) * i};
+    outputs[i].resize(1);
+    for (auto j = 0; j < size; j++) {
+      outputs[i][0].push_back(at::zeros(at::CPU(at::kFloat), {16, 16}));
+    }
+  }
+
+  WorkVector work(size);
+  for (auto i = 0; i < size; i++) {
+    work[i] = tests[i].getProcessGroup().allgather(outputs[i], inputs[i]);
+  }
+  waitWork(work);
+
+  for (auto i = 0; i < size; i++) {
+    for (auto j = 0; j < size; j++) {
+      checkValue(outputs[i][0][j], j);
+    }
+  }
+}
+
+void testGather(const std::string& path) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // Every rank is root once
+  for (auto root = 0; root < size; root++) {
+    std::vector<std::vector<at::Tensor>> inputs(size);
+    std::vector<std::vector<std::vector<at::Tensor>>> outputs(size);
+    for (auto i = 0; i < size; i++) {
+      inputs[i] = {at::ones(at::CPU(at::kFloat), {16, 16}) * i};
+    }
+    outputs[root].resize(1);
+    for (auto j = 0; j < size; j++) {
+      outputs[root][0].push_back(at::zeros(at::CPU(at::kFloat), {16, 16}));
+    }
+
+    ::c10d::GatherOptions options;
+    options.rootRank = root;
+    WorkVector work(size);
+    for (auto i = 0; i < size; i++) {
+      work[i] =
+          tests[i].getProcessGroup().gather(outputs[i], inputs[i], options);
+    }
+    waitWork(work);
+
+    for (auto j = 0; j < size; j++) {
+      checkValue(outputs[root][0][j], j);
+    }
+  }
+}
+
+void testScatter(const std::string& path) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // Every rank is root once
+  for (auto root = 0; root < size; root++) {
+    std::vector<std::vector<std::vector<at::Tensor>>> inputs(size);
+    std::vector<std::vector<at::Tensor>> outputs(size);
+    inputs[root].resize(1);
+    for (auto j = 0; j < size; j++) {
+      inputs[root][0].push_back(
+          at::ones(at::CPU(at::kFloat), {16, 16}) * (root * size + j));
+    }
+    for (auto i = 0; i < size; i++) {
+      outputs[i] = {at::zeros(at::CPU(at::kFloat), {16, 16})};
+    }
+
+    ::c10d::ScatterOptions options;
+    options.rootRank = root;
+    WorkVector work(size);
+    for (auto i = 0; i < size; i++) {
+      work[i] =
+          tests[i].getProcessGroup().scatter(outputs[i], inputs[i], options);
+    }
+    waitWork(work);
+
+    for (auto i = 0; i < size; i++) {
+      checkValue(outputs[i][0], root * size + i);
+    }
+  }
+}
+
+void testReduceScatter(const std::string& path) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // Rank i contributes i * size + j to the output of rank j
+  std::vector<std::vector<std::vector<at::Tensor>>> inputs(size);
+  std::vector<std::vector<at::Tensor>> outputs(size);
+  for (auto i = 0; i < size; i++) {
+    inputs[i].resize(1);
+    for (auto j = 0; j < size; j++) {
+      inputs[i][0].push_back(
+          at::ones(at::CPU(at::kFloat), {16, 16}) * (i * size + j));
+    }
+    outputs[i] = {at::zeros(at::CPU(at::kFloat), {16, 16})};
+  }
+
+  WorkVector work(size);
+  for (auto i = 0; i < size; i++) {
+    work[i] =
+        tests[i].getProcessGroup().reduce_scatter(outputs[i], inputs[i]);
+  }
+  waitWork(work);
+
+  for (auto j = 0; j < size; j++) {
+    checkValue(outputs[j][0], size * (size * (size - 1)) / 2 + size * j);
+  }
+}
+
+void testBarrier(const std::string& path) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // The barrier completes after the allreduce queued before it
+  std::vector<std::vector<at::Tensor>> inputs(size);
+  WorkVector allreduceWork(size);
+  WorkVector barrierWork(size);
+  for (auto i = 0; i < size; i++) {
+    inputs[i] = {at::ones(at::CPU(at::kFloat), {1024}) * i};
+    allreduceWork[i] = tests[i].getProcessGroup().allreduce(inputs[i]);
+    barrierWork[i] = tests[i].getProcessGroup().barrier();
+  }
+  waitWork(barrierWork);
+  for (auto i = 0; i < size; i++) {
+    if (!allreduceWork[i]->isCompleted()) {
+      throw std::runtime_error("barrier completed before earlier work");
+    }
+  }
+  waitWork(allreduceWork);
+}
+
+void testSendRecv(const std::string& path) {
+  const auto size = 3;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // Rank 0 sends to rank 1 with two tags, which are received in reverse
+  std::vector<at::Tensor> send0 = {at::ones(at::CPU(at::kFloat), {16}) * 7};
+  std::vector<at::Tensor> send1 = {at::ones(at::CPU(at::kFloat), {16}) * 8};
+  std::vector<at::Tensor> recv0 = {at::zeros(at::CPU(at::kFloat), {16})};
+  std::vector<at::Tensor> recv1 = {at::zeros(at::CPU(at::kFloat), {16})};
+  WorkVector work = {
+      tests[1].getProcessGroup().recv(recv1, 0, 1),
+      tests[0].getProcessGroup().send(send0, 1, 0),
+      tests[0].getProcessGroup().send(send1, 1, 1),
+      tests[1].getProcessGroup().recv(recv0, 0, 0),
+  };
+  // The operations complete without anyone waiting for them
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  for (const auto& w : work) {
+    while (!w->isCompleted()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        throw std::runtime_error("send/recv didn't complete without wait()");
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  waitWork(work);
+  checkValue(recv0[0], 7);
+  checkValue(recv1[0], 8);
+
+  // Rank 1 receives from whichever rank sends
+  std::vector<at::Tensor> send2 = {at::ones(at::CPU(at::kFloat), {16}) * 9};
+  std::vector<at::Tensor> recv2 = {at::zeros(at::CPU(at::kFloat), {16})};
+  auto recvWork = tests[1].getProcessGroup().recvAnysource(recv2, 2);
+  auto sendWork = tests[2].getProcessGroup().send(send2, 1, 2);
+  waitWork({recvWork, sendWork});
+  checkValue(recv2[0], 9);
+  if (recvWork->sourceRank() != 2) {
+    throw std::runtime_error("recvAnysource got the wrong source rank");
+  }
+}
+
+// Runs the collectives and point to point operations in separate
+// processes that find each other through a TCPStore.
+void testMultiProcess(int port) {
+  const auto size = 2;
+
+  auto run = [&](int rank) {
+    auto store = std::make_shared<::c10d::TCPStore>("127.0.0.1", port, rank == 0);
+    ::c10d::ProcessGroupGloo::Options options;
+    options.devices.push_back(createLoopbackDevice());
+    ::c10d::ProcessGroupGloo pg(store, rank, size, options);
+
+    std::vector<at::Tensor> input = {
+        at::ones(at::CPU(at::kFloat), {16, 16}) * rank};
+    std::vector<std::vector<at::Tensor>> output = {
+        {at::zeros(at::CPU(at::kFloat), {16, 16}),
+         at::zeros(at::CPU(at::kFloat), {16, 16})}};
+    waitWork({pg.allgather(output, input)});
+    checkValue(output[0][0], 0);
+    checkValue(output[0][1], 1);
+
+    std::vector<at::Tensor> tensor = {at::ones(at::CPU(at::kFloat), {16})};
+    if (rank == 0) {
+      waitWork({pg.send(tensor, 1, 0)});
+    } else {
+      tensor[0].zero_();
+      waitWork({pg.recv(tensor, 0, 0)});
+      checkValue(tensor[0], 1);
+    }
+    waitWork({pg.barrier()});
+  };
+
+  Fork fork;
+  if (fork.isChild()) {
+    try {
+      run(1);
+    } catch (const std::exception& ex) {
+      std::cerr << "rank 1 failed: " << ex.what() << std::endl;
+      _exit(1);
+    }
+    _exit(0);
+  }
+
+  run(0);
+  int status;
+  waitpid(fork.pid, &status, 0);
+  fork.pid = -1;
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    throw std::runtime_error("rank 1 failed");
+  }
+}
+
 int main(int argc, char** argv) {
+  // Fork before this process starts any threads
+  testMultiProcess(29501);
+
   {
     TemporaryFile file;
     auto work = testSignal(file.path, SIGSTOP);
@@ -279,5 +665,45 @@ int main(int argc, char** argv) {
     testBroadcast(file.path, at::kCUDA);
   }
 
+  {
+    TemporaryFile file;
+    testCompressedAllreduce(file.path);
+  }
+
+  {
+    TemporaryFile file;
+    testReduce(file.path);
+  }
+
+  {
+    TemporaryFile file;
+    testAllgather(file.path);
+  }
+
+  {
+    TemporaryFile file;
+    testGather(file.path);
+  }
+
+  {
+    TemporaryFile file;
+    testScatter(file.path);
+  }
+
+  {
+    TemporaryFile file;
+    testReduceScatter(file.path);
+  }
+
+  {
+    TemporaryFile file;
+    testBarrier(file.path);
+  }
+
+  {
+    TemporaryFile file;
+    testSendRecv(file.path);
+  }
+
   return 0;
 }
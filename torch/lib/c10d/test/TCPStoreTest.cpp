@@ -1,11 +1,139 @@
 #include "StoreTestCommon.hpp"
 
+#include <sys/resource.h>
+
 #include <cstdlib>
 #include <iostream>
 #include <thread>
 
 #include <c10d/TCPStore.hpp>
 
+std::vector<uint8_t> toVec(const std::string& str) {
+  return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+void testBatchedOps(c10d::TCPStore& store) {
+  store.multiSet({"multi0", "multi1"}, {toVec("value0"), toVec("value1")});
+  auto values = store.multiGet({"multi1", "multi0"});
+  if (values != std::vector<std::vector<uint8_t>>{toVec("value1"),
+                                                  toVec("value0")}) {
+    throw std::runtime_error("multiGet got wrong values");
+  }
+
+  // A get of a missing key returns once it is set
+  c10d::TCPStore client("127.0.0.1", 29500, false);
+  std::thread setter([&client] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    c10d::test::set(client, "late", "value");
+  });
+  c10d::test::check(store, "late", "value");
+  setter.join();
+}
+
+void testCompareSet(c10d::TCPStore& store) {
+  // An empty expected value matches a missing key
+  if (store.compareSet("cas", {}, toVec("first")) != toVec("first")) {
+    throw std::runtime_error("compareSet failed to create key");
+  }
+  if (store.compareSet("cas", toVec("wrong"), toVec("second")) !=
+      toVec("first")) {
+    throw std::runtime_error("compareSet replaced an unexpected value");
+  }
+  if (store.compareSet("cas", toVec("first"), toVec("second")) !=
+      toVec("second")) {
+    throw std::runtime_error("compareSet failed to replace the value");
+  }
+  if (!store.compareSet("cas-missing", toVec("value"), toVec("x")).empty()) {
+    throw std::runtime_error("compareSet created a key unexpectedly");
+  }
+}
+
+void testWatch(c10d::TCPStore& store) {
+  c10d::test::set(store, "watched", "v0");
+  // Returns right away if the value already differs
+  if (store.watch("watched", toVec("old")) != toVec("v0")) {
+    throw std::runtime_error("watch got wrong value");
+  }
+
+  c10d::TCPStore client("127.0.0.1", 29500, false);
+  std::thread setter([&client] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Setting the same value doesn't wake up the watcher
+    c10d::test::set(client, "watched", "v0");
+    client.add("watched-counter", 1);
+    c10d::test::set(client, "watched", "v1");
+  });
+  if (store.watch("watched", toVec("v0")) != toVec("v1")) {
+    throw std::runtime_error("watch got wrong value");
+  }
+  setter.join();
+}
+
+// A client that times out while waiting and disconnects must not leave
+// anything behind in the daemon.
+void testAbandonedWait(c10d::TCPStore& store) {
+  {
+    c10d::TCPStore client("127.0.0.1", 29500, false);
+    try {
+      client.wait({"abandoned"}, std::chrono::milliseconds(100));
+      throw std::logic_error("wait should have timed out");
+    } catch (const std::system_error&) {
+    }
+  }
+  c10d::test::set(store, "abandoned", "value");
+  c10d::TCPStore client("127.0.0.1", 29500, false);
+  c10d::test::check(client, "abandoned", "value");
+}
+
+// A watch that times out must not have its reply taken for the reply to
+// a later request.
+void testTimedOutWatch(c10d::TCPStore& store) {
+  c10d::test::set(store, "timed-out", "v0");
+  try {
+    store.watch("timed-out", toVec("v0"), std::chrono::milliseconds(100));
+    throw std::logic_error("watch should have timed out");
+  } catch (const std::system_error&) {
+  }
+  c10d::test::set(store, "timed-out", "v1");
+  c10d::test::check(store, "timed-out", "v1");
+  if (store.add("timed-out-counter", 3) != 3) {
+    throw std::runtime_error("add got the wrong value");
+  }
+}
+
+// Rendezvous of as many concurrent clients as there are file descriptors
+// for, up to numClients.
+void testRendezvous(int numClients) {
+  struct rlimit limit;
+  SYSCHECK(::getrlimit(RLIMIT_NOFILE, &limit));
+  limit.rlim_cur = limit.rlim_max;
+  SYSCHECK(::setrlimit(RLIMIT_NOFILE, &limit));
+  // Every client takes a socket on each side
+  numClients = std::min<int>(numClients, (limit.rlim_cur - 64) / 2);
+
+  c10d::TCPStore server("127.0.0.1", 29501, true);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < numClients; i++) {
+    threads.emplace_back([i, numClients] {
+      c10d::TCPStore store("127.0.0.1", 29501, false);
+      c10d::test::set(store, "rank/" + std::to_string(i), std::to_string(i));
+      if (store.add("arrived", 1) == numClients) {
+        c10d::test::set(store, "ready", "1");
+      }
+      store.wait({"ready"});
+      const auto next = (i + 1) % numClients;
+      auto values = store.multiGet({"rank/" + std::to_string(next), "arrived"});
+      if (values[0] != toVec(std::to_string(next)) ||
+          values[1] != toVec(std::to_string(numClients))) {
+        throw std::runtime_error("rendezvous got wrong values");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 int main(int argc, char** argv) {
   // server store
   c10d::TCPStore serverStore("127.0.0.1", 29500, true);
@@ -83,6 +211,13 @@ int main(int argc, char** argv) {
     c10d::test::check(serverStore, key, val);
   }
 
+  testBatchedOps(serverStore);
+  testCompareSet(serverStore);
+  testWatch(serverStore);
+  testAbandonedWait(serverStore);
+  testTimedOutWatch(serverStore);
+  testRendezvous(2048);
+
   std::cout << "Test succeeded" << std::endl;
   return EXIT_SUCCESS;
 }
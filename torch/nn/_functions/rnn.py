@@ -295,11 +295,130 @@ def CudnnRNN(mode, input_size, hidden_size, num_layers=1,
     return forward
 
 
+class CpuRNNFunction(torch.autograd.Function):
+    r"""Runs torch._cpu_rnn and differentiates it with torch._cpu_rnn_backward.
+
+    _cpu_rnn_backward is not differentiable itself, so when the gradient is
+    computed with ``create_graph=True``, backward recomputes the forward pass
+    with AutogradRNN instead and differentiates that, which keeps double
+    backward working at the cost of a slower backward pass.
+    """
+
+    @staticmethod
+    def forward(ctx, args, batch_sizes, input, hx, cx, *weight_arr):
+        (mode_name, mode, input_size, hidden_size, num_layers, batch_first,
+         bidirectional, weight_stride0) = args
+        output, hy, cy, reserve = torch._cpu_rnn(
+            input, weight_arr, weight_stride0,
+            hx, cx,
+            mode, hidden_size, num_layers,
+            batch_first, True, bidirectional,
+            list(batch_sizes.data) if batch_sizes is not None else ())
+        ctx.args = args
+        ctx.batch_sizes = batch_sizes
+        ctx.has_cx = cx is not None
+        tensors = [input, hx] + ([cx] if cx is not None else []) + list(weight_arr)
+        ctx.save_for_backward(output, reserve, *tensors)
+        if cx is not None:
+            return output, hy, cy
+        return output, hy
+
+    @staticmethod
+    def backward(ctx, grad_output, *grad_hidden):
+        (mode_name, mode, input_size, hidden_size, num_layers, batch_first,
+         bidirectional, weight_stride0) = ctx.args
+        output, reserve, input, hx = ctx.saved_tensors[:4]
+        cx = ctx.saved_tensors[4] if ctx.has_cx else None
+        weight_arr = list(ctx.saved_tensors[5 if ctx.has_cx else 4:])
+        needs_grad = ctx.needs_input_grad[2:]
+
+        if not torch.is_grad_enabled():
+            grad_input, grad_hx, grad_cx, grad_weights = torch._cpu_rnn_backward(
+                input, weight_arr, weight_stride0,
+                hx, cx, output, grad_output,
+                grad_hidden[0], grad_hidden[1] if ctx.has_cx else None,
+                mode, hidden_size, num_layers,
+                batch_first, True, bidirectional,
+                list(ctx.batch_sizes.data) if ctx.batch_sizes is not None else (),
+                reserve, list(needs_grad[:3]) + [any(needs_grad[3:])])
+            if not any(needs_grad[3:]):
+                grad_weights = [None] * len(weight_arr)
+            return (None, None, grad_input, grad_hx, grad_cx) + tuple(grad_weights)
+
+        # create_graph=True
+        func = AutogradRNN(mode_name, input_size, hidden_size, num_layers,
+                           batch_first=batch_first, bidirectional=bidirectional,
+                           variable_length=ctx.batch_sizes is not None)
+        weight = [weight_arr[i:i + weight_stride0]
+                  for i in range(0, len(weight_arr), weight_stride0)]
+        output, hidden = func(input, weight, (hx, cx) if ctx.has_cx else hx, ctx.batch_sizes)
+        outputs = [output] + (list(hidden) if ctx.has_cx else [hidden])
+        inputs = [input, hx, cx] + weight_arr
+        wrt = [t for t, needed in zip(inputs, needs_grad) if needed]
+        grads = iter(torch.autograd.grad(outputs, wrt, [grad_output] + list(grad_hidden),
+                                         create_graph=True, allow_unused=True))
+        return (None, None) + tuple(next(grads) if needed else None for needed in needs_grad)
+
+
+def CpuRNN(mode, input_size, hidden_size, num_layers=1,
+           batch_first=False, dropout=0, train=True, bidirectional=False,
+           variable_length=False, dropout_state=None, flat_weight=None):
+    mode_name = mode
+    mode = {
+        'RNN_RELU': cudnn.CUDNN_RNN_RELU,
+        'RNN_TANH': cudnn.CUDNN_RNN_TANH,
+        'LSTM': cudnn.CUDNN_LSTM,
+        'GRU': cudnn.CUDNN_GRU,
+    }[mode]
+
+    def forward(input, weight, hx, batch_sizes):
+        if mode == cudnn.CUDNN_LSTM:
+            hx, cx = hx
+        else:
+            cx = None
+
+        weight_arr = list(itertools.chain.from_iterable(weight))
+        weight_stride0 = len(weight[0])
+        tensors = [input, hx] + weight_arr + ([cx] if cx is not None else [])
+        if not variable_length:
+            batch_sizes = None
+
+        if torch.is_grad_enabled() and any(t.requires_grad for t in tensors):
+            args = (mode_name, mode, input_size, hidden_size, num_layers,
+                    batch_first, bool(bidirectional), weight_stride0)
+            outputs = CpuRNNFunction.apply(args, batch_sizes, input, hx, cx, *weight_arr)
+            output, hy = outputs[:2]
+            cy = outputs[2] if cx is not None else None
+        else:
+            # Without backward, the activations of the steps are not kept
+            output, hy, cy, _ = torch._cpu_rnn(
+                input, weight_arr, weight_stride0,
+                hx, cx,
+                mode, hidden_size, num_layers,
+                batch_first, False, bool(bidirectional),
+                list(batch_sizes.data) if batch_sizes is not None else ())
+
+        if cx is not None:
+            return (output, (hy, cy))
+        else:
+            return (output, hy)
+
+    return forward
+
+
+def cpu_rnn_is_acceptable(input, dropout=0, train=True, **kwargs):
+    # The fused CPU op has no dropout between layers
+    return (not input.is_cuda and input.dtype in (torch.float32, torch.float64) and
+            (dropout == 0 or not train))
+
+
 def RNN(*args, **kwargs):
 
     def forward(input, *fargs, **fkwargs):
         if cudnn.is_acceptable(input.data):
             func = CudnnRNN(*args, **kwargs)
+        elif cpu_rnn_is_acceptable(input, **kwargs):
+            func = CpuRNN(*args, **kwargs)
         else:
             func = AutogradRNN(*args, **kwargs)
 
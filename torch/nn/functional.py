@@ -1111,7 +1111,8 @@ def embedding(input, weight, padding_idx=None, max_norm=None, norm_type=2,
 
 
 def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
-                  scale_grad_by_freq=False, mode='mean', sparse=False):
+                  scale_grad_by_freq=False, mode='mean', sparse=False,
+                  per_sample_weights=None):
     r"""Computes sums or means of 'bags' of embeddings, without instantiating the
     intermediate embeddings.
 
@@ -1135,6 +1136,10 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
         sparse (bool, optional): if ``True``, gradient w.r.t. :attr:`weight` will be a sparse tensor. See Notes under
                                  :class:`torch.nn.Embedding` for more details regarding sparse gradients.
                                  Note: this option is not supported when ``mode="max"``.
+        per_sample_weights (Tensor, optional): a tensor of float / double weights, or None
+            to indicate all weights should be taken to be ``1``. If specified, :attr:`per_sample_weights`
+            must have exactly the same shape as input and is treated as having the same
+            :attr:`offsets`, if those are not ``None``. Only supported for ``mode='sum'``.
 
     Shape:
 
@@ -1158,6 +1163,9 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
         - :attr:`weight` (Tensor): the learnable weights of the module of
           shape ``(num_embeddings x embedding_dim)``
 
+        - :attr:`per_sample_weights` (Tensor, optional). Has the same shape as
+          :attr:`input`.
+
         - :attr:`output`: aggregated embedding values of shape ``B x embedding_dim``
 
     Examples::
@@ -1191,6 +1199,8 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
                                    dtype=torch.long, device=input.device)
 
             input = input.reshape(-1)
+            if per_sample_weights is not None:
+                per_sample_weights = per_sample_weights.reshape(-1)
     elif input.dim() == 1:
         if offsets is None:
             raise ValueError("offsets has to be a 1D Tensor but got None")
@@ -1224,6 +1234,16 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
     else:
         raise ValueError("mode has to be one of sum or mean")
 
+    if per_sample_weights is not None:
+        if mode != 0:
+            raise NotImplementedError("embedding_bag: per_sample_weights is only "
+                                      "supported for mode='sum' (got mode='{}')"
+                                      .format(['sum', 'mean', 'max'][mode]))
+        if per_sample_weights.shape != input.shape:
+            raise ValueError("embedding_bag: If per_sample_weights ({}) is not None, "
+                             "then it must have the same shape as the input ({})"
+                             .format(per_sample_weights.shape, input.shape))
+
     if max_norm is not None:
         with torch.no_grad():
             torch.embedding_renorm_(weight, input, max_norm, norm_type)
@@ -1234,7 +1254,8 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
         offsets,
         scale_grad_by_freq,
         mode,
-        sparse)
+        sparse,
+        per_sample_weights)
     return ret
 
 
@@ -23,9 +23,13 @@ DEFAULT_PROTOCOL = 2
 LONG_SIZE = struct.Struct('=l').size
 INT_SIZE = struct.Struct('=i').size
 SHORT_SIZE = struct.Struct('=h').size
+LONG_LONG_SIZE = struct.Struct('=q').size
 
 MAGIC_NUMBER = 0x1950a86a20f9469cfc6c
 PROTOCOL_VERSION = 1001
+# Files written with storage_alignment, in which the storages are placed at
+# aligned offsets recorded before the pickled object
+ALIGNED_PROTOCOL_VERSION = 1002
 STORAGE_KEY_SEPARATOR = ','
 
 
@@ -161,6 +165,28 @@ def _should_read_directly(f):
         return False
 
 
+def _align(offset, alignment):
+    return (offset + alignment - 1) // alignment * alignment
+
+
+def _map_file(f, sys_info):
+    name = getattr(f, 'name', None)
+    if not _should_read_directly(f) or not isinstance(name, _string_classes):
+        raise ValueError("torch.load with mmap_mode requires a file name or a "
+                         "file object opened from a file name")
+    # Mapped storages alias the file's bytes as they are, so they can only be
+    # used if they were saved on a machine with the same layout.
+    if sys_info['little_endian'] != (sys.byteorder == 'little') or \
+            sys_info['type_sizes'] != dict(short=SHORT_SIZE, int=INT_SIZE, long=LONG_SIZE):
+        raise RuntimeError("torch.load with mmap_mode can't map a file saved on a machine "
+                           "with a different byte order or type sizes; load it without "
+                           "mmap_mode instead")
+    size = os.fstat(f.fileno()).st_size
+    # A private mapping, so that writing to a storage copies the page instead
+    # of changing the file (or crashing, as a read-only mapping would).
+    return torch.ByteStorage.from_file(name, shared=False, size=size)
+
+
 def _check_seekable(f):
 
     def raise_err_msg(patterns, e):
@@ -179,7 +205,8 @@ def _check_seekable(f):
         raise_err_msg(["seek", "tell"], e)
 
 
-def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL):
+def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL,
+         storage_alignment=None):
     """Saves an object to a disk file.
 
     See also: :ref:`recommend-saving-models`
@@ -190,6 +217,12 @@ def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL):
            containing a file name
         pickle_module: module used for pickling metadata and objects
         pickle_protocol: can be specified to override the default protocol
+        storage_alignment: if given, the data of every storage is written at
+           a file offset that is a multiple of it (a multiple of 8, usually
+           the page size, e.g. 4096), so that :func:`torch.load` can map the
+           storages from the file with `mmap_mode` instead of reading them.
+           `f` then also has to implement tell. Such files can't be loaded by
+           older versions of PyTorch.
 
     .. warning::
         If you are using Python 2, torch.save does NOT support StringIO.StringIO
@@ -206,10 +239,16 @@ def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL):
         >>> buffer = io.BytesIO()
         >>> torch.save(x, buffer)
     """
-    return _with_file_like(f, "wb", lambda f: _save(obj, f, pickle_module, pickle_protocol))
+    return _with_file_like(f, "wb", lambda f: _save(obj, f, pickle_module, pickle_protocol,
+                                                    storage_alignment))
+
 
+def _save(obj, f, pickle_module, pickle_protocol, storage_alignment=None):
+    if storage_alignment is not None and \
+            (storage_alignment <= 0 or storage_alignment % LONG_LONG_SIZE != 0):
+        raise ValueError("storage_alignment must be a positive multiple of {}, "
+                         "but got {}".format(LONG_LONG_SIZE, storage_alignment))
 
-def _save(obj, f, pickle_module, pickle_protocol):
     if sys.version_info[0] == 2:
         import StringIO
         if isinstance(f, StringIO.StringIO):
@@ -264,8 +303,11 @@ def _save(obj, f, pickle_module, pickle_protocol):
 
         return None
 
+    protocol_version = PROTOCOL_VERSION
+    if storage_alignment is not None:
+        protocol_version = ALIGNED_PROTOCOL_VERSION
     sys_info = dict(
-        protocol_version=PROTOCOL_VERSION,
+        protocol_version=protocol_version,
         little_endian=sys.byteorder == 'little',
         type_sizes=dict(
             short=SHORT_SIZE,
@@ -273,10 +315,16 @@ def _save(obj, f, pickle_module, pickle_protocol):
             long=LONG_SIZE,
         ),
     )
+    if storage_alignment is not None:
+        sys_info['storage_alignment'] = storage_alignment
 
     pickle_module.dump(MAGIC_NUMBER, f, protocol=pickle_protocol)
-    pickle_module.dump(PROTOCOL_VERSION, f, protocol=pickle_protocol)
+    pickle_module.dump(protocol_version, f, protocol=pickle_protocol)
     pickle_module.dump(sys_info, f, protocol=pickle_protocol)
+    if storage_alignment is not None:
+        _save_aligned(obj, f, pickle_module, pickle_protocol, persistent_id,
+                      serialized_storages, storage_alignment)
+        return
     pickler = pickle_module.Pickler(f, protocol=pickle_protocol)
     pickler.persistent_id = persistent_id
     pickler.dump(obj)
@@ -288,7 +336,44 @@ def _save(obj, f, pickle_module, pickle_protocol):
         serialized_storages[key]._write_file(f, _should_read_directly(f))
 
 
-def load(f, map_location=None, pickle_module=pickle):
+def _save_aligned(obj, f, pickle_module, pickle_protocol, persistent_id,
+                  serialized_storages, storage_alignment):
+    # The object is pickled first to find its storages and its size. It is
+    # written after the offsets of the storages, so that they are known when
+    # it is unpickled. Each storage is written as usual (its size as an int64
+    # followed by its data), with padding so that its data starts at an
+    # aligned offset.
+    buffer = io.BytesIO()
+    pickler = pickle_module.Pickler(buffer, protocol=pickle_protocol)
+    pickler.persistent_id = persistent_id
+    pickler.dump(obj)
+    pickled_obj = buffer.getvalue()
+
+    # Offsets of the data of the storages from the data of the first one
+    storage_offsets = []
+    offset = 0
+    for key in sorted(serialized_storages.keys()):
+        storage = serialized_storages[key]
+        storage_offsets.append((key, offset))
+        nbytes = storage.size() * storage.element_size()
+        offset = _align(offset + nbytes + LONG_LONG_SIZE, storage_alignment)
+    pickle_module.dump((len(pickled_obj), storage_offsets), f, protocol=pickle_protocol)
+    data_start = _align(f.tell() + len(pickled_obj) + LONG_LONG_SIZE, storage_alignment)
+    f.write(pickled_obj)
+
+    # Storages are written directly to the file descriptor of real files, so
+    # f.tell() doesn't account for them
+    position = f.tell()
+    for key, offset in storage_offsets:
+        storage = serialized_storages[key]
+        header = data_start + offset - LONG_LONG_SIZE
+        f.write(b'\0' * (header - position))
+        f.flush()
+        storage._write_file(f, _should_read_directly(f))
+        position = header + LONG_LONG_SIZE + storage.size() * storage.element_size()
+
+
+def load(f, map_location=None, pickle_module=pickle, mmap_mode=None):
     """Loads an object saved with :func:`torch.save` from a file.
 
     :meth:`torch.load` uses Python's unpickling facilities but treats storages,
@@ -327,6 +412,16 @@ def load(f, map_location=None, pickle_module=pickle):
             locations
         pickle_module: module used for unpickling metadata and objects (has to
             match the pickle_module used to serialize file)
+        mmap_mode: if ``'c'``, and `f` was saved with `storage_alignment`,
+            storages are mapped copy-on-write from the file instead of being
+            read: processes loading the same file share its pages in the page
+            cache until they write to them, changes only affect the process
+            that makes them, and loading doesn't read the storages from disk
+            until they are accessed. `f` has to be a file name or a file
+            object opened from one, saved on a machine with the same byte
+            order and type sizes. Storages that are moved to another device
+            by `map_location` are copied from the mapping. Other files are
+            read as usual.
 
     .. note::
         When you call :meth:`torch.load()` on a file which contains GPU tensors, those tensors
@@ -355,13 +450,15 @@ def load(f, map_location=None, pickle_module=pickle):
         new_fd = True
         f = open(f, 'rb')
     try:
-        return _load(f, map_location, pickle_module)
+        return _load(f, map_location, pickle_module, mmap_mode)
     finally:
         if new_fd:
             f.close()
 
 
-def _load(f, map_location, pickle_module):
+def _load(f, map_location, pickle_module, mmap_mode=None):
+    if mmap_mode not in (None, 'c'):
+        raise ValueError("mmap_mode must be None or 'c', but got {}".format(mmap_mode))
     deserialized_objects = {}
 
     if map_location is None:
@@ -504,8 +601,12 @@ def _load(f, map_location, pickle_module):
         elif typename == 'storage':
             data_type, root_key, location, size, view_metadata = data
             if root_key not in deserialized_objects:
-                deserialized_objects[root_key] = restore_location(
-                    data_type(size), location)
+                if mapping is not None:
+                    obj = data_type._new_from_mapping(
+                        mapping, storage_offsets[root_key], size)
+                else:
+                    obj = data_type(size)
+                deserialized_objects[root_key] = restore_location(obj, location)
             storage = deserialized_objects[root_key]
             if view_metadata is not None:
                 view_key, offset, view_size = view_metadata
@@ -533,14 +634,35 @@ def _load(f, map_location, pickle_module):
     if magic_number != MAGIC_NUMBER:
         raise RuntimeError("Invalid magic number; corrupt file?")
     protocol_version = pickle_module.load(f)
-    if protocol_version != PROTOCOL_VERSION:
+    if protocol_version not in (PROTOCOL_VERSION, ALIGNED_PROTOCOL_VERSION):
         raise RuntimeError("Invalid protocol version: %s" % protocol_version)
 
-    _sys_info = pickle_module.load(f)
+    sys_info = pickle_module.load(f)
+    mapping = None
+    if protocol_version == ALIGNED_PROTOCOL_VERSION:
+        storage_alignment = sys_info['storage_alignment']
+        pickled_obj_size, relative_offsets = pickle_module.load(f)
+        data_start = _align(f.tell() + pickled_obj_size + LONG_LONG_SIZE, storage_alignment)
+        # Offsets of the data of the storages in the file
+        storage_offsets = {key: data_start + offset for key, offset in relative_offsets}
+        if mmap_mode is not None:
+            mapping = _map_file(f, sys_info)
+
     unpickler = pickle_module.Unpickler(f)
     unpickler.persistent_load = persistent_load
     result = unpickler.load()
 
+    if protocol_version == ALIGNED_PROTOCOL_VERSION:
+        if mapping is None:
+            for key, offset in relative_offsets:
+                header = storage_offsets[key] - LONG_LONG_SIZE
+                if f_should_read_directly:
+                    deserialized_objects[key]._set_from_file(f, header, True)
+                else:
+                    f.seek(header)
+                    deserialized_objects[key]._set_from_file(f, None, False)
+        return result
+
     deserialized_storage_keys = pickle_module.load(f)
 
     offset = f.tell() if f_should_read_directly else None
@@ -298,17 +298,13 @@ class Tensor(torch._C._TensorBase):
     def masked_fill(self, mask, value):
         return self.clone().masked_fill_(mask, value)
 
-    def unique(self, sorted=False, return_inverse=False):
+    def unique(self, sorted=False, return_inverse=False, return_counts=False):
         r"""Returns the unique scalar elements of the tensor as a 1-D tensor.
 
         See :func:`torch.unique`
         """
-        output, inverse_indices = self._unique(
-            sorted=sorted, return_inverse=return_inverse)
-        if return_inverse:
-            return output, inverse_indices
-        else:
-            return output
+        return torch.unique(self, sorted=sorted, return_inverse=return_inverse,
+                            return_counts=return_counts)
 
     def __rsub__(self, other):
         return torch.sub(other, self)